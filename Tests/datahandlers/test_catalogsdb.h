@@ -99,6 +99,31 @@ class TestCatalogsDB_DBManager : public QObject
         QCOMPARE(obj.name(), objs.front().name());
     }
 
+    void find_by_prefix()
+    {
+        const auto &success =
+            m_manager.add_object(user_catalog_id, SkyObject::GALAXY, dms{ 1 }, dms{ 0 },
+                                 "Zqx 4711", 5, "Quuxly Galaxy");
+        QVERIFY(success.first);
+
+        for (const auto &prefix : { "zqx", "ZQX 47", "quux", "quuxly gal" })
+        {
+            const auto &objs = m_manager.find_objects_by_prefix(prefix, 5);
+            QVERIFY(objs.size() > 0);
+            QCOMPARE(objs.front().name(), QString("Zqx 4711"));
+        }
+
+        QCOMPARE(m_manager.find_objects_by_prefix("zqx 4712", 5).size(), 0);
+
+        // The name search still finds substrings, the prefix search only
+        // doesn't when sqlite has full-text search
+        if (m_manager.has_name_search())
+            QCOMPARE(m_manager.find_objects_by_prefix("uuxly", 5).size(), 0);
+        const auto &objs = m_manager.find_objects_by_name("uuxly", 5);
+        QVERIFY(objs.size() > 0);
+        QCOMPARE(objs.front().name(), QString("Zqx 4711"));
+    }
+
     void get_by_id()
     {
         const auto &obj     = some_object();
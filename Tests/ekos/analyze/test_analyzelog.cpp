@@ -0,0 +1,283 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_analyzelog.h"
+
+#include "ekos/analyze/analyzelog.h"
+#include "ekos/analyze/analyzeseries.h"
+#include "qcustomplot.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#include <algorithm>
+
+using Ekos::AnalyzeLog;
+using Ekos::AnalyzeSeries;
+
+namespace
+{
+// Guide stats and temperatures in time order, between the other lines of a session
+const QStringList sessionLines =
+{
+    "#KStars version 3.7.0. Analyze log version 1.0.",
+    "AnalyzeStartTime,2026-10-17 20:00:00.000,UTC",
+    "GuideStats,1.000,0.5,-0.25,10,-20,35.5,120.0,3",
+    "GuideStats,3.000,0.75,-0.5,15,-25,36.0,121.0,3",
+    "GuideStats,5.000,-0.125,0.25,-5,10,34.5,119.0,2",
+    "CaptureStarting,6.000,30.000,Red",
+    "Temperature,7.000,-10.5",
+    "Temperature,9.000,-10.25",
+    "GuideStats,11.000,0.0,0.0,0,0,37.0,118.0,4",
+    "CaptureComplete,36.000,30.000,Red,1.50,/tmp/light.fits"
+};
+
+// Sample values for the series tests, with a NaN gap marker at 500
+double sampleValue(int i)
+{
+    return i == 500 ? qQNaN() : (i * 37) % 101;
+}
+
+AnalyzeSeries makeSeries(int samples)
+{
+    AnalyzeSeries series;
+    for (int i = 0; i < samples; i++)
+        series.append(i, {sampleValue(i)});
+    return series;
+}
+}
+
+void TestAnalyzeLog::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dir.isValid());
+}
+
+void TestAnalyzeLog::init()
+{
+    m_path = m_dir.filePath(QString("%1.analyze").arg(QTest::currentTestFunction()));
+    QFile::remove(m_path);
+    QDir(QFileInfo(companion()).absolutePath()).removeRecursively();
+}
+
+QString TestAnalyzeLog::companion() const
+{
+    return AnalyzeLog::companionPath(QFileInfo(m_path));
+}
+
+QString TestAnalyzeLog::writeLog(const QStringList &lines)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return QString();
+    QTextStream out(&file);
+    for (const auto &line : lines)
+        out << line << "\n";
+    return m_path;
+}
+
+void TestAnalyzeLog::testRoundTrip()
+{
+    QVERIFY(!writeLog(sessionLines).isEmpty());
+
+    AnalyzeLog parsed;
+    QVERIFY(parsed.read(m_path));
+    QVERIFY(QFile::exists(companion()));
+
+    // Comments are dropped, the other lines are kept with their place among the stats
+    QCOMPARE(parsed.lines, QStringList({sessionLines[1], sessionLines[5], sessionLines[9]}));
+    QCOMPARE(parsed.guideStatsBefore, QVector<quint32>({0, 3, 4}));
+    QCOMPARE(parsed.temperaturesBefore, QVector<quint32>({0, 0, 2}));
+    QCOMPARE(parsed.guideTimes, QVector<double>({1, 3, 5, 11}));
+    QCOMPARE(parsed.raErrors, QVector<float>({0.5f, 0.75f, -0.125f, 0.0f}));
+    QCOMPARE(parsed.decPulses, QVector<qint32>({-20, -25, 10, 0}));
+    QCOMPARE(parsed.numStars, QVector<qint32>({3, 3, 2, 4}));
+    QCOMPARE(parsed.temperatureTimes, QVector<double>({7, 9}));
+    QCOMPARE(parsed.temperatures, QVector<float>({-10.5f, -10.25f}));
+
+    // The companion reads back the same
+    AnalyzeLog loaded;
+    QVERIFY(loaded.load(companion(), QFileInfo(m_path)));
+    QCOMPARE(loaded.lines, parsed.lines);
+    QCOMPARE(loaded.guideStatsBefore, parsed.guideStatsBefore);
+    QCOMPARE(loaded.temperaturesBefore, parsed.temperaturesBefore);
+    QCOMPARE(loaded.guideTimes, parsed.guideTimes);
+    QCOMPARE(loaded.raErrors, parsed.raErrors);
+    QCOMPARE(loaded.decErrors, parsed.decErrors);
+    QCOMPARE(loaded.raPulses, parsed.raPulses);
+    QCOMPARE(loaded.decPulses, parsed.decPulses);
+    QCOMPARE(loaded.snrs, parsed.snrs);
+    QCOMPARE(loaded.skyBgs, parsed.skyBgs);
+    QCOMPARE(loaded.numStars, parsed.numStars);
+    QCOMPARE(loaded.temperatureTimes, parsed.temperatureTimes);
+    QCOMPARE(loaded.temperatures, parsed.temperatures);
+
+    // Files still being written don't get a companion
+    QFile::remove(companion());
+    AnalyzeLog running;
+    QVERIFY(running.read(m_path, false));
+    QVERIFY(!QFile::exists(companion()));
+    QCOMPARE(running.guideTimes, parsed.guideTimes);
+}
+
+void TestAnalyzeLog::testSizeChanged()
+{
+    QVERIFY(!writeLog(sessionLines).isEmpty());
+    AnalyzeLog log;
+    QVERIFY(log.read(m_path));
+    const QDateTime modified = QFileInfo(m_path).lastModified();
+
+    // A line is appended, and the modification time restored, the size alone invalidates the companion
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    QVERIFY(file.write("GuideStats,13.000,0.25,0.25,5,5,36.5,118.5,4\n") > 0);
+    QVERIFY(file.flush());
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+
+    AnalyzeLog stale;
+    QVERIFY(!stale.load(companion(), QFileInfo(m_path)));
+
+    AnalyzeLog updated;
+    QVERIFY(updated.read(m_path));
+    QCOMPARE(updated.guideTimes, QVector<double>({1, 3, 5, 11, 13}));
+    QVERIFY(updated.load(companion(), QFileInfo(m_path)));
+}
+
+void TestAnalyzeLog::testModificationChanged()
+{
+    QVERIFY(!writeLog(sessionLines).isEmpty());
+    AnalyzeLog log;
+    QVERIFY(log.read(m_path));
+
+    // Same size, other modification time
+    QFile file(m_path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(QFileInfo(m_path).lastModified().addSecs(-3600), QFileDevice::FileModificationTime));
+    file.close();
+
+    AnalyzeLog stale;
+    QVERIFY(!stale.load(companion(), QFileInfo(m_path)));
+    QVERIFY(stale.read(m_path));
+    QCOMPARE(stale.guideTimes, log.guideTimes);
+}
+
+void TestAnalyzeLog::testOutOfOrder()
+{
+    QStringList lines = sessionLines;
+    lines.swapItemsAt(3, 4);
+    QVERIFY(!writeLog(lines).isEmpty());
+
+    // Read in the order of the file, but not cached
+    AnalyzeLog log;
+    QVERIFY(log.read(m_path));
+    QCOMPARE(log.guideTimes, QVector<double>({1, 5, 3, 11}));
+    QVERIFY(!QFile::exists(companion()));
+}
+
+void TestAnalyzeLog::testPrune()
+{
+    // Companions of older sessions
+    const QDir directory = QFileInfo(companion()).absoluteDir();
+    QVERIFY(directory.mkpath("."));
+    const QDateTime old = QDateTime::currentDateTime().addDays(-1);
+    for (int i = 0; i < 60; i++)
+    {
+        QFile file(directory.filePath(QString("old%1.analyzeb").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("old");
+        QVERIFY(file.flush());
+        QVERIFY(file.setFileTime(old.addSecs(i), QFileDevice::FileModificationTime));
+    }
+
+    QVERIFY(!writeLog(sessionLines).isEmpty());
+    AnalyzeLog log;
+    QVERIFY(log.read(m_path));
+
+    // The oldest are removed, the new one is kept
+    const QStringList left = directory.entryList(QStringList() << "*.analyzeb", QDir::Files);
+    QCOMPARE(left.size(), 50);
+    QVERIFY(QFile::exists(companion()));
+    QVERIFY(!left.contains("old0.analyzeb"));
+    QVERIFY(left.contains("old59.analyzeb"));
+}
+
+void TestAnalyzeLog::testSeriesOrder()
+{
+    AnalyzeSeries series(2);
+    series.append(1, {1, 10});
+    series.append(3, {3, 30});
+    series.append(2, {2, 20});
+    series.append(3, {4, 40});
+
+    QCOMPARE(series.size(), 4);
+    for (int i = 0; i < series.size(); i++)
+    {
+        QCOMPARE(series.time(i), std::min(i + 1.0, 3.0));
+        QCOMPARE(series.value(0, i), i + 1.0);
+        QCOMPARE(series.value(1, i), 10 * (i + 1.0));
+    }
+    QCOMPARE(series.findBegin(2.5), 1);
+    QCOMPARE(series.findBegin(0), 0);
+}
+
+void TestAnalyzeLog::testDownsample()
+{
+    const AnalyzeSeries series = makeSeries(1000);
+    const auto data = series.downsample(0, 0, 999, 10);
+
+    // At most the minimum and maximum of each of the 11 buckets, one of them split by the gap marker
+    QVERIFY(data.size() <= 2 * 12 + 1);
+
+    bool gap = false;
+    double minimum = 1e9, maximum = -1e9;
+    for (int i = 0; i < data.size(); i++)
+    {
+        if (i > 0)
+            QVERIFY(data[i].key >= data[i - 1].key);
+        if (qIsNaN(data[i].value))
+        {
+            QCOMPARE(data[i].key, 500.0);
+            gap = true;
+            continue;
+        }
+        // Points are samples, not averages
+        QCOMPARE(data[i].value, sampleValue(static_cast<int>(data[i].key)));
+        minimum = std::min(minimum, data[i].value);
+        maximum = std::max(maximum, data[i].value);
+    }
+    QVERIFY(gap);
+    QCOMPARE(minimum, 0.0);
+    QCOMPARE(maximum, 100.0);
+}
+
+void TestAnalyzeLog::testDownsampleWindow()
+{
+    const AnalyzeSeries series = makeSeries(1000);
+    const auto data = series.downsample(0, 100, 200, 100);
+
+    // Every sample of the window is there, the rest is coarse
+    int inside = 0, outside = 0;
+    for (const auto &point : data)
+    {
+        if (point.key >= 100 && point.key <= 200)
+        {
+            QCOMPARE(point.value, sampleValue(static_cast<int>(point.key)));
+            inside++;
+        }
+        else
+            outside++;
+    }
+    QCOMPARE(inside, 101);
+    QVERIFY(outside <= 2 * 2 * 101 + 1);
+    QVERIFY(outside < 1000 - 101);
+}
+
+QTEST_GUILESS_MAIN(TestAnalyzeLog)
@@ -0,0 +1,52 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/**
+ * @class TestAnalyzeLog
+ * @short Checks the binary companion of the .analyze files, and the downsampling of the Analyze stats plot.
+ * @author KStars Developers
+ */
+class TestAnalyzeLog : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestAnalyzeLog() = default;
+
+    private slots:
+        void initTestCase();
+        void init();
+
+        void testRoundTrip();
+        void testSizeChanged();
+        void testModificationChanged();
+        void testOutOfOrder();
+        void testPrune();
+
+        void testSeriesOrder();
+        void testDownsample();
+        void testDownsampleWindow();
+
+    private:
+        // Path of the binary companion of the log of the current test
+        QString companion() const;
+        QString writeLog(const QStringList &lines);
+
+        QTemporaryDir m_dir;
+        QString m_path;
+};
@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+#include <QTemporaryDir>
+#include "ekos/auxiliary/framecombiner.h"
+
+class TestFrameCombiner : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestFrameCombiner();
+        ~TestFrameCombiner() override = default;
+
+    private slots:
+        void outlierTest_data();
+        void outlierTest();
+        void tilingTest();
+};
+
+#include "testframecombiner.moc"
+
+TestFrameCombiner::TestFrameCombiner() : QObject()
+{
+}
+
+void TestFrameCombiner::outlierTest_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("expected");
+
+    // Frames are 1000, 1004, 996, 30000 (cosmic ray) and 1002
+    QTest::newRow("Average") << static_cast<int>(Ekos::FrameCombiner::COMBINE_AVERAGE) << 6800;
+    QTest::newRow("Median") << static_cast<int>(Ekos::FrameCombiner::COMBINE_MEDIAN) << 1002;
+    QTest::newRow("Sigma Clip") << static_cast<int>(Ekos::FrameCombiner::COMBINE_SIGMA_CLIP) << 1001;
+    QTest::newRow("Winsorized") << static_cast<int>(Ekos::FrameCombiner::COMBINE_WINSORIZED) << 1003;
+}
+
+void TestFrameCombiner::outlierTest()
+{
+    QFETCH(int, method);
+    QFETCH(int, expected);
+
+    QTemporaryDir dir;
+    Ekos::FrameCombiner combiner;
+    QVERIFY(combiner.begin(100, dir.path()));
+
+    const uint16_t levels[] = { 1000, 1004, 996, 30000, 1002 };
+    std::vector<uint16_t> frame(100);
+    for (uint16_t level : levels)
+    {
+        std::fill(frame.begin(), frame.end(), level);
+        QVERIFY(combiner.addFrame(frame.data()));
+    }
+    QCOMPARE(combiner.frames(), 5u);
+
+    combiner.setMethod(static_cast<Ekos::FrameCombiner::CombineMethod>(method));
+    std::vector<uint16_t> master(100);
+    QVERIFY(combiner.combine(master.data()));
+    for (uint16_t value : master)
+        QCOMPARE(static_cast<int>(value), expected);
+}
+
+void TestFrameCombiner::tilingTest()
+{
+    // A budget far smaller than the stack forces many tiles, each pixel must still come from its own position
+    const uint32_t samples = 100000;
+    QTemporaryDir dir;
+    Ekos::FrameCombiner combiner;
+    combiner.setMemoryBudget(64 * 1024);
+    QVERIFY(combiner.begin(samples, dir.path()));
+
+    std::vector<float> frame(samples);
+    for (int f = 0; f < 7; f++)
+    {
+        for (uint32_t i = 0; i < samples; i++)
+            frame[i] = i + f;
+        QVERIFY(combiner.addFrame(frame.data()));
+    }
+
+    combiner.setMethod(Ekos::FrameCombiner::COMBINE_MEDIAN);
+    std::vector<float> master(samples);
+    QVERIFY(combiner.combine(master.data()));
+    for (uint32_t i = 0; i < samples; i++)
+        QCOMPARE(master[i], static_cast<float>(i + 3));
+
+    // The stack is dropped
+    combiner.clear();
+    QCOMPARE(combiner.frames(), 0u);
+    QVERIFY(!combiner.combine(master.data()));
+}
+
+QTEST_GUILESS_MAIN(TestFrameCombiner)
@@ -10,14 +10,77 @@
 #include <QTest>
 #endif
 
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include "testfitsdata.h"
 #include "Options.h"
+#include "fitsviewer/fitscompressedwriter.h"
 #include "ekos/auxiliary/solverutils.h"
 #include "ekos/auxiliary/stellarsolverprofile.h"
 
 Q_DECLARE_METATYPE(FITSMode);
 
+namespace
+{
+// Write a random image of the type of bitpix to filename, its pixels are returned in their native type
+bool writeRandomFits(const QString &filename, int bitpix, int dataType, int bytesPerPixel, long *naxes,
+                     std::vector<uint8_t> &pixels)
+{
+    const long nelements = naxes[0] * naxes[1] * naxes[2];
+    pixels.resize(static_cast<size_t>(nelements) * bytesPerPixel);
+
+    QRandomGenerator generator(bitpix);
+    if (bitpix == FLOAT_IMG || bitpix == DOUBLE_IMG)
+    {
+        for (long i = 0; i < nelements; i++)
+        {
+            const double value = (generator.generateDouble() - 0.5) * 1e6;
+            if (bitpix == FLOAT_IMG)
+                reinterpret_cast<float *>(pixels.data())[i] = static_cast<float>(value);
+            else
+                reinterpret_cast<double *>(pixels.data())[i] = value;
+        }
+    }
+    else
+    {
+        // The whole range of the integers, including the sign bit of the unsigned ones
+        for (auto &byte : pixels)
+            byte = static_cast<uint8_t>(generator.bounded(256));
+    }
+
+    int status = 0;
+    fitsfile *fptr = nullptr;
+    QFile::remove(filename);
+    fits_create_diskfile(&fptr, filename.toLocal8Bit().data(), &status);
+    fits_create_img(fptr, bitpix, naxes[2] > 1 ? 3 : 2, naxes, &status);
+    fits_write_img(fptr, dataType, 1, nelements, pixels.data(), &status);
+    int closeStatus = 0;
+    if (fptr)
+        fits_close_file(fptr, status ? &closeStatus : &status);
+    return status == 0;
+}
+
+// Exact median and median absolute deviation of count pixels of type T, sorting all of them
+template <typename T>
+void sortedMedianAndMAD(const std::vector<uint8_t> &pixels, size_t offset, size_t count, double &median, double &mad)
+{
+    auto middle = [](std::vector<double> &values)
+    {
+        std::sort(values.begin(), values.end());
+        return (values[(values.size() - 1) / 2] + values[values.size() / 2]) / 2;
+    };
+    const T *channel = reinterpret_cast<const T *>(pixels.data()) + offset;
+    std::vector<double> values(channel, channel + count);
+    median = middle(values);
+    for (size_t i = 0; i < count; i++)
+        values[i] = std::fabs(static_cast<double>(channel[i]) - median);
+    mad = middle(values);
+}
+}
+
 TestFitsData::TestFitsData(QObject *parent) : QObject(parent)
 {
 }
@@ -414,6 +477,439 @@ void TestFitsData::testSEPAlgorithmBenchmark()
 #endif
 }
 
+void TestFitsData::testCalculateStatsBenchmark_data()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    initGenericDataFixture();
+#endif
+}
+
+void TestFitsData::testCalculateStatsBenchmark()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QFETCH(QString, NAME);
+    QFETCH(double, MEAN);
+    QFETCH(double, STDDEV);
+    QFETCH(long, MAXIMUM);
+    QFETCH(long, MINIMUM);
+    QFETCH(double, MEDIAN);
+
+    if(!QFile::exists(NAME))
+        QSKIP("Skipping load test because of missing fixture");
+
+    std::unique_ptr<FITSData> d(new FITSData());
+    QVERIFY(d != nullptr);
+
+    QFuture<bool> worker = d->loadFromFile(NAME);
+    QTRY_VERIFY_WITH_TIMEOUT(worker.isFinished(), 10000);
+    QVERIFY(worker.result());
+
+    // Refreshing ignores the statistics of the header, everything is calculated from the pixels
+    QBENCHMARK { d->calculateStats(true); }
+
+    QVERIFY(abs(d->getMean() - MEAN) < 0.01);
+    QVERIFY(abs(d->getStdDev() - STDDEV) < 0.01);
+    QCOMPARE((long)d->getMax(), MAXIMUM);
+    QCOMPARE((long)d->getMin(), MINIMUM);
+    QVERIFY(abs(d->getMedian() - MEDIAN) < 0.01);
+#endif
+}
+
+void TestFitsData::testRoiStatistics_data()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    initGenericDataFixture();
+#endif
+}
+
+void TestFitsData::testRoiStatistics()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QFETCH(QString, NAME);
+    QFETCH(QRect, TRACKING_BOX);
+
+    if(!QFile::exists(NAME))
+        QSKIP("Skipping load test because of missing fixture");
+
+    std::unique_ptr<FITSData> d(new FITSData());
+    QVERIFY(d != nullptr);
+
+    QFuture<bool> worker = d->loadFromFile(NAME);
+    QTRY_VERIFY_WITH_TIMEOUT(worker.isFinished(), 10000);
+    QVERIFY(worker.result());
+    d->calculateStats(true);
+
+    // A selection of the whole image has the statistics of the image, selections are one based
+    d->calculateRoiStats(QRect(1, 1, d->width(), d->height()));
+    QCOMPARE(d->getMin(0, true), d->getMin());
+    QCOMPARE(d->getMax(0, true), d->getMax());
+    QCOMPARE(d->getMedian(0, true), d->getMedian());
+    QVERIFY(abs(d->getMean(0, true) - d->getMean()) < 0.0001);
+    QVERIFY(abs(d->getStdDev(0, true) - d->getStdDev()) < 0.0001);
+
+    // The tracking box is read in place, in the rows of the image
+    QCOMPARE(d->getStatistics().dataType, static_cast<uint32_t>(TUSHORT));
+    auto const * buffer = reinterpret_cast<uint16_t const *>(d->getImageBuffer());
+    double sum = 0, min = 1e30, max = -1e30;
+    for (int y = TRACKING_BOX.top(); y <= TRACKING_BOX.bottom(); y++)
+    {
+        for (int x = TRACKING_BOX.left(); x <= TRACKING_BOX.right(); x++)
+        {
+            const double value = buffer[y * d->width() + x];
+            sum += value;
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+    }
+    d->calculateRoiStats(TRACKING_BOX.translated(1, 1));
+    QCOMPARE(d->width(true), static_cast<uint16_t>(TRACKING_BOX.width()));
+    QCOMPARE(d->height(true), static_cast<uint16_t>(TRACKING_BOX.height()));
+    QCOMPARE(d->getMin(0, true), min);
+    QCOMPARE(d->getMax(0, true), max);
+    QVERIFY(abs(d->getMean(0, true) - sum / (TRACKING_BOX.width() * TRACKING_BOX.height())) < 0.0001);
+#endif
+}
+
+void TestFitsData::testReuseStatistics_data()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    initGenericDataFixture();
+#endif
+}
+
+void TestFitsData::testReuseStatistics()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QFETCH(QString, NAME);
+    QFETCH(FITSMode, MODE);
+    QFETCH(double, MEAN);
+
+    if(!QFile::exists(NAME))
+        QSKIP("Skipping load test because of missing fixture");
+
+    std::unique_ptr<FITSData> previous(new FITSData(MODE));
+    QVERIFY(previous->loadFromFile(NAME).result());
+
+    // A frame of the same train reuses the statistics of the previous frame
+    FITSImage::Statistic stats = previous->getStatistics();
+    stats.mean[0] = MEAN + 100;
+    std::unique_ptr<FITSData> next(new FITSData(MODE));
+    next->reuseStatistics(stats);
+    QVERIFY(next->loadFromFile(NAME).result());
+    QVERIFY(next->statisticsReused());
+    QCOMPARE(next->getMean(), MEAN + 100);
+
+    // Unless they are requested
+    next->calculateStats(true);
+    QVERIFY(!next->statisticsReused());
+    QVERIFY(abs(next->getMean() - MEAN) < 0.01);
+
+    // A frame of another size calculates its statistics
+    stats.width++;
+    std::unique_ptr<FITSData> other(new FITSData(MODE));
+    other->reuseStatistics(stats);
+    QVERIFY(other->loadFromFile(NAME).result());
+    QVERIFY(!other->statisticsReused());
+    QVERIFY(abs(other->getMean() - MEAN) < 0.01);
+
+    // And so does a frame of another exposure
+    stats.width--;
+    QVariant exposure;
+    if (previous->getRecordValue("EXPTIME", exposure))
+    {
+        std::unique_ptr<FITSData> same(new FITSData(MODE));
+        same->reuseStatistics(stats, exposure.toDouble());
+        QVERIFY(same->loadFromFile(NAME).result());
+        QVERIFY(same->statisticsReused());
+
+        std::unique_ptr<FITSData> longer(new FITSData(MODE));
+        longer->reuseStatistics(stats, exposure.toDouble() * 2 + 1);
+        QVERIFY(longer->loadFromFile(NAME).result());
+        QVERIFY(!longer->statisticsReused());
+        QVERIFY(abs(longer->getMean() - MEAN) < 0.01);
+    }
+#endif
+}
+
+void TestFitsData::testMedianAbsoluteDeviation_data()
+{
+    QTest::addColumn<int>("BITPIX");
+    QTest::addColumn<int>("DATATYPE");
+    QTest::addColumn<int>("BYTES");
+    QTest::addColumn<int>("CHANNELS");
+
+    // 8 and 16 bit images are counted per value, the others go through the histogram bins
+    QTest::newRow("BYTE") << BYTE_IMG << TBYTE << 1 << 1;
+    QTest::newRow("USHORT-RGB") << USHORT_IMG << TUSHORT << 2 << 3;
+    QTest::newRow("LONG") << LONG_IMG << TINT << 4 << 1;
+    QTest::newRow("FLOAT") << FLOAT_IMG << TFLOAT << 4 << 1;
+    QTest::newRow("DOUBLE-RGB") << DOUBLE_IMG << TDOUBLE << 8 << 3;
+}
+
+void TestFitsData::testMedianAbsoluteDeviation()
+{
+    QFETCH(int, BITPIX);
+    QFETCH(int, DATATYPE);
+    QFETCH(int, BYTES);
+    QFETCH(int, CHANNELS);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("random.fits");
+
+    // An even number of samples, the medians are between two of them
+    long naxes[3] = { 101, 76, CHANNELS };
+    std::vector<uint8_t> pixels;
+    QVERIFY(writeRandomFits(filename, BITPIX, DATATYPE, BYTES, naxes, pixels));
+
+    std::unique_ptr<FITSData> d(new FITSData());
+    QVERIFY(d->loadFromFile(filename).result());
+
+    const size_t count = naxes[0] * naxes[1];
+    for (int n = 0; n < CHANNELS; n++)
+    {
+        double median = 0, mad = 0;
+        switch (DATATYPE)
+        {
+            case TBYTE:
+                sortedMedianAndMAD<uint8_t>(pixels, n * count, count, median, mad);
+                break;
+            case TUSHORT:
+                sortedMedianAndMAD<uint16_t>(pixels, n * count, count, median, mad);
+                break;
+            case TINT:
+                sortedMedianAndMAD<int32_t>(pixels, n * count, count, median, mad);
+                break;
+            case TFLOAT:
+                sortedMedianAndMAD<float>(pixels, n * count, count, median, mad);
+                break;
+            default:
+                sortedMedianAndMAD<double>(pixels, n * count, count, median, mad);
+                break;
+        }
+        QVERIFY(mad > 0);
+        QCOMPARE(d->getStatistics().median[n], median);
+        QCOMPARE(d->getStatistics().mad[n], mad);
+    }
+}
+
+void TestFitsData::testCompressedWriteBenchmark_data()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QTest::addColumn<QString>("NAME");
+    QTest::addColumn<int>("CODEC");
+
+    QTest::newRow("M47-NONE") << "m47_sim_stars.fits" << static_cast<int>(FITSCompressedWriter::NO_COMPRESSION);
+    QTest::newRow("M47-RICE") << "m47_sim_stars.fits" << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("M47-GZIP") << "m47_sim_stars.fits" << static_cast<int>(FITSCompressedWriter::GZIP);
+#endif
+}
+
+void TestFitsData::testCompressedWriteBenchmark()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QFETCH(QString, NAME);
+    QFETCH(int, CODEC);
+
+    if(!QFile::exists(NAME))
+        QSKIP("Skipping load test because of missing fixture");
+
+    QFile input(NAME);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    const QByteArray fits = input.readAll();
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath(CODEC ? "compressed.fits.fz" : "uncompressed.fits");
+    const auto codec = static_cast<FITSCompressedWriter::Codec>(CODEC);
+
+    // Uncompressed frames are written as they are received from the camera
+    QElapsedTimer timer;
+    int saves = 0;
+    timer.start();
+    QBENCHMARK
+    {
+        if (codec == FITSCompressedWriter::NO_COMPRESSION)
+        {
+            QFile output(filename);
+            QVERIFY(output.open(QIODevice::WriteOnly));
+            QCOMPARE(output.write(fits), fits.size());
+        }
+        else
+        {
+            QString error;
+            QVERIFY2(FITSCompressedWriter::writeFile(filename, fits, codec, &error), qPrintable(error));
+        }
+        saves++;
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    qInfo() << QTest::currentDataTag() << "wrote" << fits.size() * saves / seconds / 1e6 << "MB/s, file size"
+            << QFileInfo(filename).size() << "bytes for" << fits.size() << "bytes of FITS";
+
+    // The written image must be the original one, whatever its compression
+    std::unique_ptr<FITSData> original(new FITSData());
+    std::unique_ptr<FITSData> written(new FITSData());
+    QVERIFY(original->loadFromFile(NAME).result());
+    QVERIFY(written->loadFromFile(filename).result());
+    const auto &stats = original->getStatistics();
+    QCOMPARE(written->getStatistics().width, stats.width);
+    QCOMPARE(written->getStatistics().height, stats.height);
+    QCOMPARE(written->getStatistics().dataType, stats.dataType);
+    QVERIFY(memcmp(written->getImageBuffer(), original->getImageBuffer(),
+                   stats.samples_per_channel * stats.channels * stats.bytesPerPixel) == 0);
+#endif
+}
+
+void TestFitsData::testCompressedRoundTrip_data()
+{
+    QTest::addColumn<int>("BITPIX");
+    QTest::addColumn<int>("DATATYPE");
+    QTest::addColumn<int>("BYTES");
+    QTest::addColumn<int>("CHANNELS");
+    QTest::addColumn<int>("CODEC");
+
+    // 300 rows are split in tiles of 16 rows, the last one shorter, compressed by several jobs
+    QTest::newRow("BYTE-RICE") << BYTE_IMG << TBYTE << 1 << 1 << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("USHORT-RICE-RGB") << USHORT_IMG << TUSHORT << 2 << 3 << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("LONG-RICE") << LONG_IMG << TINT << 4 << 1 << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("LONG-GZIP") << LONG_IMG << TINT << 4 << 1 << static_cast<int>(FITSCompressedWriter::GZIP);
+    QTest::newRow("ULONG-RICE") << ULONG_IMG << TUINT << 4 << 1 << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("ULONG-GZIP-RGB") << ULONG_IMG << TUINT << 4 << 3 << static_cast<int>(FITSCompressedWriter::GZIP);
+    // Rice is not lossless for floating point values, they are compressed with GZIP
+    QTest::newRow("FLOAT-RICE") << FLOAT_IMG << TFLOAT << 4 << 1 << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("FLOAT-GZIP-RGB") << FLOAT_IMG << TFLOAT << 4 << 3 << static_cast<int>(FITSCompressedWriter::GZIP);
+    QTest::newRow("DOUBLE-GZIP") << DOUBLE_IMG << TDOUBLE << 8 << 1 << static_cast<int>(FITSCompressedWriter::GZIP);
+}
+
+void TestFitsData::testCompressedRoundTrip()
+{
+    QFETCH(int, BITPIX);
+    QFETCH(int, DATATYPE);
+    QFETCH(int, BYTES);
+    QFETCH(int, CHANNELS);
+    QFETCH(int, CODEC);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString source = dir.filePath("source.fits");
+    const QString compressed = dir.filePath("compressed.fits.fz");
+
+    long naxes[3] = { 301, 300, CHANNELS };
+    std::vector<uint8_t> pixels;
+    QVERIFY(writeRandomFits(source, BITPIX, DATATYPE, BYTES, naxes, pixels));
+
+    QFile input(source);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+    QString error;
+    QVERIFY2(FITSCompressedWriter::writeFile(compressed, input.readAll(),
+             static_cast<FITSCompressedWriter::Codec>(CODEC), &error), qPrintable(error));
+
+    // Read back by cfitsio, the compressed image is the first extension
+    int status = 0, hdutype = 0, bitpix = 0, naxis = 0, anynull = 0;
+    long written[3] = { 1, 1, 1 };
+    char compression[FLEN_VALUE] = {0};
+    fitsfile *fptr = nullptr;
+    fits_open_diskfile(&fptr, compressed.toLocal8Bit().data(), READONLY, &status);
+    fits_movabs_hdu(fptr, 2, &hdutype, &status);
+    QCOMPARE(fits_is_compressed_image(fptr, &status), 1);
+    fits_read_key_str(fptr, "ZCMPTYPE", compression, nullptr, &status);
+    fits_get_img_equivtype(fptr, &bitpix, &status);
+    fits_get_img_dim(fptr, &naxis, &status);
+    fits_get_img_size(fptr, 3, written, &status);
+    std::vector<uint8_t> read(pixels.size());
+    fits_read_img(fptr, DATATYPE, 1, naxes[0] * naxes[1] * naxes[2], nullptr, read.data(), &anynull, &status);
+    int closeStatus = 0;
+    fits_close_file(fptr, &closeStatus);
+
+    QCOMPARE(status, 0);
+    const bool integer = BITPIX != FLOAT_IMG && BITPIX != DOUBLE_IMG;
+    QCOMPARE(QString(compression), QString(CODEC == FITSCompressedWriter::RICE && integer ? "RICE_1" : "GZIP_1"));
+    QCOMPARE(bitpix, BITPIX);
+    QCOMPARE(naxis, CHANNELS > 1 ? 3 : 2);
+    QCOMPARE(written[0], naxes[0]);
+    QCOMPARE(written[1], naxes[1]);
+    QCOMPARE(written[2], naxes[2]);
+    QVERIFY(read == pixels);
+}
+
+void TestFitsData::testSaveCompressed_data()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QTest::addColumn<QString>("NAME");
+    QTest::addColumn<int>("CODEC");
+
+    // An empty name stands for a random floating point image
+    QTest::newRow("M47-RICE") << "m47_sim_stars.fits" << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("M47-GZIP") << "m47_sim_stars.fits" << static_cast<int>(FITSCompressedWriter::GZIP);
+    QTest::newRow("BAHTINOV-RICE") << "bahtinov-focus.fits" << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("FLOAT-RICE") << "" << static_cast<int>(FITSCompressedWriter::RICE);
+    QTest::newRow("FLOAT-GZIP") << "" << static_cast<int>(FITSCompressedWriter::GZIP);
+#endif
+}
+
+void TestFitsData::testSaveCompressed()
+{
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    QFETCH(QString, NAME);
+    QFETCH(int, CODEC);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    if (NAME.isEmpty())
+    {
+        NAME = dir.filePath("float.fits");
+        long naxes[3] = { 640, 480, 1 };
+        std::vector<uint8_t> pixels;
+        QVERIFY(writeRandomFits(NAME, FLOAT_IMG, TFLOAT, sizeof(float), naxes, pixels));
+    }
+    else if(!QFile::exists(NAME))
+        QSKIP("Skipping save test because of missing fixture");
+
+    const int compression = Options::fitsCompression();
+    Options::setFitsCompression(CODEC);
+
+    const QString filename = dir.filePath("saved.fits.fz");
+    std::unique_ptr<FITSData> original(new FITSData());
+    std::unique_ptr<FITSData> saved(new FITSData());
+    QVERIFY(original->loadFromFile(NAME).result());
+    const bool success = original->saveImage(filename);
+    Options::setFitsCompression(compression);
+    QVERIFY2(success, qPrintable(original->getLastError()));
+
+    // The saved image must be the loaded one
+    QVERIFY(original->loadFromFile(NAME).result());
+    QVERIFY(saved->loadFromFile(filename).result());
+    const auto &stats = original->getStatistics();
+    QCOMPARE(saved->getStatistics().width, stats.width);
+    QCOMPARE(saved->getStatistics().height, stats.height);
+    QCOMPARE(saved->getStatistics().channels, stats.channels);
+    QCOMPARE(saved->getStatistics().dataType, stats.dataType);
+    QVERIFY(memcmp(saved->getImageBuffer(), original->getImageBuffer(),
+                   stats.samples_per_channel * stats.channels * stats.bytesPerPixel) == 0);
+#endif
+}
+
 QString SolverLoop::status() const
 {
     return QString("%1/%2 %3% %4 %5")
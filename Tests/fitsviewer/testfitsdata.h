@@ -46,6 +46,27 @@ class TestFitsData : public QObject
         void testSEPAlgorithmBenchmark_data();
         void testSEPAlgorithmBenchmark();
 
+        void testCalculateStatsBenchmark_data();
+        void testCalculateStatsBenchmark();
+
+        void testRoiStatistics_data();
+        void testRoiStatistics();
+
+        void testReuseStatistics_data();
+        void testReuseStatistics();
+
+        void testMedianAbsoluteDeviation_data();
+        void testMedianAbsoluteDeviation();
+
+        void testCompressedWriteBenchmark_data();
+        void testCompressedWriteBenchmark();
+
+        void testCompressedRoundTrip_data();
+        void testCompressedRoundTrip();
+
+        void testSaveCompressed_data();
+        void testSaveCompressed();
+
         void testComputeHFR_data();
         void testComputeHFR();
 
@@ -0,0 +1,380 @@
+/*  KStars tests
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QRandomGenerator>
+
+#include <random>
+
+#include "testfitsstack.h"
+#include "fitsviewer/fitsdata.h"
+#include "fitsviewer/fitsstack.h"
+#include "fitsviewer/fitsstackkernel.h"
+#include "auxiliary/robuststatistics.h"
+
+namespace
+{
+constexpr float LOW_SIGMA = 3.0f;
+constexpr float HIGH_SIGMA = 3.0f;
+constexpr float WINSOR_CUTOFF = 2.0f;
+}
+
+TestFitsStack::TestFitsStack(QObject *parent) : QObject(parent)
+{
+}
+
+// Synthetic subs: a noisy background with the odd hot pixel / satellite trail value to reject
+void TestFitsStack::makeSubs(const int numSubs, const int pixels, const int channels)
+{
+    QRandomGenerator rand(42);
+    m_Subs.resize(numSubs);
+    m_SubPtrs.resize(numSubs);
+    m_Weights.resize(numSubs);
+    for (int i = 0; i < numSubs; i++)
+    {
+        m_Subs[i].resize(pixels * channels);
+        for (auto &value : m_Subs[i])
+        {
+            value = 1000.0f + 50.0f * static_cast<float>(rand.generateDouble());
+            if (rand.bounded(100) == 0)
+                value += 30000.0f;
+        }
+        m_SubPtrs[i] = m_Subs[i].constData();
+        m_Weights[i] = 1.0f + rand.bounded(3);
+    }
+}
+
+// This is the per pixel algorithm used by FITSStack::stackSigmaClipPixel
+void TestFitsStack::referenceClip(const int start, const int end, const int channels, const bool winsorize,
+                                  float *finalImagePtr, QVector<cv::Vec4f *> &sigmaClipPtr)
+{
+    const int numImages = m_SubPtrs.size();
+    for (int x = start; x < end; x++)
+    {
+        std::vector<float> values(numImages);
+        for (int ch = 0; ch < channels; ch++)
+        {
+            for (int image = 0; image < numImages; image++)
+                values[image] = m_SubPtrs[image][x * channels + ch];
+
+            if (winsorize)
+            {
+                float median = Mathematics::RobustStatistics::ComputeLocation(
+                                   Mathematics::RobustStatistics::LOCATION_MEDIAN, values);
+                auto const stddev = std::sqrt(Mathematics::RobustStatistics::ComputeScale(
+                                                  Mathematics::RobustStatistics::SCALE_VARIANCE, values));
+                float lower = std::max(0.0, median - (stddev * WINSOR_CUTOFF));
+                float upper = median + (stddev * WINSOR_CUTOFF);
+                for (auto &value : values)
+                    value = std::min(std::max(value, lower), upper);
+            }
+
+            float median = Mathematics::RobustStatistics::ComputeLocation(
+                               Mathematics::RobustStatistics::LOCATION_MEDIAN, values);
+            float pixelValue = median, sum = 0.0, weightSum = 0.0, lower = -1.0, upper = -1.0;
+            if (values.size() > 3)
+            {
+                auto const stddev = std::sqrt(Mathematics::RobustStatistics::ComputeScale(
+                                                  Mathematics::RobustStatistics::SCALE_VARIANCE, values));
+                lower = std::max(0.0, median - (stddev * LOW_SIGMA));
+                upper = median + (stddev * HIGH_SIGMA);
+                for (unsigned int i = 0; i < values.size(); i++)
+                {
+                    if (values[i] < lower || values[i] > upper)
+                        continue;
+                    sum += values[i] * m_Weights[i];
+                    weightSum += m_Weights[i];
+                }
+                if (weightSum > 0.0)
+                    pixelValue = sum / weightSum;
+            }
+            sigmaClipPtr[ch][x] = cv::Vec4f(lower, upper, sum, weightSum);
+            finalImagePtr[x * channels + ch] = pixelValue;
+        }
+    }
+}
+
+void TestFitsStack::testSigmaClipKernel_data()
+{
+    QTest::addColumn<int>("SUBS");
+    QTest::addColumn<int>("CHANNELS");
+    QTest::addColumn<bool>("WINSORIZE");
+
+    QTest::newRow("3 subs mono") << 3 << 1 << false;
+    QTest::newRow("5 subs mono") << 5 << 1 << false;
+    QTest::newRow("24 subs mono") << 24 << 1 << false;
+    QTest::newRow("24 subs mono winsorized") << 24 << 1 << true;
+    QTest::newRow("7 subs colour") << 7 << 3 << false;
+    QTest::newRow("10 subs colour winsorized") << 10 << 3 << true;
+}
+
+void TestFitsStack::testSigmaClipKernel()
+{
+    QFETCH(int, SUBS);
+    QFETCH(int, CHANNELS);
+    QFETCH(bool, WINSORIZE);
+
+    // Use a pixel count that doesn't fill the last SIMD vector to exercise the scalar tail
+    const int pixels = 1021;
+    makeSubs(SUBS, pixels, CHANNELS);
+
+    FITSSigmaClipKernel::Params params { WINSORIZE, WINSOR_CUTOFF, LOW_SIGMA, HIGH_SIGMA };
+    FITSSigmaClipKernel kernel(SUBS, CHANNELS, params, m_Weights);
+
+    std::vector<float> reference(pixels * CHANNELS), simd(pixels * CHANNELS), scalar(pixels * CHANNELS);
+    std::vector<std::vector<cv::Vec4f>> refClip(CHANNELS), simdClip(CHANNELS), scalarClip(CHANNELS);
+    QVector<cv::Vec4f *> referencePtr(CHANNELS), simdPtr(CHANNELS), scalarPtr(CHANNELS);
+    for (int ch = 0; ch < CHANNELS; ch++)
+    {
+        refClip[ch].resize(pixels);
+        simdClip[ch].resize(pixels);
+        scalarClip[ch].resize(pixels);
+        referencePtr[ch] = refClip[ch].data();
+        simdPtr[ch] = simdClip[ch].data();
+        scalarPtr[ch] = scalarClip[ch].data();
+    }
+
+    referenceClip(0, pixels, CHANNELS, WINSORIZE, reference.data(), referencePtr);
+    kernel.clip(0, pixels, m_SubPtrs.data(), simd.data(), simdPtr.data(), true);
+    kernel.clip(0, pixels, m_SubPtrs.data(), scalar.data(), scalarPtr.data(), false);
+
+    // The kernel works in float whereas the reference uses double statistics so allow a small tolerance
+    for (int i = 0; i < pixels * CHANNELS; i++)
+    {
+        QVERIFY2(qAbs(simd[i] - reference[i]) <= 1e-3f * reference[i],
+                 qPrintable(QString("SIMD pixel %1: %2 vs %3").arg(i).arg(simd[i]).arg(reference[i])));
+        QVERIFY2(qAbs(scalar[i] - reference[i]) <= 1e-3f * reference[i],
+                 qPrintable(QString("Scalar pixel %1: %2 vs %3").arg(i).arg(scalar[i]).arg(reference[i])));
+    }
+    for (int ch = 0; ch < CHANNELS; ch++)
+    {
+        for (int x = 0; x < pixels; x++)
+        {
+            QCOMPARE(simdClip[ch][x][3], refClip[ch][x][3]);
+            QCOMPARE(scalarClip[ch][x][3], refClip[ch][x][3]);
+        }
+    }
+}
+
+void TestFitsStack::testSigmaClipBenchmark_data()
+{
+    QTest::addColumn<QString>("PATH");
+
+    QTest::newRow("reference") << "reference";
+    QTest::newRow("scalar") << "scalar";
+    QTest::newRow("simd") << (FITSSigmaClipKernel::hasSIMD() ? "simd" : "scalar");
+}
+
+void TestFitsStack::testSigmaClipBenchmark()
+{
+    QFETCH(QString, PATH);
+
+    // 24 subs of a 512 x 512 mono tile
+    const int subs = 24, pixels = 512 * 512;
+    makeSubs(subs, pixels, 1);
+
+    FITSSigmaClipKernel::Params params { false, WINSOR_CUTOFF, LOW_SIGMA, HIGH_SIGMA };
+    FITSSigmaClipKernel kernel(subs, 1, params, m_Weights);
+
+    std::vector<float> finalImage(pixels);
+    std::vector<cv::Vec4f> sigmaClip(pixels);
+    QVector<cv::Vec4f *> sigmaClipPtr(1, sigmaClip.data());
+
+    if (PATH == "reference")
+    {
+        QBENCHMARK { referenceClip(0, pixels, 1, false, finalImage.data(), sigmaClipPtr); }
+    }
+    else
+    {
+        const bool useSIMD = (PATH == "simd");
+        QBENCHMARK { kernel.clip(0, pixels, m_SubPtrs.data(), finalImage.data(), sigmaClipPtr.data(), useSIMD); }
+    }
+}
+
+void TestFitsStack::testTiledStack_data()
+{
+    QTest::addColumn<int>("REJECTION");
+    QTest::addColumn<int>("CHANNELS");
+
+    QTest::newRow("sigma mono") << static_cast<int>(LS_STACKING_REJ_SIGMA) << 1;
+    QTest::newRow("winsorized mono") << static_cast<int>(LS_STACKING_REJ_WINDSOR) << 1;
+    QTest::newRow("sigma colour") << static_cast<int>(LS_STACKING_REJ_SIGMA) << 3;
+    QTest::newRow("winsorized colour") << static_cast<int>(LS_STACKING_REJ_WINDSOR) << 3;
+}
+
+// Stacking through the scratch file a band of rows at a time gives exactly the same stack as in memory
+void TestFitsStack::testTiledStack()
+{
+    QFETCH(int, REJECTION);
+    QFETCH(int, CHANNELS);
+
+    // The width isn't a multiple of the SIMD lanes, so tiles don't start on a whole vector unless aligned
+    const int subs = 9, width = 301, height = 203;
+    makeSubs(subs, width * height, CHANNELS);
+
+    cv::Mat stacks[2], sigmaClips[2];
+    for (int tiled = 0; tiled < 2; tiled++)
+    {
+        LiveStackData params {};
+        params.alignMethod = LS_ALIGNMENT_NONE;
+        params.tileMemory = tiled ? 1 : 0;
+        params.downscale = LS_DOWNSCALE_NONE;
+        params.weighting = LS_STACKING_EQUAL;
+        params.rejection = static_cast<LiveStackRejection>(REJECTION);
+        params.lowSigma = LOW_SIGMA;
+        params.highSigma = HIGH_SIGMA;
+        params.windsorCutoff = WINSOR_CUTOFF;
+
+        FITSData data;
+        FITSStack stack(&data, params);
+        for (int i = 0; i < subs; i++)
+        {
+            stack.setupNextSub();
+            QVERIFY(stack.addSub(m_Subs[i].data(), CV_32FC(CHANNELS), width, height, sizeof(float)));
+            stack.m_StackImageData.last().status = FITSStack::OK;
+        }
+        if (tiled)
+            QVERIFY(stack.getTileRows(subs, height) < height / 2);
+
+        float totalWeight = 0.0f;
+        QVERIFY(stack.stackSubs(true, totalWeight, stacks[tiled]));
+        QVERIFY(!stacks[tiled].empty());
+        cv::merge(std::vector<cv::Mat>(stack.m_SigmaClip32FC4.begin(), stack.m_SigmaClip32FC4.end()), sigmaClips[tiled]);
+    }
+
+    QCOMPARE(cv::norm(stacks[0], stacks[1], cv::NORM_INF), 0.0);
+    QCOMPARE(cv::norm(sigmaClips[0], sigmaClips[1], cv::NORM_INF), 0.0);
+}
+
+// A master added while subs are being calibrated in the background only applies to the subs prepared after it
+void TestFitsStack::testMasterDuringPrepare()
+{
+    const int subs = 8, width = 1000, height = 800;
+    std::vector<float> sub(width * height, 1000.0f), darkA(width * height, 100.0f), darkB(width * height, 200.0f);
+
+    LiveStackData params {};
+    params.alignMethod = LS_ALIGNMENT_NONE;
+    params.downscale = LS_DOWNSCALE_NONE;
+    params.weighting = LS_STACKING_EQUAL;
+    params.rejection = LS_STACKING_REJ_NONE;
+
+    FITSData data;
+    FITSStack stack(&data, params);
+    stack.addMaster(true, darkA.data(), width, height, 0, CV_32F);
+
+    // The second half of the subs is started after the dark changes, while the first half is still running
+    for (int i = 0; i < 2 * subs; i++)
+    {
+        if (i == subs)
+            stack.addMaster(true, darkB.data(), width, height, 0, CV_32F);
+
+        stack.setupNextSub();
+        QVERIFY(stack.addSub(sub.data(), CV_32F, width, height, sizeof(float)));
+        stack.m_StackImageData.last().status = FITSStack::OK;
+        stack.prepareSubAsync();
+    }
+    stack.collectPreparedSubs();
+
+    for (int i = 0; i < 2 * subs; i++)
+    {
+        const FITSStack::StackImageData &prepared = stack.m_StackImageData[i];
+        QCOMPARE(prepared.status, FITSStack::OK);
+        QVERIFY(prepared.isCalibrated);
+
+        double minVal, maxVal;
+        cv::minMaxLoc(prepared.image, &minVal, &maxVal);
+        const double expected = i < subs ? 900.0 : 800.0;
+        QVERIFY2(minVal == expected && maxVal == expected,
+                 qPrintable(QString("Sub %1: %2 to %3 instead of %4").arg(i).arg(minVal).arg(maxVal).arg(expected)));
+    }
+}
+
+void TestFitsStack::testIncrementalStack_data()
+{
+    testTiledStack_data();
+}
+
+// Adding subs to an existing sigma clipped stack gives nearly the same result as stacking all the subs at once.
+// The incremental stack clips each new value against running estimates rather than the median of all the values
+// so they only agree within the noise: within one standard deviation of the noise per pixel, and to 3% of it on average
+void TestFitsStack::testIncrementalStack()
+{
+    QFETCH(int, REJECTION);
+    QFETCH(int, CHANNELS);
+
+    const int initialSubs = 12, newSubs = 12, width = 151, height = 101;
+    const float background = 1000.0f, noise = 10.0f;
+
+    // Gaussian noise, and a single bright outlier in every 11th pixel / channel that both stacks must reject
+    std::mt19937 generator(42);
+    std::normal_distribution<float> distribution(background, noise);
+    const int values = width * height * CHANNELS;
+    std::vector<std::vector<float>> subs(initialSubs + newSubs, std::vector<float>(values));
+    for (int i = 0; i < values; i++)
+    {
+        for (auto &sub : subs)
+            sub[i] = distribution(generator);
+        if (i % 11 == 0)
+            subs[(i / 11) % subs.size()][i] += 5000.0f;
+    }
+
+    LiveStackData params {};
+    params.alignMethod = LS_ALIGNMENT_NONE;
+    params.downscale = LS_DOWNSCALE_NONE;
+    params.weighting = LS_STACKING_EQUAL;
+    params.rejection = static_cast<LiveStackRejection>(REJECTION);
+    params.lowSigma = LOW_SIGMA;
+    params.highSigma = HIGH_SIGMA;
+    params.windsorCutoff = WINSOR_CUTOFF;
+
+    auto addSubs = [&](FITSStack &stack, const int start, const int end)
+    {
+        for (int i = start; i < end; i++)
+        {
+            stack.setupNextSub();
+            QVERIFY(stack.addSub(subs[i].data(), CV_32FC(CHANNELS), width, height, sizeof(float)));
+            stack.m_StackImageData.last().status = FITSStack::OK;
+        }
+    };
+
+    FITSData batchData;
+    FITSStack batchStack(&batchData, params);
+    addSubs(batchStack, 0, initialSubs + newSubs);
+    float totalWeight = 0.0f;
+    cv::Mat batch;
+    QVERIFY(batchStack.stackSubs(true, totalWeight, batch));
+
+    FITSData incrementalData;
+    FITSStack incrementalStack(&incrementalData, params);
+    addSubs(incrementalStack, 0, initialSubs);
+    QVERIFY(incrementalStack.stackSubs(true, totalWeight, incrementalStack.m_StackedImage32F));
+    incrementalStack.m_StackImageData.clear();
+    addSubs(incrementalStack, initialSubs, initialSubs + newSubs);
+    QVERIFY(incrementalStack.stackSubs(false, totalWeight, incrementalStack.m_StackedImage32F));
+    const cv::Mat &incremental = incrementalStack.m_StackedImage32F;
+
+    // The running counts only miss the outliers and the odd value in the tails of the noise
+    for (int ch = 0; ch < CHANNELS; ch++)
+    {
+        double minCount, maxCount;
+        cv::minMaxLoc(incrementalStack.m_OnlineCount32S[ch], &minCount, &maxCount);
+        QVERIFY(maxCount <= initialSubs + newSubs);
+        QVERIFY(cv::mean(incrementalStack.m_OnlineCount32S[ch])[0] >= initialSubs + newSubs - 1);
+    }
+
+    QCOMPARE(batch.size(), incremental.size());
+    const double maxDiff = cv::norm(batch, incremental, cv::NORM_INF);
+    const double meanDiff = cv::norm(batch, incremental, cv::NORM_L1) / values;
+    QVERIFY2(maxDiff <= noise, qPrintable(QString("Max difference %1").arg(maxDiff)));
+    QVERIFY2(meanDiff <= 0.03 * noise, qPrintable(QString("Mean difference %1").arg(meanDiff)));
+}
+
+QTEST_GUILESS_MAIN(TestFitsStack)
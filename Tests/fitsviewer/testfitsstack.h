@@ -0,0 +1,43 @@
+/*  KStars tests
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+
+#include "opencv2/core.hpp"
+
+class TestFitsStack : public QObject
+{
+        Q_OBJECT
+    public:
+        explicit TestFitsStack(QObject *parent = nullptr);
+
+    private slots:
+        void testSigmaClipKernel_data();
+        void testSigmaClipKernel();
+
+        void testSigmaClipBenchmark_data();
+        void testSigmaClipBenchmark();
+
+        void testTiledStack_data();
+        void testTiledStack();
+
+        void testMasterDuringPrepare();
+
+        void testIncrementalStack_data();
+        void testIncrementalStack();
+
+    private:
+        void makeSubs(const int numSubs, const int pixels, const int channels);
+        void referenceClip(const int start, const int end, const int channels, const bool winsorize,
+                           float *finalImagePtr, QVector<cv::Vec4f *> &sigmaClipPtr);
+
+        QVector<QVector<float>> m_Subs;
+        std::vector<const float *> m_SubPtrs;
+        std::vector<float> m_Weights;
+};
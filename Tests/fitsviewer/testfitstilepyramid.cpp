@@ -0,0 +1,148 @@
+/*  KStars tests
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QPainter>
+
+#include "testfitstilepyramid.h"
+#include "fitsviewer/fitsdata.h"
+#include "fitsviewer/fitstilepyramid.h"
+#include "fitsviewer/stretch.h"
+
+namespace
+{
+// 1280x1024, 16 bits
+const QString NAME = "m47_sim_stars.fits";
+
+// Draws the source rectangle of the image from the pyramid, into an image the size of target.
+QImage drawPyramid(FITSTilePyramid &pyramid, const QSize &target, const QRectF &source)
+{
+    QImage image(target, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QPainter painter(&image);
+    pyramid.draw(&painter, QRectF(QPointF(0, 0), target), source);
+    painter.end();
+    return image;
+}
+
+int stretchedPixel(const QImage &image, int x, int y)
+{
+    return image.constScanLine(y)[x];
+}
+}
+
+TestFitsTilePyramid::TestFitsTilePyramid(QObject *parent) : QObject(parent)
+{
+}
+
+void TestFitsTilePyramid::initTestCase()
+{
+    if (!QFile::exists(NAME))
+        QSKIP("Skipping tile pyramid test because of missing fixture");
+
+    m_Data.reset(new FITSData());
+    QFuture<bool> worker = m_Data->loadFromFile(NAME);
+    QTRY_VERIFY_WITH_TIMEOUT(worker.isFinished(), 60000);
+    QVERIFY(worker.result());
+    QCOMPARE(m_Data->channels(), 1);
+
+    Stretch stretch(m_Data->width(), m_Data->height(), m_Data->channels(), m_Data->dataType());
+    stretch.setParams(stretch.computeParams(m_Data->getImageBuffer()));
+    m_Stretched = QImage(m_Data->width(), m_Data->height(), QImage::Format_Indexed8);
+    stretch.run(m_Data->getImageBuffer(), &m_Stretched);
+}
+
+// Level 0 tiles are the image stretched with the same parameters
+void TestFitsTilePyramid::testLevel0()
+{
+    Stretch stretch(m_Data->width(), m_Data->height(), m_Data->channels(), m_Data->dataType());
+    FITSTilePyramid pyramid;
+    pyramid.reset(m_Data, stretch.computeParams(m_Data->getImageBuffer()), 1);
+
+    // Four tiles of level 0, drawn without scaling
+    const int size = 2 * FITSTilePyramid::TILE_SIZE;
+    const QImage drawn = drawPyramid(pyramid, QSize(size, size), QRectF(0, 0, size, size));
+
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+        {
+            const QRgb pixel = drawn.pixel(x, y);
+            if (qRed(pixel) != stretchedPixel(m_Stretched, x, y) || qGreen(pixel) != qRed(pixel))
+                QFAIL(qPrintable(QString("Level 0 differs at %1,%2: %3 instead of %4").arg(x).arg(y)
+                                 .arg(qRed(pixel)).arg(stretchedPixel(m_Stretched, x, y))));
+        }
+}
+
+// Level 1 tiles average 2x2 pixels of the stretched image
+void TestFitsTilePyramid::testLevel1()
+{
+    Stretch stretch(m_Data->width(), m_Data->height(), m_Data->channels(), m_Data->dataType());
+    FITSTilePyramid pyramid;
+    pyramid.reset(m_Data, stretch.computeParams(m_Data->getImageBuffer()), 1);
+
+    // One tile of level 1 covers twice its size of the image
+    const int size = FITSTilePyramid::TILE_SIZE;
+    const QImage drawn = drawPyramid(pyramid, QSize(size, size), QRectF(0, 0, 2 * size, 2 * size));
+
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+        {
+            const int expected = (stretchedPixel(m_Stretched, 2 * x, 2 * y) + stretchedPixel(m_Stretched, 2 * x + 1, 2 * y) +
+                                  stretchedPixel(m_Stretched, 2 * x, 2 * y + 1) +
+                                  stretchedPixel(m_Stretched, 2 * x + 1, 2 * y + 1) + 2) / 4;
+            const QRgb pixel = drawn.pixel(x, y);
+            if (qRed(pixel) != expected)
+                QFAIL(qPrintable(QString("Level 1 differs at %1,%2: %3 instead of %4").arg(x).arg(y)
+                                 .arg(qRed(pixel)).arg(expected)));
+        }
+}
+
+// With a budget of a few tiles, the pyramid keeps the tiles it draws, not the ones it reduced them from,
+// and still draws the same image.
+void TestFitsTilePyramid::testBudget()
+{
+    Stretch stretch(m_Data->width(), m_Data->height(), m_Data->channels(), m_Data->dataType());
+    const StretchParams params = stretch.computeParams(m_Data->getImageBuffer());
+    const qint64 tileBytes = FITSTilePyramid::TILE_SIZE * FITSTilePyramid::TILE_SIZE;
+
+    FITSTilePyramid unlimited;
+    unlimited.reset(m_Data, params, 1);
+    FITSTilePyramid pyramid(4 * tileBytes);
+    pyramid.reset(m_Data, params, 1);
+
+    // The whole image, from level 2, reduced from the 20 tiles of level 0
+    const QSize whole(m_Data->width() / 4, m_Data->height() / 4);
+    const QRectF image(0, 0, m_Data->width(), m_Data->height());
+    QCOMPARE(drawPyramid(pyramid, whole, image), drawPyramid(unlimited, whole, image));
+    QVERIFY(pyramid.m_TileBytes <= 4 * tileBytes);
+    QCOMPARE(pyramid.m_Tiles.size(), 2);
+    for (int x = 0; x < 2; x++)
+        QVERIFY(pyramid.m_Tiles.contains(FITSTilePyramid::key(2, QPoint(x, 0))));
+
+    // Drawing it again reuses its tiles
+    const qint64 cacheKey = pyramid.m_Tiles.value(FITSTilePyramid::key(2, QPoint(0, 0))).image.cacheKey();
+    QCOMPARE(drawPyramid(pyramid, whole, image), drawPyramid(unlimited, whole, image));
+    QCOMPARE(pyramid.m_Tiles.value(FITSTilePyramid::key(2, QPoint(0, 0))).image.cacheKey(), cacheKey);
+
+    // Four tiles of level 0 fill the budget, the tiles of the whole image are dropped.
+    // The right and bottom edges stop short of the next tiles.
+    const int size = 2 * FITSTilePyramid::TILE_SIZE;
+    const QRectF zoomed(FITSTilePyramid::TILE_SIZE, FITSTilePyramid::TILE_SIZE, size - 1, size - 1);
+    QCOMPARE(drawPyramid(pyramid, QSize(size, size), zoomed), drawPyramid(unlimited, QSize(size, size), zoomed));
+    QCOMPARE(pyramid.m_TileBytes, 4 * tileBytes);
+    QVERIFY(!pyramid.m_Tiles.contains(FITSTilePyramid::key(2, QPoint(0, 0))));
+
+    // And computed again when needed
+    QCOMPARE(drawPyramid(pyramid, whole, image), drawPyramid(unlimited, whole, image));
+    QVERIFY(pyramid.m_TileBytes <= 4 * tileBytes);
+}
+
+QTEST_GUILESS_MAIN(TestFitsTilePyramid)
@@ -0,0 +1,32 @@
+/*  KStars tests
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+
+class FITSData;
+
+class TestFitsTilePyramid : public QObject
+{
+        Q_OBJECT
+    public:
+        explicit TestFitsTilePyramid(QObject *parent = nullptr);
+
+    private slots:
+        void initTestCase();
+
+        void testLevel0();
+        void testLevel1();
+        void testBudget();
+
+    private:
+        QSharedPointer<FITSData> m_Data;
+        // The whole image, stretched at once as FITSView does for small images
+        QImage m_Stretched;
+};
@@ -0,0 +1,146 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_hipsprefetcher.h"
+
+#include "hips/healpix.h"
+#include "hips/hipsprefetcher.h"
+#include "Options.h"
+
+#include <QSet>
+#include <QThread>
+
+#include <cmath>
+
+namespace
+{
+constexpr int LEVEL = 6;
+constexpr int MAX_LEVEL = 9;
+// Time between two reported frames, long enough to be measured reliably
+constexpr int FRAME_MS = 100;
+
+bool isSorted(const QVector<hipsPrefetchItem_t> &queue)
+{
+    for (int i = 1; i < queue.size(); i++)
+        if (queue[i].priority < queue[i - 1].priority)
+            return false;
+    return true;
+}
+}
+
+void TestHIPSPrefetcher::testStillView()
+{
+    HIPSPrefetcher prefetcher;
+    HEALPix healpix;
+    const double ra = 1.0, de = 0.3;
+
+    prefetcher.update(ra, de, 2.0, LEVEL, MAX_LEVEL);
+    const QVector<hipsPrefetchItem_t> queue = prefetcher.queue();
+
+    // The tile under the center comes first, then rings of neighbours, each tile once, all at the rendered level
+    QVERIFY(!queue.isEmpty());
+    QCOMPARE(queue.first().pix, healpix.getPix(LEVEL, ra, de));
+    QCOMPARE(queue.first().priority, 0);
+    QVERIFY(isSorted(queue));
+
+    QSet<int> pixels;
+    for (const auto &item : queue)
+    {
+        QCOMPARE(item.level, LEVEL);
+        QVERIFY(!pixels.contains(item.pix));
+        pixels.insert(item.pix);
+    }
+
+    // A wider view at the same level needs more rings
+    prefetcher.clear();
+    QVERIFY(prefetcher.queue().isEmpty());
+    prefetcher.update(ra, de, 4.0, LEVEL, MAX_LEVEL);
+    QVERIFY(prefetcher.queue().size() > queue.size());
+}
+
+void TestHIPSPrefetcher::testPanning()
+{
+    HIPSPrefetcher prefetcher;
+    HEALPix healpix;
+    const double de = 0.0, step = 0.01;
+
+    // Pan east at a steady rate: the queue is centered ahead of the view
+    double ra = 1.0;
+    for (int i = 0; i < 4; i++)
+    {
+        prefetcher.update(ra, de, 2.0, LEVEL, MAX_LEVEL);
+        QThread::msleep(FRAME_MS);
+        ra += step;
+    }
+    prefetcher.update(ra, de, 2.0, LEVEL, MAX_LEVEL);
+
+    const QVector<hipsPrefetchItem_t> queue = prefetcher.queue();
+    QVERIFY(!queue.isEmpty());
+    QVERIFY(isSorted(queue));
+    QVERIFY(queue.first().pix != healpix.getPix(LEVEL, ra, de));
+
+    // The view moves by about 0.1 rad/s, so half a second ahead it is about 0.05 rad further east
+    bool ahead = false;
+    for (double predicted = ra + 0.03; predicted < ra + 0.07; predicted += 0.005)
+        ahead |= queue.first().pix == healpix.getPix(LEVEL, predicted, de);
+    QVERIFY(ahead);
+}
+
+void TestHIPSPrefetcher::testZoomingIn()
+{
+    // Levels are used as they are with online sources
+    Options::setHIPSUseOfflineSource(false);
+
+    HIPSPrefetcher prefetcher;
+    double fov = 4.0;
+    for (int i = 0; i < 4; i++)
+    {
+        prefetcher.update(1.0, 0.3, fov, LEVEL, MAX_LEVEL);
+        QThread::msleep(FRAME_MS);
+        fov *= 0.8;
+    }
+    prefetcher.update(1.0, 0.3, fov, LEVEL, MAX_LEVEL);
+
+    // The next level is queued too, after the tile under the center of the current one
+    const QVector<hipsPrefetchItem_t> queue = prefetcher.queue();
+    QVERIFY(isSorted(queue));
+    QCOMPARE(queue.first().level, LEVEL);
+
+    int nextLevel = 0;
+    for (const auto &item : queue)
+    {
+        QVERIFY(item.level == LEVEL || item.level == LEVEL + 1);
+        if (item.level == LEVEL + 1)
+        {
+            QVERIFY(item.priority >= 1);
+            nextLevel++;
+        }
+    }
+    QVERIFY(nextLevel > 0);
+
+    // Not beyond the deepest level of the source
+    prefetcher.clear();
+    fov = 4.0;
+    for (int i = 0; i < 4; i++)
+    {
+        prefetcher.update(1.0, 0.3, fov, MAX_LEVEL, MAX_LEVEL);
+        QThread::msleep(FRAME_MS);
+        fov *= 0.8;
+    }
+    for (const auto &item : prefetcher.queue())
+        QCOMPARE(item.level, MAX_LEVEL);
+}
+
+void TestHIPSPrefetcher::testInvalidView()
+{
+    HIPSPrefetcher prefetcher;
+    prefetcher.update(std::nan(""), 0.3, 2.0, LEVEL, MAX_LEVEL);
+    QVERIFY(prefetcher.queue().isEmpty());
+    prefetcher.update(1.0, 0.3, 0.0, LEVEL, MAX_LEVEL);
+    QVERIFY(prefetcher.queue().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestHIPSPrefetcher)
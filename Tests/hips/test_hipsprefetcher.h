@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+
+/**
+ * @class TestHIPSPrefetcher
+ * @short Checks which HiPS tiles the prefetcher queues for a still, a panning and a zooming view.
+ * @author KStars Developers
+ */
+class TestHIPSPrefetcher : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestHIPSPrefetcher() = default;
+
+    private slots:
+        void testStillView();
+        void testPanning();
+        void testZoomingIn();
+        void testInvalidView();
+};
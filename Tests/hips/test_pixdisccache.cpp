@@ -0,0 +1,192 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_pixdisccache.h"
+
+#include "hips/pixdisccache.h"
+
+#include <QFile>
+
+#include <memory>
+
+namespace
+{
+constexpr int TILE_WIDTH = 16;
+// Header of the file, then page aligned slots: 64 bytes of slot header and a 16x16 RGBA tile fit in one page
+constexpr qint64 SLOT_SIZE = 4096;
+constexpr qint64 FILE_HEADER_SIZE = 64;
+constexpr int SLOTS = 3;
+
+pixCacheKey_t makeKey(int level, int pix, qint64 uid = 1)
+{
+    pixCacheKey_t key;
+    key.level = level;
+    key.pix = pix;
+    key.uid = uid;
+    return key;
+}
+
+QImage makeTile(int seed, int width = TILE_WIDTH)
+{
+    QImage image(width, width, QImage::Format_ARGB32);
+    for (int y = 0; y < width; y++)
+        for (int x = 0; x < width; x++)
+            image.setPixel(x, y, qRgb(seed, x * 16, y * 16));
+    return image;
+}
+
+bool sameTile(PixDiscCache &cache, const pixCacheKey_t &key, const QImage &expected)
+{
+    std::unique_ptr<QImage> image(cache.get(key));
+    return image && *image == expected;
+}
+}
+
+void TestPixDiscCache::init()
+{
+    QVERIFY(m_dir.isValid());
+    m_path = m_dir.filePath(QString("decoded-%1.cache").arg(QTest::currentTestFunction()));
+}
+
+void TestPixDiscCache::testAddGet()
+{
+    PixDiscCache cache;
+    QVERIFY(cache.open(m_path, TILE_WIDTH, FILE_HEADER_SIZE + SLOTS * SLOT_SIZE));
+    QVERIFY(cache.isOpen());
+    QCOMPARE(cache.tileWidth(), TILE_WIDTH);
+
+    QVERIFY(cache.get(makeKey(3, 10)) == nullptr);
+
+    const QImage tile = makeTile(10);
+    QVERIFY(cache.add(makeKey(3, 10), tile));
+    QVERIFY(sameTile(cache, makeKey(3, 10), tile));
+    QCOMPARE(cache.used(), SLOT_SIZE);
+
+    // The same tile again is not stored twice, and a tile larger than a slot is not stored at all
+    QVERIFY(!cache.add(makeKey(3, 10), tile));
+    QVERIFY(!cache.add(makeKey(3, 11), makeTile(11, 4 * TILE_WIDTH)));
+    QCOMPARE(cache.used(), SLOT_SIZE);
+
+    // Other formats are converted, grayscale is kept as it is
+    QImage gray(TILE_WIDTH, TILE_WIDTH, QImage::Format_Grayscale8);
+    gray.fill(77);
+    QVERIFY(cache.add(makeKey(3, 12), gray));
+    QVERIFY(sameTile(cache, makeKey(3, 12), gray));
+
+    cache.clear();
+    QVERIFY(!cache.contains(makeKey(3, 10)));
+    QCOMPARE(cache.used(), 0);
+}
+
+void TestPixDiscCache::testKeys()
+{
+    PixDiscCache cache;
+    QVERIFY(cache.open(m_path, TILE_WIDTH, FILE_HEADER_SIZE + SLOTS * SLOT_SIZE));
+
+    // Keys that only differ in one of the source, level or pixel are different tiles
+    QVERIFY(cache.add(makeKey(3, 5, 1), makeTile(1)));
+    QVERIFY(cache.add(makeKey(4, 5, 1), makeTile(2)));
+    QVERIFY(cache.add(makeKey(3, 5, 2), makeTile(3)));
+
+    QVERIFY(sameTile(cache, makeKey(3, 5, 1), makeTile(1)));
+    QVERIFY(sameTile(cache, makeKey(4, 5, 1), makeTile(2)));
+    QVERIFY(sameTile(cache, makeKey(3, 5, 2), makeTile(3)));
+    QVERIFY(!cache.contains(makeKey(3, 6, 1)));
+    QVERIFY(!cache.contains(makeKey(5, 5, 1)));
+    QVERIFY(!cache.contains(makeKey(3, 5, 3)));
+}
+
+void TestPixDiscCache::testEviction()
+{
+    PixDiscCache cache;
+    QVERIFY(cache.open(m_path, TILE_WIDTH, FILE_HEADER_SIZE + SLOTS * SLOT_SIZE));
+
+    for (int pix = 0; pix < SLOTS; pix++)
+        QVERIFY(cache.add(makeKey(3, pix), makeTile(pix)));
+    QCOMPARE(cache.used(), SLOTS * SLOT_SIZE);
+
+    // Using tile 0 makes tile 1 the least recently used, so it goes first
+    QVERIFY(sameTile(cache, makeKey(3, 0), makeTile(0)));
+    QVERIFY(cache.add(makeKey(3, 100), makeTile(100)));
+    QVERIFY(!cache.contains(makeKey(3, 1)));
+    QVERIFY(cache.contains(makeKey(3, 0)));
+    QVERIFY(cache.contains(makeKey(3, 2)));
+    QCOMPARE(cache.used(), SLOTS * SLOT_SIZE);
+
+    QVERIFY(cache.add(makeKey(3, 101), makeTile(101)));
+    QVERIFY(!cache.contains(makeKey(3, 2)));
+
+    // The slots that were reused hold the new tiles
+    QVERIFY(sameTile(cache, makeKey(3, 0), makeTile(0)));
+    QVERIFY(sameTile(cache, makeKey(3, 100), makeTile(100)));
+    QVERIFY(sameTile(cache, makeKey(3, 101), makeTile(101)));
+}
+
+void TestPixDiscCache::testReopen()
+{
+    const qint64 size = FILE_HEADER_SIZE + SLOTS * SLOT_SIZE;
+    {
+        PixDiscCache cache;
+        QVERIFY(cache.open(m_path, TILE_WIDTH, size));
+        QVERIFY(cache.add(makeKey(3, 1), makeTile(1)));
+        QVERIFY(cache.add(makeKey(3, 2), makeTile(2)));
+    }
+
+    // Same layout: the tiles are still there
+    {
+        PixDiscCache cache;
+        QVERIFY(cache.open(m_path, TILE_WIDTH, size));
+        QVERIFY(sameTile(cache, makeKey(3, 1), makeTile(1)));
+        QVERIFY(sameTile(cache, makeKey(3, 2), makeTile(2)));
+    }
+
+    // A different tile width or size drops the old contents
+    {
+        PixDiscCache cache;
+        QVERIFY(cache.open(m_path, 2 * TILE_WIDTH, 4 * size));
+        QVERIFY(!cache.contains(makeKey(3, 1)));
+    }
+    {
+        PixDiscCache cache;
+        QVERIFY(cache.open(m_path, TILE_WIDTH, size));
+        QVERIFY(!cache.contains(makeKey(3, 1)));
+        QCOMPARE(cache.used(), 0);
+    }
+
+    // Too small for a single slot
+    PixDiscCache cache;
+    QVERIFY(!cache.open(m_path, TILE_WIDTH, SLOT_SIZE));
+    QVERIFY(!cache.isOpen());
+}
+
+void TestPixDiscCache::testDamagedSlot()
+{
+    const qint64 size = FILE_HEADER_SIZE + SLOTS * SLOT_SIZE;
+    {
+        PixDiscCache cache;
+        QVERIFY(cache.open(m_path, TILE_WIDTH, size));
+        QVERIFY(cache.add(makeKey(3, 1), makeTile(1)));
+        QVERIFY(cache.add(makeKey(3, 2), makeTile(2)));
+    }
+
+    // Give the first slot an image height that would run past the end of the slot
+    {
+        QFile file(m_path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        const qint32 height = 1000;
+        QVERIFY(file.seek(FILE_HEADER_SIZE + 4 * sizeof(qint32)));
+        QCOMPARE(file.write(reinterpret_cast<const char *>(&height), sizeof(height)), qint64(sizeof(height)));
+    }
+
+    PixDiscCache cache;
+    QVERIFY(cache.open(m_path, TILE_WIDTH, size));
+    QVERIFY(!cache.contains(makeKey(3, 1)));
+    QVERIFY(cache.get(makeKey(3, 1)) == nullptr);
+    QVERIFY(sameTile(cache, makeKey(3, 2), makeTile(2)));
+    QCOMPARE(cache.used(), SLOT_SIZE);
+}
+
+QTEST_GUILESS_MAIN(TestPixDiscCache)
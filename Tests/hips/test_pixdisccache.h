@@ -0,0 +1,43 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/**
+ * @class TestPixDiscCache
+ * @short Checks the decoded HiPS tile cache: keys, least recently used eviction and reopening the file.
+ * @author KStars Developers
+ */
+class TestPixDiscCache : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestPixDiscCache() = default;
+
+    private slots:
+        void init();
+
+        void testAddGet();
+        void testKeys();
+        void testEviction();
+        void testReopen();
+        void testDamagedSlot();
+
+    private:
+        QTemporaryDir m_dir;
+        QString m_path;
+};
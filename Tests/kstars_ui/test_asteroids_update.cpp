@@ -0,0 +1,120 @@
+/*  KStars UI tests
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_asteroids_update.h"
+
+#include "kstars_ui_tests.h"
+
+#include "kstars.h"
+#include "ksnumbers.h"
+#include "Options.h"
+#include "skycomponents/asteroidscomponent.h"
+#include "skycomponents/skymapcomposite.h"
+#include "skycomponents/solarsystemcomposite.h"
+#include "skyobjects/ksasteroid.h"
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+namespace
+{
+AsteroidsComponent *asteroidsComponent()
+{
+    return KStarsData::Instance()->skyComposite()->solarSystemComposite()->asteroidsComponent();
+}
+}
+
+TestAsteroidsUpdate::TestAsteroidsUpdate(QObject *parent): QObject(parent)
+{
+}
+
+void TestAsteroidsUpdate::initTestCase()
+{
+    KTELL_BEGIN();
+
+    // The clock would update the asteroids between the measures
+    if (KStars::Instance()->isStartedWithClockRunning())
+        KStarsData::Instance()->clock()->stop();
+
+    m_ShowAsteroids = Options::showAsteroids();
+    Options::setShowAsteroids(true);
+
+    QVERIFY(asteroidsComponent() != nullptr);
+    if (asteroidsComponent()->objectList().isEmpty())
+        QSKIP("No asteroids were loaded");
+}
+
+void TestAsteroidsUpdate::cleanupTestCase()
+{
+    Options::setShowAsteroids(m_ShowAsteroids);
+
+    if (KStars::Instance()->isStartedWithClockRunning())
+        KStarsData::Instance()->clock()->start();
+
+    KTELL_END();
+}
+
+void TestAsteroidsUpdate::testPositions()
+{
+    AsteroidsComponent *asteroids = asteroidsComponent();
+    KSNumbers num(KStarsData::Instance()->ut().djd());
+
+    // One body at a time, as each KSAsteroid does on its own
+    asteroids->SolarSystemListComponent::updateSolarSystemBodies(&num);
+    QList<QPair<double, double>> expected;
+    for (const SkyObject *o : asteroids->objectList())
+        expected.append(qMakePair(o->ra().Degrees(), o->dec().Degrees()));
+
+    asteroids->updateSolarSystemBodies(&num);
+
+    // The asteroids bright enough to be drawn are at the same place, within KSAsteroid's own accuracy
+    int drawn = 0;
+    for (int k = 0; k < asteroids->objectList().size(); k++)
+    {
+        KSAsteroid *ast = static_cast<KSAsteroid *>(asteroids->objectList().at(k));
+        if (!ast->toDraw())
+            continue;
+
+        drawn++;
+        const SkyPoint p(dms(expected.at(k).first), dms(expected.at(k).second));
+        const double error = ast->angularDistanceTo(&p).Degrees() * 3600;
+        QVERIFY2(error < 5, qPrintable(QString("%1 is %2\" away").arg(ast->name()).arg(error)));
+    }
+    QVERIFY(drawn > 0);
+}
+
+void TestAsteroidsUpdate::benchmarkUpdate_data()
+{
+    QTest::addColumn<bool>("batch");
+
+    QTest::newRow("one body at a time") << false;
+    QTest::newRow("batch") << true;
+}
+
+void TestAsteroidsUpdate::benchmarkUpdate()
+{
+    QFETCH(bool, batch);
+
+    AsteroidsComponent *asteroids = asteroidsComponent();
+    KSNumbers num(KStarsData::Instance()->ut().djd());
+    qInfo() << asteroids->objectList().size() << "asteroids, magnitude limit" << Options::magLimitAsteroid();
+
+    QBENCHMARK
+    {
+        // A slightly different date each time, the positions are cached by date
+        num.updateValues(num.julianDay() + 1.0 / 1440);
+        if (batch)
+            asteroids->updateSolarSystemBodies(&num);
+        else
+            asteroids->SolarSystemListComponent::updateSolarSystemBodies(&num);
+    }
+}
+
+QTEST_KSTARS_MAIN(TestAsteroidsUpdate)
@@ -0,0 +1,37 @@
+/*  KStars UI tests
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef TEST_ASTEROIDS_UPDATE_H
+#define TEST_ASTEROIDS_UPDATE_H
+
+#include "config-kstars.h"
+#include <QObject>
+
+/**
+ * @class TestAsteroidsUpdate
+ * @short Compares the batched asteroid update with the one body at a time update, on the asteroids loaded by KStars.
+ * @author KStars Developers
+ */
+class TestAsteroidsUpdate: public QObject
+{
+        Q_OBJECT
+    public:
+        explicit TestAsteroidsUpdate(QObject *parent = nullptr);
+
+    private slots:
+        void initTestCase();
+        void cleanupTestCase();
+
+        void testPositions();
+
+        void benchmarkUpdate_data();
+        void benchmarkUpdate();
+
+    private:
+        bool m_ShowAsteroids { false };
+};
+
+#endif // TEST_ASTEROIDS_UPDATE_H
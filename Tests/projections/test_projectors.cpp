@@ -0,0 +1,139 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_projectors.h"
+
+#include "ksutils.h"
+#include "projections/azimuthalequidistantprojector.h"
+#include "projections/equirectangularprojector.h"
+#include "projections/gnomonicprojector.h"
+#include "projections/lambertprojector.h"
+#include "projections/orthographicprojector.h"
+#include "projections/stereographicprojector.h"
+
+#include <QMetaEnum>
+#include <QVector>
+
+#include <cmath>
+#include <memory>
+
+namespace
+{
+std::unique_ptr<Projector> makeProjector(Projector::Projection type, const ViewParams &vp)
+{
+    switch (type)
+    {
+        case Projector::Lambert:
+            return std::make_unique<LambertProjector>(vp);
+        case Projector::AzimuthalEquidistant:
+            return std::make_unique<AzimuthalEquidistantProjector>(vp);
+        case Projector::Orthographic:
+            return std::make_unique<OrthographicProjector>(vp);
+        case Projector::Equirectangular:
+            return std::make_unique<EquirectangularProjector>(vp);
+        case Projector::Stereographic:
+            return std::make_unique<StereographicProjector>(vp);
+        case Projector::Gnomonic:
+            return std::make_unique<GnomonicProjector>(vp);
+        default:
+            return nullptr;
+    }
+}
+}
+
+void TestProjectors::testBatchMatchesScalar_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<bool>("useAltAz");
+
+    const QVector<Projector::Projection> types = { Projector::Lambert, Projector::AzimuthalEquidistant,
+                                                   Projector::Orthographic, Projector::Equirectangular,
+                                                   Projector::Stereographic, Projector::Gnomonic
+                                                 };
+    for (auto type : types)
+    {
+        const QString name = QMetaEnum::fromType<Projector::Projection>().valueToKey(type);
+        QTest::newRow(qPrintable(name + ", equatorial")) << int(type) << false;
+        QTest::newRow(qPrintable(name + ", horizontal")) << int(type) << true;
+    }
+}
+
+void TestProjectors::testBatchMatchesScalar()
+{
+    QFETCH(int, type);
+    QFETCH(bool, useAltAz);
+
+    // The horizontal view is also rotated, mirrored and refracted, to go through every term of the projection.
+    // The focus is off the grid below so that no point lies exactly on the edge of the visible hemisphere.
+    SkyPoint focus;
+    focus.setRA(6.753);
+    focus.setDec(27.9);
+    focus.setAz(121.7);
+    focus.setAlt(38.3);
+
+    ViewParams vp;
+    vp.width         = 800;
+    vp.height        = 600;
+    vp.zoomFactor    = 400;
+    vp.rotationAngle = CachingDms(useAltAz ? 17.0 : 0.0);
+    vp.useRefraction = useAltAz;
+    vp.useAltAz      = useAltAz;
+    vp.mirror        = useAltAz;
+    vp.focus         = &focus;
+
+    std::unique_ptr<Projector> proj = makeProjector(static_cast<Projector::Projection>(type), vp);
+    QVERIFY(proj);
+
+    // The whole sphere, so most points are off screen and about half of them are behind it
+    QVector<SkyPoint> points;
+    for (double lat = -87.5; lat < 90; lat += 5)
+    {
+        for (double lon = 0; lon < 360; lon += 7.5)
+        {
+            SkyPoint p;
+            p.setRA(lon / 15.0);
+            p.setDec(lat);
+            p.setAz(lon);
+            p.setAlt(lat);
+            points.append(p);
+        }
+    }
+
+    QVector<const SkyPoint *> pointers;
+    for (const auto &p : points)
+        pointers.append(&p);
+
+    QVector<Eigen::Vector2f> screen(points.size());
+    QVector<bool> visible(points.size());
+    proj->toScreenVec(pointers.constData(), pointers.size(), screen.data(), visible.data());
+
+    int onScreen = 0, behind = 0;
+    for (int i = 0; i < points.size(); i++)
+    {
+        bool scalarVisible = false;
+        const QPointF expected = proj->toScreen(&points[i], true, &scalarVisible);
+        const QPointF actual   = KSUtils::vecToPoint(screen[i]);
+
+        // Both are single precision screen positions, and the gnomonic ones grow without bound near the edge
+        const double tolerance = 1e-3 * (1 + std::hypot(expected.x(), expected.y()));
+        QVERIFY2(std::hypot(actual.x() - expected.x(), actual.y() - expected.y()) <= tolerance,
+                 qPrintable(QString("point %1 (%2, %3): batch (%4, %5), scalar (%6, %7)")
+                            .arg(i).arg(points[i].az().Degrees()).arg(points[i].alt().Degrees())
+                            .arg(actual.x()).arg(actual.y()).arg(expected.x()).arg(expected.y())));
+        QCOMPARE(visible[i], scalarVisible);
+
+        if (scalarVisible && proj->onScreen(expected))
+            onScreen++;
+        if (!scalarVisible)
+            behind++;
+    }
+
+    // The grid must have covered both cases
+    QVERIFY(onScreen > 0);
+    QVERIFY(behind > 0);
+}
+
+QTEST_GUILESS_MAIN(TestProjectors)
@@ -0,0 +1,34 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+
+/**
+ * @class TestProjectors
+ * @short Checks the batched Projector::toScreenVec() against the scalar toScreen() of every projection.
+ * @author KStars Developers
+ */
+class TestProjectors : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestProjectors() = default;
+        ~TestProjectors() override = default;
+
+    private slots:
+        void testBatchMatchesScalar_data();
+        void testBatchMatchesScalar();
+};
@@ -18,6 +18,7 @@
 #include "ekos/capture/sequencejob.h"
 #include "ekos/capture/placeholderpath.h"
 #include "geolocation.h"
+#include "ksmoon.h"
 #include "Options.h"
 
 #include <QtGlobal>
@@ -51,6 +52,8 @@ class TestSchedulerUnit : public QObject
         void loadSequenceQueueTest();
         void estimateJobTimeTest();
         void evaluateJobsTest();
+        void calculateNextTimeTest_data();
+        void calculateNextTimeTest();
 
     private:
         void runSetupJob(Ekos::SchedulerJob &job,
@@ -603,4 +606,85 @@ void TestSchedulerUnit::evaluateJobsTest()
     jobs.clear();
 }
 
+// The next time the constraints are met (or missed), found by checking them every increment minutes for a day.
+// This is how SchedulerJob::calculateNextTime() used to work, it now solves the intervals instead.
+QDateTime stepNextTime(const Ekos::SchedulerJob &job, const KStarsDateTime &start, bool checkIfConstraintsAreMet,
+                       int increment)
+{
+    SkyPoint const target = job.getTargetCoords();
+    SkyObject o;
+    o.setRA0(target.ra0());
+    o.setDec0(target.dec0());
+
+    for (int minute = 0; minute < 24 * 60; minute += increment)
+    {
+        KStarsDateTime const t(start.addSecs(minute * 60));
+        QString reason;
+        bool const met = (!job.getEnforceTwilight() || job.runsDuringAstronomicalNightTime(t)) &&
+                         job.checkAltitudeAndMoon(o, t, &reason, nullptr);
+        if (met == checkIfConstraintsAreMet)
+            return t;
+    }
+    return QDateTime();
+}
+
+void TestSchedulerUnit::calculateNextTimeTest_data()
+{
+    QTest::addColumn<int>("startHour");        // Local time, hours from midNight
+    QTest::addColumn<double>("minAltitude");
+    QTest::addColumn<double>("minMoonSeparation");
+    QTest::addColumn<double>("maxMoonAltitude");
+    QTest::addColumn<bool>("enforceTwilight");
+    QTest::addColumn<int>("increment");        // Minutes
+
+    QTest::newRow("altitude") << -4 << 80.0 << 0.0 << 90.0 << false << 1;
+    QTest::newRow("altitude, 10 minutes") << -4 << 80.0 << 0.0 << 90.0 << false << 10;
+    QTest::newRow("altitude, after midnight") << 1 << 30.0 << 0.0 << 90.0 << false << 1;
+    QTest::newRow("twilight") << -12 << 0.0 << 0.0 << 90.0 << true << 1;
+    QTest::newRow("twilight, before dawn") << 2 << 0.0 << 0.0 << 90.0 << true << 1;
+    QTest::newRow("moon altitude") << -12 << 0.0 << 0.0 << 10.0 << false << 1;
+    QTest::newRow("moon separation") << -12 << 0.0 << 120.0 << 90.0 << false << 1;
+    QTest::newRow("combined") << -12 << 30.0 << 60.0 << 10.0 << true << 5;
+}
+
+// Compares SchedulerJob::calculateNextTime() with checking the constraints every increment minutes.
+void TestSchedulerUnit::calculateNextTimeTest()
+{
+    QFETCH(int, startHour);
+    QFETCH(double, minAltitude);
+    QFETCH(double, minMoonSeparation);
+    QFETCH(double, maxMoonAltitude);
+    QFETCH(bool, enforceTwilight);
+    QFETCH(int, increment);
+
+    // Unit tests don't instantiate KStarsData, so the Moon doesn't move against the stars.
+    // Put it about where it was that night, it still rises and sets.
+    KSMoon moon;
+    moon.setRA(dms(90.0));
+    moon.setDec(dms(20.0));
+
+    Ekos::SchedulerJob job(&moon);
+    KStarsDateTime start(midNight.addSecs(startHour * 3600));
+    runSetupJob(job, &siliconValley, &start, "Job1",
+                midnightRA, testDEC, 0.0,
+                QUrl(QString("file:%1").arg(seqFile9Filters)), QUrl(""),
+                Ekos::START_ASAP, QDateTime(),
+                Ekos::FINISH_SEQUENCE, QDateTime(), 1,
+                minAltitude, minMoonSeparation, maxMoonAltitude, enforceTwilight);
+
+    // The moon track is interpolated, allow for an increment more
+    const int tolerance = (increment + 1) * 60;
+
+    for (bool checkIfConstraintsAreMet : {true, false})
+    {
+        job.clearCache();
+        const QDateTime expected = stepNextTime(job, start, checkIfConstraintsAreMet, increment);
+        const QDateTime next = job.calculateNextTime(start, checkIfConstraintsAreMet, increment);
+
+        QCOMPARE(next.isValid(), expected.isValid());
+        if (expected.isValid())
+            QVERIFY(compareTimes(next, expected, tolerance));
+    }
+}
+
 QTEST_GUILESS_MAIN(TestSchedulerUnit)
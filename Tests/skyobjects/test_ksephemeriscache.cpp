@@ -0,0 +1,120 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_ksephemeriscache.h"
+
+#include "skyobjects/ksephemeriscache.h"
+
+#include <QRandomGenerator>
+
+#include <cmath>
+
+namespace
+{
+// A perturbed eccentric orbit: the longitude wraps around many times, and the distance and latitude
+// have a short period term
+void orbit(double period, double t, double *position)
+{
+    const double M = 2 * M_PI * t / period;
+    position[0] = std::fmod(M + 0.2 * std::sin(M) + 0.001 * std::sin(17 * M), 2 * M_PI);
+    position[1] = 0.05 * std::sin(M + 1) + 0.0001 * std::cos(13 * M);
+    position[2] = 1.5 * (1 - 0.1 * std::cos(M));
+}
+}
+
+void TestKSEphemerisCache::testAccuracy_data()
+{
+    QTest::addColumn<double>("period");
+    QTest::addColumn<double>("segmentLength");
+    QTest::addColumn<int>("degree");
+    QTest::addColumn<double>("tolerance");
+
+    QTest::newRow("short segments") << 100.0 << 1.0 << 12 << 1e-9;
+    QTest::newRow("long segments") << 100.0 << 4.0 << 16 << 1e-8;
+    QTest::newRow("fast orbit") << 27.0 << 0.5 << 12 << 1e-9;
+}
+
+void TestKSEphemerisCache::testAccuracy()
+{
+    QFETCH(double, period);
+    QFETCH(double, segmentLength);
+    QFETCH(int, degree);
+    QFETCH(double, tolerance);
+
+    auto function = [period](double t, double * position)
+    {
+        orbit(period, t, position);
+    };
+    KSEphemerisCache cache(function, segmentLength, degree, tolerance);
+
+    QRandomGenerator random(1);
+    for (int k = 0; k < 10000; k++)
+    {
+        const double t = random.bounded(2000.0) - 1000.0;
+        double cached[3], exact[3];
+        cache.evaluate(t, cached);
+        function(t, exact);
+
+        QVERIFY2(std::fabs(std::remainder(cached[0] - exact[0], 2 * M_PI)) <= tolerance,
+                 qPrintable(QString("Longitude at %1: %2 instead of %3").arg(t).arg(cached[0]).arg(exact[0])));
+        QVERIFY(std::fabs(cached[1] - exact[1]) <= tolerance);
+        QVERIFY(std::fabs(cached[2] - exact[2]) <= tolerance);
+    }
+
+    QCOMPARE(cache.rejected(), 0);
+}
+
+void TestKSEphemerisCache::testRejectedSegments()
+{
+    // Far too long segments for the polynomials: the exact function must be used instead
+    int evaluations = 0;
+    auto function = [&evaluations](double t, double * position)
+    {
+        evaluations++;
+        orbit(10.0, t, position);
+    };
+    KSEphemerisCache cache(function, 20.0, 8, 1e-9);
+
+    double cached[3], exact[3];
+    cache.evaluate(3.3, cached);
+    QCOMPARE(cache.rejected(), 1);
+
+    orbit(10.0, 3.3, exact);
+    for (int c = 0; c < 3; c++)
+        QCOMPARE(cached[c], exact[c]);
+
+    // No second fit of the same segment
+    evaluations = 0;
+    cache.evaluate(4.4, cached);
+    QCOMPARE(evaluations, 1);
+    QCOMPARE(cache.rejected(), 1);
+}
+
+void TestKSEphemerisCache::testPrecompute()
+{
+    int evaluations = 0;
+    auto function = [&evaluations](double t, double * position)
+    {
+        evaluations++;
+        orbit(100.0, t, position);
+    };
+    KSEphemerisCache cache(function, 2.0, 12, 1e-9);
+
+    cache.precompute(-10.0, 9.5);
+    QCOMPARE(cache.size(), 10);
+
+    // Within the precomputed range, no more evaluation of the function
+    evaluations = 0;
+    double position[3];
+    for (double t = -10.0; t < 10.0; t += 0.01)
+        cache.evaluate(t, position);
+    QCOMPARE(evaluations, 0);
+
+    cache.clear();
+    QCOMPARE(cache.size(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestKSEphemerisCache)
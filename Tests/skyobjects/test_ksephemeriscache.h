@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+
+/**
+ * @class TestKSEphemerisCache
+ * @short Checks the Chebyshev ephemeris cache against the functions it approximates.
+ * @author KStars Developers
+ */
+class TestKSEphemerisCache : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestKSEphemerisCache() = default;
+
+    private slots:
+        void testAccuracy_data();
+        void testAccuracy();
+        void testRejectedSegments();
+        void testPrecompute();
+};
@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_ksorbitbatch.h"
+
+#include "ksutils.h"
+#include "skyobjects/ksasteroid.h"
+#include "skyobjects/ksorbitbatch.h"
+
+#include <QFile>
+#include <QRandomGenerator>
+
+#include <cmath>
+
+namespace
+{
+constexpr long double J2000 = 2451545.0;
+}
+
+TestKSOrbitBatch::~TestKSOrbitBatch()
+{
+    qDeleteAll(m_Asteroids);
+}
+
+void TestKSOrbitBatch::findHeliocentricPosition(KSAsteroid *asteroid, long double jd, double &x, double &y,
+        double &z)
+{
+    asteroid->lastPrecessJD = jd;
+    asteroid->findHeliocentricPosition(x, y, z);
+}
+
+void TestKSOrbitBatch::initTestCase()
+{
+    // Loaded the same way as AsteroidsComponent::loadDataFromText()
+    if (QFile::exists("asteroids.dat"))
+    {
+        KSUtils::JPLParser parser("asteroids.dat");
+        parser.for_each([&](const auto & get)
+        {
+            const QString name = get("full_name").toString().trimmed();
+            const long double JD = get("epoch_mjd").toString().toInt() + 2400000.5;
+            m_Asteroids.append(new KSAsteroid(name.section(' ', 0, 0).toInt(), name.section(' ', 1, -1), QString(), JD,
+                                              get("a").toString().toDouble(), get("e").toString().toDouble(),
+                                              dms(get("i").toString().toDouble()), dms(get("w").toString().toDouble()),
+                                              dms(get("om").toString().toDouble()), dms(get("ma").toString().toDouble()),
+                                              get("H").toString().toDouble(), get("G").toString().toDouble()));
+        });
+    }
+    else
+        qWarning() << "Missing asteroids.dat, only checking synthetic orbits";
+
+    // Comet like orbits, where Kepler's equation is the hardest to solve
+    QRandomGenerator random(42);
+    for (int k = 0; k < 200; k++)
+    {
+        m_Asteroids.append(new KSAsteroid(0, QString("Eccentric %1").arg(k), QString(),
+                                          J2000 + random.bounded(10000.0) - 5000.0, 1.0 + random.bounded(5.0),
+                                          0.9 + random.bounded(0.099), dms(random.bounded(40.0)),
+                                          dms(random.bounded(360.0)), dms(random.bounded(360.0)),
+                                          dms(random.bounded(360.0)), 15, 0.15));
+    }
+}
+
+void TestKSOrbitBatch::testPositions_data()
+{
+    QTest::addColumn<double>("jd");
+
+    QTest::newRow("J2000") << 2451545.0;
+    QTest::newRow("2026") << 2461041.5;
+    QTest::newRow("1900") << 2415020.0;
+}
+
+void TestKSOrbitBatch::testPositions()
+{
+    QFETCH(double, jd);
+
+    KSOrbitBatch batch;
+    QVector<int> indexes;
+    for (KSAsteroid *ast : m_Asteroids)
+        indexes.append(batch.add(ast->JD, ast->a, ast->e, ast->i.Degrees(), ast->w.Degrees(), ast->N.Degrees(),
+                                 ast->M.Degrees(), ast->P));
+
+    // Hyperbolic and parabolic orbits are left to the callers
+    QCOMPARE(batch.add(J2000, 1.0, 1.0, 0, 0, 0, 0, 365.25), -1);
+    QCOMPARE(batch.add(J2000, 1.0, 1.5, 0, 0, 0, 0, 365.25), -1);
+
+    batch.solve(jd);
+
+    for (int k = 0; k < m_Asteroids.size(); k++)
+    {
+        KSAsteroid *ast = m_Asteroids.at(k);
+        const int index = indexes.at(k);
+        if (ast->e >= 1)
+        {
+            QCOMPARE(index, -1);
+            continue;
+        }
+        QVERIFY(index >= 0);
+
+        double x, y, z;
+        findHeliocentricPosition(ast, jd, x, y, z);
+
+        // KSAsteroid stops iterating once the eccentric anomaly changes by less than 0.001 degree,
+        // about 2e-5 radians, while the batch converges fully.
+        const double error = std::sqrt(std::pow(batch.x()[index] - x, 2) + std::pow(batch.y()[index] - y, 2) +
+                                       std::pow(batch.z()[index] - z, 2));
+        QVERIFY2(error < 2e-5 * ast->a,
+                 qPrintable(QString("%1 e=%2 error %3 AU").arg(ast->name()).arg(ast->e).arg(error)));
+        QVERIFY(std::fabs(batch.r()[index] - std::sqrt(x * x + y * y + z * z)) < 2e-5 * ast->a);
+    }
+}
+
+void TestKSOrbitBatch::benchmarkSolve_data()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("KSAsteroid") << 0;
+    QTest::newRow("batch, one thread") << 1;
+    QTest::newRow("batch, parallel") << 2;
+}
+
+void TestKSOrbitBatch::benchmarkSolve()
+{
+    QFETCH(int, method);
+
+    KSOrbitBatch batch;
+    for (KSAsteroid *ast : m_Asteroids)
+        batch.add(ast->JD, ast->a, ast->e, ast->i.Degrees(), ast->w.Degrees(), ast->N.Degrees(), ast->M.Degrees(),
+                  ast->P);
+
+    const long double jd = 2461041.5;
+    double sum = 0;
+
+    QBENCHMARK
+    {
+        switch (method)
+        {
+            case 0:
+                for (KSAsteroid *ast : m_Asteroids)
+                {
+                    double x, y, z;
+                    findHeliocentricPosition(ast, jd, x, y, z);
+                    sum += x;
+                }
+                break;
+
+            case 1:
+                batch.solve(jd, 0, batch.size());
+                sum += batch.x()[0];
+                break;
+
+            default:
+                batch.solve(jd);
+                sum += batch.x()[0];
+                break;
+        }
+    }
+
+    QVERIFY(!std::isnan(sum));
+}
+
+QTEST_GUILESS_MAIN(TestKSOrbitBatch)
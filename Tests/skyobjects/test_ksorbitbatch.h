@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+#include <QVector>
+
+class KSAsteroid;
+
+/**
+ * @class TestKSOrbitBatch
+ * @short Checks the batched Kepler solver against KSAsteroid, and measures both on the shipped asteroids.
+ * @author KStars Developers
+ */
+class TestKSOrbitBatch : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestKSOrbitBatch() = default;
+        ~TestKSOrbitBatch() override;
+
+    private slots:
+        void initTestCase();
+
+        void testPositions_data();
+        void testPositions();
+
+        void benchmarkSolve_data();
+        void benchmarkSolve();
+
+    private:
+        // The position KSAsteroid finds on its own, one asteroid at a time
+        static void findHeliocentricPosition(KSAsteroid *asteroid, long double jd, double &x, double &y, double &z);
+
+        // The asteroids of the data file shipped with KStars, then a few very eccentric orbits
+        QVector<KSAsteroid *> m_Asteroids;
+};
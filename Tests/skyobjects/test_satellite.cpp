@@ -0,0 +1,220 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_satellite.h"
+
+#include "geolocation.h"
+#include "skyobjects/satellitebatch.h"
+
+#include <QRandomGenerator>
+
+#include <cmath>
+
+namespace
+{
+// About the size of the largest TLE groups
+constexpr int SATELLITE_COUNT = 5000;
+
+// ISS, with a small drag term
+const char *ISS_LINE1 = "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927";
+const char *ISS_LINE2 = "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537";
+}
+
+TestSatellite::~TestSatellite()
+{
+    qDeleteAll(m_Satellites);
+}
+
+void TestSatellite::initTestCase()
+{
+    // Random low earth orbits, a few of them with a perigee low enough to use the simplified drag model
+    QRandomGenerator random(42);
+    for (int k = 0; k < SATELLITE_COUNT; k++)
+    {
+        const double meanMotion = (k % 50 == 0) ? 16.0 + random.bounded(0.3) : 11.5 + random.bounded(4.0);
+        const QString line1     = QString("1 %1U 20001A   20%2.%3  .00000100  00000-0  %4-4 0  9990")
+                                  .arg(k, 5, 10, QChar('0'))
+                                  .arg(1 + random.bounded(360), 3, 10, QChar('0'))
+                                  .arg(random.bounded(100000000), 8, 10, QChar('0'))
+                                  .arg(1000 + random.bounded(50000), 5, 10, QChar('0'));
+        const QString line2 = QString("2 %1 %2 %3 %4 %5 %6 %7    10")
+                              .arg(k, 5, 10, QChar('0'))
+                              .arg(random.bounded(98.0), 8, 'f', 4)
+                              .arg(random.bounded(360.0), 8, 'f', 4)
+                              .arg(random.bounded(500000), 7, 10, QChar('0'))
+                              .arg(random.bounded(360.0), 8, 'f', 4)
+                              .arg(random.bounded(360.0), 8, 'f', 4)
+                              .arg(meanMotion, 11, 'f', 8);
+        m_Satellites.append(new Satellite(QString("SAT %1").arg(k), line1, line2));
+    }
+}
+
+void TestSatellite::testReference()
+{
+    // Test vector 00005 from Vallado et al., "Revisiting Spacetrack Report #3" (2006)
+    Satellite sat("00005", "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+                  "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667");
+
+    double position[3], velocity[3];
+    QCOMPARE(sat.sgp4(0, position, velocity), 0);
+
+    const double expectedPosition[3] = { 7022.46529266, -1400.08296755, 0.03995155 };
+    const double expectedVelocity[3] = { 1.893841015, 6.405893759, 4.534807250 };
+    for (int i = 0; i < 3; i++)
+    {
+        QVERIFY(std::fabs(position[i] - expectedPosition[i]) < 1e-6);
+        QVERIFY(std::fabs(velocity[i] - expectedVelocity[i]) < 1e-8);
+    }
+}
+
+void TestSatellite::testDeepSpace()
+{
+    // A geostationary satellite is left to the scalar propagator
+    Satellite sat("GOES", "1 28912U 05041A   08264.51782528 -.00000100  00000-0  00000-0 0  9990",
+                  "2 28912   0.0200  90.0000 0001000 270.0000 180.0000  1.00270000 10000");
+
+    SatelliteBatch batch;
+    QCOMPARE(batch.add(&sat), -1);
+    QCOMPARE(batch.size(), 0);
+}
+
+void TestSatellite::testBatch_data()
+{
+    QTest::addColumn<double>("days");
+
+    QTest::newRow("epoch") << 0.0;
+    QTest::newRow("one day") << 1.0;
+    QTest::newRow("one month") << 30.0;
+}
+
+void TestSatellite::testBatch()
+{
+    QFETCH(double, days);
+
+    SatelliteBatch batch;
+    for (Satellite *sat : m_Satellites)
+        QCOMPARE(batch.add(sat), batch.size() - 1);
+
+    const double jd = m_Satellites.first()->m_tle_jd + days;
+    batch.solve(jd);
+
+    int errors = 0;
+    for (int k = 0; k < m_Satellites.size(); k++)
+    {
+        Satellite *sat = m_Satellites.at(k);
+        double position[3], velocity[3], batchPosition[3], batchVelocity[3];
+
+        const int rc = sat->sgp4((jd - sat->m_tle_jd) * 1440, position, velocity);
+        QCOMPARE(batch.state(k, batchPosition, batchVelocity), rc);
+        if (rc != 0)
+        {
+            errors++;
+            continue;
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            // 1 mm and 1 mm/s
+            QVERIFY2(std::fabs(batchPosition[i] - position[i]) < 1e-6,
+                     qPrintable(QString("Satellite %1 error %2 km").arg(k).arg(batchPosition[i] - position[i])));
+            QVERIFY(std::fabs(batchVelocity[i] - velocity[i]) < 1e-6);
+        }
+    }
+
+    // Most of the satellites must still be in orbit for the comparison to mean something
+    QVERIFY(errors < m_Satellites.size() / 2);
+}
+
+void TestSatellite::testPasses()
+{
+    Satellite sat("ISS", ISS_LINE1, ISS_LINE2);
+    GeoLocation geo(dms(7.0), dms(45.0));
+
+    const double start = sat.m_tle_jd, end = start + 2;
+    const QList<SatellitePass> passes = sat.findPasses(start, end, &geo);
+    QVERIFY(!passes.isEmpty());
+
+    // Step through the window one second at a time, the rise and set times must agree to that
+    const double step = 1.0 / 86400;
+    int index = 0;
+    bool up   = sat.elevation(Satellite::frame(start, &geo)) > 0;
+    double rise = start;
+    for (double t = start + step; t <= end; t += step)
+    {
+        const double alt = sat.elevation(Satellite::frame(t, &geo));
+        if (alt > 0 && !up)
+        {
+            rise = t;
+            up   = true;
+        }
+        else if (alt <= 0 && up)
+        {
+            up = false;
+            QVERIFY(index < passes.size());
+            const SatellitePass &pass = passes.at(index++);
+            QVERIFY(std::fabs(pass.riseJD - rise) < 2 * step);
+            QVERIFY(std::fabs(pass.setJD - t) < 2 * step);
+            QVERIFY(pass.culminationJD > pass.riseJD && pass.culminationJD < pass.setJD);
+            QVERIFY(pass.culminationAlt > 0 && pass.culminationAlt <= 90);
+            QVERIFY(std::fabs(sat.elevation(Satellite::frame(pass.culminationJD, &geo)) - pass.culminationAlt) < 1e-6);
+        }
+    }
+    QCOMPARE(index + (up ? 1 : 0), passes.size());
+
+    // A higher threshold keeps a subset of the passes, each reaching above it
+    const QList<SatellitePass> highPasses = sat.findPasses(start, end, &geo, 30);
+    QVERIFY(highPasses.size() < passes.size());
+    for (const auto &pass : highPasses)
+        QVERIFY(pass.culminationAlt > 30);
+}
+
+void TestSatellite::benchmarkPropagate_data()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("scalar") << 0;
+    QTest::newRow("batch, one thread") << 1;
+    QTest::newRow("batch, parallel") << 2;
+}
+
+void TestSatellite::benchmarkPropagate()
+{
+    QFETCH(int, method);
+
+    SatelliteBatch batch;
+    for (Satellite *sat : m_Satellites)
+        batch.add(sat);
+
+    const double jd = m_Satellites.first()->m_tle_jd + 1;
+    double sum = 0;
+
+    QBENCHMARK
+    {
+        switch (method)
+        {
+            case 0:
+                for (Satellite *sat : m_Satellites)
+                {
+                    double position[3], velocity[3];
+                    sat->sgp4((jd - sat->m_tle_jd) * 1440, position, velocity);
+                    sum += position[0];
+                }
+                break;
+
+            case 1:
+                batch.solve(jd, 0, batch.size());
+                break;
+
+            default:
+                batch.solve(jd);
+                break;
+        }
+    }
+
+    QVERIFY(!std::isnan(sum));
+}
+
+QTEST_GUILESS_MAIN(TestSatellite)
@@ -0,0 +1,51 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QObject>
+
+#define UNIT_TEST
+
+#include "skyobjects/satellite.h"
+
+/**
+ * @class TestSatellite
+ * @short Checks the SGP4 propagator, the batched propagator and the pass search.
+ * @author KStars Developers
+ */
+class TestSatellite : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestSatellite() = default;
+        ~TestSatellite() override;
+
+    private slots:
+        void initTestCase();
+
+        void testReference();
+        void testDeepSpace();
+
+        void testBatch_data();
+        void testBatch();
+
+        void testPasses();
+
+        void benchmarkPropagate_data();
+        void benchmarkPropagate();
+
+    private:
+        QList<Satellite *> m_Satellites;
+};
@@ -0,0 +1,201 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * This file contains unit tests for the NightVisibility class.
+ */
+
+#include <QObject>
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <cmath>
+
+#include "geolocation.h"
+#include "ksalmanac.h"
+#include "ksnumbers.h"
+#include "nightvisibility.h"
+#include "Options.h"
+#include "skypoint.h"
+
+class TestNightVisibility : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestNightVisibility();
+
+        /** @short Destructor */
+        ~TestNightVisibility() override = default;
+
+    private slots:
+        void computeTest_data();
+        void computeTest();
+};
+
+// This include must go after the class declaration.
+#include "testnightvisibility.moc"
+
+namespace
+{
+
+// The steps the Imaging Planner used to scan the night with, in minutes:
+// the scheduler resolution for the hours, and a coarser one for the altitude.
+constexpr int RUN_STEP_MINUTES = 10;
+constexpr int ALTITUDE_STEP_MINUTES = 20;
+
+// The targets, J2000. Depending on the latitude they are circumpolar, rise and set, or never rise.
+struct TestTarget
+{
+    const char *name;
+    double ra;  // hours
+    double dec; // degrees
+};
+
+const TestTarget targets[] =
+{
+    {"M42", 5.588, -5.39},
+    {"M31", 0.712, 41.27},
+    {"M13", 16.695, 36.46},
+    {"Polaris", 2.530, 89.26},
+    {"LMC", 5.392, -69.76},
+    {"Omega Centauri", 13.447, -47.48},
+};
+
+double altitudeAt(const GeoLocation &geo, SkyPoint &p, const KStarsDateTime &ut)
+{
+    CachingDms LST = geo.GSTtoLST(ut.gst());
+    p.EquatorialToHorizontal(&LST, geo.lat());
+    return p.alt().Degrees();
+}
+
+}  // namespace
+
+TestNightVisibility::TestNightVisibility() : QObject()
+{
+    // Setting this true winds up calling KStarsData::Instance() via SkyPoint::apparentCoord().
+    // Unit tests don't instantiate KStarsData::Instance() and will crash.
+    Options::setUseRelativistic(false);
+
+    // The night is astronomical dusk to dawn, without the scheduler's offsets
+    Options::setDuskOffset(0);
+    Options::setDawnOffset(0);
+    Options::setPreDawnTime(0);
+    Options::setEnableAltitudeLimits(false);
+}
+
+void TestNightVisibility::computeTest_data()
+{
+    QTest::addColumn<double>("longitude");
+    QTest::addColumn<double>("latitude");
+    QTest::addColumn<double>("tz");
+    QTest::addColumn<QDate>("date");
+    QTest::addColumn<double>("minAltitude");
+
+    QTest::newRow("Silicon Valley, winter") << -122.17 << 37.44 << -8.0 << QDate(2026, 1, 15) << 30.0;
+    QTest::newRow("Silicon Valley, spring, horizon") << -122.17 << 37.44 << -8.0 << QDate(2026, 4, 10) << 0.0;
+    QTest::newRow("Sydney, winter") << 151.21 << -33.87 << 10.0 << QDate(2026, 6, 15) << 10.0;
+    QTest::newRow("Helsinki, winter") << 24.94 << 60.17 << 2.0 << QDate(2026, 12, 21) << 20.0;
+    QTest::newRow("Quito, autumn") << -78.47 << -0.18 << -5.0 << QDate(2026, 10, 1) << 40.0;
+}
+
+// Compares NightVisibility::compute() with scanning the night in steps, the way the Imaging Planner used to
+// compute the hours a target can be imaged and its highest altitude.
+void TestNightVisibility::computeTest()
+{
+    QFETCH(double, longitude);
+    QFETCH(double, latitude);
+    QFETCH(double, tz);
+    QFETCH(QDate, date);
+    QFETCH(double, minAltitude);
+
+    const GeoLocation geo(dms(longitude), dms(latitude), "Test", "", "", tz);
+
+    NightVisibility::Constraints constraints;
+    constraints.minAltitude = minAltitude;
+    constraints.enforceTwilight = true;
+    const NightVisibility visibility(date, &geo, nullptr, constraints);
+
+    // Astronomical dusk and dawn in hours from local noon, the same twilight the planner used
+    const KStarsDateTime noon = geo.LTtoUT(KStarsDateTime(date, QTime(12, 0)));
+    const KStarsDateTime midnight = geo.LTtoUT(KStarsDateTime(date.addDays(1), QTime(0, 1)));
+    const KSAlmanac ksal(midnight, &geo);
+    const double midnightHours = noon.secsTo(midnight) / 3600.0;
+    const double dusk = midnightHours + 24 * ksal.getDuskAstronomicalTwilight();
+    const double dawn = midnightHours + 24 * ksal.getDawnAstronomicalTwilight();
+    QVERIFY(dusk < dawn);
+
+    // Targets are followed at their position of date, as NightVisibility does
+    KSNumbers numbers(noon.djd() + 0.5);
+
+    int circumpolar = 0, neverRising = 0;
+    for (const auto &target : targets)
+    {
+        SkyPoint p;
+        p.setRA0(dms(target.ra * 15.0));
+        p.setDec0(dms(target.dec));
+        p.updateCoordsNow(&numbers);
+
+        const NightVisibility::Result result = visibility.compute({dms(target.ra * 15.0), dms(target.dec)});
+
+        // Hours: count the steps when the target is high enough during the night
+        int stepsUp = 0;
+        for (int minutes = 0; minutes < 24 * 60; minutes += RUN_STEP_MINUTES)
+        {
+            const double hours = minutes / 60.0;
+            if (hours >= dusk && hours <= dawn &&
+                    altitudeAt(geo, p, KStarsDateTime(noon.djd() + hours / 24.0)) >= minAltitude)
+                stepsUp++;
+        }
+        const double sampledHours = stepsUp * RUN_STEP_MINUTES / 60.0;
+
+        // Altitude: the highest one sampled from dusk to dawn
+        double sampledMaxAltitude = -90;
+        for (double hours = dusk; hours < dawn; hours += ALTITUDE_STEP_MINUTES / 60.0)
+            sampledMaxAltitude = std::max(sampledMaxAltitude,
+                                          altitudeAt(geo, p, KStarsDateTime(noon.djd() + hours / 24.0)));
+
+        const QString message = QString("%1: %2 hours above %3º, sampled %4; maximum altitude %5º, sampled %6º")
+                                .arg(target.name).arg(result.hours).arg(minAltitude).arg(sampledHours)
+                                .arg(result.maxAltitude).arg(sampledMaxAltitude);
+
+        // There are at most two windows in a night, so four edges, each found to within a step by the scan
+        QVERIFY2(std::fabs(result.hours - sampledHours) <= 4 * RUN_STEP_MINUTES / 60.0 + 1e-6, qPrintable(message));
+
+        // The exact maximum is never below a sampled altitude. The altitude changes by at most 15º per hour
+        // and the last sample can be up to a step before dawn, so the samples miss it by less than a step of that.
+        QVERIFY2(result.maxAltitude >= sampledMaxAltitude - 0.01, qPrintable(message));
+        QVERIFY2(result.maxAltitude - sampledMaxAltitude <= 15.0 * ALTITUDE_STEP_MINUTES / 60.0, qPrintable(message));
+
+        // A target that is always above the limit can be imaged for the whole night, one that never reaches it not at all
+        const double lowest = -90 + std::fabs(latitude + p.dec().Degrees());
+        const double highest = 90 - std::fabs(latitude - p.dec().Degrees());
+        if (lowest >= minAltitude)
+        {
+            QVERIFY2(std::fabs(result.hours - (dawn - dusk)) < 1e-3, qPrintable(message));
+            circumpolar++;
+        }
+        if (highest < minAltitude)
+        {
+            QVERIFY2(result.hours == 0, qPrintable(message));
+            QCOMPARE(sampledHours, 0.0);
+            neverRising++;
+        }
+    }
+
+    // Each place has a target that never rises high enough, and away from the equator a circumpolar one
+    QVERIFY(neverRising > 0);
+    if (std::fabs(latitude) > 30)
+        QVERIFY(circumpolar > 0);
+}
+
+QTEST_GUILESS_MAIN(TestNightVisibility)
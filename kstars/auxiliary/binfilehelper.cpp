@@ -11,6 +11,13 @@
 
 #include <QStandardPaths>
 
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 class BinFileHelper;
 
 BinFileHelper::BinFileHelper()
@@ -28,6 +35,7 @@ BinFileHelper::~BinFileHelper()
 
 void BinFileHelper::init()
 {
+    unmapFile();
     if (fileHandle)
         fclose(fileHandle);
 
@@ -83,9 +91,75 @@ FILE *BinFileHelper::openFile(const QString &fileName)
         errnum = ERR_FILEOPEN;
         return nullptr;
     }
+    filePath = FilePath;
     return fileHandle;
 }
 
+bool BinFileHelper::mapFile()
+{
+    if (mappedData)
+        return true;
+    if (!fileHandle)
+        return false;
+
+    mappedFile.setFileName(filePath);
+    if (!mappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    mappedSize = mappedFile.size();
+    mappedData = mappedFile.map(0, mappedSize);
+    if (!mappedData)
+    {
+        mappedFile.close();
+        mappedSize = 0;
+        return false;
+    }
+
+#ifdef Q_OS_UNIX
+    // Trixels are read in whatever order they come into view so stop the kernel reading ahead sequentially
+    madvise(mappedData, mappedSize, MADV_RANDOM);
+#endif
+    return true;
+}
+
+void BinFileHelper::unmapFile()
+{
+    if (mappedData)
+        mappedFile.unmap(mappedData);
+    if (mappedFile.isOpen())
+        mappedFile.close();
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+const char *BinFileHelper::getRecords(quint32 offset, quint32 nrecs) const
+{
+    if (!mappedData || static_cast<qint64>(offset) + static_cast<qint64>(nrecs) * recordSize > mappedSize)
+        return nullptr;
+
+    return reinterpret_cast<const char *>(mappedData) + offset;
+}
+
+void BinFileHelper::prefetchRecords(quint32 offset, quint32 nrecs) const
+{
+#ifdef Q_OS_UNIX
+    if (!mappedData || nrecs == 0)
+        return;
+
+    qint64 end = std::min(mappedSize, static_cast<qint64>(offset) + static_cast<qint64>(nrecs) * recordSize);
+    if (end <= offset)
+        return;
+
+    // madvise needs a page aligned start address
+    const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    const qint64 start    = (static_cast<qint64>(offset) / pageSize) * pageSize;
+    madvise(mappedData + start, end - start, MADV_WILLNEED);
+#else
+    Q_UNUSED(offset)
+    Q_UNUSED(nrecs)
+#endif
+}
+
 enum BinFileHelper::Errors BinFileHelper::__readHeader()
 {
     qint16 endian_id, i;
@@ -275,6 +349,7 @@ bool BinFileHelper::readHeader()
 
 void BinFileHelper::closeFile()
 {
+    unmapFile();
     fclose(fileHandle);
     fileHandle = nullptr;
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <QFile>
 #include <QString>
 #include <QVector>
 
@@ -69,6 +70,38 @@ class BinFileHelper
      */
     void closeFile();
 
+    /**
+     * @short  Map the open file read-only into memory so that records can be read without any file I/O calls
+     * @note   If the file can't be mapped (e.g. no address space on 32-bit systems) the file handle remains
+     *         usable and callers should fall back to fread
+     * @return True if the file is mapped
+     */
+    bool mapFile();
+
+    /**
+     * @short  Check whether the file is mapped into memory
+     * @return True if mapFile() succeeded and the file hasn't been closed since
+     */
+    inline bool isMapped() const { return mappedData != nullptr; }
+
+    /**
+     * @short  Get a zero-copy view of a range of records in the mapped file
+     * @param  offset  Offset in bytes of the first record from the start of the file
+     * @param  nrecs   Number of records in the range
+     * @return Pointer to the first record, valid until the file is closed. nullptr if the file is not mapped
+     *         or the range runs past the end of the file
+     * @note   The records are as stored in the file, i.e. they may need byte swapping and need not be aligned
+     */
+    const char *getRecords(quint32 offset, quint32 nrecs) const;
+
+    /**
+     * @short  Ask the OS to start paging in a range of records that will be needed soon, e.g. the rest of a
+     *         trixel that is about to come into view. Does nothing if the file is not mapped
+     * @param  offset  Offset in bytes of the first record from the start of the file
+     * @param  nrecs   Number of records in the range
+     */
+    void prefetchRecords(quint32 offset, quint32 nrecs) const;
+
     /**
      * @short   Get error number
      * @return  A number corresponding to the error
@@ -227,8 +260,19 @@ class BinFileHelper
      */
     void init();
 
+    /**
+     * @short  Helper function that unmaps the file if it is mapped
+     */
+    void unmapFile();
+
     /// Handle to the file.
     FILE *fileHandle { nullptr};
+    /// Path of the open file
+    QString filePath;
+    /// Read-only mapping of the whole file, if mapFile() has been called
+    QFile mappedFile;
+    uchar *mappedData { nullptr };
+    qint64 mappedSize { 0 };
     /// Stores offsets corresponding to each index table entry
     QVector<unsigned long> indexOffset;
     /// Stores number of records under each index table entry
@@ -179,6 +179,9 @@ DBManager::DBManager(const QString &filename) : m_db_file(filename)
     m_q_obj_by_maglim_and_type =
         make_query(m_db, SqlStatements::dso_by_maglim_and_type, true);
     m_q_obj_by_oid = make_query(m_db, SqlStatements::dso_by_oid, true);
+
+    if (name_search_exists())
+        prepare_name_search();
 };
 
 DBManager::DBManager(const DBManager &other) : DBManager::DBManager{ other.m_db_file } {};
@@ -358,9 +361,57 @@ bool DBManager::compile_master_catalog()
     success &= query.exec(SqlStatements::create_master_mag_index);
     success &= query.exec(SqlStatements::create_master_type_index);
     success &= query.exec(SqlStatements::create_master_name_index);
+
+    // Not fatal, the name search falls back to LIKE without the index
+    compile_name_search();
     return success;
 };
 
+bool DBManager::name_search_exists()
+{
+    QSqlQuery query{ m_db };
+    query.exec(SqlStatements::exists_master_name_search);
+    return query.next();
+}
+
+bool DBManager::compile_missing_name_search()
+{
+    if (name_search_exists())
+        return prepare_name_search();
+
+    auto _ = gsl::finally([&]()
+    {
+        m_db.commit();
+    });
+    m_db.transaction();
+    return compile_name_search();
+}
+
+bool DBManager::compile_name_search()
+{
+    QSqlQuery query{ m_db };
+    if (!query.exec(SqlStatements::drop_master_name_search) ||
+            !query.exec(SqlStatements::create_master_name_search) ||
+            !query.exec(SqlStatements::fill_master_name_search))
+    {
+        qCWarning(KSTARS_CATALOGS)
+                << "No full-text index for the catalog names:" << query.lastError().text();
+        m_name_search = false;
+        return false;
+    }
+
+    return prepare_name_search();
+}
+
+bool DBManager::prepare_name_search()
+{
+    // Not fatal, the search falls back to LIKE
+    m_q_obj_by_name_prefix = QSqlQuery{ m_db };
+    m_q_obj_by_name_prefix.setForwardOnly(true);
+    m_name_search = m_q_obj_by_name_prefix.prepare(SqlStatements::dso_by_name_prefix);
+    return m_name_search;
+}
+
 const Catalog read_catalog(const QSqlQuery &query)
 {
     return { query.value("id").toInt(),
@@ -523,6 +574,52 @@ CatalogObjectList DBManager::find_objects_by_name(const QString &name, const int
 
 }
 
+CatalogObjectList DBManager::find_objects_by_prefix(const QString &prefix, const int limit)
+{
+    QMutexLocker _{ &m_mutex };
+
+    if (limit == 0)
+        return CatalogObjectList();
+
+    return _find_objects_by_prefix(prefix, limit);
+}
+
+CatalogObjectList DBManager::_find_objects_by_prefix(const QString &prefix, const int limit)
+{
+    // Split the text into words like the index does, each of them is
+    // matched as a quoted prefix so that no character has a meaning in
+    // the query syntax.
+    QStringList words;
+    QString word;
+    for (const QChar c : prefix + ' ')
+    {
+        if (c.isLetterOrNumber())
+            word += c;
+        else if (word.size() > 0)
+        {
+            words << QString("\"%1\"*").arg(word);
+            word.clear();
+        }
+    }
+
+    // The index of an older database is built on a worker thread, it is
+    // used once it is there
+    if (!m_name_search && !words.isEmpty() && name_search_exists())
+        prepare_name_search();
+
+    if (words.isEmpty() || !m_name_search)
+    {
+        m_q_obj_by_name.bindValue(":name", prefix);
+        m_q_obj_by_name.bindValue(":limit", limit);
+        return fetch_objects(m_q_obj_by_name);
+    }
+
+    m_q_obj_by_name_prefix.bindValue(":match", words.join(' '));
+    m_q_obj_by_name_prefix.bindValue(":name", prefix);
+    m_q_obj_by_name_prefix.bindValue(":limit", limit);
+    return fetch_objects(m_q_obj_by_name_prefix);
+}
+
 CatalogObjectList DBManager::find_objects_by_name(const int catalog_id,
         const QString &name, const int limit)
 {
@@ -207,6 +207,8 @@ class DBManager
         swap(m_q_obj_by_trixel_null_mag, other.m_q_obj_by_trixel_null_mag);
         swap(m_q_obj_by_name, other.m_q_obj_by_name);
         swap(m_q_obj_by_name_exact, other.m_q_obj_by_name_exact);
+        swap(m_q_obj_by_name_prefix, other.m_q_obj_by_name_prefix);
+        swap(m_name_search, other.m_name_search);
         swap(m_q_obj_by_lim, other.m_q_obj_by_lim);
         swap(m_q_obj_by_maglim, other.m_q_obj_by_maglim);
         swap(m_q_obj_by_maglim_and_type, other.m_q_obj_by_maglim_and_type);
@@ -284,6 +286,34 @@ class DBManager
     CatalogObjectList find_objects_by_name(const QString &name, const int limit = -1,
                                            const bool exactMatchOnly = false);
 
+    /**
+     * \brief Find objects by the beginning of their names, best matches first.
+     *
+     * Every word of \p `prefix` has to start a word of the `name`,
+     * `long_name` or `catalog_identifier` of an object, so that `ngc
+     * 22` finds NGC 224 and `andro` the Andromeda Galaxy. Objects
+     * whose name starts with \p `prefix` come first, then the most
+     * relevant and the brightest.
+     *
+     * Uses the full-text index of the master catalog, which keeps
+     * the search interactive with millions of objects. Falls back to
+     * a substring search if sqlite lacks full-text search, or while
+     * the index of an older database is built, \sa
+     * compile_missing_name_search.
+     *
+     * \param limit Upper limit to the quanitity of results. `-1` means "no
+     * limit"
+     *
+     * \return a list of matching objects
+     */
+    CatalogObjectList find_objects_by_prefix(const QString &prefix, const int limit = -1);
+
+    /**
+     * \returns whether the prefix search uses the full-text index of
+     * the names, rather than a substring search
+     */
+    bool has_name_search() const { return m_name_search; }
+
     /**
      * \brief Find an objects by name in the catalog with \p `catalog_id`.
      *
@@ -507,13 +537,23 @@ class DBManager
     /**
      * Compiles the master catalog by merging the individual catalogs based
      * on `oid` and precedence and creates an index by (trixel, magnitude) on
-     * the master table. **Caution** you may want to call
-     * `update_catalog_views` beforhand.
+     * the master table. The full-text index of the names is built again
+     * too. **Caution** you may want to call `update_catalog_views` beforhand.
      *
      * @return true in case of success, false in case of an error
      */
     bool compile_master_catalog();
 
+    /**
+     * Builds the full-text index of the names if the database was
+     * created before it. This takes a while with large catalogs, so
+     * it is meant to run on a worker thread, with a DBManager of its
+     * own. Other DBManagers use the index once it is built.
+     *
+     * @return true if the index can be used
+     */
+    bool compile_missing_name_search();
+
     /**
      * Updates the all_catalog_view so that it includes all known
      * catalogs.
@@ -572,6 +612,7 @@ class DBManager
     QSqlQuery m_q_obj_by_trixel_no_nulls;
     QSqlQuery m_q_obj_by_name;
     QSqlQuery m_q_obj_by_name_exact;
+    QSqlQuery m_q_obj_by_name_prefix;
     QSqlQuery m_q_obj_by_lim;
     QSqlQuery m_q_obj_by_maglim;
     QSqlQuery m_q_obj_by_maglim_and_type;
@@ -597,6 +638,11 @@ class DBManager
      */
     int m_db_version = -1;
 
+    /**
+     * Wether the full-text index of the names is available.
+     */
+    bool m_name_search = false;
+
     /**
      * A simple mutex to be locked when using prepared statements,
      * that are stored in the class.
@@ -629,6 +675,33 @@ class DBManager
      */
     std::tuple<int, int, bool> get_db_meta();
 
+    /**
+     * (Re)creates the full-text index of the names in the master
+     * catalog.
+     *
+     * @return true in case of success, false if sqlite lacks full-text
+     * search or in case of an error
+     */
+    bool compile_name_search();
+
+    /**
+     * @return whether the database has the full-text index of the names
+     */
+    bool name_search_exists();
+
+    /**
+     * Prepares the ranked prefix search on the full-text index.
+     *
+     * @return true if the index can be used
+     */
+    bool prepare_name_search();
+
+    /**
+     * Ranked prefix search, \sa find_objects_by_prefix. `m_mutex`
+     * has to be locked.
+     */
+    CatalogObjectList _find_objects_by_prefix(const QString &prefix, const int limit);
+
     /**
      * Gets a vector of catalog ids of catalogs. If \p include_disabled is
      * `true`, disabled catalogs will be included.
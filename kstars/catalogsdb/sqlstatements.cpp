@@ -299,6 +299,17 @@ const QString create_master_name_index =
     "COLLATE NOCASE ASC, long_name COLLATE NOCASE ASC, "
     "magnitude ASC)";
 
+// Full-text index of the names in the master catalog, its content is read from master.
+// Requires the fts5 extension of sqlite, the name search falls back to LIKE without it.
+const QString drop_master_name_search = "DROP TABLE IF EXISTS master_name_search";
+const QString create_master_name_search =
+    "CREATE VIRTUAL TABLE master_name_search USING fts5(name, long_name, "
+    "catalog_identifier, content='master', prefix='1 2 3')";
+const QString fill_master_name_search =
+    "INSERT INTO master_name_search(master_name_search) VALUES('rebuild')";
+const QString exists_master_name_search = "SELECT name FROM sqlite_master WHERE "
+        "type='table' AND name='master_name_search';";
+
 const QString get_first_catalog = "SELECT id, name, precedence, author, source, "
                                   "description, mut, enabled, version, color, license, "
                                   "maintainer, timestamp FROM catalogs LIMIT 1";
@@ -355,7 +366,17 @@ const QString _dso_by_name =
 
 const QString _dso_by_name_exact = "SELECT %1 FROM master WHERE name = :name LIMIT 1";
 
+// Names starting with the searched text first, shortest completion first, then by
+// relevance
+const QString _dso_by_name_prefix =
+    "SELECT %1 FROM master INNER JOIN (SELECT rowid AS match_id, rank AS match_rank "
+    "FROM master_name_search WHERE master_name_search MATCH :match) ON master.rowid = "
+    "match_id ORDER BY name LIKE :name || \"%\" DESC, CASE WHEN name LIKE :name || "
+    "\"%\" THEN LENGTH(name) END, match_rank, %2 LIMIT :limit";
+
 const QString dso_by_name       = QString(_dso_by_name).arg(object_fields).arg(mag_asc);
+const QString dso_by_name_prefix =
+    QString(_dso_by_name_prefix).arg(object_fields).arg(mag_asc);
 const QString dso_by_name_exact = QString(_dso_by_name_exact).arg(object_fields);
 
 inline const QString dso_by_name_and_catalog(const int id)
@@ -368,8 +389,8 @@ inline const QString dso_by_name_and_catalog(const int id)
            .arg(mag_asc);
 }
 
-const QString _dso_by_wildcard = "SELECT %1 FROM master WHERE name LIKE :wildcard LIMIT "
-                                 ":limit ORDER BY CAST(name AS INTEGER)";
+const QString _dso_by_wildcard = "SELECT %1 FROM master WHERE name LIKE :wildcard "
+                                 "ORDER BY CAST(name AS INTEGER) LIMIT :limit";
 
 inline const QString dso_by_wildcard()
 {
@@ -310,7 +310,8 @@ void FindDialog::filterList()
     //        return; // Ignore this search since the search text has changed
     //    }
 
-    auto objs = m_dbManager.find_objects_by_name(SearchText, 10);
+    // Every keystroke searches, so use the name index rather than a substring search
+    auto objs = m_dbManager.find_objects_by_prefix(SearchText, 10);
 
     bool exactMatchExists = objs.size() > 0 ? (QString::compare(objs.front().name(), SearchText,
                             Qt::CaseInsensitive) == 0) : false;
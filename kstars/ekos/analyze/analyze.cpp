@@ -5,6 +5,7 @@
 */
 
 #include "analyze.h"
+#include "analyzelog.h"
 
 #include <knotification.h>
 #include <QDateTime>
@@ -822,12 +823,12 @@ void Analyze::addGuideStats(double raDrift, double decDrift, int raPulse, int de
                 (time - lastCaptureRmsTime > MAX_GUIDE_STATS_GAP))
         {
             // this is the first sample in a series with a gap behind us.
-            statsPlot->graph(CAPTURE_RMS_GRAPH)->addData(lastCaptureRmsTime + .0001, qQNaN());
-            statsPlot->graph(CAPTURE_RMS_GRAPH)->addData(time - .0001, qQNaN());
+            captureRmsSeries.append(lastCaptureRmsTime + .0001, {qQNaN()});
+            captureRmsSeries.append(time - .0001, {qQNaN()});
             captureRms->resetFilter();
         }
         const double rmsC = captureRms->newSample(raDrift, decDrift);
-        statsPlot->graph(CAPTURE_RMS_GRAPH)->addData(time, rmsC);
+        captureRmsSeries.append(time, {rmsC});
         lastCaptureRmsTime = time;
     }
 
@@ -839,12 +840,8 @@ void Analyze::addGuideStatsInternal(double raDrift, double decDrift, double raPu
                                     double numStars, double skyBackground,
                                     double drift, double rms, double time)
 {
-    statsPlot->graph(RA_GRAPH)->addData(time, raDrift);
-    statsPlot->graph(DEC_GRAPH)->addData(time, decDrift);
-    statsPlot->graph(RA_PULSE_GRAPH)->addData(time, raPulse);
-    statsPlot->graph(DEC_PULSE_GRAPH)->addData(time, decPulse);
-    statsPlot->graph(DRIFT_GRAPH)->addData(time, drift);
-    statsPlot->graph(RMS_GRAPH)->addData(time, rms);
+    // The order of the values is that of GuideColumn.
+    guideSeries.append(time, {raDrift, decDrift, raPulse, decPulse, drift, rms, snr, numStars, skyBackground});
 
     // Set the SNR axis' maximum to 95% of the way up from the middle to the top.
     if (!qIsNaN(snr))
@@ -853,10 +850,6 @@ void Analyze::addGuideStatsInternal(double raDrift, double decDrift, double raPu
         skyBgMax = std::max(skyBackground, skyBgMax);
     if (!qIsNaN(numStars))
         numStarsMax = std::max(numStars, static_cast<double>(numStarsMax));
-
-    statsPlot->graph(SNR_GRAPH)->addData(time, snr);
-    statsPlot->graph(NUMSTARS_GRAPH)->addData(time, numStars);
-    statsPlot->graph(SKYBG_GRAPH)->addData(time, skyBackground);
 }
 
 void Analyze::addTemperature(double temperature, double time)
@@ -864,7 +857,7 @@ void Analyze::addTemperature(double temperature, double time)
     // The HFR corresponds to the last capture
     // If there is no temperature sensor, focus sends a large negative value.
     if (temperature > -200)
-        statsPlot->graph(TEMPERATURE_GRAPH)->addData(time, temperature);
+        temperatureSeries.append(time, {temperature});
 }
 
 void Analyze::addFocusPosition(double focusPosition, double time)
@@ -932,19 +925,40 @@ void Analyze::addMountCoords(double ra, double dec, double az,
 double Analyze::readDataFromFile(const QString &filename)
 {
     double lastTime = 10;
-    QFile inputFile(filename);
-    if (inputFile.open(QIODevice::ReadOnly))
+    // The log of the current session is still growing, it isn't worth converting.
+    AnalyzeLog analyzeLog;
+    if (!analyzeLog.read(filename, filename != logFilename))
+        return lastTime;
+
+    // Guide stats and temperatures are replayed in their place in the file,
+    // as their processing depends on the other messages (e.g. the capture RMS).
+    int guideStats = 0, temperatures = 0;
+    auto replayUntil = [&](int guideStatsEnd, int temperaturesEnd)
     {
-        QTextStream in(&inputFile);
-        while (!in.atEnd())
+        for (; guideStats < guideStatsEnd; ++guideStats)
+        {
+            const double time = analyzeLog.guideTimes[guideStats];
+            processGuideStats(time, analyzeLog.raErrors[guideStats], analyzeLog.decErrors[guideStats],
+                              analyzeLog.raPulses[guideStats], analyzeLog.decPulses[guideStats], analyzeLog.snrs[guideStats],
+                              analyzeLog.skyBgs[guideStats], analyzeLog.numStars[guideStats], true);
+            lastTime = std::max(lastTime, time);
+        }
+        for (; temperatures < temperaturesEnd; ++temperatures)
         {
-            QString line = in.readLine();
-            double time = processInputLine(line);
-            if (time > lastTime)
-                lastTime = time;
+            const double time = analyzeLog.temperatureTimes[temperatures];
+            processTemperature(time, analyzeLog.temperatures[temperatures], true);
+            lastTime = std::max(lastTime, time);
         }
-        inputFile.close();
+    };
+
+    for (int i = 0; i < analyzeLog.lines.size(); ++i)
+    {
+        replayUntil(analyzeLog.guideStatsBefore[i], analyzeLog.temperaturesBefore[i]);
+        const double time = processInputLine(analyzeLog.lines[i]);
+        if (time > lastTime)
+            lastTime = time;
     }
+    replayUntil(analyzeLog.guideTimes.size(), analyzeLog.temperatureTimes.size());
     return lastTime;
 }
 
@@ -1597,20 +1611,14 @@ void Analyze::displayGuideGraphics(double start, double end, double *raRMS,
                                    double *decRMS, double *totalRMS, int *numSamples)
 {
     resetGraphicsPlot();
-    auto ra = statsPlot->graph(RA_GRAPH)->data()->findBegin(start);
-    auto dec = statsPlot->graph(DEC_GRAPH)->data()->findBegin(start);
-    auto raEnd = statsPlot->graph(RA_GRAPH)->data()->findEnd(end);
-    auto decEnd = statsPlot->graph(DEC_GRAPH)->data()->findEnd(end);
+    // The full resolution samples, the stats plot may only hold part of them.
     int num = 0;
     double raSquareErrorSum = 0, decSquareErrorSum = 0;
-    while (ra != raEnd && dec != decEnd &&
-            ra->mainKey() < end && dec->mainKey() < end &&
-            ra != statsPlot->graph(RA_GRAPH)->data()->constEnd() &&
-            dec != statsPlot->graph(DEC_GRAPH)->data()->constEnd() &&
-            ra->mainKey() < end && dec->mainKey() < end)
-    {
-        const double raVal = ra->mainValue();
-        const double decVal = dec->mainValue();
+    for (int i = std::max(0, guideSeries.findBegin(start));
+            i < guideSeries.size() && guideSeries.time(i) < end; ++i)
+    {
+        const double raVal = guideSeries.value(GUIDE_RA, i);
+        const double decVal = guideSeries.value(GUIDE_DEC, i);
         graphicsPlot->graph(GUIDER_GRAPHICS)->addData(raVal, decVal);
         if (!qIsNaN(raVal) && !qIsNaN(decVal))
         {
@@ -1618,8 +1626,6 @@ void Analyze::displayGuideGraphics(double start, double end, double *raRMS,
             decSquareErrorSum += decVal * decVal;
             num++;
         }
-        ra++;
-        dec++;
     }
     if (numSamples != nullptr)
         *numSamples = num;
@@ -2041,6 +2047,7 @@ void Analyze::replot(bool adjustSlider)
     timelinePlot->yAxis->setRange(0, LAST_Y);
 
     statsPlot->xAxis->setRange(plotStart, plotStart + plotWidth);
+    plotSeries();
 
     // Rescale any automatic y-axes.
     if (statsPlot->isVisible())
@@ -2080,6 +2087,28 @@ void Analyze::replot(bool adjustSlider)
     updateStatsValues();
 }
 
+void Analyze::plotSeries()
+{
+    const QCPRange range = statsPlot->xAxis->range();
+    const int samples = guideSeries.size() + captureRmsSeries.size() + temperatureSeries.size();
+    if (range == seriesPlotRange && samples == seriesPlotSamples)
+        return;
+    seriesPlotRange = range;
+    seriesPlotSamples = samples;
+
+    const int pixels = std::max(100, statsPlot->axisRect()->width());
+    const std::pair<int, int> guideGraphs[] =
+    {
+        {RA_GRAPH, GUIDE_RA}, {DEC_GRAPH, GUIDE_DEC}, {RA_PULSE_GRAPH, GUIDE_RA_PULSE},
+        {DEC_PULSE_GRAPH, GUIDE_DEC_PULSE}, {DRIFT_GRAPH, GUIDE_DRIFT}, {RMS_GRAPH, GUIDE_RMS},
+        {SNR_GRAPH, GUIDE_SNR}, {NUMSTARS_GRAPH, GUIDE_NUMSTARS}, {SKYBG_GRAPH, GUIDE_SKYBG}
+    };
+    for (const auto &graph : guideGraphs)
+        guideSeries.plot(statsPlot->graph(graph.first), graph.second, range.lower, range.upper, pixels);
+    captureRmsSeries.plot(statsPlot->graph(CAPTURE_RMS_GRAPH), 0, range.lower, range.upper, pixels);
+    temperatureSeries.plot(statsPlot->graph(TEMPERATURE_GRAPH), 0, range.lower, range.upper, pixels);
+}
+
 void Analyze::statsYZoom(double zoomAmount)
 {
     auto axis = activeYAxis;
@@ -2141,6 +2170,24 @@ void updateStat(double time, QLineEdit *valueBox, QCPGraph *graph, Func func, bo
     else valueBox->setDisabled(true);
 }
 
+// Same as updateStat() for a column of an AnalyzeSeries.
+template<typename Func>
+void updateStat(double time, QLineEdit *valueBox, const AnalyzeSeries &series, int column, Func func)
+{
+    const int index = series.findBegin(time);
+    double timeDiffThreshold = 10000000.0;
+    if ((index >= 0) && (fabs(series.time(index) - time) < timeDiffThreshold))
+    {
+        const double foundVal = series.value(column, index);
+        valueBox->setDisabled(false);
+        if (qIsNaN(foundVal))
+            valueBox->clear();
+        else
+            valueBox->setText(func(foundVal));
+    }
+    else valueBox->setDisabled(true);
+}
+
 }  // namespace
 
 // This populates the output boxes below the stats plot with the correct statistics.
@@ -2154,16 +2201,16 @@ void Analyze::updateStatsValues()
     // that is, it keeps those values from the last exposure.
     updateStat(time, hfrOut, statsPlot->graph(HFR_GRAPH), d2Fcn, true);
     updateStat(time, eccentricityOut, statsPlot->graph(ECCENTRICITY_GRAPH), d2Fcn, true);
-    updateStat(time, skyBgOut, statsPlot->graph(SKYBG_GRAPH), d1Fcn);
-    updateStat(time, snrOut, statsPlot->graph(SNR_GRAPH), d1Fcn);
-    updateStat(time, raOut, statsPlot->graph(RA_GRAPH), d2Fcn);
-    updateStat(time, decOut, statsPlot->graph(DEC_GRAPH), d2Fcn);
-    updateStat(time, driftOut, statsPlot->graph(DRIFT_GRAPH), d2Fcn);
-    updateStat(time, rmsOut, statsPlot->graph(RMS_GRAPH), d2Fcn);
-    updateStat(time, rmsCOut, statsPlot->graph(CAPTURE_RMS_GRAPH), d2Fcn);
+    updateStat(time, skyBgOut, guideSeries, GUIDE_SKYBG, d1Fcn);
+    updateStat(time, snrOut, guideSeries, GUIDE_SNR, d1Fcn);
+    updateStat(time, raOut, guideSeries, GUIDE_RA, d2Fcn);
+    updateStat(time, decOut, guideSeries, GUIDE_DEC, d2Fcn);
+    updateStat(time, driftOut, guideSeries, GUIDE_DRIFT, d2Fcn);
+    updateStat(time, rmsOut, guideSeries, GUIDE_RMS, d2Fcn);
+    updateStat(time, rmsCOut, captureRmsSeries, 0, d2Fcn);
     updateStat(time, azOut, statsPlot->graph(AZ_GRAPH), d1Fcn);
     updateStat(time, altOut, statsPlot->graph(ALT_GRAPH), d2Fcn);
-    updateStat(time, temperatureOut, statsPlot->graph(TEMPERATURE_GRAPH), d2Fcn);
+    updateStat(time, temperatureOut, temperatureSeries, 0, d2Fcn);
 
     auto asFcn = [](double d) -> QString { return QString("%1\"").arg(d, 0, 'f', 0); };
     updateStat(time, targetDistanceOut, statsPlot->graph(TARGET_DISTANCE_GRAPH), asFcn, true);
@@ -2195,9 +2242,9 @@ void Analyze::updateStatsValues()
     updateStat(time, mountHaOut, statsPlot->graph(MOUNT_HA_GRAPH), haFcn);
 
     auto intFcn = [](double d) -> QString { return QString::number(d, 'f', 0); };
-    updateStat(time, numStarsOut, statsPlot->graph(NUMSTARS_GRAPH), intFcn);
-    updateStat(time, raPulseOut, statsPlot->graph(RA_PULSE_GRAPH), intFcn);
-    updateStat(time, decPulseOut, statsPlot->graph(DEC_PULSE_GRAPH), intFcn);
+    updateStat(time, numStarsOut, guideSeries, GUIDE_NUMSTARS, intFcn);
+    updateStat(time, raPulseOut, guideSeries, GUIDE_RA_PULSE, intFcn);
+    updateStat(time, decPulseOut, guideSeries, GUIDE_DEC_PULSE, intFcn);
     updateStat(time, numCaptureStarsOut, statsPlot->graph(NUM_CAPTURE_STARS_GRAPH), intFcn, true);
     updateStat(time, medianOut, statsPlot->graph(MEDIAN_GRAPH), intFcn, true);
     updateStat(time, focusPositionOut, statsPlot->graph(FOCUS_POSITION_GRAPH), intFcn);
@@ -2720,6 +2767,8 @@ void Analyze::initStatsPlot()
 
     // Didn't include QCP::iRangeDrag as it  interacts poorly with the curson logic.
     statsPlot->setInteractions(QCP::iRangeZoom);
+    // Wheel zooms change the x-axis range without going through replot().
+    connect(statsPlot->xAxis, QOverload<const QCPRange &>::of(&QCPAxis::rangeChanged), this, &Analyze::plotSeries);
 
     restoreYAxes(Options::analyzeStatsYAxis());
 }
@@ -2734,6 +2783,11 @@ void Analyze::reset()
     guiderRms->resetFilter();
     captureRms->resetFilter();
 
+    guideSeries.clear();
+    captureRmsSeries.clear();
+    temperatureSeries.clear();
+    seriesPlotSamples = -1;
+
     unhighlightTimelineItem();
 
     for (int i = 0; i < statsPlot->graphCount(); ++i)
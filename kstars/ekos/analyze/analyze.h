@@ -8,6 +8,7 @@
 #define ANALYZE_H
 
 #include <memory>
+#include "analyzeseries.h"
 #include "ekos/ekos.h"
 #include "ekos/mount/mount.h"
 #include "indi/indimount.h"
@@ -285,6 +286,8 @@ class Analyze : public QWidget, public Ui::Analyze
 
         // Plotting primatives.
         void replot(bool adjustSlider = true);
+        // Gives statsPlot the guide stats and temperatures at the resolution of its x-axis range.
+        void plotSeries();
         void zoomIn();
         void zoomOut();
         void scroll(int value);
@@ -439,6 +442,7 @@ class Analyze : public QWidget, public Ui::Analyze
         void resetTemperature();
 
         // Read and display an input .analyze file.
+        // The file is read from its binary companion, see AnalyzeLog, unless it is the current session's log.
         double readDataFromFile(const QString &filename);
         double processInputLine(const QString &line);
 
@@ -503,6 +507,20 @@ class Analyze : public QWidget, public Ui::Analyze
         // When displaying the current session it should equal analyzeStartTime.
         QDateTime displayStartTime;
 
+        // Guide stats, capture RMS and temperatures, see AnalyzeSeries.
+        // Their graphs in statsPlot only hold what plotSeries() gave them.
+        enum GuideColumn
+        {
+            GUIDE_RA, GUIDE_DEC, GUIDE_RA_PULSE, GUIDE_DEC_PULSE, GUIDE_DRIFT, GUIDE_RMS,
+            GUIDE_SNR, GUIDE_NUMSTARS, GUIDE_SKYBG, GUIDE_COLUMNS
+        };
+        AnalyzeSeries guideSeries { GUIDE_COLUMNS };
+        AnalyzeSeries captureRmsSeries;
+        AnalyzeSeries temperatureSeries;
+        // The x-axis range and number of samples last plotted by plotSeries().
+        QCPRange seriesPlotRange;
+        int seriesPlotSamples { -1 };
+
         // AddGuideStats uses RmsFilter to compute RMS values of the squared
         // RA and DEC errors, thus calculating the RMS error.
         std::unique_ptr<RmsFilter> guiderRms;
@@ -0,0 +1,276 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "analyzelog.h"
+
+#include "auxiliary/kspaths.h"
+
+#include <ekos_analyze_debug.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace
+{
+constexpr quint32 ANALYZE_LOG_MAGIC = 0x4b53414c;
+// Increment when the layout or the parsing changes, older companions are then converted again.
+constexpr qint32 ANALYZE_LOG_VERSION = 1;
+// Same limit as Analyze::processInputLine()
+constexpr double MAX_LOG_TIME = 3600 * 24 * 10;
+// Companions kept in the cache directory, the least recently written ones are removed first.
+constexpr int MAX_COMPANIONS = 50;
+
+bool logTime(const QString &text, double *time)
+{
+    bool ok;
+    *time = text.toDouble(&ok);
+    return ok && *time >= 0 && *time <= MAX_LOG_TIME;
+}
+
+// Columns are stored as raw arrays in the byte order of the machine, the companion is a local cache.
+template <typename T>
+void writeLogColumn(QDataStream &out, const QVector<T> &column)
+{
+    out << static_cast<qint32>(column.size());
+    out.writeRawData(reinterpret_cast<const char *>(column.constData()), column.size() * sizeof(T));
+}
+
+template <typename T>
+bool readLogColumn(QDataStream &in, QVector<T> &column)
+{
+    qint32 size = -1;
+    in >> size;
+    if (in.status() != QDataStream::Ok || size < 0 || size > in.device()->bytesAvailable() / qint64(sizeof(T)))
+        return false;
+    column.resize(size);
+    const int bytes = size * sizeof(T);
+    return in.readRawData(reinterpret_cast<char *>(column.data()), bytes) == bytes;
+}
+}
+
+namespace Ekos
+{
+
+bool AnalyzeLog::read(const QString &filename, bool useCompanion)
+{
+    const QFileInfo source(filename);
+    if (!source.exists())
+        return false;
+
+    const QString path = useCompanion ? companionPath(source) : QString();
+    if (useCompanion && load(path, source))
+        return true;
+
+    if (!parse(filename))
+        return false;
+
+    // Files out of time order are rare, they are parsed every time rather than cached.
+    if (useCompanion && inTimeOrder())
+    {
+        if (save(path, source))
+            pruneCompanions(QFileInfo(path).absolutePath());
+        else
+            qCDebug(KSTARS_EKOS_ANALYZE) << "Could not write the binary companion of" << filename;
+    }
+    return true;
+}
+
+bool AnalyzeLog::inTimeOrder() const
+{
+    return std::is_sorted(guideTimes.constBegin(), guideTimes.constEnd()) &&
+           std::is_sorted(temperatureTimes.constBegin(), temperatureTimes.constEnd());
+}
+
+void AnalyzeLog::clear()
+{
+    lines.clear();
+    guideStatsBefore.clear();
+    temperaturesBefore.clear();
+    guideTimes.clear();
+    raErrors.clear();
+    decErrors.clear();
+    snrs.clear();
+    skyBgs.clear();
+    raPulses.clear();
+    decPulses.clear();
+    numStars.clear();
+    temperatureTimes.clear();
+    temperatures.clear();
+}
+
+bool AnalyzeLog::parse(const QString &filename)
+{
+    clear();
+    QFile inputFile(filename);
+    if (!inputFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QTextStream in(&inputFile);
+    while (!in.atEnd())
+    {
+        const QString line = in.readLine();
+        if (line.isEmpty() || line.at(0) == QLatin1Char('#'))
+            continue;
+
+        if (line.startsWith(QLatin1String("GuideStats,")))
+        {
+            // Malformed lines would be ignored by Analyze as well.
+            parseGuideStats(line.split(QLatin1Char(',')));
+            continue;
+        }
+        if (line.startsWith(QLatin1String("Temperature,")))
+        {
+            parseTemperature(line.split(QLatin1Char(',')));
+            continue;
+        }
+
+        lines.append(line);
+        guideStatsBefore.append(guideTimes.size());
+        temperaturesBefore.append(temperatureTimes.size());
+    }
+    return true;
+}
+
+bool AnalyzeLog::parseGuideStats(const QStringList &list)
+{
+    if (list.size() != 9)
+        return false;
+
+    double time;
+    bool ok[7];
+    if (!logTime(list[1], &time))
+        return false;
+    const double ra = list[2].toDouble(&ok[0]);
+    const double dec = list[3].toDouble(&ok[1]);
+    const int raPulse = list[4].toInt(&ok[2]);
+    const int decPulse = list[5].toInt(&ok[3]);
+    const double snr = list[6].toDouble(&ok[4]);
+    const double skyBg = list[7].toDouble(&ok[5]);
+    const int stars = list[8].toInt(&ok[6]);
+    if (std::find(ok, ok + 7, false) != ok + 7)
+        return false;
+
+    guideTimes.append(time);
+    raErrors.append(ra);
+    decErrors.append(dec);
+    raPulses.append(raPulse);
+    decPulses.append(decPulse);
+    snrs.append(snr);
+    skyBgs.append(skyBg);
+    numStars.append(stars);
+    return true;
+}
+
+bool AnalyzeLog::parseTemperature(const QStringList &list)
+{
+    if (list.size() != 3)
+        return false;
+
+    double time;
+    bool ok;
+    if (!logTime(list[1], &time))
+        return false;
+    const double temperature = list[2].toDouble(&ok);
+    if (!ok)
+        return false;
+
+    temperatureTimes.append(time);
+    temperatures.append(temperature);
+    return true;
+}
+
+QString AnalyzeLog::companionPath(const QFileInfo &source)
+{
+    // The .analyze files may be in a read-only or shared directory, companions go to the cache.
+    const QByteArray hash = QCryptographicHash::hash(source.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QDir(KSPaths::writableLocation(QStandardPaths::CacheLocation))
+           .filePath(QString("analyze/%1.analyzeb").arg(QString::fromLatin1(hash)));
+}
+
+void AnalyzeLog::pruneCompanions(const QString &directory)
+{
+    const QFileInfoList companions = QDir(directory).entryInfoList(QStringList() << "*.analyzeb", QDir::Files,
+                                     QDir::Time);
+    for (int i = MAX_COMPANIONS; i < companions.size(); ++i)
+        QFile::remove(companions[i].absoluteFilePath());
+}
+
+bool AnalyzeLog::load(const QString &path, const QFileInfo &source)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint64 size = -1, modified = -1;
+    in >> magic >> version >> size >> modified;
+    if (magic != ANALYZE_LOG_MAGIC || version != ANALYZE_LOG_VERSION || size != source.size() ||
+            modified != source.lastModified().toMSecsSinceEpoch())
+        return false;
+
+    clear();
+    in >> lines;
+    const bool ok = in.status() == QDataStream::Ok &&
+                    readLogColumn(in, guideStatsBefore) && readLogColumn(in, temperaturesBefore) &&
+                    readLogColumn(in, guideTimes) && readLogColumn(in, raErrors) && readLogColumn(in, decErrors) &&
+                    readLogColumn(in, raPulses) && readLogColumn(in, decPulses) && readLogColumn(in, snrs) &&
+                    readLogColumn(in, skyBgs) && readLogColumn(in, numStars) &&
+                    readLogColumn(in, temperatureTimes) && readLogColumn(in, temperatures);
+
+    // A truncated or inconsistent companion is converted again.
+    const int guideStats = guideTimes.size();
+    if (!ok || !inTimeOrder() || guideStatsBefore.size() != lines.size() || temperaturesBefore.size() != lines.size() ||
+            raErrors.size() != guideStats || decErrors.size() != guideStats || raPulses.size() != guideStats ||
+            decPulses.size() != guideStats || snrs.size() != guideStats || skyBgs.size() != guideStats ||
+            numStars.size() != guideStats || temperatures.size() != temperatureTimes.size() ||
+            (!lines.isEmpty() && (guideStatsBefore.last() > quint32(guideStats) ||
+                                  temperaturesBefore.last() > quint32(temperatureTimes.size()))))
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool AnalyzeLog::save(const QString &path, const QFileInfo &source) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << ANALYZE_LOG_MAGIC << ANALYZE_LOG_VERSION << source.size()
+        << static_cast<qint64>(source.lastModified().toMSecsSinceEpoch());
+    out << lines;
+    writeLogColumn(out, guideStatsBefore);
+    writeLogColumn(out, temperaturesBefore);
+    writeLogColumn(out, guideTimes);
+    writeLogColumn(out, raErrors);
+    writeLogColumn(out, decErrors);
+    writeLogColumn(out, raPulses);
+    writeLogColumn(out, decPulses);
+    writeLogColumn(out, snrs);
+    writeLogColumn(out, skyBgs);
+    writeLogColumn(out, numStars);
+    writeLogColumn(out, temperatureTimes);
+    writeLogColumn(out, temperatures);
+
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+}
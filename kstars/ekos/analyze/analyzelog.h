@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QStringList>
+#include <QVector>
+
+class QFileInfo;
+class TestAnalyzeLog;
+
+namespace Ekos
+{
+
+/**
+ * @class AnalyzeLog
+ * @short The contents of a .analyze file, read from a binary companion file when possible.
+ *
+ * Guide stats and temperatures make up almost all of the lines of a .analyze file. They are kept
+ * as columns, the other (rare) lines are kept as text for Analyze::processInputLine(), all in the
+ * order of the file. The first time a file is read its contents are also written in binary to the
+ * cache directory, so that the next reads only need to copy the columns instead of parsing text.
+ * Only files whose guide stats and temperatures are in time order are converted.
+ * The companion is ignored once the .analyze file is modified, and the least recently written
+ * companions are removed once there are too many of them.
+ *
+ * @author KStars Developers
+ */
+class AnalyzeLog
+{
+    public:
+        /**
+         * @short Read a .analyze file.
+         * @param useCompanion Read and write the binary companion. Files still being written shouldn't use it.
+         * @return false if the file couldn't be read.
+         */
+        bool read(const QString &filename, bool useCompanion = true);
+
+        // Lines other than guide stats and temperatures, in the order of the file.
+        QStringList lines;
+        // For each line, the number of guide stats and temperatures that come before it in the file.
+        QVector<quint32> guideStatsBefore, temperaturesBefore;
+
+        // Guide stats
+        QVector<double> guideTimes;
+        QVector<float> raErrors, decErrors, snrs, skyBgs;
+        QVector<qint32> raPulses, decPulses, numStars;
+
+        // Temperatures
+        QVector<double> temperatureTimes;
+        QVector<float> temperatures;
+
+    private:
+        void clear();
+        bool parse(const QString &filename);
+        bool parseGuideStats(const QStringList &list);
+        bool parseTemperature(const QStringList &list);
+        bool load(const QString &path, const QFileInfo &source);
+        bool save(const QString &path, const QFileInfo &source) const;
+        bool inTimeOrder() const;
+        static QString companionPath(const QFileInfo &source);
+        static void pruneCompanions(const QString &directory);
+
+        friend TestAnalyzeLog;
+};
+
+}
@@ -0,0 +1,116 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "analyzeseries.h"
+
+#include "qcustomplot.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Append the samples from..to-1 to data, keeping the minimum and maximum of each bucket of the given width.
+// NaN values mark gaps in the series and are always kept.
+void downsampleSeries(const QVector<double> &times, const QVector<float> &values, int from, int to,
+                      double width, QVector<QCPGraphData> &data)
+{
+    int i = from;
+    while (i < to)
+    {
+        if (qIsNaN(values[i]))
+        {
+            data.append(QCPGraphData(times[i], qQNaN()));
+            i++;
+            continue;
+        }
+
+        // Buckets are aligned on multiples of their width, so they don't change as the view scrolls.
+        const double bucketEnd = width > 0 ? (std::floor(times[i] / width) + 1) * width : times[i];
+        int minIndex = i, maxIndex = i, j = i + 1;
+        for (; j < to && times[j] < bucketEnd && !qIsNaN(values[j]); j++)
+        {
+            if (values[j] < values[minIndex])
+                minIndex = j;
+            if (values[j] > values[maxIndex])
+                maxIndex = j;
+        }
+
+        const int firstIndex = std::min(minIndex, maxIndex), lastIndex = std::max(minIndex, maxIndex);
+        data.append(QCPGraphData(times[firstIndex], values[firstIndex]));
+        if (lastIndex != firstIndex)
+            data.append(QCPGraphData(times[lastIndex], values[lastIndex]));
+        i = j;
+    }
+}
+}
+
+namespace Ekos
+{
+
+AnalyzeSeries::AnalyzeSeries(int columns) : m_Values(columns)
+{
+}
+
+void AnalyzeSeries::append(double time, std::initializer_list<double> values)
+{
+    // Samples nearly always come in order, the searches below rely on it.
+    if (m_Times.isEmpty() || time >= m_Times.last())
+    {
+        m_Times.append(time);
+        int column = 0;
+        for (double value : values)
+            m_Values[column++].append(value);
+        return;
+    }
+
+    const int index = std::upper_bound(m_Times.constBegin(), m_Times.constEnd(), time) - m_Times.constBegin();
+    m_Times.insert(index, time);
+    int column = 0;
+    for (double value : values)
+        m_Values[column++].insert(index, value);
+}
+
+void AnalyzeSeries::clear()
+{
+    m_Times.clear();
+    for (auto &column : m_Values)
+        column.clear();
+}
+
+int AnalyzeSeries::findBegin(double time) const
+{
+    if (m_Times.isEmpty())
+        return -1;
+    const int index = std::lower_bound(m_Times.constBegin(), m_Times.constEnd(), time) - m_Times.constBegin();
+    return std::max(0, index - 1);
+}
+
+void AnalyzeSeries::plot(QCPGraph *graph, int column, double start, double end, int pixels) const
+{
+    graph->data()->set(downsample(column, start, end, pixels), true);
+}
+
+QVector<QCPGraphData> AnalyzeSeries::downsample(int column, double start, double end, int pixels) const
+{
+    QVector<QCPGraphData> data;
+    if (!m_Times.isEmpty())
+    {
+        pixels = std::max(1, pixels);
+        const int first = std::lower_bound(m_Times.constBegin(), m_Times.constEnd(), start) - m_Times.constBegin();
+        const int last = std::upper_bound(m_Times.constBegin(), m_Times.constEnd(), end) - m_Times.constBegin();
+        // Outside of the window, the whole series is reduced to the resolution of a full width plot.
+        const double coarseWidth = std::max(end - start, m_Times.last() - m_Times.first()) / pixels;
+
+        data.reserve(std::min(m_Times.size(), 8 * pixels));
+        downsampleSeries(m_Times, m_Values[column], 0, first, coarseWidth, data);
+        downsampleSeries(m_Times, m_Values[column], first, last, (end - start) / pixels, data);
+        downsampleSeries(m_Times, m_Values[column], last, m_Times.size(), coarseWidth, data);
+    }
+    return data;
+}
+
+}
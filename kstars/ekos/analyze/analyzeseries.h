@@ -0,0 +1,75 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QVector>
+
+#include <initializer_list>
+
+class QCPGraph;
+class QCPGraphData;
+
+namespace Ekos
+{
+
+/**
+ * @class AnalyzeSeries
+ * @short Compact storage for the long, densely sampled series of the Analyze stats plot.
+ *
+ * Guide stats and temperatures arrive every few seconds, so a multi-night session holds millions
+ * of points. They are kept here as columns sharing one time axis, values in single precision,
+ * and only what can be seen at the resolution of the plot is handed to QCustomPlot: every sample
+ * in the visible window when zoomed in, and the minimum and maximum of each pixel wide bucket
+ * otherwise. Extremes are kept everywhere, so automatic y-axis ranges don't change.
+ *
+ * Times are seconds since the start of the log. Samples are kept in time order, a sample older than
+ * the last one, e.g. from a log whose lines are out of order, is inserted in its place.
+ *
+ * @author KStars Developers
+ */
+class AnalyzeSeries
+{
+    public:
+        explicit AnalyzeSeries(int columns = 1);
+
+        // Add a sample, with one value per column.
+        void append(double time, std::initializer_list<double> values);
+        void clear();
+
+        int size() const
+        {
+            return m_Times.size();
+        }
+        double time(int index) const
+        {
+            return m_Times[index];
+        }
+        double value(int column, int index) const
+        {
+            return m_Values[column][index];
+        }
+
+        // Index of the last sample before time, or of the first sample if there is none,
+        // as QCPDataContainer::findBegin(). -1 if the series is empty.
+        int findBegin(double time) const;
+
+        /**
+         * @short Replace the data of graph with a column, at full resolution between start and end.
+         * @param pixels Width of the window on screen. Data are reduced to about 2 points per pixel
+         * inside the window, and to the same number of points for the whole series outside of it.
+         */
+        void plot(QCPGraph *graph, int column, double start, double end, int pixels) const;
+
+        // The points plot() hands to the graph, in time order.
+        QVector<QCPGraphData> downsample(int column, double start, double end, int pixels) const;
+
+    private:
+        QVector<double> m_Times;
+        QVector<QVector<float>> m_Values;
+};
+
+}
@@ -547,8 +547,15 @@ void DarkLibrary::updateProperty(INDI::Property prop)
     }
 
     uint32_t totalElements = m_CurrentDarkFrame->channels() * m_CurrentDarkFrame->samplesPerChannel();
-    if (totalElements != m_DarkMasterBuffer.size())
-        m_DarkMasterBuffer.assign(totalElements, 0);
+    if (totalElements != m_MasterCombiner.samples())
+    {
+        QString darksPath = QDir(KSPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("darks");
+        if (!m_MasterCombiner.begin(totalElements, darksPath))
+        {
+            m_FileLabel->setText(i18n("Failed to create dark frames scratch file: %1", m_MasterCombiner.errorString()));
+            return;
+        }
+    }
 
     aggregate(m_CurrentDarkFrame);
     darkProgress->setValue(darkProgress->value() + 1);
@@ -1296,8 +1303,8 @@ template <typename T>
 void DarkLibrary::aggregateInternal(const QSharedPointer<FITSData> &data)
 {
     T const *darkBuffer  = reinterpret_cast<T const*>(data->getImageBuffer());
-    for (uint32_t i = 0; i < m_DarkMasterBuffer.size(); i++)
-        m_DarkMasterBuffer[i] += darkBuffer[i];
+    if (!m_MasterCombiner.addFrame(darkBuffer))
+        m_FileLabel->setText(i18n("Failed to store dark frame: %1", m_MasterCombiner.errorString()));
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -1305,61 +1312,70 @@ void DarkLibrary::aggregateInternal(const QSharedPointer<FITSData> &data)
 ///////////////////////////////////////////////////////////////////////////////////////
 void DarkLibrary::generateMasterFrame(const QSharedPointer<FITSData> &data, const QJsonObject &metadata)
 {
+    bool combined = false;
     switch (data->dataType())
     {
         case TBYTE:
-            generateMasterFrameInternal<uint8_t>(data, metadata);
+            combined = generateMasterFrameInternal<uint8_t>(data, metadata);
             break;
 
         case TSHORT:
-            generateMasterFrameInternal<int16_t>(data, metadata);
+            combined = generateMasterFrameInternal<int16_t>(data, metadata);
             break;
 
         case TUSHORT:
-            generateMasterFrameInternal<uint16_t>(data, metadata);
+            combined = generateMasterFrameInternal<uint16_t>(data, metadata);
             break;
 
         case TLONG:
-            generateMasterFrameInternal<int32_t>(data, metadata);
+            combined = generateMasterFrameInternal<int32_t>(data, metadata);
             break;
 
         case TULONG:
-            generateMasterFrameInternal<uint32_t>(data, metadata);
+            combined = generateMasterFrameInternal<uint32_t>(data, metadata);
             break;
 
         case TFLOAT:
-            generateMasterFrameInternal<float>(data, metadata);
+            combined = generateMasterFrameInternal<float>(data, metadata);
             break;
 
         case TLONGLONG:
-            generateMasterFrameInternal<int64_t>(data, metadata);
+            combined = generateMasterFrameInternal<int64_t>(data, metadata);
             break;
 
         case TDOUBLE:
-            generateMasterFrameInternal<double>(data, metadata);
+            combined = generateMasterFrameInternal<double>(data, metadata);
             break;
 
         default:
+            m_FileLabel->setText(i18n("Failed to combine dark frames: unsupported data type."));
             break;
     }
 
-    emit newImage(data);
-    // Reset Master Buffer
-    m_DarkMasterBuffer.assign(m_DarkMasterBuffer.size(), 0);
+    // Drop the frames, the next job starts a new stack
+    m_MasterCombiner.clear();
+
+    // The buffer doesn't hold a master frame, the reason is already shown
+    if (!combined)
+        return;
 
+    emit newImage(data);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////
-template <typename T>  void DarkLibrary::generateMasterFrameInternal(const QSharedPointer<FITSData> &data,
+template <typename T>  bool DarkLibrary::generateMasterFrameInternal(const QSharedPointer<FITSData> &data,
         const QJsonObject &metadata)
 {
     T *writableBuffer = reinterpret_cast<T *>(data->getWritableImageBuffer());
-    const uint32_t count = metadata["count"].toInt();
-    // Average the values
-    for (uint32_t i = 0; i < m_DarkMasterBuffer.size(); i++)
-        writableBuffer[i] = m_DarkMasterBuffer[i] / count;
+    // Combine the frames of the job with the selected algorithm, the defect map is then built from this master
+    m_MasterCombiner.setMethod(static_cast<FrameCombiner::CombineMethod>(combinAlgorithmCombo->currentIndex()));
+    if (!m_MasterCombiner.combine(writableBuffer))
+    {
+        m_FileLabel->setText(i18n("Failed to combine dark frames: %1", m_MasterCombiner.errorString()));
+        return false;
+    }
 
     QString ts = QDateTime::currentDateTime().toString("yyyy-MM-ddThh-mm-ss");
     QString path = QDir(KSPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("darks/darkframe_" + ts +
@@ -1369,7 +1385,7 @@ template <typename T>  void DarkLibrary::generateMasterFrameInternal(const QShar
     if (!data->saveImage(path))
     {
         m_FileLabel->setText(i18n("Failed to save master frame: %1", data->getLastError()));
-        return;
+        return true;
     }
 
     auto memoryMB = KSUtils::getAvailableRAM() / 1e6;
@@ -1391,6 +1407,7 @@ template <typename T>  void DarkLibrary::generateMasterFrameInternal(const QShar
     m_DarkFramesDatabaseList.append(map);
     m_FileLabel->setText(i18n("Master Dark saved to %1", path));
     KStarsData::Instance()->userdb()->AddDarkFrame(map);
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
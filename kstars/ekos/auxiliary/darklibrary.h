@@ -10,6 +10,7 @@
 #include "indi/indidustcap.h"
 #include "darkview.h"
 #include "defectmap.h"
+#include "framecombiner.h"
 #include "ekos/ekos.h"
 
 #include <QDialog>
@@ -33,8 +34,9 @@ class SequenceJob;
  *
  * Dark Frames:
  *
- * The user can generate dark frames from an average combination of the camera dark frames. By default, 5 dark frames
- * are captured to merged into a single master frame. Frame duration, binning, and temperature are all configurable.
+ * The user can generate dark frames from an average, median, sigma clipped or winsorized combination of the camera dark
+ * frames. The robust methods reject cosmic rays and other transient outliers before they reach the master frame and the
+ * defect map built from it. By default, 5 dark frames are captured to merged into a single master frame. Frame duration, binning, and temperature are all configurable.
  * If the user select "Dark" in any of the Ekos module, Dark Library can be queried if a suitable dark frame exists given
  * the current camera settings (binning, temperature..etc). If a suitable frame exists, it is loaded up and send to /class DarkProcessor
  * class along with the light frame to perform subtraction or defect map corrections.
@@ -176,8 +178,9 @@ protected:
          * @param data last used data. This is not used for reading, but to simply apply the algorithm to the FITSData buffer
          * and then save it to disk.
          * @param metadata information on frame to help in the stacking process.
+         * @return true if the frames were combined into the buffer of data, false if combining them failed.
          */
-        template <typename T>  void generateMasterFrameInternal(const QSharedPointer<FITSData> &data, const QJsonObject &metadata);
+        template <typename T>  bool generateMasterFrameInternal(const QSharedPointer<FITSData> &data, const QJsonObject &metadata);
 
         /**
          * @brief aggregateHelper Calls tempelated aggregate function with the appropiate data type.
@@ -289,7 +292,8 @@ protected:
         QSqlTableModel *darkFramesModel = nullptr;
         QSortFilterProxyModel *sortFilter = nullptr;
 
-        std::vector<uint32_t> m_DarkMasterBuffer;
+        // Frames of the dark job in progress, combined into the master frame once all are received
+        FrameCombiner m_MasterCombiner;
         uint32_t m_DarkImagesCounter {0};
         bool m_RememberFITSViewer {true};
         bool m_RememberSummaryView {true};
@@ -0,0 +1,241 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "framecombiner.h"
+
+#include <QDir>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <atomic>
+
+namespace
+{
+// Smallest tile, below this the reads get too small to be efficient
+constexpr qint64 MIN_TILE_SAMPLES = 4096;
+// Standard deviation of normally distributed data from its median absolute deviation
+constexpr double MAD_TO_SIGMA = 1.4826;
+
+double combinerMean(const float *values, int count)
+{
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += values[i];
+    return sum / count;
+}
+
+double combinerStandardDeviation(const float *values, int count)
+{
+    const double mean = combinerMean(values, count);
+    double sum = 0;
+    for (int i = 0; i < count; i++)
+        sum += (values[i] - mean) * (values[i] - mean);
+    return std::sqrt(sum / count);
+}
+
+// Reorders the values
+double combinerMedian(float *values, int count)
+{
+    const int middle = count / 2;
+    std::nth_element(values, values + middle, values + count);
+    if (count % 2)
+        return values[middle];
+
+    // The lower middle value is the largest of the lower half
+    return 0.5 * (values[middle] + *std::max_element(values, values + middle));
+}
+
+// Robust estimate of the standard deviation from the median absolute deviation. A single outlier inflates the
+// plain standard deviation so much on small stacks that it is never rejected.
+double combinerSigma(const float *values, int count, double median, float *scratch)
+{
+    for (int i = 0; i < count; i++)
+        scratch[i] = std::fabs(values[i] - median);
+
+    const double mad = combinerMedian(scratch, count);
+    if (mad > 0)
+        return MAD_TO_SIGMA * mad;
+
+    // More than half of the values are identical (e.g. quantized bias frames)
+    return combinerStandardDeviation(values, count);
+}
+}
+
+namespace Ekos
+{
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+bool FrameCombiner::begin(uint32_t samples, const QString &directory)
+{
+    clear();
+
+    QDir().mkpath(directory);
+    m_File.reset(new QTemporaryFile(QDir(directory).filePath("combine_XXXXXX.tmp")));
+    if (!m_File->open())
+    {
+        m_ErrorString = m_File->errorString();
+        m_File.reset();
+        return false;
+    }
+
+    m_Samples = samples;
+    m_ErrorString.clear();
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+void FrameCombiner::clear()
+{
+    // Removes the scratch file
+    m_File.reset();
+    m_Samples = 0;
+    m_Frames = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+bool FrameCombiner::write(const float *values, uint32_t count)
+{
+    const qint64 bytes = static_cast<qint64>(count) * sizeof(float);
+    if (m_File->write(reinterpret_cast<const char *>(values), bytes) != bytes)
+    {
+        m_ErrorString = m_File->errorString();
+        return false;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+bool FrameCombiner::combineInternal(const std::function<void (uint32_t, const float *, uint32_t)> &store)
+{
+    if (!m_File || m_Frames == 0)
+        return false;
+
+    if (!m_File->flush())
+    {
+        m_ErrorString = m_File->errorString();
+        return false;
+    }
+
+    // The values of all frames for one tile per worker thread must fit in the budget
+    const qint64 threads = std::max(1, QThread::idealThreadCount());
+    const qint64 tileSamples = std::min<qint64>(m_Samples,
+                               std::max<qint64>(MIN_TILE_SAMPLES, m_MemoryBudget / (threads * m_Frames * sizeof(float))));
+
+    QVector<uint32_t> tiles;
+    for (qint64 start = 0; start < m_Samples; start += tileSamples)
+        tiles.append(start);
+
+    std::atomic<bool> success { true };
+    QtConcurrent::blockingMap(tiles, [&](uint32_t start)
+    {
+        const uint32_t count = std::min<qint64>(tileSamples, m_Samples - start);
+        const qint64 bytes = static_cast<qint64>(count) * sizeof(float);
+        std::vector<float> stack(static_cast<size_t>(count) * m_Frames);
+
+        {
+            QMutexLocker locker(&m_ReadMutex);
+            for (uint32_t frame = 0; frame < m_Frames && success; frame++)
+            {
+                if (!m_File->seek((static_cast<qint64>(frame) * m_Samples + start) * sizeof(float)) ||
+                        m_File->read(reinterpret_cast<char *>(stack.data() + static_cast<size_t>(frame) * count), bytes) != bytes)
+                {
+                    m_ErrorString = m_File->errorString();
+                    success = false;
+                }
+            }
+        }
+        if (!success)
+            return;
+
+        std::vector<float> values(m_Frames), scratch(m_Frames), result(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            for (uint32_t frame = 0; frame < m_Frames; frame++)
+                values[frame] = stack[static_cast<size_t>(frame) * count + i];
+            result[i] = combinePixel(values.data(), scratch.data());
+        }
+
+        store(start, result.data(), count);
+    });
+
+    return success;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+float FrameCombiner::combinePixel(float *values, float *scratch) const
+{
+    int count = m_Frames;
+
+    switch (m_Method)
+    {
+        case COMBINE_AVERAGE:
+            break;
+
+        case COMBINE_MEDIAN:
+            return combinerMedian(values, count);
+
+        case COMBINE_SIGMA_CLIP:
+            // Reject the values too far from the median until none is left to reject, then average the others
+            for (int iteration = 0; iteration < m_Iterations && count > 2; iteration++)
+            {
+                const double median = combinerMedian(values, count);
+                const double sigma = combinerSigma(values, count, median, scratch);
+                if (sigma <= 0)
+                    break;
+
+                int kept = 0;
+                for (int i = 0; i < count; i++)
+                {
+                    if (std::fabs(values[i] - median) <= m_Sigma * sigma)
+                        values[kept++] = values[i];
+                }
+
+                if (kept == count || kept == 0)
+                    break;
+                count = kept;
+            }
+            break;
+
+        case COMBINE_WINSORIZED:
+            // Clamp the values too far from the median until none is left to clamp, then average all of them
+            for (int iteration = 0; iteration < m_Iterations && count > 2; iteration++)
+            {
+                const double median = combinerMedian(values, count);
+                const double sigma = combinerSigma(values, count, median, scratch);
+                if (sigma <= 0)
+                    break;
+
+                const float low = median - m_Sigma * sigma, high = median + m_Sigma * sigma;
+                bool clamped = false;
+                for (int i = 0; i < count; i++)
+                {
+                    if (values[i] < low || values[i] > high)
+                    {
+                        values[i] = std::min(std::max(values[i], low), high);
+                        clamped = true;
+                    }
+                }
+
+                if (!clamped)
+                    break;
+            }
+            break;
+    }
+
+    return combinerMean(values, count);
+}
+
+}
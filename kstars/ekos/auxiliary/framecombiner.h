@@ -0,0 +1,180 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Ekos
+{
+
+/**
+ * @brief The FrameCombiner class combines a stack of frames into a master frame in bounded memory.
+ *
+ * Frames are converted to float and appended to a scratch file as they arrive, so the number of frames is not
+ * limited by the available RAM. When the master is requested, the image is split into tiles small enough for the
+ * values of all frames for one tile per worker thread to fit in the memory budget. Tiles are read back and combined
+ * in parallel, each pixel being combined across all the frames with the selected method. Robust methods reject
+ * outliers such as cosmic rays, satellite trails or readout glitches that would otherwise leak into a plain average.
+ *
+ * Values are stored as float, which is exact for 8 and 16 bit data.
+ *
+ * @author KStars Developers
+ */
+class FrameCombiner
+{
+    public:
+        typedef enum
+        {
+            COMBINE_AVERAGE,
+            COMBINE_MEDIAN,
+            COMBINE_SIGMA_CLIP,
+            COMBINE_WINSORIZED
+        } CombineMethod;
+
+        FrameCombiner() = default;
+
+        /**
+         * @brief begin Start a new stack, dropping the current one.
+         * @param samples Number of samples in each frame (all channels).
+         * @param directory Where to create the scratch file. Avoid RAM backed directories such as /tmp on some systems.
+         * @return True if the scratch file was created.
+         */
+        bool begin(uint32_t samples, const QString &directory);
+
+        /**
+         * @brief clear Drop the stack and remove the scratch file.
+         */
+        void clear();
+
+        /**
+         * @brief addFrame Append a frame to the stack.
+         * @param buffer Frame data, with the number of samples passed to begin().
+         * @return True if the frame was stored.
+         */
+        template <typename T>
+        bool addFrame(T const *buffer)
+        {
+            if (!m_File || !m_File->seek(static_cast<qint64>(m_Frames) * m_Samples * sizeof(float)))
+                return false;
+
+            std::vector<float> chunk(std::min(m_Samples, WRITE_CHUNK_SAMPLES));
+            for (uint32_t start = 0; start < m_Samples; start += chunk.size())
+            {
+                const uint32_t count = std::min<uint32_t>(chunk.size(), m_Samples - start);
+                for (uint32_t i = 0; i < count; i++)
+                    chunk[i] = static_cast<float>(buffer[start + i]);
+                if (!write(chunk.data(), count))
+                    return false;
+            }
+
+            m_Frames++;
+            return true;
+        }
+
+        /**
+         * @brief combine Combine all the frames of the stack.
+         * @param output Buffer receiving the master frame, with the number of samples passed to begin().
+         * Integer results are rounded and clamped to the range of T.
+         * @return True on success.
+         */
+        template <typename T>
+        bool combine(T *output)
+        {
+            return combineInternal([output](uint32_t offset, const float *values, uint32_t count)
+            {
+                for (uint32_t i = 0; i < count; i++)
+                    output[offset + i] = convert<T>(values[i]);
+            });
+        }
+
+        void setMethod(CombineMethod method)
+        {
+            m_Method = method;
+        }
+        CombineMethod method() const
+        {
+            return m_Method;
+        }
+
+        /**
+         * @brief setSigma Set the rejection (sigma clipping) or clamping (winsorizing) bounds, in standard deviations
+         * from the median. The standard deviation is estimated from the median absolute deviation.
+         */
+        void setSigma(double sigma)
+        {
+            m_Sigma = sigma;
+        }
+        void setIterations(int iterations)
+        {
+            m_Iterations = iterations;
+        }
+
+        /**
+         * @brief setMemoryBudget Set the maximum memory used to hold the tiles being combined, in bytes.
+         */
+        void setMemoryBudget(qint64 bytes)
+        {
+            m_MemoryBudget = bytes;
+        }
+
+        uint32_t samples() const
+        {
+            return m_Samples;
+        }
+        uint32_t frames() const
+        {
+            return m_Frames;
+        }
+        const QString &errorString() const
+        {
+            return m_ErrorString;
+        }
+
+    private:
+        bool write(const float *values, uint32_t count);
+        bool combineInternal(const std::function<void(uint32_t, const float *, uint32_t)> &store);
+        // Combine the values of one pixel, scratch must have room for as many values
+        float combinePixel(float *values, float *scratch) const;
+
+        template <typename T>
+        static T convert(float value)
+        {
+            if (std::is_integral<T>::value)
+            {
+                const double rounded = std::round(static_cast<double>(value));
+                return static_cast<T>(std::min<double>(std::max<double>(rounded, std::numeric_limits<T>::lowest()),
+                                                       std::numeric_limits<T>::max()));
+            }
+            return static_cast<T>(value);
+        }
+
+        // Samples converted and written at a time when adding a frame
+        static constexpr uint32_t WRITE_CHUNK_SAMPLES {1 << 20};
+
+        std::unique_ptr<QTemporaryFile> m_File;
+        // Serializes reading the tiles back, the combination itself runs in parallel
+        QMutex m_ReadMutex;
+        uint32_t m_Samples {0};
+        uint32_t m_Frames {0};
+        CombineMethod m_Method {COMBINE_AVERAGE};
+        double m_Sigma {3.0};
+        int m_Iterations {5};
+        qint64 m_MemoryBudget {256 * 1024 * 1024};
+        QString m_ErrorString;
+};
+
+}
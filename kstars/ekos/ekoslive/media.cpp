@@ -380,7 +380,7 @@ void Media::stretch(const QSharedPointer<FITSData> &data, QImage &image, Stretch
     Stretch stretch(width, height, channels, dataType);
 
     // Compute new auto-stretch params.
-    params = stretch.computeParams(data->getImageBuffer());
+    params = stretch.computeParams(data->getImageBuffer(), data->getStatistics().median, data->getStatistics().mad);
     stretch.setParams(params);
     stretch.run(data->getImageBuffer(), &image, 1);
 }
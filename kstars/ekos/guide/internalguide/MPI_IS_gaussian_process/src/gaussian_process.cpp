@@ -42,6 +42,12 @@ GP::GP() : covFunc_(nullptr), // initialize pointer to null
     gram_matrix_(Eigen::MatrixXd()),
     alpha_(Eigen::VectorXd()),
     chol_gram_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
+    chol_gram_factor_(Eigen::MatrixXd()),
+    chol_gram_factor_valid_(false),
+    chol_loc_(Eigen::VectorXd()),
+    chol_noise_(Eigen::VectorXd()),
+    incremental_updates_(0),
+    last_inference_incremental_(false),
     log_noise_sd_(-1E20),
     use_explicit_trend_(false),
     feature_vectors_(Eigen::MatrixXd()),
@@ -59,6 +65,12 @@ GP::GP(const covariance_functions::CovFunc &covFunc) :
     gram_matrix_(Eigen::MatrixXd()),
     alpha_(Eigen::VectorXd()),
     chol_gram_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
+    chol_gram_factor_(Eigen::MatrixXd()),
+    chol_gram_factor_valid_(false),
+    chol_loc_(Eigen::VectorXd()),
+    chol_noise_(Eigen::VectorXd()),
+    incremental_updates_(0),
+    last_inference_incremental_(false),
     log_noise_sd_(-1E20),
     use_explicit_trend_(false),
     feature_vectors_(Eigen::MatrixXd()),
@@ -77,6 +89,12 @@ GP::GP(const double noise_variance,
     gram_matrix_(Eigen::MatrixXd()),
     alpha_(Eigen::VectorXd()),
     chol_gram_matrix_(Eigen::LDLT<Eigen::MatrixXd>()),
+    chol_gram_factor_(Eigen::MatrixXd()),
+    chol_gram_factor_valid_(false),
+    chol_loc_(Eigen::VectorXd()),
+    chol_noise_(Eigen::VectorXd()),
+    incremental_updates_(0),
+    last_inference_incremental_(false),
     log_noise_sd_(std::log(noise_variance)),
     use_explicit_trend_(false),
     feature_vectors_(Eigen::MatrixXd()),
@@ -100,6 +118,12 @@ GP::GP(const GP &that) :
     gram_matrix_(that.gram_matrix_),
     alpha_(that.alpha_),
     chol_gram_matrix_(that.chol_gram_matrix_),
+    chol_gram_factor_(that.chol_gram_factor_),
+    chol_gram_factor_valid_(that.chol_gram_factor_valid_),
+    chol_loc_(that.chol_loc_),
+    chol_noise_(that.chol_noise_),
+    incremental_updates_(that.incremental_updates_),
+    last_inference_incremental_(that.last_inference_incremental_),
     log_noise_sd_(that.log_noise_sd_),
     use_explicit_trend_(that.use_explicit_trend_),
     feature_vectors_(that.feature_vectors_),
@@ -118,6 +142,7 @@ bool GP::setCovarianceFunction(const covariance_functions::CovFunc &covFunc)
         return false;
     delete covFunc_; // initialized to zero, so delete is safe
     covFunc_ = covFunc.clone();
+    invalidateGramFactor();
 
     return true;
 }
@@ -149,6 +174,12 @@ GP &GP::operator=(const GP &that)
         gram_matrix_ = that.gram_matrix_;
         alpha_ = that.alpha_;
         chol_gram_matrix_ = that.chol_gram_matrix_;
+        chol_gram_factor_ = that.chol_gram_factor_;
+        chol_gram_factor_valid_ = that.chol_gram_factor_valid_;
+        chol_loc_ = that.chol_loc_;
+        chol_noise_ = that.chol_noise_;
+        incremental_updates_ = that.incremental_updates_;
+        last_inference_incremental_ = that.last_inference_incremental_;
         log_noise_sd_ = that.log_noise_sd_;
     }
     return *this;
@@ -183,7 +214,7 @@ Eigen::VectorXd GP::drawSample(const Eigen::VectorXd &locations,
         mixed_covariance = covFunc_->evaluate(locations, data_loc_);
         Eigen::MatrixXd posterior_covariance;
         posterior_covariance = prior_covariance - mixed_covariance *
-                               (chol_gram_matrix_.solve(mixed_covariance.transpose()));
+                               (solveGram(mixed_covariance.transpose()));
         kernel_matrix = posterior_covariance + JITTER * Eigen::MatrixXd::Identity(
                             posterior_covariance.rows(), posterior_covariance.cols());
     }
@@ -201,26 +232,18 @@ void GP::infer()
 {
     assert(data_loc_.rows() > 0 && "Error: the GP is not yet initialized!");
 
-    // The data covariance matrix
-    Eigen::MatrixXd data_cov = covFunc_->evaluate(data_loc_, data_loc_);
+    Eigen::VectorXd noise = gramNoise();
 
-    // swapping in the Gram matrix is faster than directly assigning it
-    gram_matrix_.swap(data_cov); // store the new data_cov as gram matrix
-    if (data_var_.rows() == 0) // homoscedastic
+    // update the Cholesky decomposition of the Gram matrix if possible,
+    // otherwise compute it again
+    last_inference_incremental_ = updateGramMatrix(noise);
+    if (!last_inference_incremental_)
     {
-        gram_matrix_ += (std::exp(2 * log_noise_sd_) + JITTER) *
-                        Eigen::MatrixXd::Identity(gram_matrix_.rows(), gram_matrix_.cols());
+        factorizeGramMatrix(noise);
     }
-    else // heteroscedastic
-    {
-        gram_matrix_ += data_var_.asDiagonal();
-    }
-
-    // compute the Cholesky decomposition of the Gram matrix
-    chol_gram_matrix_ = gram_matrix_.ldlt();
 
     // pre-compute the alpha, which is the solution of the chol to the data
-    alpha_ = chol_gram_matrix_.solve(data_out_);
+    alpha_ = solveGram(data_out_);
 
     if (use_explicit_trend_)
     {
@@ -229,13 +252,198 @@ void GP::infer()
         feature_vectors_.row(0) = Eigen::MatrixXd::Ones(1, data_loc_.rows()); // instead of pow(0)
         feature_vectors_.row(1) = data_loc_.array(); // instead of pow(1)
 
-        feature_matrix_ = feature_vectors_ * chol_gram_matrix_.solve(feature_vectors_.transpose());
+        feature_matrix_ = feature_vectors_ * solveGram(feature_vectors_.transpose());
         chol_feature_matrix_ = feature_matrix_.ldlt();
 
         beta_ = chol_feature_matrix_.solve(feature_vectors_) * alpha_;
     }
 }
 
+Eigen::VectorXd GP::gramNoise() const
+{
+    if (data_var_.rows() == 0) // homoscedastic
+    {
+        return Eigen::VectorXd::Constant(data_loc_.rows(), std::exp(2 * log_noise_sd_) + JITTER);
+    }
+    else // heteroscedastic
+    {
+        return data_var_;
+    }
+}
+
+void GP::factorizeGramMatrix(const Eigen::VectorXd &noise)
+{
+    // The data covariance matrix
+    Eigen::MatrixXd data_cov = covFunc_->evaluate(data_loc_, data_loc_);
+
+    // swapping in the Gram matrix is faster than directly assigning it
+    gram_matrix_.swap(data_cov); // store the new data_cov as gram matrix
+    gram_matrix_ += noise.asDiagonal();
+
+    // compute the Cholesky decomposition of the Gram matrix. The LDLT is more
+    // robust for nearly singular matrices, but can't be updated incrementally.
+    Eigen::LLT<Eigen::MatrixXd> chol_gram_matrix(gram_matrix_);
+    if (chol_gram_matrix.info() == Eigen::Success)
+    {
+        chol_gram_factor_ = chol_gram_matrix.matrixL();
+        chol_gram_factor_valid_ = true;
+        chol_gram_matrix_ = Eigen::LDLT<Eigen::MatrixXd>();
+    }
+    else
+    {
+        chol_gram_matrix_ = gram_matrix_.ldlt();
+        invalidateGramFactor();
+    }
+
+    chol_loc_ = data_loc_;
+    chol_noise_ = noise;
+    incremental_updates_ = 0;
+}
+
+bool GP::updateGramMatrix(const Eigen::VectorXd &noise)
+{
+    if (!chol_gram_factor_valid_ || incremental_updates_ >= MAX_INCREMENTAL_UPDATES)
+    {
+        return false;
+    }
+
+    const int n_old = static_cast<int>(chol_loc_.rows());
+    const int n_new = static_cast<int>(data_loc_.rows());
+
+    // match the factored data points with the new ones. The data usually keeps
+    // its order, so the search starts after the last match.
+    std::vector<int> match(n_old, -1);
+    std::vector<bool> used(n_new, false);
+    int kept = 0;
+    int hint = 0;
+    for (int i = 0; i < n_old; ++i)
+    {
+        for (int k = 0; k < n_new; ++k)
+        {
+            int j = (hint + k) % n_new;
+            if (!used[j] && data_loc_(j) == chol_loc_(i) && noise(j) == chol_noise_(i))
+            {
+                match[i] = j;
+                used[j] = true;
+                hint = j + 1;
+                ++kept;
+                break;
+            }
+        }
+    }
+
+    // every removed or added point costs O(n^2), a new decomposition O(n^3)
+    const int removed = n_old - kept;
+    const int added = n_new - kept;
+    if (kept == 0 || 4 * (removed + added) > n_new)
+    {
+        return false;
+    }
+
+    // remove the points which are gone, from the back to keep the indices valid
+    for (int i = n_old - 1; i >= 0; --i)
+    {
+        if (match[i] < 0)
+        {
+            math_tools::cholesky_remove(chol_gram_factor_, i);
+            math_tools::remove_row_column(gram_matrix_, i);
+        }
+    }
+
+    // the new order is the one of the factor, followed by the added points
+    std::vector<int> order;
+    order.reserve(n_new);
+    for (int i = 0; i < n_old; ++i)
+    {
+        if (match[i] >= 0)
+        {
+            order.push_back(match[i]);
+        }
+    }
+    for (int j = 0; j < n_new; ++j)
+    {
+        if (!used[j])
+        {
+            order.push_back(j);
+        }
+    }
+
+    Eigen::VectorXd loc(n_new);
+    Eigen::VectorXd out(n_new);
+    Eigen::VectorXd var(data_var_.rows() > 0 ? n_new : 0);
+    Eigen::VectorXd ordered_noise(n_new);
+    for (int i = 0; i < n_new; ++i)
+    {
+        loc(i) = data_loc_(order[i]);
+        out(i) = data_out_(order[i]);
+        ordered_noise(i) = noise(order[i]);
+        if (var.rows() > 0)
+        {
+            var(i) = data_var_(order[i]);
+        }
+    }
+
+    if (added > 0)
+    {
+        Eigen::VectorXd kept_loc = loc.head(kept);
+        Eigen::VectorXd added_loc = loc.tail(added);
+
+        Eigen::MatrixXd mixed_cov = covFunc_->evaluate(kept_loc, added_loc);
+        Eigen::MatrixXd added_cov = covFunc_->evaluate(added_loc, added_loc);
+        added_cov += ordered_noise.tail(added).asDiagonal();
+
+        if (!math_tools::cholesky_append(chol_gram_factor_, mixed_cov, added_cov))
+        {
+            return false; // the data is left as it was, a new decomposition follows
+        }
+
+        gram_matrix_.conservativeResize(n_new, n_new);
+        gram_matrix_.topRightCorner(kept, added) = mixed_cov;
+        gram_matrix_.bottomLeftCorner(added, kept) = mixed_cov.transpose();
+        gram_matrix_.bottomRightCorner(added, added) = added_cov;
+    }
+
+    data_loc_.swap(loc);
+    data_out_.swap(out);
+    if (var.rows() > 0)
+    {
+        data_var_.swap(var);
+    }
+    chol_loc_ = data_loc_;
+    chol_noise_ = ordered_noise;
+
+    if (removed > 0 || added > 0)
+    {
+        ++incremental_updates_;
+    }
+    return true;
+}
+
+Eigen::MatrixXd GP::solveGram(const Eigen::MatrixXd &b) const
+{
+    if (chol_gram_factor_valid_)
+    {
+        // K^-1 b = L^-T (L^-1 b)
+        Eigen::MatrixXd x = chol_gram_factor_.triangularView<Eigen::Lower>().solve(b);
+        chol_gram_factor_.triangularView<Eigen::Lower>().transpose().solveInPlace(x);
+        return x;
+    }
+    return chol_gram_matrix_.solve(b);
+}
+
+void GP::invalidateGramFactor()
+{
+    chol_gram_factor_ = Eigen::MatrixXd();
+    chol_gram_factor_valid_ = false;
+    chol_loc_ = Eigen::VectorXd();
+    chol_noise_ = Eigen::VectorXd();
+}
+
+bool GP::wasLastInferenceIncremental() const
+{
+    return last_inference_incremental_;
+}
+
 void GP::infer(const Eigen::VectorXd &data_loc,
                const Eigen::VectorXd &data_out,
                const Eigen::VectorXd &data_var /* = EigenVectorXd() */)
@@ -282,6 +490,14 @@ void GP::inferSD(const Eigen::VectorXd &data_loc,
               covariance_ordering(covariance)
              );
 
+    // keep the selected points in their original order, so that consecutive
+    // subsets mostly share their points in the same order and the Cholesky
+    // decomposition can be updated instead of computed again
+    if (n < data_loc.rows())
+    {
+        std::sort(index.begin(), index.begin() + n);
+    }
+
     bool use_var = data_var.rows() > 0; // true means heteroscedastic noise
 
     if (n < data_loc.rows())
@@ -323,6 +539,7 @@ void GP::clearData()
 {
     gram_matrix_ = Eigen::MatrixXd();
     chol_gram_matrix_ = Eigen::LDLT<Eigen::MatrixXd>();
+    invalidateGramFactor();
     data_loc_ = Eigen::VectorXd();
     data_out_ = Eigen::VectorXd();
 }
@@ -412,7 +629,7 @@ const
     Eigen::VectorXd m = mixed_cov * alpha_;
 
     // precompute K^{-1} * mixed_cov
-    Eigen::MatrixXd gamma = chol_gram_matrix_.solve(mixed_cov.transpose());
+    Eigen::MatrixXd gamma = solveGram(mixed_cov.transpose());
 
     Eigen::MatrixXd R;
 
@@ -448,6 +665,7 @@ void GP::setHyperParameters(const Eigen::VectorXd &hyperParameters)
     log_noise_sd_ = hyperParameters[0];
     covFunc_->setParameters(hyperParameters.segment(1, covFunc_->getParameterCount()));
     covFunc_->setExtraParameters(hyperParameters.tail(covFunc_->getExtraParameterCount()));
+    invalidateGramFactor(); // the whole Gram matrix changes
     if (data_loc_.rows() > 0)
     {
         infer();
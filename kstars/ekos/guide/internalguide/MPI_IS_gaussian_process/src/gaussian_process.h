@@ -35,6 +35,10 @@
 // make the Cholesky decomposition stable.
 #define JITTER 1e-6
 
+// Number of incremental updates of the Cholesky factor of the Gram matrix
+// before it is computed again from scratch, to bound the accumulated rounding.
+#define MAX_INCREMENTAL_UPDATES 200
+
 class GP
 {
 private:
@@ -46,6 +50,15 @@ private:
     Eigen::MatrixXd gram_matrix_;
     Eigen::VectorXd alpha_;
     Eigen::LDLT<Eigen::MatrixXd> chol_gram_matrix_;
+    // Lower Cholesky factor of the Gram matrix, updated as data points come
+    // and go. chol_gram_matrix_ is only used if this factorization failed.
+    Eigen::MatrixXd chol_gram_factor_;
+    bool chol_gram_factor_valid_;
+    // Locations and noise of the data points in the factor, in its order
+    Eigen::VectorXd chol_loc_;
+    Eigen::VectorXd chol_noise_;
+    int incremental_updates_;
+    bool last_inference_incremental_;
     double log_noise_sd_;
     bool use_explicit_trend_;
     Eigen::MatrixXd feature_vectors_;
@@ -53,6 +66,36 @@ private:
     Eigen::LDLT<Eigen::MatrixXd> chol_feature_matrix_;
     Eigen::VectorXd beta_;
 
+    /*!
+     * Returns the noise added to the diagonal of the Gram matrix for each
+     * data point.
+     */
+    Eigen::VectorXd gramNoise() const;
+
+    /*!
+     * Builds the Gram matrix and its Cholesky decomposition from scratch.
+     */
+    void factorizeGramMatrix(const Eigen::VectorXd& noise);
+
+    /*!
+     * Updates the Cholesky decomposition of the Gram matrix for the data
+     * points that were removed and added since the last inference, and
+     * reorders the data to match the factor. Returns false if a new
+     * decomposition is needed instead.
+     */
+    bool updateGramMatrix(const Eigen::VectorXd& noise);
+
+    /*!
+     * Solves the Gram matrix for the given right hand side.
+     */
+    Eigen::MatrixXd solveGram(const Eigen::MatrixXd& b) const;
+
+    /*!
+     * Forces a new decomposition at the next inference, e.g. after the
+     * covariance function changed.
+     */
+    void invalidateGramFactor();
+
 public:
     typedef std::pair<Eigen::VectorXd, Eigen::MatrixXd> VectorMatrixPair;
 
@@ -100,9 +143,20 @@ public:
      *
      * This function works on the already stored data and doesn't return
      * anything. The work is done here, I/O somewhere else.
+     *
+     * If most of the datapoints were already part of the previous inference,
+     * the Cholesky decomposition is updated in O(n^2) per added or removed
+     * point instead of being computed again in O(n^3). The stored data may be
+     * reordered to match the decomposition, which doesn't change the result.
      */
     void infer();
 
+    /*!
+     * Returns true if the last inference updated the previous Cholesky
+     * decomposition instead of computing a new one.
+     */
+    bool wasLastInferenceIncremental() const;
+
     /*!
      * Stores the given datapoints in the form of data location \a data_loc,
      * the output values \a data_out and noise vector \a data_sig.
@@ -17,7 +17,6 @@
 #include "gaussian_process_guider.h"
 
 #include <cmath>
-#include <ctime>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -40,6 +39,8 @@
 
 #define HYSTERESIS 0.1 // for the hybrid mode
 
+#define PERIOD_UPDATE_TOLERANCE 1e-3 // relative period change passed on to the GP
+
 GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
     start_time_(std::chrono::system_clock::now()),
     last_time_(std::chrono::system_clock::now()),
@@ -54,6 +55,8 @@ GaussianProcessGuider::GaussianProcessGuider(guide_parameters parameters) :
     output_covariance_function_(),
     gp_(covariance_function_),
     learning_rate_(DEFAULT_LEARNING_RATE),
+    filtered_period_length_(parameters.PKPeriodLength_),
+    estimated_period_length_(parameters.PKPeriodLength_),
     parameters(parameters)
 {
     circular_buffer_data_.push_front(data_point()); // add first point
@@ -140,7 +143,8 @@ double GaussianProcessGuider::CalculateVariance(double SNR)
 void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_limits<double>::quiet_NaN()*/)
 {
 #if PRINT_TIMINGS_
-    clock_t begin = std::clock(); // this is for timing the method in a simple way
+    // wall clock time, std::clock() would add up the CPU time of all threads of the process
+    auto begin = std::chrono::steady_clock::now(); // this is for timing the method in a simple way
 #endif
 
     size_t N = get_number_of_measurements();
@@ -170,9 +174,9 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
     gear_error = sum_controls + measurements; // for each time step, add the residual error
 
 #if PRINT_TIMINGS_
-    clock_t end = std::clock();
-    double time_init = double(end - begin) / CLOCKS_PER_SEC;
-    begin = std::clock();
+    auto end = std::chrono::steady_clock::now();
+    double time_init = std::chrono::duration<double>(end - begin).count();
+    begin = std::chrono::steady_clock::now();
 #endif
 
     // regularize the measurements
@@ -184,9 +188,9 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
     variances = result.row(2);
 
 #if PRINT_TIMINGS_
-    end = std::clock();
-    double time_regularize = double(end - begin) / CLOCKS_PER_SEC;
-    begin = std::clock();
+    end = std::chrono::steady_clock::now();
+    double time_regularize = std::chrono::duration<double>(end - begin).count();
+    begin = std::chrono::steady_clock::now();
 #endif
 
     // linear least squares regression for offset and drift to de-trend the data
@@ -205,9 +209,9 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
     Eigen::VectorXd gear_error_detrend = gear_error - linear_fit;
 
 #if PRINT_TIMINGS_
-    end = std::clock();
-    double time_detrend = double(end - begin) / CLOCKS_PER_SEC;
-    begin = std::clock();
+    end = std::chrono::steady_clock::now();
+    double time_detrend = std::chrono::duration<double>(end - begin).count();
+    begin = std::chrono::steady_clock::now();
     double time_fft = 0; // need to initialize in case the FFT isn't calculated
 #endif
 
@@ -215,30 +219,44 @@ void GaussianProcessGuider::UpdateGP(double prediction_point /*= std::numeric_li
     double period_length = GetGPHyperparameters()[PKPeriodLength];
     if (GetBoolComputePeriod() && get_last_point().timestamp > parameters.min_periods_for_period_estimation_ * period_length)
     {
-        // find periodicity parameter with FFT
-        period_length = EstimatePeriodLength(timestamps, gear_error_detrend);
-        UpdatePeriodLength(period_length);
+        // find periodicity parameter with FFT, unless the data is the same as last time
+        if (timestamps.rows() != period_estimation_time_.rows() || timestamps != period_estimation_time_
+                || gear_error_detrend != period_estimation_data_)
+        {
+            estimated_period_length_ = EstimatePeriodLength(timestamps, gear_error_detrend);
+            period_estimation_time_ = timestamps;
+            period_estimation_data_ = gear_error_detrend;
+        }
+        UpdatePeriodLength(estimated_period_length_);
 
 #if PRINT_TIMINGS_
-        end = std::clock();
-        time_fft = double(end - begin) / CLOCKS_PER_SEC;
+        end = std::chrono::steady_clock::now();
+        time_fft = std::chrono::duration<double>(end - begin).count();
 #endif
     }
 
 #if PRINT_TIMINGS_
-    begin = std::clock();
+    begin = std::chrono::steady_clock::now();
 #endif
 
     // inference of the GP with the new points, maximum accuracy should be reached around current time
     gp_.inferSD(timestamps, gear_error, parameters.points_for_approximation_, variances, prediction_point);
 
 #if PRINT_TIMINGS_
-    end = std::clock();
-    double time_gp = double(end - begin) / CLOCKS_PER_SEC;
+    end = std::chrono::steady_clock::now();
+    double time_gp = std::chrono::duration<double>(end - begin).count();
 
-    printf("timings: init: %f, regularize: %f, detrend: %f, fft: %f, gp: %f, total: %f\n",
+    printf("timings: init: %f, regularize: %f, detrend: %f, fft: %f, gp: %f (%s), total: %f\n",
            time_init, time_regularize, time_detrend, time_fft, time_gp,
+           gp_.wasLastInferenceIncremental() ? "updated" : "factorized",
            time_init + time_regularize + time_detrend + time_fft + time_gp);
+    qCDebug(KSTARS_EKOS_GUIDE) << QString("GPG timings: init %1 regularize %2 detrend %3 fft %4 gp %5 (%6) ms")
+                               .arg(1e3 * time_init, 0, 'f', 3)
+                               .arg(1e3 * time_regularize, 0, 'f', 3)
+                               .arg(1e3 * time_detrend, 0, 'f', 3)
+                               .arg(1e3 * time_fft, 0, 'f', 3)
+                               .arg(1e3 * time_gp, 0, 'f', 3)
+                               .arg(gp_.wasLastInferenceIncremental() ? "updated" : "factorized");
 #endif
 }
 
@@ -425,6 +443,8 @@ void GaussianProcessGuider::reset()
     qCDebug(KSTARS_EKOS_GUIDE) << QString("GPG::reset()");
     circular_buffer_data_.clear();
     gp_.clearData();
+    period_estimation_time_ = Eigen::VectorXd();
+    period_estimation_data_ = Eigen::VectorXd();
 
     // We need to add a first data point because the measurements are always relative to the control.
     // For the first measurement, we therefore need to add a point with zero control.
@@ -513,6 +533,8 @@ bool GaussianProcessGuider::SetGPHyperparameters(std::vector<double> const &hype
 {
     Eigen::VectorXd hyperparameters_eig = Eigen::VectorXd::Map(&hyperparameters[0], hyperparameters.size());
 
+    filtered_period_length_ = hyperparameters[PKPeriodLength];
+
     // prevent length scales from becoming too small (makes GP unstable)
     hyperparameters_eig(SE0KLengthScale) = std::max(hyperparameters_eig(SE0KLengthScale), 1.0);
     hyperparameters_eig(PKLengthScale) = std::max(hyperparameters_eig(PKLengthScale), 1.0);
@@ -697,13 +719,19 @@ void GaussianProcessGuider::UpdatePeriodLength(double period_length)
     // ...and save the day for the users
     if (math_tools::isNaN(period_length))
     {
-        period_length = hypers[PKPeriodLength]; // just use the old value instead
+        period_length = filtered_period_length_; // just use the old value instead
     }
 
     // we just apply a simple learning rate to slow down parameter jumps
-    hypers[PKPeriodLength] = (1 - learning_rate_) * hypers[PKPeriodLength] + learning_rate_ * period_length;
+    filtered_period_length_ = (1 - learning_rate_) * filtered_period_length_ + learning_rate_ * period_length;
 
-    SetGPHyperparameters(hypers); // the setter function is needed to convert parameters
+    // changing the period requires a new decomposition of the Gram matrix, so the
+    // small steps of the learning rate are collected until they become relevant
+    if (std::abs(filtered_period_length_ - hypers[PKPeriodLength]) > PERIOD_UPDATE_TOLERANCE * hypers[PKPeriodLength])
+    {
+        hypers[PKPeriodLength] = filtered_period_length_;
+        SetGPHyperparameters(hypers); // the setter function is needed to convert parameters
+    }
 }
 
 Eigen::MatrixXd GaussianProcessGuider::regularize_dataset(const Eigen::VectorXd &timestamps,
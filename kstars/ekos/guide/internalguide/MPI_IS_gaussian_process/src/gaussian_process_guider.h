@@ -177,6 +177,23 @@ class GaussianProcessGuider
          */
         double learning_rate_;
 
+        /**
+         * Period length after the learning rate was applied. It is passed on to
+         * the GP only when it differs enough from the period in use, since any
+         * change of the hyperparameters requires a new decomposition of the
+         * Gram matrix.
+         */
+        double filtered_period_length_;
+
+        /**
+         * Input and result of the last period estimation. The regularized data
+         * only changes when a grid cell is completed, the spectrum doesn't need
+         * to be computed again in between.
+         */
+        Eigen::VectorXd period_estimation_time_;
+        Eigen::VectorXd period_estimation_data_;
+        double estimated_period_length_;
+
         /**
          * Guiding parameters of this instance.
          */
@@ -18,6 +18,7 @@
  */
 
 #include "math_tools.h"
+#include <cassert>
 #include <stdexcept>
 #include <cmath>
 #include <cstdint>
@@ -201,6 +202,81 @@ double stdandard_deviation(Eigen::VectorXd &input)
     return std::sqrt(centered.pow(2).sum() / (centered.size() - 1));
 }
 
+void cholesky_rank_one_update(Eigen::Ref<Eigen::MatrixXd> L, Eigen::VectorXd v)
+{
+    const int n = static_cast<int>(L.rows());
+    for (int k = 0; k < n; ++k)
+    {
+        // Givens rotation that zeroes v(k) against the diagonal element
+        double r = std::hypot(L(k, k), v(k));
+        double c = r / L(k, k);
+        double s = v(k) / L(k, k);
+        L(k, k) = r;
+
+        int m = n - k - 1;
+        if (m > 0)
+        {
+            L.col(k).tail(m) = (L.col(k).tail(m) + s * v.tail(m)) / c;
+            v.tail(m) = c * v.tail(m) - s * L.col(k).tail(m);
+        }
+    }
+}
+
+void cholesky_remove(Eigen::MatrixXd &L, int index)
+{
+    const int n = static_cast<int>(L.rows());
+    const int m = n - index - 1; // size of the trailing block
+
+    assert(index >= 0 && index < n);
+
+    // The trailing block loses the contribution of the removed column:
+    // L33' * L33'^T = L33 * L33^T + l32 * l32^T
+    if (m > 0)
+    {
+        cholesky_rank_one_update(L.bottomRightCorner(m, m), L.col(index).tail(m));
+    }
+    remove_row_column(L, index);
+}
+
+bool cholesky_append(Eigen::MatrixXd &L, const Eigen::MatrixXd &B, const Eigen::MatrixXd &C)
+{
+    const int n = static_cast<int>(L.rows());
+    const int m = static_cast<int>(C.rows());
+
+    assert(B.rows() == n && B.cols() == m && C.cols() == m);
+
+    // [L 0; L21 L22] with L21 = (L^-1 B)^T and L22 the factor of the Schur complement C - L21 L21^T
+    Eigen::MatrixXd L21t = L.triangularView<Eigen::Lower>().solve(B);
+    Eigen::LLT<Eigen::MatrixXd> schur(C - L21t.transpose() * L21t);
+    if (schur.info() != Eigen::Success)
+    {
+        return false;
+    }
+
+    L.conservativeResize(n + m, n + m);
+    L.topRightCorner(n, m).setZero();
+    L.bottomLeftCorner(m, n) = L21t.transpose();
+    L.bottomRightCorner(m, m) = schur.matrixL();
+    return true;
+}
+
+void remove_row_column(Eigen::MatrixXd &matrix, int index)
+{
+    const int n = static_cast<int>(matrix.rows());
+    const int m = n - index - 1;
+
+    assert(index >= 0 && index < n && matrix.cols() == n);
+
+    // the blocks overlap their destination, they are copied through temporaries
+    if (m > 0)
+    {
+        matrix.block(index, 0, m, index) = matrix.block(index + 1, 0, m, index).eval();
+        matrix.block(0, index, index, m) = matrix.block(0, index + 1, index, m).eval();
+        matrix.block(index, index, m, m) = matrix.block(index + 1, index + 1, m, m).eval();
+    }
+    matrix.conservativeResize(n - 1, n - 1);
+}
+
 
 }  // namespace math_tools
 
@@ -132,6 +132,34 @@ namespace math_tools
      */
     double stdandard_deviation(Eigen::VectorXd& input);
 
+    /*!
+     * Updates the lower Cholesky factor L of a matrix A in place, so that it
+     * becomes the factor of A + v * v^T. This costs O(n^2) instead of the O(n^3)
+     * of a new decomposition.
+     */
+    void cholesky_rank_one_update(Eigen::Ref<Eigen::MatrixXd> L, Eigen::VectorXd v);
+
+    /*!
+     * Updates the lower Cholesky factor L of a matrix A to the factor of A with
+     * the given row and column removed. The trailing block is corrected with a
+     * rank-one update, in O(n^2).
+     */
+    void cholesky_remove(Eigen::MatrixXd& L, int index);
+
+    /*!
+     * Extends the lower Cholesky factor L of a matrix A to the factor of the
+     * block matrix [A B; B^T C], in O(n^2 m) for m appended rows.
+     *
+     * Returns false and leaves L unchanged if the extended matrix is not
+     * positive definite.
+     */
+    bool cholesky_append(Eigen::MatrixXd& L, const Eigen::MatrixXd& B, const Eigen::MatrixXd& C);
+
+    /*!
+     * Removes a row and the column with the same index from a square matrix.
+     */
+    void remove_row_column(Eigen::MatrixXd& matrix, int index);
+
 }  // namespace math_tools
 
 #endif  // define GP_MATH_TOOLS_H
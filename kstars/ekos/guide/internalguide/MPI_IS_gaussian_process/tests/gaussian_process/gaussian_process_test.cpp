@@ -196,6 +196,47 @@ TEST_F(GPTest, infer_prediction_clear_test)
     EXPECT_NEAR(prediction(1), 0, 1e-6);
 }
 
+// The incremental update of the Cholesky decomposition must give the same
+// predictions as a new decomposition
+TEST_F(GPTest, incremental_inference_test)
+{
+    int N = 60;
+    Eigen::VectorXd data_loc = Eigen::VectorXd::LinSpaced(N, 0, 5.9);
+    Eigen::VectorXd data_out = (data_loc.array() * 2).sin();
+    Eigen::VectorXd data_var = Eigen::VectorXd::Constant(N, 0.1);
+
+    Eigen::VectorXd prediction_location(3);
+    prediction_location << 4.05, 4.55, 5.05;
+
+    GP reference_gp(covariance_function_);
+    // slide a window of 40 points over the data, one point at a time
+    for (int start = 0; start + 40 <= N; start++)
+    {
+        gp_.infer(data_loc.segment(start, 40), data_out.segment(start, 40), data_var.segment(start, 40));
+        if (start > 0)
+        {
+            EXPECT_TRUE(gp_.wasLastInferenceIncremental());
+        }
+
+        reference_gp.clearData();
+        reference_gp.infer(data_loc.segment(start, 40), data_out.segment(start, 40), data_var.segment(start, 40));
+        EXPECT_FALSE(reference_gp.wasLastInferenceIncremental());
+
+        Eigen::VectorXd variances, reference_variances;
+        Eigen::VectorXd prediction = gp_.predict(prediction_location, &variances);
+        Eigen::VectorXd reference_prediction = reference_gp.predict(prediction_location, &reference_variances);
+        for (int i = 0; i < prediction.rows(); i++)
+        {
+            EXPECT_NEAR(prediction(i), reference_prediction(i), 1e-8);
+            EXPECT_NEAR(variances(i), reference_variances(i), 1e-8);
+        }
+    }
+
+    // changing the hyperparameters requires a new decomposition
+    gp_.setHyperParameters(gp_.getHyperParameters());
+    EXPECT_FALSE(gp_.wasLastInferenceIncremental());
+}
+
 TEST_F(GPTest, squareDistanceTest)
 {
     Eigen::MatrixXd a(4, 3);
@@ -184,6 +184,45 @@ TEST(MathToolsTest, StdTest)
     EXPECT_NEAR(math_tools::stdandard_deviation(data), matlab_result, 1e-3);
 }
 
+TEST(MathToolsTest, CholeskyUpdateTest)
+{
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(10, 10);
+    Eigen::MatrixXd A = X * X.transpose() + 10 * Eigen::MatrixXd::Identity(10, 10);
+    Eigen::MatrixXd L = A.llt().matrixL();
+
+    // removing a row and column
+    math_tools::cholesky_remove(L, 3);
+    math_tools::remove_row_column(A, 3);
+    ASSERT_EQ(L.rows(), 9);
+    Eigen::MatrixXd expected_L = A.llt().matrixL();
+    for (int col = 0; col < L.cols(); col++)
+    {
+        for (int row = 0; row < L.rows(); row++)
+        {
+            EXPECT_NEAR(L(row, col), expected_L(row, col), 1e-10);
+        }
+    }
+
+    // appending two rows and columns
+    Eigen::MatrixXd B = 0.1 * Eigen::MatrixXd::Random(9, 2);
+    Eigen::MatrixXd C = 5 * Eigen::MatrixXd::Identity(2, 2);
+    ASSERT_TRUE(math_tools::cholesky_append(L, B, C));
+    Eigen::MatrixXd A_ext(11, 11);
+    A_ext << A, B, B.transpose(), C;
+    expected_L = A_ext.llt().matrixL();
+    for (int col = 0; col < L.cols(); col++)
+    {
+        for (int row = 0; row < L.rows(); row++)
+        {
+            EXPECT_NEAR(L(row, col), expected_L(row, col), 1e-10);
+        }
+    }
+
+    // the extension must be positive definite
+    EXPECT_FALSE(math_tools::cholesky_append(L, Eigen::MatrixXd::Zero(11, 1), -Eigen::MatrixXd::Identity(1, 1)));
+    EXPECT_EQ(L.rows(), 11);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -217,6 +217,7 @@ void SchedulerJob::setFITSFile(const QUrl &value)
 void SchedulerJob::setMinAltitude(const double &value)
 {
     minAltitude = value;
+    visibilityCache.clear();
 }
 
 bool SchedulerJob::hasAltitudeConstraint() const
@@ -231,11 +232,13 @@ bool SchedulerJob::hasAltitudeConstraint() const
 void SchedulerJob::setMinMoonSeparation(const double &value)
 {
     minMoonSeparation = value;
+    visibilityCache.clear();
 }
 
 void SchedulerJob::setMaxMoonAltitude(const double &value)
 {
     maxMoonAltitude = value;
+    visibilityCache.clear();
 }
 
 void SchedulerJob::setStopTime(const QDateTime &value)
@@ -461,12 +464,14 @@ void SchedulerJob::setInSequenceFocus(bool value)
 void SchedulerJob::setEnforceTwilight(bool value)
 {
     enforceTwilight = value;
+    visibilityCache.clear();
     SchedulerModuleState::calculateDawnDusk(startupTime, nextDawn, nextDusk);
 }
 
 void SchedulerJob::setEnforceArtificialHorizon(bool value)
 {
     enforceArtificialHorizon = value;
+    visibilityCache.clear();
 }
 
 void SchedulerJob::setLightFramesRequired(bool value)
@@ -515,6 +520,7 @@ void SchedulerJob::setTargetCoords(const dms &ra, const dms &dec, double djd)
 {
     targetCoords.setRA0(ra);
     targetCoords.setDec0(dec);
+    visibilityCache.clear();
 
     targetCoords.apparentCoord(static_cast<long double>(J2000), djd);
 }
@@ -645,8 +651,11 @@ bool SchedulerJob::moonConstraintsOK(QDateTime const &when, QString *reason, dou
     KSNumbers numbers(ltWhen.djd());
     o.updateCoordsNow(&numbers);
 
-    CachingDms LST = SchedulerModuleState::getGeo()->GSTtoLST(SchedulerModuleState::getGeo()->LTtoUT(ltWhen).gst());
-    moon->updateCoords(&numbers, true, SchedulerModuleState::getGeo()->lat(), &LST, true);
+    // The Moon moves fast enough for the time zone to matter, place it at the universal time
+    const KStarsDateTime ut = SchedulerModuleState::getGeo()->LTtoUT(ltWhen);
+    KSNumbers moonNumbers(ut.djd());
+    CachingDms LST = SchedulerModuleState::getGeo()->GSTtoLST(ut.gst());
+    moon->updateCoords(&moonNumbers, true, SchedulerModuleState::getGeo()->lat(), &LST, true);
     moon->EquatorialToHorizontal(&LST, SchedulerModuleState::getGeo()->lat());
 
     bool separationOK = true;
@@ -691,15 +700,6 @@ QDateTime SchedulerJob::calculateNextTime(QDateTime const &when, bool checkIfCon
                           Qt::UTC == when.timeSpec() ? SchedulerModuleState::getGeo()->UTtoLT(KStarsDateTime(when)) : when :
                           getLocalTime());
 
-    // Create a sky object with the target catalog coordinates
-    SkyPoint const target = getTargetCoords();
-    SkyObject o;
-    o.setRA0(target.ra0());
-    o.setDec0(target.dec0());
-
-    // Calculate the UT at the argument time
-    KStarsDateTime const ut = SchedulerModuleState::getGeo()->LTtoUT(ltWhen);
-
     unsigned int maxMinute = 1e8;
     if (!runningJob && until.isValid())
         maxMinute = when.secsTo(until) / 60;
@@ -707,93 +707,109 @@ QDateTime SchedulerJob::calculateNextTime(QDateTime const &when, bool checkIfCon
     if (maxMinute > 24 * 60)
         maxMinute = 24 * 60;
 
-    unsigned int nextAltCheck = 0;
-    bool inSkip = false;
-    int skipStart = 0;
-    constexpr int MAX_SKIP = 30;
-
-    // Within the next 24 hours, search when the job target matches the altitude and moon constraints
-    for (unsigned int minute = 0; minute < maxMinute; minute += increment)
+    // Rather than stepping through the next 24 hours, intersect the intervals when each constraint is met.
+    // Windows are computed for nights starting at local noon, two of them cover the search.
+    const QDate night = ltWhen.time().hour() < 12 ? ltWhen.date().addDays(-1) : ltWhen.date();
+    const double minutesFromNoon = (ltWhen.djd() - KStarsDateTime(night, QTime(12, 0)).djd()) * 24 * 60;
+    NightVisibility::Intervals windows;
+    for (int day = 0; day < 2; day++)
     {
-        KStarsDateTime const ltOffset(ltWhen.addSecs(minute * 60));
-
-        // Is this violating twilight?
-        QDateTime nextSuccess;
-        if (getEnforceTwilight() && !runsDuringAstronomicalNightTime(ltOffset, &nextSuccess))
+        for (const auto &window : visibilityWindows(night.addDays(day)))
         {
-            if (checkIfConstraintsAreMet)
-            {
-                // Change the minute to increment-minutes before next success.
-                if (nextSuccess.isValid())
-                {
-                    const int minutesToSuccess = ltOffset.secsTo(nextSuccess) / 60 - increment;
-                    if (minutesToSuccess > 0)
-                        minute += minutesToSuccess;
-                }
-                nextAltCheck = 0;
-                inSkip = false;
-                continue;
-            }
+            const double start = (day * 24 + window.first) * 60 - minutesFromNoon;
+            const double end = (day * 24 + window.second) * 60 - minutesFromNoon;
+            // Merge the windows that continue across noon
+            if (!windows.isEmpty() && start - windows.last().second < 1e-6)
+                windows.last().second = end;
             else
-            {
-                if (reason) *reason = "twilight";
-                return ltOffset;
-            }
+                windows.append(qMakePair(start, end));
         }
+    }
 
-        if (minute >= nextAltCheck)
+    // Keep the answer on the increment grid, as if the constraints were checked every increment minutes
+    unsigned int minute = 0;
+    if (checkIfConstraintsAreMet)
+    {
+        bool found = false;
+        for (const auto &window : windows)
         {
-            double margin;
-            const bool altAndMoonOK = checkAltitudeAndMoon(o, ltOffset, reason, &margin);
-            bool done = ((checkIfConstraintsAreMet && altAndMoonOK) || (!checkIfConstraintsAreMet && !altAndMoonOK));
-
-            if (done && inSkip)
+            if (window.second < 0)
+                continue;
+            const unsigned int first = window.first <= 0 ? 0 :
+                                       static_cast<unsigned int>(std::ceil(window.first / increment)) * increment;
+            if (first <= window.second)
             {
-                // If we skipped ahead, and when we come to the end of the skip and the code looks to exit,
-                // perhaps the skip was too aggressive (unlikely, but can happen in odd situations).
-                // We re-do the skipped iterations here.
-
-                // Just in case
-                if (minute - skipStart <= MAX_SKIP)
-                {
-                    for (unsigned int min = skipStart; min < minute; min += increment)
-                    {
-                        KStarsDateTime const lt(ltWhen.addSecs(min * 60));
-                        // don't need to test twilight--that was not skipped.
-                        const bool checkOK = checkAltitudeAndMoon(o, lt, reason, nullptr);
-                        if ((checkIfConstraintsAreMet && checkOK) || (!checkIfConstraintsAreMet && !checkOK))
-                        {
-                            // Found an earlier return.
-                            return lt;
-                        }
-                    }
-                }
+                minute = first;
+                found = true;
+                break;
             }
+        }
+        if (!found)
+            return QDateTime();
+    }
+    else
+    {
+        for (const auto &window : windows)
+        {
+            if (window.first > minute)
+                break;
+            if (window.second >= minute)
+                minute = (static_cast<unsigned int>(std::floor(window.second / increment)) + 1) * increment;
+        }
+    }
 
-            if (done)
-                return ltOffset;
+    if (minute >= maxMinute)
+        return QDateTime();
 
-            // If we've exceeded the margin by a lot, no need to check again for several minutes.
-            if (margin > 15)
-            {
-                inSkip = true;
-                skipStart = minute + increment;
-                nextAltCheck = minute + MAX_SKIP;
-            }
-            else if (margin > 5)
-            {
-                inSkip = true;
-                skipStart = minute + increment;
-                nextAltCheck = minute + 16;
-            }
-            else
-            {
-                inSkip = false;
-                skipStart = minute + increment;
-            }
+    KStarsDateTime const ltOffset(ltWhen.addSecs(minute * 60));
+    if (reason != nullptr && !checkIfConstraintsAreMet)
+    {
+        // Report which constraint is missed
+        if (getEnforceTwilight() && !runsDuringAstronomicalNightTime(ltOffset))
+            *reason = "twilight";
+        else
+        {
+            SkyPoint const target = getTargetCoords();
+            SkyObject o;
+            o.setRA0(target.ra0());
+            o.setDec0(target.dec0());
+            checkAltitudeAndMoon(o, ltOffset, reason, nullptr);
         }
     }
-    return QDateTime();
+    return ltOffset;
+}
+
+const NightVisibility::Intervals &SchedulerJob::visibilityWindows(const QDate &night) const
+{
+    if (m_LeadJob != nullptr)
+        return m_LeadJob->visibilityWindows(night);
+
+    auto cached = visibilityCache.constFind(night);
+    if (cached != visibilityCache.constEnd())
+        return cached.value();
+
+    NightVisibility::Constraints constraints;
+    constraints.minAltitude = getMinAltitude();
+    constraints.minMoonSeparation = getMinMoonSeparation();
+    constraints.maxMoonAltitude = getMaxMoonAltitude();
+    constraints.enforceTwilight = getEnforceTwilight();
+    if (getEnforceArtificialHorizon())
+        constraints.horizon = getHorizon();
+
+    // Following the Moon through the night is only needed for the moon constraints
+    const bool hasMoonConstraints = moon != nullptr && (getMinMoonSeparation() > 0 || getMaxMoonAltitude() < 90);
+    const NightVisibility visibility(night, SchedulerModuleState::getGeo(), hasMoonConstraints ? moon : nullptr,
+                                     constraints);
+
+    // Manage the cache size.
+    if (visibilityCache.size() > 10)
+        visibilityCache.clear();
+
+    SkyPoint const target = getTargetCoords();
+    NightVisibility::Target t;
+    t.ra0 = target.ra0();
+    t.dec0 = target.dec0();
+    return visibilityCache.insert(night, visibility.windows(t)).value();
 }
 
 bool SchedulerJob::checkAltitudeAndMoon(SkyObject o, const KStarsDateTime &ltOffset, QString *reason, double *margin) const
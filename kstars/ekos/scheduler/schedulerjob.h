@@ -10,6 +10,7 @@
 #include "schedulertypes.h"
 #include "ekos/capture/sequencejob.h"
 #include "greedyscheduler.h"
+#include "tools/nightvisibility.h"
 
 #include <QUrl>
 #include <QMap>
@@ -539,6 +540,8 @@ class SchedulerJob
              * @brief calculateNextTime calculate the next time constraints are met (or missed).
              * @param when date and time to start searching from, now if omitted.
              * @param constraintsAreMet if true, searches for the next time constrains are met, else missed.
+             * @note The times when all constraints are met are solved as intervals for each night and cached,
+             * the result is then rounded up to the next multiple of increment minutes from when.
              * @return The date and time the target meets or misses constraints.
              */
         QDateTime calculateNextTime(QDateTime const &when, bool checkIfConstraintsAreMet = true, int increment = 1,
@@ -607,10 +610,11 @@ class SchedulerJob
         QString jobStartupConditionString(StartupCondition condition) const;
         QString jobCompletionConditionString(CompletionCondition condition) const;
 
-        // Clear the cache that keeps results for getNextPossibleStartTime().
+        // Clear the caches that keep results for getNextPossibleStartTime() and calculateNextTime().
         void clearCache()
         {
             startTimeCache.clear();
+            visibilityCache.clear();
         }
         double getAltitudeAtStartup() const
         {
@@ -840,6 +844,12 @@ class SchedulerJob
         };
         StartTimeCache startTimeCache;
 
+        // Times when the constraints are met during the night following noon on the date, in hours from local noon.
+        const NightVisibility::Intervals &visibilityWindows(const QDate &night) const;
+        // Windows computed by visibilityWindows(), keyed by night. Reset with the start time cache, or when
+        // the constraints of the job change.
+        mutable QMap<QDate, NightVisibility::Intervals> visibilityCache;
+
         // These are used in testing, instead of KStars::Instance() resources
         static KStarsDateTime *storedLocalTime;
         static GeoLocation *storedGeo;
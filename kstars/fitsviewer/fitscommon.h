@@ -328,6 +328,7 @@ typedef struct
     QString alignMaster;
     LiveStackAlignMethod alignMethod;
     int numInMem;
+    int tileMemory;
     LiveStackDownscale downscale;
     LiveStackFrameWeighting weighting;
     LiveStackRejection rejection;
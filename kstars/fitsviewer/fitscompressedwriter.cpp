@@ -0,0 +1,231 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitscompressedwriter.h"
+
+#include <QFile>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+// Rows per tile. Tiles are as wide as the image, as cfitsio does by default.
+constexpr long COMPRESSED_TILE_ROWS = 16;
+// Tiles compressed by each job
+constexpr long TILES_PER_JOB = 8;
+
+int compressedPixelSize(int bitpix)
+{
+    switch (bitpix)
+    {
+        case USHORT_IMG:
+            return 2;
+        case ULONG_IMG:
+            return 4;
+        default:
+            return std::abs(bitpix) / 8;
+    }
+}
+
+int compressedDataType(int bitpix)
+{
+    switch (bitpix)
+    {
+        case BYTE_IMG:
+            return TBYTE;
+        case SHORT_IMG:
+            return TSHORT;
+        case USHORT_IMG:
+            return TUSHORT;
+        case LONG_IMG:
+            return TINT;
+        case ULONG_IMG:
+            return TUINT;
+        case LONGLONG_IMG:
+            return TLONGLONG;
+        case FLOAT_IMG:
+            return TFLOAT;
+        case DOUBLE_IMG:
+            return TDOUBLE;
+        default:
+            return 0;
+    }
+}
+
+// Compress consecutive rows of a plane, starting on a tile boundary. cfitsio writes them to an image of
+// their own in memory, compressed the same way, and the rows of its table are the compressed tiles.
+QVector<QByteArray> compressTiles(FITSCompressedWriter::Codec codec, int bitpix, long width, long rows,
+                                  const uint8_t *input, int *status)
+{
+    QVector<QByteArray> tiles;
+    fitsfile *fptr = nullptr;
+    size_t size = 2880 * 4;
+    void *memory = malloc(size);
+    long naxes[2] = { width, rows };
+    int column = 0;
+
+    if (fits_create_memfile(&fptr, &memory, &size, 2880, realloc, status) == 0 &&
+            FITSCompressedWriter::createImage(fptr, codec, bitpix, 2, naxes, status) &&
+            fits_write_img(fptr, compressedDataType(bitpix), 1, width * rows, const_cast<uint8_t *>(input), status) == 0 &&
+            fits_get_colnum(fptr, CASEINSEN, const_cast<char *>("COMPRESSED_DATA"), &column, status) == 0)
+    {
+        const long count = (rows + COMPRESSED_TILE_ROWS - 1) / COMPRESSED_TILE_ROWS;
+        for (long row = 1; row <= count && *status == 0; row++)
+        {
+            long length = 0, offset = 0;
+            if (fits_read_descript(fptr, column, row, &length, &offset, status))
+                break;
+            QByteArray tile(static_cast<int>(length), Qt::Uninitialized);
+            fits_read_col(fptr, TBYTE, column, row, 1, length, nullptr, tile.data(), nullptr, status);
+            tiles.append(tile);
+        }
+    }
+
+    int closeStatus = 0;
+    if (fptr)
+        fits_close_file(fptr, &closeStatus);
+    free(memory);
+    return tiles;
+}
+}
+
+bool FITSCompressedWriter::createImage(fitsfile *fptr, Codec codec, int bitpix, int naxis, long *naxes, int *status)
+{
+    // Compressed images are extensions, a new file first needs an empty primary HDU.
+    int hdus = 0;
+    if (fits_get_num_hdus(fptr, &hdus, status) == 0 && hdus == 0)
+        fits_create_img(fptr, BYTE_IMG, 0, nullptr, status);
+
+    const bool integer = bitpix != FLOAT_IMG && bitpix != DOUBLE_IMG && bitpix != LONGLONG_IMG;
+    long tile[3] = { naxes[0], std::min(COMPRESSED_TILE_ROWS, naxes[1]), 1 };
+    fits_set_compression_type(fptr, codec == RICE && integer ? RICE_1 : GZIP_1, status);
+    fits_set_tile_dim(fptr, naxis, tile, status);
+    // Floating point values are kept as they are instead of being quantized.
+    fits_set_quantize_level(fptr, 0, status);
+    return fits_create_img(fptr, bitpix, naxis, naxes, status) == 0;
+}
+
+bool FITSCompressedWriter::writeImage(fitsfile *fptr, int bitpix, long width, long height, long channels,
+                                      const void *buffer, int *status)
+{
+    char compression[FLEN_VALUE] = {0};
+    long tileRows = 1;
+    int column = 0;
+    if (fits_read_key_str(fptr, "ZCMPTYPE", compression, nullptr, status) ||
+            fits_read_key_lng(fptr, "ZTILE2", &tileRows, nullptr, status) ||
+            fits_get_colnum(fptr, CASEINSEN, const_cast<char *>("COMPRESSED_DATA"), &column, status))
+        return false;
+
+    const Codec codec = QLatin1String(compression) == QLatin1String("RICE_1") ? RICE : GZIP;
+    const int pixelSize = compressedPixelSize(bitpix);
+    const long tilesPerPlane = (height + tileRows - 1) / tileRows;
+    const long jobsPerPlane = (tilesPerPlane + TILES_PER_JOB - 1) / TILES_PER_JOB;
+    QVector<QVector<QByteArray>> jobTiles(jobsPerPlane * channels);
+    QVector<int> statuses(jobTiles.size(), 0);
+    QVector<int> indexes(jobTiles.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&](int i)
+    {
+        const long plane = i / jobsPerPlane;
+        const long firstRow = (i % jobsPerPlane) * TILES_PER_JOB * tileRows;
+        const long rows = std::min(TILES_PER_JOB * tileRows, height - firstRow);
+        const uint8_t *input = static_cast<const uint8_t *>(buffer) +
+                               (static_cast<size_t>(plane) * height + firstRow) * width * pixelSize;
+        jobTiles[i] = compressTiles(codec, bitpix, width, rows, input, &statuses[i]);
+    });
+
+    for (int tileStatus : statuses)
+    {
+        if (tileStatus)
+        {
+            *status = tileStatus;
+            return false;
+        }
+    }
+
+    // Tiles are the rows of the table, in the order of the pixels.
+    long row = 1;
+    for (const auto &tiles : jobTiles)
+    {
+        for (const auto &tile : tiles)
+        {
+            if (fits_write_col(fptr, TBYTE, column, row++, 1, tile.size(), const_cast<char *>(tile.data()), status))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool FITSCompressedWriter::writeFile(const QString &filename, const QByteArray &fits, Codec codec, QString *error)
+{
+    int status = 0, bitpix = 0, naxis = 0, anynull = 0, keys = 0;
+    long naxes[3] = { 1, 1, 1 };
+    fitsfile *input = nullptr, *output = nullptr;
+    void *memory = const_cast<char *>(fits.constData());
+    size_t size = fits.size();
+
+    if (fits_open_memfile(&input, "", READONLY, &memory, &size, 0, nullptr, &status) == 0 &&
+            fits_get_img_equivtype(input, &bitpix, &status) == 0 &&
+            fits_get_img_dim(input, &naxis, &status) == 0 && (naxis < 2 || naxis > 3))
+        status = BAD_NAXIS;
+
+    std::vector<uint8_t> pixels;
+    if (status == 0 && fits_get_img_size(input, 3, naxes, &status) == 0)
+    {
+        pixels.resize(static_cast<size_t>(naxes[0]) * naxes[1] * naxes[2] * compressedPixelSize(bitpix));
+        fits_read_img(input, compressedDataType(bitpix), 1, naxes[0] * naxes[1] * naxes[2], nullptr, pixels.data(),
+                      &anynull, &status);
+    }
+
+    // Use create diskfile as it does not use extended file names which has problems creating
+    // files with [ ] or ( ) in their names.
+    if (status == 0)
+    {
+        QFile::remove(filename);
+        fits_create_diskfile(&output, filename.toLocal8Bit().data(), &status);
+    }
+
+    if (status == 0 && createImage(output, codec, bitpix, naxis, naxes, &status))
+    {
+        // Structural keywords are those of the compressed image, the others are copied.
+        char card[FLEN_CARD];
+        fits_get_hdrspace(input, &keys, nullptr, &status);
+        for (int i = 1; i <= keys && status == 0; i++)
+        {
+            fits_read_record(input, i, card, &status);
+            const int keyClass = fits_get_keyclass(card);
+            if (keyClass != TYP_STRUC_KEY && keyClass != TYP_CMPRS_KEY && keyClass != TYP_SCAL_KEY &&
+                    keyClass != TYP_CKSUM_KEY)
+                fits_write_record(output, card, &status);
+        }
+        writeImage(output, bitpix, naxes[0], naxes[1], naxes[2], pixels.data(), &status);
+    }
+
+    int closeStatus = 0;
+    if (input)
+        fits_close_file(input, &closeStatus);
+    if (output)
+        fits_close_file(output, status ? &closeStatus : &status);
+
+    if (status)
+    {
+        if (output)
+            QFile::remove(filename);
+        if (error)
+        {
+            char message[FLEN_ERRMSG] = {0};
+            fits_get_errstatus(status, message);
+            *error = QString::fromLatin1(message);
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#ifdef WIN32
+// This header must be included before fitsio.h to avoid compiler errors with Visual Studio
+#include <windows.h>
+#endif
+
+#include <fitsio.h>
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @class FITSCompressedWriter
+ * @short Writes lossless tile compressed FITS images, compressing the tiles in parallel.
+ *
+ * cfitsio compresses the tiles of an image one after the other while it is written. Here the image is
+ * created empty by cfitsio, with the usual ZIMAGE keywords. Its rows are then split in runs of tiles, each
+ * written by cfitsio to a compressed image of its own in memory, on the global thread pool, and the
+ * compressed tiles are copied from these to the table of the image.
+ * The files are read by any reader supporting tile compression, like funpack or KStars itself.
+ *
+ * Floating point and 64 bit images are always compressed with GZIP, Rice would not be lossless.
+ *
+ * @author KStars Developers
+ */
+class FITSCompressedWriter
+{
+    public:
+        // Values of Options::fitsCompression()
+        typedef enum
+        {
+            NO_COMPRESSION,
+            RICE,
+            GZIP
+        } Codec;
+
+        /**
+         * @brief createImage Create a tile compressed image HDU, as fits_create_img() does.
+         * @param bitpix Equivalent BITPIX of the image, e.g. USHORT_IMG for 16 bit unsigned data.
+         */
+        static bool createImage(fitsfile *fptr, Codec codec, int bitpix, int naxis, long *naxes, int *status);
+
+        /**
+         * @brief writeImage Compress and write the pixels of an image created by createImage().
+         * @param buffer Pixels, in the native type of bitpix (unsigned 32 bit integers for ULONG_IMG).
+         */
+        static bool writeImage(fitsfile *fptr, int bitpix, long width, long height, long channels, const void *buffer,
+                               int *status);
+
+        /**
+         * @brief writeFile Compress a FITS file held in memory, e.g. a captured frame, to filename.
+         * The header of the first image is kept, other HDUs are dropped.
+         */
+        static bool writeFile(const QString &filename, const QByteArray &fits, Codec codec, QString *error = nullptr);
+};
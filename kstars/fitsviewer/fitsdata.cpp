@@ -9,13 +9,12 @@
 
 #include "fitsdata.h"
 #include "fitsbahtinovdetector.h"
+#include "fitscompressedwriter.h"
 #include "fitsthresholddetector.h"
 #include "fitsgradientdetector.h"
 #include "fitscentroiddetector.h"
 #include "fitssepdetector.h"
 
-#include "fpack.h"
-
 #include "kstarsdata.h"
 #include "ksutils.h"
 #include "kspaths.h"
@@ -28,6 +27,7 @@
 #include <QApplication>
 #include <QImage>
 #include <QtConcurrent>
+#include <QThread>
 #include <QImageReader>
 #include <QUrl>
 #include <QNetworkAccessManager>
@@ -47,6 +47,9 @@
 
 #include <cfloat>
 #include <cmath>
+#include <cstdlib>
+#include <numeric>
+#include <type_traits>
 
 #include <fits_debug.h>
 
@@ -152,8 +155,6 @@ FITSData::~FITSData()
     {
         fits_flush_file(fptr, &status);
         fits_close_file(fptr, &status);
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         fptr = nullptr;
     }
 
@@ -180,6 +181,7 @@ FITSData::~FITSData()
         fits_close_file(m_Stackfptr, &status);
         m_Stackfptr = nullptr;
     }
+    m_StackPrefetch.clear();
     m_StackFITSWatcher.waitForFinished();
     m_StackWatcher.waitForFinished();
 }
@@ -194,10 +196,9 @@ void FITSData::loadCommon(const QString &inFilename)
     {
         fits_flush_file(fptr, &status);
         fits_close_file(fptr, &status);
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         fptr = nullptr;
     }
+    m_FileBuffer.clear();
 
     m_Filename = inFilename;
 }
@@ -341,6 +342,7 @@ void FITSData::checkCancelStack()
 
         // Drain any subs in the work Q
         m_StackQ.clear();
+        m_StackPrefetch.clear();
 
         emit stackReady();
     }
@@ -408,10 +410,14 @@ bool FITSData::processNextSub(QString &sub)
     m_StackFITSAsync = stackFITSSub;
     qCDebug(KSTARS_FITS) << "Loading sub" << sub;
 
+    // Pick up the sub if it has already been read ahead and start reading the ones after it
+    QFuture<QByteArray> prefetch = m_StackPrefetch.take(sub);
+    prefetchSubs();
+
     // Lambda to load the sub in the background
-    QFuture<bool> future = QtConcurrent::run([this, sub]() -> bool
+    QFuture<bool> future = QtConcurrent::run([this, sub, prefetch]() -> bool
     {
-        bool ok = stackLoadFITSImage(sub, false);
+        bool ok = stackLoadFITSImage(sub, false, prefetch.isCanceled() ? QByteArray() : prefetch.result());
         if (!ok)
             qCDebug(KSTARS_FITS) << QString("Unable to load sub %1").arg(sub);
         else
@@ -437,6 +443,24 @@ bool FITSData::processNextSub(QString &sub)
     return true;
 }
 
+void FITSData::prefetchSubs()
+{
+    for (int i = m_StackSubPos + 1; i < m_StackSubs.size() && i <= m_StackSubPos + STACK_PREFETCH_DEPTH; i++)
+    {
+        const QString sub = m_StackSubs[i];
+        if (m_StackPrefetch.contains(sub))
+            continue;
+
+        m_StackPrefetch.insert(sub, QtConcurrent::run([sub]() -> QByteArray
+        {
+            QFile file(sub);
+            if (!file.open(QIODevice::ReadOnly))
+                return QByteArray();
+            return file.readAll();
+        }));
+    }
+}
+
 void FITSData::processMasters()
 {
     // Dark
@@ -550,6 +574,8 @@ void FITSData::stackFITSLoaded()
                 }
                 // We're not plate solving so update sub status to good and emit stats
                 m_Stack->addSubStatus(true);
+                if (m_DarkLoaded && m_FlatLoaded)
+                    m_Stack->prepareSubAsync();
                 emit stackUpdateStats(true, m_StackSubPos, m_StackDirWatcher->getCurrentFiles().size(), m_Stack->getMeanSubSNR(),
                                       m_Stack->getMinSubSNR(), m_Stack->getMaxSubSNR());
             }
@@ -572,6 +598,11 @@ void FITSData::solverDone(const bool timedOut, const bool success, const double
 {
     bool ok = m_Stack->solverDone(m_StackWCSHandle, timedOut, success, hfr, numStars);
 
+    // Calibrate and align this sub in the background while the next one is loaded and solved. Masters are
+    // only loaded after the subs of the initial stack so in that case this is left to stack()
+    if (ok && m_DarkLoaded && m_FlatLoaded)
+        m_Stack->prepareSubAsync();
+
     emit stackUpdateStats(ok, m_StackSubPos, m_StackDirWatcher->getCurrentFiles().size(), m_Stack->getMeanSubSNR(),
                           m_Stack->getMinSubSNR(), m_Stack->getMaxSubSNR());
     nextStackAction();
@@ -739,6 +770,91 @@ QString fitsErrorToString(int status)
     QString message = error_status;
     return message;
 }
+
+// Move to the first HDU with image data. Tile compressed images are stored after an empty primary HDU.
+bool moveToImageHDU(fitsfile *fptr, int *status)
+{
+    int hdus = 0;
+    if (fits_get_num_hdus(fptr, &hdus, status))
+        return false;
+    for (int hdu = 1; hdu <= hdus; hdu++)
+    {
+        int type = 0, naxis = 0;
+        if (fits_movabs_hdu(fptr, hdu, &type, status) || fits_get_img_dim(fptr, &naxis, status))
+            return false;
+        if (type == IMAGE_HDU && naxis > 0)
+            return true;
+    }
+    *status = NOT_IMAGE;
+    return false;
+}
+
+// Decode a tile compressed image held in memory straight into buffer.
+// The rows of tiles are split in bands, each decoded in parallel with its own cfitsio handle on the same memory.
+bool readCompressedImage(fitsfile *fptr, const QByteArray &file, int dataType, int bytesPerPixel,
+                         long width, long height, long channels, uint8_t *buffer, int *status)
+{
+    // Tiles are whole rows unless ZTILE2 says otherwise.
+    long tileHeight = 1;
+    int keyStatus = 0;
+    if (fits_read_key_lng(fptr, "ZTILE2", &tileHeight, nullptr, &keyStatus) || tileHeight < 1)
+        tileHeight = 1;
+    const long tileRows = (height + tileHeight - 1) / tileHeight;
+    const long bandsPerPlane = std::min<long>(tileRows, QThread::idealThreadCount());
+
+    // Handles can only be used concurrently if cfitsio was built thread safe.
+    int anynull = 0;
+    if (!fits_is_reentrant() || bandsPerPlane * channels <= 1)
+        return fits_read_img(fptr, dataType, 1, width * height * channels, nullptr, buffer, &anynull, status) == 0;
+
+    struct Band
+    {
+        long plane, firstRow, rows;
+    };
+    QVector<Band> bands;
+    for (long plane = 0; plane < channels; plane++)
+    {
+        for (long band = 0; band < bandsPerPlane; band++)
+        {
+            const long firstRow = tileRows * band / bandsPerPlane * tileHeight;
+            const long lastRow = std::min(height, tileRows * (band + 1) / bandsPerPlane * tileHeight);
+            bands.append({plane, firstRow, lastRow - firstRow});
+        }
+    }
+
+    int hdu = 0;
+    fits_get_hdu_num(fptr, &hdu);
+    QVector<int> statuses(bands.size(), 0);
+    QVector<int> indexes(bands.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&](int i)
+    {
+        const Band &band = bands[i];
+        fitsfile *bandFptr = nullptr;
+        void *memory = const_cast<char *>(file.constData());
+        size_t size = file.size();
+        int bandAnynull = 0;
+        long firstPixel[3] = { 1, band.firstRow + 1, band.plane + 1 };
+        uint8_t *output = buffer + (static_cast<size_t>(band.plane) * height + band.firstRow) * width * bytesPerPixel;
+        if (fits_open_memfile(&bandFptr, "", READONLY, &memory, &size, 0, nullptr, &statuses[i]) == 0)
+        {
+            if (fits_movabs_hdu(bandFptr, hdu, nullptr, &statuses[i]) == 0)
+                fits_read_pix(bandFptr, dataType, firstPixel, band.rows * width, nullptr, output, &bandAnynull, &statuses[i]);
+            int closeStatus = 0;
+            fits_close_file(bandFptr, &closeStatus);
+        }
+    });
+
+    for (int bandStatus : statuses)
+    {
+        if (bandStatus)
+        {
+            *status = bandStatus;
+            return false;
+        }
+    }
+    return true;
+}
 }
 
 bool FITSData::privateLoad(const QByteArray &buffer)
@@ -766,61 +882,40 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
 
     m_HistogramConstructed = false;
 
-    if (m_Extension.contains(".fz") || isCompressed)
+    const bool compressed = m_Extension.contains(".fz") || isCompressed;
+    if (compressed)
     {
-        fpstate fpvar;
-        fp_init (&fpvar);
-        bool rc = false;
-
+        // Compressed images are decoded from memory, tile by tile, without unpacking them first.
         if (buffer.isEmpty())
         {
             // Store so we don't lose.
             m_compressedFilename = m_Filename;
 
-            QString uncompressedFile = QDir::tempPath() + QString("/%1").arg(QUuid::createUuid().toString().remove(
-                                           QRegularExpression("[-{}]")));
-
-            rc = fp_unpack_file_to_fits(m_Filename.toLocal8Bit().data(), &fptr, fpvar) == 0;
-            if (rc)
+            QFile file(m_Filename);
+            if (!file.open(QIODevice::ReadOnly))
             {
-                m_Filename = uncompressedFile;
+                m_LastError = i18n("Error opening fits file %1 : %2", m_Filename, file.errorString());
+                return false;
             }
+            m_FileBuffer = file.readAll();
         }
         else
-        {
-            size_t m_PackBufferSize = 100000;
-            free(m_PackBuffer);
-            m_PackBuffer = (uint8_t *)malloc(m_PackBufferSize);
-            rc = fp_unpack_data_to_data(buffer.data(), buffer.size(), &m_PackBuffer, &m_PackBufferSize, fpvar) == 0;
-
-            if (rc)
-            {
-                void *data = reinterpret_cast<void *>(m_PackBuffer);
-                if (fits_open_memfile(&fptr, m_Filename.toLocal8Bit().data(), READONLY, &data, &m_PackBufferSize, 0,
-                                      nullptr, &status))
-                {
-                    m_LastError = i18n("Error reading fits buffer: %1.", fitsErrorToString(status));
-                    return false;
-                }
+            m_FileBuffer = buffer;
 
-                m_Statistics.size = m_PackBufferSize;
-            }
-            //rc = fp_unpack_data_to_fits(buffer.data(), buffer.size(), &fptr, fpvar) == 0;
-        }
-
-        if (rc == false)
+        m_FileBufferPtr = const_cast<char *>(m_FileBuffer.constData());
+        m_FileBufferSize = m_FileBuffer.size();
+        if (fits_open_memfile(&fptr, m_Filename.toLocal8Bit().data(), READONLY,
+                              &m_FileBufferPtr, &m_FileBufferSize, 0, nullptr, &status) ||
+                !moveToImageHDU(fptr, &status))
         {
-            free(m_PackBuffer);
-            m_PackBuffer = nullptr;
-            m_LastError = i18n("Failed to unpack compressed fits");
+            m_LastError = i18n("Failed to unpack compressed fits: %1", fitsErrorToString(status));
             qCCritical(KSTARS_FITS) << m_LastError;
             return false;
         }
 
         m_isTemporary = true;
         m_isCompressed = true;
-        m_Statistics.size = fptr->Fptr->logfilesize;
-
+        m_Statistics.size = m_FileBufferSize;
     }
     else if (buffer.isEmpty())
     {
@@ -835,31 +930,29 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
     }
     else
     {
-        // Read the FITS file from a memory buffer.
-        void *temp_buffer = const_cast<void *>(reinterpret_cast<const void *>(buffer.data()));
-        size_t temp_size = buffer.size();
+        // Read the FITS file from a memory buffer, in place.
+        m_FileBuffer = buffer;
+        m_FileBufferPtr = const_cast<char *>(m_FileBuffer.constData());
+        m_FileBufferSize = m_FileBuffer.size();
         if (fits_open_memfile(&fptr, m_Filename.toLocal8Bit().data(), READONLY,
-                              &temp_buffer, &temp_size, 0, nullptr, &status))
+                              &m_FileBufferPtr, &m_FileBufferSize, 0, nullptr, &status))
         {
             m_LastError = i18n("Error reading fits buffer: %1", fitsErrorToString(status));
             return false;
         }
 
-        m_Statistics.size = temp_size;
+        m_Statistics.size = m_FileBufferSize;
     }
 
-    if (fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
+    // Compressed images are already on their image HDU.
+    if (!compressed && fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
     {
 
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         m_LastError = i18n("Could not locate image HDU: %1", fitsErrorToString(status));
     }
 
     if (fits_get_img_param(fptr, 3, &m_FITSBITPIX, &(m_Statistics.ndim), naxes, &status))
     {
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         m_LastError = i18n("FITS file open error (fits_get_img_param): %1", fitsErrorToString(status));
         return false;
     }
@@ -876,8 +969,6 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
     {
         m_LastError = i18n("1D FITS images are not supported in KStars.");
         qCCritical(KSTARS_FITS) << m_LastError;
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         return false;
     }
 
@@ -932,8 +1023,6 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
     {
         m_LastError = i18n("Image has invalid dimensions %1x%2", naxes[0], naxes[1]);
         qCCritical(KSTARS_FITS) << m_LastError;
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         return false;
     }
 
@@ -963,8 +1052,6 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
         qCWarning(KSTARS_FITS) << "FITSData: Not enough memory for image_buffer channel. Requested: "
                                << m_ImageBufferSize << " bytes.";
         clearImageBuffers();
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
         return false;
     }
 
@@ -973,12 +1060,18 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
     flipVCounter   = 0;
     long nelements = m_Statistics.samples_per_channel * m_Statistics.channels;
 
-    if (fits_read_img(fptr, m_Statistics.dataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, &status))
+    if (compressed ? !readCompressedImage(fptr, m_FileBuffer, m_Statistics.dataType, m_Statistics.bytesPerPixel,
+                                          m_Statistics.width, m_Statistics.height, m_Statistics.channels, m_ImageBuffer, &status) :
+            fits_read_img(fptr, m_Statistics.dataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, &status))
     {
         m_LastError = i18n("Error reading image: %1", fitsErrorToString(status));
         return false;
     }
 
+    // The pixels are read, don't hold on to the whole file. A loaded image only needs its header from now on.
+    if (!compressed && !buffer.isEmpty() && !keepHeaderOnly())
+        return false;
+
     parseHeader();
 
     // Get UTC date time
@@ -1019,10 +1112,40 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
     return true;
 }
 
+bool FITSData::keepHeaderOnly()
+{
+    int status = 0;
+    LONGLONG headStart = 0, dataStart = 0, dataEnd = 0;
+    if (fits_get_hduaddrll(fptr, &headStart, &dataStart, &dataEnd, &status))
+    {
+        m_LastError = i18n("Could not locate image HDU: %1", fitsErrorToString(status));
+        return false;
+    }
+
+    // A copy of the headers up to the pixels, the buffer the image was loaded from is released
+    QByteArray header(m_FileBuffer.constData(), dataStart);
+    fits_close_file(fptr, &status);
+    fptr = nullptr;
+    status = 0;
+
+    m_FileBuffer = header;
+    m_FileBufferPtr = const_cast<char *>(m_FileBuffer.constData());
+    m_FileBufferSize = m_FileBuffer.size();
+    if (fits_open_memfile(&fptr, m_Filename.toLocal8Bit().data(), READONLY,
+                          &m_FileBufferPtr, &m_FileBufferSize, 0, nullptr, &status) ||
+            fits_movabs_hdu(fptr, 1, IMAGE_HDU, &status))
+    {
+        m_LastError = i18n("Error reading fits buffer: %1", fitsErrorToString(status));
+        return false;
+    }
+
+    return true;
+}
+
 // Load a FITS image temporarily for stacking so no need to setup all the global
 // variables required for a "normal" load
 #if !defined (KSTARS_LITE) && defined (HAVE_WCSLIB) && defined (HAVE_OPENCV)
-bool FITSData::stackLoadFITSImage(QString filename, const bool isCompressed)
+bool FITSData::stackLoadFITSImage(QString filename, const bool isCompressed, const QByteArray &fileBuffer)
 {
     int status = 0, anynull = 0;
 
@@ -1035,25 +1158,46 @@ bool FITSData::stackLoadFITSImage(QString filename, const bool isCompressed)
         m_Stackfptr = nullptr;
         status = 0;
     }
+    m_StackFileBuffer.clear();
 
     QFileInfo info(filename);
     QString extension = info.completeSuffix().toLower();
 
     if (extension.contains(".fz") || isCompressed)
     {
-        fpstate fpvar;
-        fp_init (&fpvar);
-        bool rc = false;
-
-        QString uncompressedFile = QDir::tempPath() + QString("/%1").arg(QUuid::createUuid().toString().remove(
-                                                              QRegularExpression("[-{}]")));
-
-        rc = fp_unpack_file_to_fits(filename.toLocal8Bit().data(), &m_Stackfptr, fpvar) == 0;
-        if (rc)
-            filename = uncompressedFile;
+        // Compressed subs are decoded from memory, tile by tile, without unpacking them first.
+        if (!fileBuffer.isEmpty())
+            m_StackFileBuffer = fileBuffer;
         else
         {
-            qCDebug(KSTARS_FITS) << QString("Failed to unpack compressed fits file %1").arg(filename);
+            QFile file(filename);
+            if (!file.open(QIODevice::ReadOnly))
+            {
+                qCDebug(KSTARS_FITS) << QString("Error %1 opening fits file %2").arg(file.errorString()).arg(filename);
+                return false;
+            }
+            m_StackFileBuffer = file.readAll();
+        }
+        m_StackFileBufferPtr = const_cast<void *>(reinterpret_cast<const void *>(m_StackFileBuffer.constData()));
+        m_StackFileBufferSize = m_StackFileBuffer.size();
+        if (fits_open_memfile(&m_Stackfptr, filename.toLocal8Bit().data(), READONLY, &m_StackFileBufferPtr,
+                              &m_StackFileBufferSize, 0, nullptr, &status) || !moveToImageHDU(m_Stackfptr, &status))
+        {
+            qCDebug(KSTARS_FITS) << QString("Failed to unpack compressed fits file %1: %2").arg(filename)
+                                 .arg(fitsErrorToString(status));
+            return false;
+        }
+    }
+    else if (!fileBuffer.isEmpty())
+    {
+        // The sub has been read ahead so open it from memory
+        m_StackFileBuffer = fileBuffer;
+        m_StackFileBufferPtr = const_cast<void *>(reinterpret_cast<const void *>(m_StackFileBuffer.constData()));
+        m_StackFileBufferSize = m_StackFileBuffer.size();
+        if (fits_open_memfile(&m_Stackfptr, filename.toLocal8Bit().data(), READONLY, &m_StackFileBufferPtr,
+                              &m_StackFileBufferSize, 0, nullptr, &status))
+        {
+            qCDebug(KSTARS_FITS) << QString("Error %1 opening fits buffer %2").arg(fitsErrorToString(status)).arg(filename);
             return false;
         }
     }
@@ -1068,7 +1212,9 @@ bool FITSData::stackLoadFITSImage(QString filename, const bool isCompressed)
         }
     }
 
-    if (fits_movabs_hdu(m_Stackfptr, 1, IMAGE_HDU, &status))
+    // Compressed subs are already on their image HDU.
+    const bool compressed = extension.contains(".fz") || isCompressed;
+    if (!compressed && fits_movabs_hdu(m_Stackfptr, 1, IMAGE_HDU, &status))
     {
         qCDebug(KSTARS_FITS) << QString("Error %1 locating image HDU in %2").arg(fitsErrorToString(status)).arg(filename);
         return false;
@@ -1086,7 +1232,7 @@ bool FITSData::stackLoadFITSImage(QString filename, const bool isCompressed)
     if ((fits_is_compressed_image(m_Stackfptr, &status) || m_StackStatistics.stats.ndim <= 0) && !isCompressed)
     {
         qCDebug(KSTARS_FITS) << "Image is compressed. Reloading...";
-        return stackLoadFITSImage(filename, true);
+        return stackLoadFITSImage(filename, true, fileBuffer);
     }
 
     if (m_StackStatistics.stats.ndim < 2)
@@ -1184,7 +1330,12 @@ bool FITSData::stackLoadFITSImage(QString filename, const bool isCompressed)
     }
 
     long nelements = m_StackStatistics.stats.samples_per_channel * m_StackStatistics.stats.channels;
-    if (fits_read_img(m_Stackfptr, m_StackStatistics.stats.dataType, 1, nelements, nullptr, m_StackImageBuffer, &anynull, &status))
+    if (compressed ? !readCompressedImage(m_Stackfptr, m_StackFileBuffer, m_StackStatistics.stats.dataType,
+                                          m_StackStatistics.stats.bytesPerPixel, m_StackStatistics.stats.width,
+                                          m_StackStatistics.stats.height, m_StackStatistics.stats.channels,
+                                          m_StackImageBuffer, &status) :
+            fits_read_img(m_Stackfptr, m_StackStatistics.stats.dataType, 1, nelements, nullptr, m_StackImageBuffer, &anynull,
+                          &status))
     {
         qCDebug(KSTARS_FITS) << QString("Error %1 reading image: %2").arg(fitsErrorToString(status)).arg(filename);
         return false;
@@ -1764,11 +1915,12 @@ bool FITSData::saveImage(const QString &newFilename)
         return true;
     }
 
-    if (m_isCompressed)
-    {
-        m_LastError = i18n("Saving compressed files is not supported.");
-        return false;
-    }
+    // The image is in memory, so it can be saved to any file, compressed or not.
+    // Saving to an .fz file compresses it with the tile compression of the options, Rice by default.
+    auto codec = FITSCompressedWriter::NO_COMPRESSION;
+    if (newFilename.endsWith(".fz"))
+        codec = Options::fitsCompression() > 0 ? static_cast<FITSCompressedWriter::Codec>(Options::fitsCompression()) :
+                FITSCompressedWriter::RICE;
 
     int status = 0;
     long nelements;
@@ -1827,6 +1979,7 @@ bool FITSData::saveImage(const QString &newFilename)
     if (fptr && fits_close_file(fptr, &status))
         // We can continue if the close fails, e.g. on a memory file
         status = 0;
+    m_FileBuffer.clear();
 
     /* Create a new File, overwriting existing*/
     if (fits_create_file(&new_fptr, QString("!%1").arg(newFilename).toLocal8Bit(), &status))
@@ -1844,7 +1997,12 @@ bool FITSData::saveImage(const QString &newFilename)
     long naxes[3] = {m_Statistics.width, m_Statistics.height, naxis};
 
     // JM 2020-12-28: Here we to use bitpix values
-    if (fits_create_img(fptr, m_FITSBITPIX, naxis, naxes, &status))
+    if (codec != FITSCompressedWriter::NO_COMPRESSION)
+        FITSCompressedWriter::createImage(fptr, codec, m_FITSBITPIX, naxis, naxes, &status);
+    else
+        fits_create_img(fptr, m_FITSBITPIX, naxis, naxes, &status);
+
+    if (status)
     {
         m_LastError = i18n("Failed to create image: %1", fitsErrorToString(status));
         return false;
@@ -1902,6 +2060,12 @@ bool FITSData::saveImage(const QString &newFilename)
             fits_write_key(fptr, TDOUBLE, "MEDIAN2", &m_Statistics.median[1], "Median Channel 2", &status);
             fits_write_key(fptr, TDOUBLE, "MEDIAN3", &m_Statistics.median[2], "Median Channel 3", &status);
         }
+        fits_write_key(fptr, TDOUBLE, "MAD1", &m_Statistics.mad[0], "Median Absolute Deviation Channel 1", &status);
+        if (channels() > 1)
+        {
+            fits_write_key(fptr, TDOUBLE, "MAD2", &m_Statistics.mad[1], "Median Absolute Deviation Channel 2", &status);
+            fits_write_key(fptr, TDOUBLE, "MAD3", &m_Statistics.mad[2], "Median Absolute Deviation Channel 3", &status);
+        }
     }
 
     // Standard Deviation
@@ -1992,7 +2156,13 @@ bool FITSData::saveImage(const QString &newFilename)
     rotCounter = flipHCounter = flipVCounter = 0;
 
     // Here we need to use the actual data type
-    if (fits_write_img(fptr, m_Statistics.dataType, 1, nelements, m_ImageBuffer, &status))
+    if (codec != FITSCompressedWriter::NO_COMPRESSION)
+        FITSCompressedWriter::writeImage(fptr, m_FITSBITPIX, m_Statistics.width, m_Statistics.height,
+                                         m_Statistics.channels, m_ImageBuffer, &status);
+    else
+        fits_write_img(fptr, m_Statistics.dataType, 1, nelements, m_ImageBuffer, &status);
+
+    if (status)
     {
         m_LastError = i18n("Failed to write image: %1", fitsErrorToString(status));
         return false;
@@ -2011,50 +2181,28 @@ void FITSData::clearImageBuffers()
 {
     delete[] m_ImageBuffer;
     m_ImageBuffer = nullptr;
-    if(m_ImageRoiBuffer != nullptr )
-    {
-        delete[] m_ImageRoiBuffer;
-        m_ImageRoiBuffer = nullptr;
-
-    }
     //m_BayerBuffer = nullptr;
 }
 
-void FITSData::makeRoiBuffer(QRect roi)
+void FITSData::calculateRoiStats(QRect roi)
 {
     if (!roi.isValid())
         return;
 
-    uint32_t channelSize = roi.height() * roi.width();
-    if(channelSize  > m_Statistics.samples_per_channel || channelSize == 1)
+    // The region is not copied, its statistics are calculated in the rows of the image.
+    // Selections are one based.
+    const QRect region = roi.translated(-1, -1).intersected(QRect(0, 0, m_Statistics.width, m_Statistics.height));
+    uint32_t channelSize = region.height() * region.width();
+    if(channelSize  > m_Statistics.samples_per_channel || channelSize <= 1)
     {
         return;
     }
-    if(m_ImageRoiBuffer != nullptr )
-    {
-        delete[] m_ImageRoiBuffer;
-        m_ImageRoiBuffer = nullptr;
-    }
-    int xoffset = roi.topLeft().x() - 1;
-    int yoffset = roi.topLeft().y() - 1;
-    uint32_t bpp = m_Statistics.bytesPerPixel;
-    m_ImageRoiBuffer = new uint8_t[roi.height()*roi.width()*m_Statistics.channels * m_Statistics.bytesPerPixel]();
-    for(int n = 0 ; n < m_Statistics.channels ; n++)
-    {
-        for(int i = 0; i < roi.height(); i++)
-        {
-            size_t i1 = n * channelSize * bpp +  i * roi.width() * bpp;
-            size_t i2 = n * m_Statistics.samples_per_channel * bpp + (yoffset + i) * width() * bpp + xoffset * bpp;
-            memcpy(&m_ImageRoiBuffer[i1],
-                   &m_ImageBuffer[i2],
-                   roi.width() * bpp);
-        }
 
-    }
-    memcpy(&m_ROIStatistics, &m_Statistics, sizeof(FITSImage::Statistic));
-    m_ROIStatistics.samples_per_channel = roi.height() * roi.width();
-    m_ROIStatistics.width = roi.width();
-    m_ROIStatistics.height = roi.height();
+    m_ROIRegion = region;
+    m_ROIStatistics = m_Statistics;
+    m_ROIStatistics.samples_per_channel = channelSize;
+    m_ROIStatistics.width = region.width();
+    m_ROIStatistics.height = region.height();
     calculateStats(false, true);
 }
 
@@ -2091,573 +2239,465 @@ void FITSData::setupWCSParams()
     }
 }
 
+void FITSData::reuseStatistics(const FITSImage::Statistic &previous, double exposure, double gain)
+{
+    m_PreviousStatistics = previous;
+    m_PreviousExposure = exposure;
+    m_PreviousGain = gain;
+    m_ReusePreviousStatistics = true;
+}
+
 void FITSData::calculateStats(bool refresh, bool roi)
 {
-    // Calculate min max
-    if(roi == false)
-    {
-        calculateMinMax(refresh);
-        calculateMedian(refresh);
+    FITSImage::Statistic &stats = roi ? m_ROIStatistics : m_Statistics;
 
-        // Try to read mean/median/stddev if in file
-        if (refresh == false && fptr)
+    // Whole frame statistics of a frame of the same train, only when loading
+    if (roi == false)
+    {
+        const FITSImage::Statistic &previous = m_PreviousStatistics;
+        // Frames of another exposure or gain have another background
+        auto sameSetting = [this](const char *key, double previousValue)
         {
             int status = 0;
-            int nfound = 0;
-            if (fits_read_key_dbl(fptr, "MEAN1", &m_Statistics.mean[0], nullptr, &status) == 0)
-                nfound++;
-            // NB. These could fail if missing, which is OK.
-            fits_read_key_dbl(fptr, "MEAN2", & m_Statistics.mean[1], nullptr, &status);
-            fits_read_key_dbl(fptr, "MEAN3", &m_Statistics.mean[2], nullptr, &status);
-
-            status = 0;
-            if (fits_read_key_dbl(fptr, "STDDEV1", &m_Statistics.stddev[0], nullptr, &status) == 0)
-                nfound++;
-            // NB. These could fail if missing, which is OK.
-            fits_read_key_dbl(fptr, "STDDEV2", &m_Statistics.stddev[1], nullptr, &status);
-            fits_read_key_dbl(fptr, "STDDEV3", &m_Statistics.stddev[2], nullptr, &status);
-
-            // If all is OK, we're done
-            if (nfound == 2)
-                return;
-        }
-
-        // Get standard deviation and mean in one run
-        switch (m_Statistics.dataType)
-        {
-            case TBYTE:
-                calculateStdDev<uint8_t>();
-                break;
-
-            case TSHORT:
-                calculateStdDev<int16_t>();
-                break;
-
-            case TUSHORT:
-                calculateStdDev<uint16_t>();
-                break;
-
-            case TLONG:
-                calculateStdDev<int32_t>();
-                break;
-
-            case TULONG:
-                calculateStdDev<uint32_t>();
-                break;
-
-            case TFLOAT:
-                calculateStdDev<float>();
-                break;
-
-            case TLONGLONG:
-                calculateStdDev<int64_t>();
-                break;
-
-            case TDOUBLE:
-                calculateStdDev<double>();
-                break;
-
-            default:
-                return;
+            double value = 0;
+            return previousValue < 0 || fptr == nullptr ||
+                   fits_read_key_dbl(fptr, key, &value, nullptr, &status) ||
+                   std::fabs(value - previousValue) <= 1e-6 * std::max(1.0, previousValue);
+        };
+        m_StatisticsReused = m_ReusePreviousStatistics && refresh == false && previous.width == m_Statistics.width &&
+                             previous.height == m_Statistics.height && previous.channels == m_Statistics.channels &&
+                             previous.dataType == m_Statistics.dataType && sameSetting("EXPTIME", m_PreviousExposure) &&
+                             sameSetting("GAIN", m_PreviousGain);
+        m_ReusePreviousStatistics = false;
+        if (m_StatisticsReused)
+        {
+            for (int n = 0; n < 3; n++)
+            {
+                m_Statistics.min[n] = previous.min[n];
+                m_Statistics.max[n] = previous.max[n];
+                m_Statistics.mean[n] = previous.mean[n];
+                m_Statistics.stddev[n] = previous.stddev[n];
+                m_Statistics.median[n] = previous.median[n];
+                m_Statistics.mad[n] = previous.mad[n];
+            }
+            m_Statistics.SNR = previous.SNR;
+            return;
         }
-
-        // FIXME That's not really SNR, must implement a proper solution for this value
-        m_Statistics.SNR = m_Statistics.mean[0] / m_Statistics.stddev[0];
     }
-    else
-    {
-        calculateMinMax(refresh, roi);
-        calculateMedian(refresh, roi);
 
-        switch (m_ROIStatistics.dataType)
+    // Try to read min/max, median, mean and stddev if in file
+    FITSImage::Statistic header;
+    bool haveMinMax = false, haveMedian = false, haveMeanStdDev = false;
+    if (roi == false && refresh == false && fptr)
+    {
+        // NB. These could fail if missing, which is OK.
+        auto readKey = [this](const char *key, double * value)
+        {
+            int status = 0;
+            return fits_read_key_dbl(fptr, key, value, nullptr, &status) == 0;
+        };
+
+        const bool haveMin = readKey("DATAMIN", &header.min[0]) || readKey("MIN1", &header.min[0]);
+        readKey("MIN2", &header.min[1]);
+        readKey("MIN3", &header.min[2]);
+        const bool haveMax = readKey("DATAMAX", &header.max[0]) || readKey("MAX1", &header.max[0]);
+        readKey("MAX2", &header.max[1]);
+        readKey("MAX3", &header.max[2]);
+        // If we found both keywords, no need to calculate them, unless they are both zeros
+        haveMinMax = haveMin && haveMax && !(header.min[0] == 0 && header.max[0] == 0);
+
+        // The median absolute deviation is calculated with the median, so both are needed
+        haveMedian = readKey("MEDIAN1", &header.median[0]) && readKey("MAD1", &header.mad[0]);
+        readKey("MEDIAN2", &header.median[1]);
+        readKey("MEDIAN3", &header.median[2]);
+        readKey("MAD2", &header.mad[1]);
+        readKey("MAD3", &header.mad[2]);
+
+        haveMeanStdDev = readKey("MEAN1", &header.mean[0]);
+        readKey("MEAN2", &header.mean[1]);
+        readKey("MEAN3", &header.mean[2]);
+        haveMeanStdDev = readKey("STDDEV1", &header.stddev[0]) && haveMeanStdDev;
+        readKey("STDDEV2", &header.stddev[1]);
+        readKey("STDDEV3", &header.stddev[2]);
+    }
+
+    // Whatever is missing is calculated in one run over each channel
+    if (!haveMinMax || !haveMedian || !haveMeanStdDev)
+    {
+        switch (stats.dataType)
         {
             case TBYTE:
-                calculateStdDev<uint8_t>(roi);
+                calculateStatsInternal<uint8_t>(roi, true, !haveMedian);
                 break;
 
             case TSHORT:
-                calculateStdDev<int16_t>(roi);
+                calculateStatsInternal<int16_t>(roi, true, !haveMedian);
                 break;
 
             case TUSHORT:
-                calculateStdDev<uint16_t>(roi);
+                calculateStatsInternal<uint16_t>(roi, true, !haveMedian);
                 break;
 
             case TLONG:
-                calculateStdDev<int32_t>(roi);
+                calculateStatsInternal<int32_t>(roi, true, !haveMedian);
                 break;
 
             case TULONG:
-                calculateStdDev<uint32_t>(roi);
+                calculateStatsInternal<uint32_t>(roi, true, !haveMedian);
                 break;
 
             case TFLOAT:
-                calculateStdDev<float>(roi);
+                calculateStatsInternal<float>(roi, true, !haveMedian);
                 break;
 
             case TLONGLONG:
-                calculateStdDev<int64_t>(roi);
+                calculateStatsInternal<int64_t>(roi, true, !haveMedian);
                 break;
 
             case TDOUBLE:
-                calculateStdDev<double>(roi);
+                calculateStatsInternal<double>(roi, true, !haveMedian);
                 break;
 
             default:
                 return;
         }
     }
-}
 
-void FITSData::calculateMinMax(bool refresh, bool roi)
-{
-    if(roi == false)
+    for (int n = 0; n < 3; n++)
     {
-        int status, nfound = 0;
-
-        status = 0;
-
-        // Only fetch from header if we have a single channel
-        // Otherwise, calculate manually.
-        if (fptr != nullptr && !refresh)
+        if (haveMinMax)
         {
-
-            status = 0;
-
-            if (fits_read_key_dbl(fptr, "DATAMIN", &(m_Statistics.min[0]), nullptr, &status) == 0)
-                nfound++;
-            else if (fits_read_key_dbl(fptr, "MIN1", &(m_Statistics.min[0]), nullptr, &status) == 0)
-                nfound++;
-
-            // NB. These could fail if missing, which is OK.
-            fits_read_key_dbl(fptr, "MIN2", &m_Statistics.min[1], nullptr, &status);
-            fits_read_key_dbl(fptr, "MIN3", &m_Statistics.min[2], nullptr, &status);
-
-            status = 0;
-
-            if (fits_read_key_dbl(fptr, "DATAMAX", &(m_Statistics.max[0]), nullptr, &status) == 0)
-                nfound++;
-            else if (fits_read_key_dbl(fptr, "MAX1", &(m_Statistics.max[0]), nullptr, &status) == 0)
-                nfound++;
-
-            // NB. These could fail if missing, which is OK.
-            fits_read_key_dbl(fptr, "MAX2", &m_Statistics.max[1], nullptr, &status);
-            fits_read_key_dbl(fptr, "MAX3", &m_Statistics.max[2], nullptr, &status);
-
-            // If we found both keywords, no need to calculate them, unless they are both zeros
-            if (nfound == 2 && !(m_Statistics.min[0] == 0 && m_Statistics.max[0] == 0))
-                return;
+            stats.min[n] = header.min[n];
+            stats.max[n] = header.max[n];
         }
-
-        m_Statistics.min[0] = 1.0E30;
-        m_Statistics.max[0] = -1.0E30;
-
-        m_Statistics.min[1] = 1.0E30;
-        m_Statistics.max[1] = -1.0E30;
-
-        m_Statistics.min[2] = 1.0E30;
-        m_Statistics.max[2] = -1.0E30;
-
-        switch (m_Statistics.dataType)
+        if (haveMedian)
         {
-            case TBYTE:
-                calculateMinMax<uint8_t>();
-                break;
-
-            case TSHORT:
-                calculateMinMax<int16_t>();
-                break;
+            stats.median[n] = header.median[n];
+            stats.mad[n] = header.mad[n];
+        }
+        if (haveMeanStdDev)
+        {
+            stats.mean[n] = header.mean[n];
+            stats.stddev[n] = header.stddev[n];
+        }
+    }
 
-            case TUSHORT:
-                calculateMinMax<uint16_t>();
-                break;
+    // FIXME That's not really SNR, must implement a proper solution for this value
+    if (roi == false)
+        m_Statistics.SNR = m_Statistics.mean[0] / m_Statistics.stddev[0];
+}
 
-            case TLONG:
-                calculateMinMax<int32_t>();
-                break;
+namespace
+{
+// Samples of a block, processed while they are in the L1 cache
+constexpr uint32_t STATS_BLOCK_SIZE = 4096;
+// Bins of the histogram locating the median of 32 and 64 bit images
+constexpr int MEDIAN_BIN_COUNT = 65536;
 
-            case TULONG:
-                calculateMinMax<uint32_t>();
-                break;
+// 8 and 16 bit integer images are counted per value, which gives their exact median
+template <typename T>
+constexpr bool statsCountValues()
+{
+    return std::is_integral<T>::value && sizeof(T) <= 2;
+}
 
-            case TFLOAT:
-                calculateMinMax<float>();
-                break;
+// Results of the run over a part of a channel, see statsOfRegion()
+template <typename T>
+struct ChannelStats
+{
+    T min { std::numeric_limits<T>::max() };
+    T max { std::numeric_limits<T>::lowest() };
+    double sum { 0 };
+    double squaredSum { 0 };
+    // Number of samples of each value, only for statsCountValues() types
+    std::vector<uint32_t> counts;
+};
 
-            case TLONGLONG:
-                calculateMinMax<int64_t>();
-                break;
+// Rows of a region processed by one thread
+struct StatsPartition
+{
+    size_t offset;
+    uint32_t width;
+    uint32_t rows;
+};
 
-            case TDOUBLE:
-                calculateMinMax<double>();
-                break;
+// Split a region of rows of width samples, stride samples apart, in parts for the thread pool
+QVector<StatsPartition> statsPartitions(uint32_t width, uint32_t height, uint32_t stride)
+{
+    // Rows following each other are a single run
+    if (stride == width)
+    {
+        width *= height;
+        height = 1;
+    }
 
-            default:
-                break;
-        }
+    // Small regions, e.g. guiding tracking boxes, are not worth splitting
+    uint32_t count = qBound<uint32_t>(1, width * height / (16 * STATS_BLOCK_SIZE), QThread::idealThreadCount());
+    QVector<StatsPartition> partitions;
+    if (height == 1)
+    {
+        const uint32_t step = width / count;
+        for (uint32_t i = 0; i < count; i++)
+            partitions.append(StatsPartition { static_cast<size_t>(i) * step, i == count - 1 ? width - i * step : step, 1 });
     }
     else
     {
-        m_ROIStatistics.min[0] = 1.0E30;
-        m_ROIStatistics.max[0] = -1.0E30;
-
-        m_ROIStatistics.min[1] = 1.0E30;
-        m_ROIStatistics.max[1] = -1.0E30;
-
-        m_ROIStatistics.min[2] = 1.0E30;
-        m_ROIStatistics.max[2] = -1.0E30;
-
-        switch (m_Statistics.dataType)
-        {
-            case TBYTE:
-                calculateMinMax<uint8_t>(roi);
-                break;
-
-            case TSHORT:
-                calculateMinMax<int16_t>(roi);
-                break;
-
-            case TUSHORT:
-                calculateMinMax<uint16_t>(roi);
-                break;
-
-            case TLONG:
-                calculateMinMax<int32_t>(roi);
-                break;
-
-            case TULONG:
-                calculateMinMax<uint32_t>(roi);
-                break;
-
-            case TFLOAT:
-                calculateMinMax<float>(roi);
-                break;
-
-            case TLONGLONG:
-                calculateMinMax<int64_t>(roi);
-                break;
-
-            case TDOUBLE:
-                calculateMinMax<double>(roi);
-                break;
-
-            default:
-                break;
-        }
-
+        count = std::min(count, height);
+        const uint32_t step = height / count;
+        for (uint32_t i = 0; i < count; i++)
+            partitions.append(StatsPartition { static_cast<size_t>(i) * step * stride, width, i == count - 1 ? height - i * step : step });
     }
+    return partitions;
 }
 
-void FITSData::calculateMedian(bool refresh, bool roi)
+template <typename T>
+void accumulateStats(ChannelStats<T> &stats, const T *values, uint32_t count)
 {
-    if(!roi)
-    {
-        int status, nfound = 0;
-
-        status = 0;
+    // Small integers are summed exactly, a block cannot overflow
+    using Sum = typename std::conditional<statsCountValues<T>(), int64_t, double>::type;
 
-        // Only fetch from header if we have a single channel
-        // Otherwise, calculate manually.
-        if (fptr != nullptr && !refresh)
+    for (uint32_t block = 0; block < count; block += STATS_BLOCK_SIZE)
+    {
+        const uint32_t blockEnd = std::min(count, block + STATS_BLOCK_SIZE);
+        T min = stats.min, max = stats.max;
+        Sum sum = 0, squaredSum = 0;
+        // No branches nor function calls, so that the compiler vectorizes the loop
+        for (uint32_t i = block; i < blockEnd; i++)
         {
-            status = 0;
-            if (fits_read_key_dbl(fptr, "MEDIAN1", &m_Statistics.median[0], nullptr, &status) == 0)
-                nfound++;
-
-            // NB. These could fail if missing, which is OK.
-            fits_read_key_dbl(fptr, "MEDIAN2", &m_Statistics.median[1], nullptr, &status);
-            fits_read_key_dbl(fptr, "MEDIAN3", &m_Statistics.median[2], nullptr, &status);
-
-            if (nfound == 1)
-                return;
+            const T value = values[i];
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+            sum += value;
+            squaredSum += static_cast<Sum>(value) * value;
         }
+        stats.min = min;
+        stats.max = max;
+        stats.sum += sum;
+        stats.squaredSum += squaredSum;
 
-        m_Statistics.median[RED_CHANNEL] = 0;
-        m_Statistics.median[GREEN_CHANNEL] = 0;
-        m_Statistics.median[BLUE_CHANNEL] = 0;
-
-        switch (m_Statistics.dataType)
+        if constexpr (statsCountValues<T>())
         {
-            case TBYTE:
-                calculateMedian<uint8_t>();
-                break;
-
-            case TSHORT:
-                calculateMedian<int16_t>();
-                break;
-
-            case TUSHORT:
-                calculateMedian<uint16_t>();
-                break;
-
-            case TLONG:
-                calculateMedian<int32_t>();
-                break;
-
-            case TULONG:
-                calculateMedian<uint32_t>();
-                break;
-
-            case TFLOAT:
-                calculateMedian<float>();
-                break;
-
-            case TLONGLONG:
-                calculateMedian<int64_t>();
-                break;
-
-            case TDOUBLE:
-                calculateMedian<double>();
-                break;
-
-            default:
-                break;
+            for (uint32_t i = block; i < blockEnd; i++)
+                stats.counts[values[i] - std::numeric_limits<T>::lowest()]++;
         }
     }
-    else
-    {
-        m_ROIStatistics.median[RED_CHANNEL] = 0;
-        m_ROIStatistics.median[GREEN_CHANNEL] = 0;
-        m_ROIStatistics.median[BLUE_CHANNEL] = 0;
-
-        switch (m_ROIStatistics.dataType)
-        {
-            case TBYTE:
-                calculateMedian<uint8_t>(roi);
-                break;
-
-            case TSHORT:
-                calculateMedian<int16_t>(roi);
-                break;
-
-            case TUSHORT:
-                calculateMedian<uint16_t>(roi);
-                break;
-
-            case TLONG:
-                calculateMedian<int32_t>(roi);
-                break;
-
-            case TULONG:
-                calculateMedian<uint32_t>(roi);
-                break;
-
-            case TFLOAT:
-                calculateMedian<float>(roi);
-                break;
-
-            case TLONGLONG:
-                calculateMedian<int64_t>(roi);
-                break;
-
-            case TDOUBLE:
-                calculateMedian<double>(roi);
-                break;
-
-            default:
-                break;
-        }
-
-    }
 }
 
 template <typename T>
-void FITSData::calculateMedian(bool roi)
+ChannelStats<T> statsOfPartition(const T *buffer, StatsPartition partition, uint32_t stride)
 {
-    auto * buffer = reinterpret_cast<T *>(roi ? m_ImageRoiBuffer : m_ImageBuffer);
-    const uint32_t maxMedianSize = 500000;
-    uint32_t medianSize = roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel;
-    uint8_t downsample = 1;
-    if (medianSize > maxMedianSize)
-    {
-        downsample = (static_cast<double>(medianSize) / maxMedianSize) + 0.999;
-        medianSize /= downsample;
-    }
-    // Ideally samples would be declared like this...
-    // std::vector<T> samples;
-    // Unfortunately this doesn't compile on Mac - see the comments in robuststatistics.cpp for more details
-    // So for now declare samples like this...
-    std::vector<int32_t> samples;
-    samples.reserve(medianSize);
+    ChannelStats<T> stats;
+    if constexpr (statsCountValues<T>())
+        stats.counts.assign(size_t(1) << (8 * sizeof(T)), 0);
 
-    for (uint8_t n = 0; n < m_Statistics.channels; n++)
-    {
-        auto *oneChannel = buffer + n * (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel);
-        for (uint32_t upto = 0; upto < (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel);
-                upto += downsample)
-            samples.push_back(oneChannel[upto]);
-        auto median = Mathematics::RobustStatistics::ComputeLocation(Mathematics::RobustStatistics::LOCATION_MEDIAN, samples);
-        roi ? m_ROIStatistics.median[n] = median : m_Statistics.median[n] = median;
-    }
+    for (uint32_t row = 0; row < partition.rows; row++)
+        accumulateStats(stats, buffer + partition.offset + static_cast<size_t>(row) * stride, partition.width);
+    return stats;
 }
 
+// Run the parts of a region of a channel on the thread pool, and merge their results
 template <typename T>
-QPair<T, T> FITSData::getParitionMinMax(uint32_t start, uint32_t stride, bool roi)
+ChannelStats<T> statsOfRegion(const T *buffer, uint32_t width, uint32_t height, uint32_t stride)
 {
-    auto * buffer = reinterpret_cast<T *>(roi ? m_ImageRoiBuffer : m_ImageBuffer);
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
+    const QVector<StatsPartition> partitions = statsPartitions(width, height, stride);
 
-    uint32_t end = start + stride;
+    QList<QFuture<ChannelStats<T>>> futures;
+    for (int i = 1; i < partitions.size(); i++)
+        futures.append(QtConcurrent::run(&statsOfPartition<T>, buffer, partitions[i], stride));
 
-    for (uint32_t i = start; i < end; i++)
+    ChannelStats<T> stats = statsOfPartition<T>(buffer, partitions[0], stride);
+    for (auto &future : futures)
     {
-        min = qMin(buffer[i], min);
-        max = qMax(buffer[i], max);
-        //        if (buffer[i] < min)
-        //            min = buffer[i];
-        //        else if (buffer[i] > max)
-        //            max = buffer[i];
+        const ChannelStats<T> &result = future.result();
+        stats.min = std::min(stats.min, result.min);
+        stats.max = std::max(stats.max, result.max);
+        stats.sum += result.sum;
+        stats.squaredSum += result.squaredSum;
+        for (size_t j = 0; j < result.counts.size(); j++)
+            stats.counts[j] += result.counts[j];
     }
-
-    return qMakePair(min, max);
+    return stats;
 }
 
+// Median from the number of samples of each value, as the average of the two middle samples
 template <typename T>
-void FITSData::calculateMinMax(bool roi)
+double medianOfCounts(const std::vector<uint32_t> &counts, uint32_t samples)
 {
-    T min = std::numeric_limits<T>::max();
-    T max = std::numeric_limits<T>::min();
-
-
-    // Create N threads
-    const uint8_t nThreads = 16;
+    const uint32_t lowRank = (samples - 1) / 2, highRank = samples / 2;
+    double low = 0;
+    uint32_t below = 0;
+    for (size_t value = 0; value < counts.size(); value++)
+    {
+        if (below <= lowRank && lowRank < below + counts[value])
+            low = static_cast<double>(value) + std::numeric_limits<T>::lowest();
+        if (below <= highRank && highRank < below + counts[value])
+            return (low + static_cast<double>(value) + std::numeric_limits<T>::lowest()) / 2;
+        below += counts[value];
+    }
+    return low;
+}
 
-    for (int n = 0; n < m_Statistics.channels; n++)
+// Median absolute deviation from the number of samples of each value. The deviations are counted
+// in half steps, as the median is halfway between two values when they differ.
+template <typename T>
+double madOfCounts(const std::vector<uint32_t> &counts, uint32_t samples, double median)
+{
+    const int64_t twiceMedian = std::llround(2 * (median - std::numeric_limits<T>::lowest()));
+    std::vector<uint32_t> deviations(2 * counts.size() + 1, 0);
+    for (size_t value = 0; value < counts.size(); value++)
     {
-        uint32_t cStart = n * (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel);
-
-        // Calculate how many elements we process per thread
-        uint32_t tStride = (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel) / nThreads;
-
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + ((roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel) -
-                                      (tStride * nThreads));
-
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
-
-        // List of futures
-        QList<QFuture<QPair<T, T>>> futures;
+        if (counts[value] > 0)
+            deviations[std::llabs(2 * static_cast<int64_t>(value) - twiceMedian)] += counts[value];
+    }
+    return medianOfCounts<uint32_t>(deviations, samples) / 2;
+}
 
-        for (int i = 0; i < nThreads; i++)
-        {
-            // Run threads
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-            futures.append(QtConcurrent::run(&FITSData::getParitionMinMax<T>, this, tStart, (i == (nThreads - 1)) ? fStride : tStride,
-                                             roi));
-#else
-            futures.append(QtConcurrent::run(this, &FITSData::getParitionMinMax<T>, tStart, (i == (nThreads - 1)) ? fStride : tStride,
-                                             roi));
-#endif
-            tStart += tStride;
-        }
+// Median of larger types. A histogram locates the bins of the two middle samples,
+// then only the samples of these bins are sorted to find their exact values.
+// The samples are valueOf() the pixels, all within [low, high].
+template <typename T, typename F>
+double medianOfBins(const T *buffer, uint32_t width, uint32_t height, uint32_t stride, double low, double high,
+                    F valueOf)
+{
+    if (!(low < high))
+        return low;
 
-        // Now wait for results
-        for (int i = 0; i < nThreads; i++)
+    using V = decltype(valueOf(T()));
+    const double scale = MEDIAN_BIN_COUNT / (high - low);
+    auto binOf = [low, scale](V value)
+    {
+        const double offset = (static_cast<double>(value) - low) * scale;
+        return offset > 0 ? std::min(MEDIAN_BIN_COUNT - 1, static_cast<int>(offset)) : 0;
+    };
+    // Calls function on the value of each sample of a partition
+    auto forEachSample = [buffer, stride, valueOf](const StatsPartition & partition, auto function)
+    {
+        for (uint32_t row = 0; row < partition.rows; row++)
         {
-            QPair<T, T> result = futures[i].result();
-            min = qMin(result.first, min);
-            max = qMax(result.second, max);
+            const T *values = buffer + partition.offset + static_cast<size_t>(row) * stride;
+            for (uint32_t i = 0; i < partition.width; i++)
+                function(valueOf(values[i]));
         }
+    };
 
-        if(!roi)
-        {
-            m_Statistics.min[n] = min;
-            m_Statistics.max[n] = max;
-        }
-        else
+    // Not a number samples (blank pixels) are ignored
+    const QVector<StatsPartition> partitions = statsPartitions(width, height, stride);
+    QList<QFuture<std::vector<uint32_t>>> histograms;
+    for (const auto &partition : partitions)
+    {
+        histograms.append(QtConcurrent::run([ =, &binOf, &forEachSample]()
         {
-            m_ROIStatistics.min[n] = min;
-            m_ROIStatistics.max[n] = max;
-        }
+            std::vector<uint32_t> bins(MEDIAN_BIN_COUNT, 0);
+            forEachSample(partition, [&](V value)
+            {
+                if (value == value)
+                    bins[binOf(value)]++;
+            });
+            return bins;
+        }));
     }
 
-}
+    std::vector<uint32_t> bins = histograms[0].result();
+    for (int i = 1; i < histograms.size(); i++)
+    {
+        const std::vector<uint32_t> &result = histograms[i].result();
+        for (int j = 0; j < MEDIAN_BIN_COUNT; j++)
+            bins[j] += result[j];
+    }
 
-// This struct is used when returning results from the threaded getSumAndSquaredSum calculations
-// used to compute the mean and variance of the image.
-struct SumData
-{
-    double sum;
-    double squaredSum;
-    double numSamples;
-    SumData(double s, double sq, int n) : sum(s), squaredSum(sq), numSamples(n) {}
-    SumData() : sum(0), squaredSum(0), numSamples(0) {}
-};
+    const uint32_t count = std::accumulate(bins.begin(), bins.end(), 0u);
+    if (count == 0)
+        return 0;
+    const uint32_t lowRank = (count - 1) / 2, highRank = count / 2;
+    int lowBin = 0;
+    uint32_t below = 0;
+    while (below + bins[lowBin] <= lowRank)
+        below += bins[lowBin++];
+    int highBin = lowBin;
+    uint32_t belowHigh = below;
+    while (belowHigh + bins[highBin] <= highRank)
+        belowHigh += bins[highBin++];
+
+    // Exact values, from the few samples of the middle bins
+    QList<QFuture<std::vector<V>>> selections;
+    for (const auto &partition : partitions)
+    {
+        selections.append(QtConcurrent::run([ =, &binOf, &forEachSample]()
+        {
+            std::vector<V> selected;
+            forEachSample(partition, [&](V value)
+            {
+                const int bin = value == value ? binOf(value) : -1;
+                if (bin >= lowBin && bin <= highBin)
+                    selected.push_back(value);
+            });
+            return selected;
+        }));
+    }
 
-template <typename T>
-SumData getSumAndSquaredSum(uint32_t start, uint32_t stride, uint8_t *buff)
-{
-    auto * buffer = reinterpret_cast<T *>(buff);
-    const uint32_t end = start + stride;
-    double sum = 0;
-    double squaredSum = 0;
-    for (uint32_t i = start; i < end; i++)
+    std::vector<V> selected;
+    for (auto &selection : selections)
     {
-        double sample = buffer[i];
-        sum += sample;
-        squaredSum += sample * sample;
+        const std::vector<V> &result = selection.result();
+        selected.insert(selected.end(), result.begin(), result.end());
     }
-    const double numSamples = end - start;
-    return SumData(sum, squaredSum, numSamples);
+
+    auto lowSample = selected.begin() + (lowRank - below);
+    std::nth_element(selected.begin(), lowSample, selected.end());
+    const double lowValue = *lowSample;
+    const double highValue = highRank == lowRank ? lowValue : *std::min_element(lowSample + 1, selected.end());
+    return (lowValue + highValue) / 2;
+}
 }
 
 template <typename T>
-void FITSData::calculateStdDev(bool roi )
+void FITSData::calculateStatsInternal(bool roi, bool minMax, bool median)
 {
-    // Create N threads
-    const uint8_t nThreads = 16;
+    FITSImage::Statistic &stats = roi ? m_ROIStatistics : m_Statistics;
+    if (m_ImageBuffer == nullptr || stats.samples_per_channel == 0)
+        return;
+
+    // The region of interest is read in place, in the rows of the image
+    const QRect region = roi ? m_ROIRegion : QRect(0, 0, m_Statistics.width, m_Statistics.height);
+    const uint32_t stride = m_Statistics.width;
+    const uint32_t samples = region.width() * region.height();
 
     for (int n = 0; n < m_Statistics.channels; n++)
     {
-        uint32_t cStart = n * (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel);
+        const T * const origin = reinterpret_cast<T const *>(m_ImageBuffer) + n * m_Statistics.samples_per_channel +
+                                 region.y() * stride + region.x();
+        const ChannelStats<T> result = statsOfRegion<T>(origin, region.width(), region.height(), stride);
 
-        // Calculate how many elements we process per thread
-        uint32_t tStride = (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel) / nThreads;
+        const double mean = result.sum / samples;
+        const double variance = result.squaredSum / samples - mean * mean;
+        stats.mean[n] = mean;
+        stats.stddev[n] = sqrt(std::max(0.0, variance));
 
-        // Calculate the final stride since we can have some left over due to division above
-        uint32_t fStride = tStride + ((roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel) -
-                                      (tStride * nThreads));
-
-        // Start location for inspecting elements
-        uint32_t tStart = cStart;
-
-        // List of futures
-        QList<QFuture<SumData>> futures;
-
-        for (int i = 0; i < nThreads; i++)
+        if (minMax)
         {
-            // Run threads
-            uint8_t *buff = roi ? m_ImageRoiBuffer : m_ImageBuffer;
-            futures.append(QtConcurrent::run(&getSumAndSquaredSum<T>, tStart,
-                                             (i == (nThreads - 1)) ? fStride : tStride, buff));
-            tStart += tStride;
+            stats.min[n] = result.min;
+            stats.max[n] = result.max;
         }
 
-        // Now wait for results
-        double sum = 0, squared_sum = 0;
-        double numSamples = 0;
-        for (int i = 0; i < nThreads; i++)
-        {
-            const SumData result = futures[i].result();
-            sum += result.sum;
-            squared_sum += result.squaredSum;
-            numSamples += result.numSamples;
-
-        }
-        if (numSamples <= 0) continue;
-        const double mean = sum / numSamples;
-        const double variance = squared_sum / numSamples - mean * mean;
-        if(!roi)
+        if (median)
         {
-            m_Statistics.mean[n]   = mean;
-            m_Statistics.stddev[n] = sqrt(variance);
-        }
-        else
-        {
-            m_ROIStatistics.mean[n] = mean;
-            m_ROIStatistics.stddev[n] = sqrt(variance);
+            const auto identity = [](T value)
+            {
+                return value;
+            };
+            stats.median[n] = statsCountValues<T>() ? medianOfCounts<T>(result.counts, samples) :
+                              medianOfBins<T>(origin, region.width(), region.height(), stride, result.min, result.max,
+                                              identity);
+
+            // Median absolute deviation, found the same way
+            const double center = stats.median[n];
+            const auto deviation = [center](T value)
+            {
+                return std::fabs(static_cast<double>(value) - center);
+            };
+            stats.mad[n] = statsCountValues<T>() ? madOfCounts<T>(result.counts, samples, center) :
+                           medianOfBins<T>(origin, region.width(), region.height(), stride, 0,
+                                           std::max(center - result.min, result.max - center), deviation);
         }
     }
 }
@@ -2767,7 +2807,8 @@ bool FITSData::parseHeader(const bool stack)
     char * header = nullptr;
     int status = 0, nkeys = 0;
 
-    if (fits_hdr2str(stack ? m_Stackfptr : fptr, 0, nullptr, 0, &header, &nkeys, &status))
+    // Compressed images give the header of the equivalent uncompressed image.
+    if (fits_convert_hdr2str(stack ? m_Stackfptr : fptr, 0, nullptr, 0, &header, &nkeys, &status))
     {
         fits_report_error(stderr, status);
         free(header);
@@ -3498,7 +3539,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t * targetImage, QVector<double
                     m_Statistics.min[i] = min[i];
                     m_Statistics.max[i] = max[i];
                 }
-                calculateStdDev<T>();
+                calculateStatsInternal<T>(false, false, true);
             }
         }
         break;
@@ -3602,7 +3643,7 @@ void FITSData::applyFilter(FITSScale type, uint8_t * targetImage, QVector<double
             delete[] extension;
 
             if (calcStats)
-                calculateStdDev<T>();
+                calculateStatsInternal<T>(false, false, true);
         }
         break;
 
@@ -3677,7 +3718,7 @@ bool FITSData::loadWCS()
     if (fptr)
     {
         char *header = nullptr;
-        if (fits_hdr2str(fptr, 1, nullptr, 0, &header, &nkeyrec, &status))
+        if (fits_convert_hdr2str(fptr, 1, nullptr, 0, &header, &nkeyrec, &status))
         {
             char errmsg[512];
             fits_get_errstatus(status, errmsg);
@@ -41,6 +41,7 @@
 #include <QNetworkReply>
 #include <QTimer>
 #include <QQueue>
+#include <QMap>
 
 #ifndef KSTARS_LITE
 #include <kxmlguiwindow.h>
@@ -123,7 +124,8 @@ class FITSData : public QObject
 
         /**
          * @brief loadFITSFromMemory Loading FITS from memory buffer.
-         * @param buffer The memory buffer containing the fits data.
+         * @param buffer The memory buffer containing the fits data. FITS images keep a reference to it rather than
+         * a copy while loading, a buffer created with QByteArray::fromRawData() must outlive the loading.
          * @return bool indicating success or failure.
          */
         bool loadFromBuffer(const QByteArray &buffer);
@@ -151,6 +153,17 @@ class FITSData : public QObject
         ////////////////////////////////////////////////////////////////////////////////////////
         // Calculate stats
         void calculateStats(bool refresh = false, bool roi = false);
+        /**
+         * @brief reuseStatistics Reuse the statistics of a previous frame of the same train, e.g. of a guide camera,
+         * instead of calculating them over the whole image when it is loaded. They are only reused by a frame of the
+         * same size and data type, whose EXPTIME and GAIN keywords, if any, match exposure and gain. Negative values
+         * are not checked. calculateStats(true) still calculates them.
+         */
+        void reuseStatistics(const FITSImage::Statistic &previous, double exposure = -1, double gain = -1);
+        bool statisticsReused() const
+        {
+            return m_StatisticsReused;
+        }
         void saveStatistics(FITSImage::Statistic &other);
         void restoreStatistics(FITSImage::Statistic &other);
         FITSImage::Statistic const &getStatistics() const
@@ -827,7 +840,7 @@ class FITSData : public QObject
                               const double maxSNR);
 
     public slots:
-        void makeRoiBuffer(QRect roi);
+        void calculateRoiStats(QRect roi);
 
         /**
          * @brief Called when 1 (or more) new files added to the watched stack directory
@@ -850,6 +863,8 @@ class FITSData : public QObject
         bool loadCanonicalImage(const QByteArray &buffer);
         // Load FITS images.
         bool loadFITSImage(const QByteArray &buffer, const bool isCompressed = false);
+        // Reopen fptr on a copy of the headers of the memory buffer, once the pixels are read.
+        bool keepHeaderOnly();
         // Load XISF images.
         bool loadXISFImage(const QByteArray &buffer);
         // Save XISF images.
@@ -858,8 +873,6 @@ class FITSData : public QObject
         bool loadRAWImage(const QByteArray &buffer);
 
         void rotWCSFITS(int angle, int mirror);
-        void calculateMinMax(bool refresh = false, bool roi = false);
-        void calculateMedian(bool refresh = false, bool roi = false);
         bool checkDebayer();
         void readWCSKeys();
 
@@ -898,13 +911,10 @@ class FITSData : public QObject
         template <typename T>
         void applyFilter(FITSScale type, uint8_t *targetImage, QVector<double> * min = nullptr, QVector<double> * max = nullptr);
 
+        /* Calculate mean & standard deviation, and optionally min/max and median with the median absolute deviation,
+           in a single run over each channel */
         template <typename T>
-        void calculateMinMax(bool roi = false);
-        template <typename T>
-        void calculateMedian(bool roi = false);
-
-        template <typename T>
-        QPair<T, T> getParitionMinMax(uint32_t start, uint32_t stride, bool roi);
+        void calculateStatsInternal(bool roi, bool minMax, bool median);
 
         /* Calculate the Gaussian blur matrix and apply it to the image using the convolution filter */
         QVector<double> createGaussianKernel(int size, double sigma);
@@ -913,10 +923,6 @@ class FITSData : public QObject
         template <typename T>
         void gaussianBlur(int kernelSize, double sigma);
 
-        /* Calculate running average & standard deviation */
-        template <typename T>
-        void calculateStdDev( bool roi = false );
-
         template <typename T>
         void convertToQImage(double dataMin, double dataMax, double scale, double zero, QImage &image);
 
@@ -996,11 +1002,17 @@ class FITSData : public QObject
         /**
          * @brief A quicker version of loadFITSImage used by Live Stacking
          * @param filename to open
-         * @param buffer
          * @param isCompressed
+         * @param fileBuffer optional contents of filename already read into memory (see prefetchSubs)
          * @return success
          */
-        bool stackLoadFITSImage(QString filename, const bool isCompressed);
+        bool stackLoadFITSImage(QString filename, const bool isCompressed, const QByteArray &fileBuffer = QByteArray());
+
+        /**
+         * @brief Read ahead the next few subs in the background so file I/O overlaps plate solving
+         *        of the current sub. The read ahead window is bounded by STACK_PREFETCH_DEPTH
+         */
+        void prefetchSubs();
 
         /**
          * @brief stackCheckDebayer checks whether a stack sub needs to be debayered
@@ -1047,14 +1059,18 @@ class FITSData : public QObject
 
         /// Pointer to CFITSIO FITS file struct
         fitsfile *fptr { nullptr };
+        // Raw bytes fptr was opened from when loading from memory. cfitsio keeps the address of the pointer and
+        // reads the header through it after loading, so they live as long as fptr. The buffer is shared, not copied,
+        // while loading. Uncompressed images then only keep their own copy of the headers.
+        QByteArray m_FileBuffer;
+        void *m_FileBufferPtr { nullptr };
+        size_t m_FileBufferSize { 0 };
         /// Generic data image buffer
         uint8_t *m_ImageBuffer { nullptr };
         /// Above buffer size in bytes
         uint32_t m_ImageBufferSize { 0 };
-        /// Image Buffer if Selection is to be done
-        uint8_t *m_ImageRoiBuffer { nullptr };
-        /// Above buffer size in bytes
-        uint32_t m_ImageRoiBufferSize { 0 };
+        /// Region of the selection, in the image buffer
+        QRect m_ROIRegion;
         /// Is this a temporary file or one loaded from disk?
         bool m_isTemporary { false };
         /// is this file compress (.fits.fz)?
@@ -1067,8 +1083,6 @@ class FITSData : public QObject
         bool HasWCS { false };        /// Do we have WCS keywords in this FITS data?
         /// Is the image debayarable?
         bool HasDebayer { false };
-        /// Buffer to hold fpack uncompressed data
-        uint8_t *m_PackBuffer {nullptr};
 
         /// Our very own file name
         QString m_Filename, m_compressedFilename, m_Extension;
@@ -1108,6 +1122,12 @@ class FITSData : public QObject
         int m_FITSBITPIX {USHORT_IMG};
         FITSImage::Statistic m_Statistics;
         FITSImage::Statistic m_ROIStatistics;
+        // Statistics of a previous frame, used instead of calculating them when loading
+        FITSImage::Statistic m_PreviousStatistics;
+        double m_PreviousExposure { -1 };
+        double m_PreviousGain { -1 };
+        bool m_ReusePreviousStatistics { false };
+        bool m_StatisticsReused { false };
 
         // A list of header records
         QList<Record> m_HeaderRecords;
@@ -1189,6 +1209,13 @@ class FITSData : public QObject
         struct wcsprm *m_StackWCSHandle { nullptr };
         int m_Stacknwcs {0};
         fitsfile *m_Stackfptr { nullptr };
+        // Raw bytes of the sub m_Stackfptr was opened from. cfitsio keeps the address of the pointer
+        QByteArray m_StackFileBuffer;
+        void *m_StackFileBufferPtr { nullptr };
+        size_t m_StackFileBufferSize { 0 };
+        // Subs being read ahead, keyed on filename
+        QMap<QString, QFuture<QByteArray>> m_StackPrefetch;
+        static constexpr int STACK_PREFETCH_DEPTH { 2 };
         QList<Record> m_StackHeaderRecords;
         QFutureWatcher<bool> m_StackWatcher;
         QFutureWatcher<bool> m_StackFITSWatcher;
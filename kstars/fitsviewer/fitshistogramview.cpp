@@ -272,7 +272,8 @@ void FITSHistogramView::createNonLinearHistogram()
 
     Stretch stretch(width, height, m_ImageData->channels(), m_ImageData->dataType());
     // Compute new auto-stretch params.
-    StretchParams stretchParams = stretch.computeParams(m_ImageData->getImageBuffer());
+    const FITSImage::Statistic &stats = m_ImageData->getStatistics();
+    StretchParams stretchParams = stretch.computeParams(m_ImageData->getImageBuffer(), stats.median, stats.mad);
 
     stretch.setParams(stretchParams);
     stretch.run(m_ImageData->getImageBuffer(), &rawImage);
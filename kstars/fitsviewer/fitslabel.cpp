@@ -26,6 +26,8 @@
 #include "indi/indimount.h"
 #endif
 
+#include <QPaintEvent>
+#include <QPainter>
 #include <QScrollBar>
 #include <QToolTip>
 
@@ -134,6 +136,17 @@ void FITSLabel::leaveEvent(QEvent *e)
     emit mouseOverPixel(-1, -1);
 }
 
+// Large images have no pixmap, the view paints the exposed tiles and the overlays.
+void FITSLabel::paintEvent(QPaintEvent *e)
+{
+    QLabel::paintEvent(e);
+    if (view->isTiled())
+    {
+        QPainter painter(this);
+        view->drawFrame(&painter, e->rect());
+    }
+}
+
 /**
 I added some things to the top of this method to allow panning and Scope slewing to function.
 If you are in the dragMouse mode and the mousebutton is pressed, The method checks the difference
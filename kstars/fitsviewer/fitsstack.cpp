@@ -5,8 +5,10 @@
 */
 
 #include <QtConcurrent>
+#include <QSharedPointer>
 
 #include "fitsstack.h"
+#include "fitsstackkernel.h"
 #include "fitsdata.h"
 #include <fits_debug.h>
 #include "fitscommon.h"
@@ -17,10 +19,16 @@
 #include <wcshdr.h>
 #include <fitsio.h>
 
+#include <cmath>
+#include <numeric>
+
 FITSStack::FITSStack(FITSData *parent, LiveStackData params) : QObject(parent)
 {
     m_Data = parent;
     m_StackData = params;
+
+    // Leave a core for loading and plate solving the subs that feed the pool
+    m_PreparePool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
 }
 
 FITSStack::~FITSStack()
@@ -67,6 +75,7 @@ void FITSStack::setupNextSub()
     imageData.wcsprm = nullptr;
     imageData.hfr = -1;
     imageData.numStars = 0;
+    imageData.isPreparing = false;
     m_StackImageData.push_back(imageData);
 }
 
@@ -133,7 +142,16 @@ bool FITSStack::addSub(void * imageBuffer, const int cvType, const int width, co
             m_MeanSubSNR = ((m_MeanSubSNR * (subs - 1)) + snr) / subs;
         }
 
-        m_StackImageData.last().image = newImage;
+        if (m_StackData.tileMemory > 0)
+        {
+            // Tiled stacking so spill the sub to the scratch file rather than holding it in memory
+            cv::Mat scratchImage = m_Scratch.append(newImage);
+            if (scratchImage.empty())
+                return false;
+            m_StackImageData.last().image = scratchImage;
+        }
+        else
+            m_StackImageData.last().image = newImage;
         return true;
     }
     catch (const cv::Exception &ex)
@@ -203,28 +221,27 @@ void FITSStack::addMaster(const bool dark, void * imageBuffer, const int width,
         if (!checkSub(imageClone.cols, imageClone.rows, 0, channels))
             return;
 
+        // Prepare jobs in flight keep the masters they were started with, so the new master is completed
+        // in its own buffer before it replaces the old one
         if (dark)
         {
-            m_MasterDark = imageClone;
-
             // If the dark has been normalised to 0-1 then we need to increase values so they match the subs
             double minVal, maxVal;
-            cv::minMaxLoc(m_MasterDark, &minVal, &maxVal);
+            cv::minMaxLoc(imageClone, &minVal, &maxVal);
             if (maxVal <= 1.0)
             {
                 if (m_BytesPerPixel == 1)
-                    m_MasterDark *= 255;
+                    imageClone *= 255;
                 else if (m_BytesPerPixel == 2)
-                    m_MasterDark *= 65535;
+                    imageClone *= 65535;
             }
+            m_MasterDark = imageClone;
         }
         else
         {
-            m_MasterFlat = imageClone;
-
             // Scale the flat down using the median value (note that this also takes care of normalised flats 0-1
             std::vector<cv::Mat> channels;
-            cv::split(m_MasterFlat, channels);
+            cv::split(imageClone, channels);
 
             for (unsigned int c = 0; c < channels.size(); c++)
             {
@@ -244,7 +261,9 @@ void FITSStack::addMaster(const bool dark, void * imageBuffer, const int width,
                     cv::max(channels[c], 0.1f, channels[c]);
                 }
             }
-            cv::merge(channels, m_MasterFlat);
+            cv::Mat flat;
+            cv::merge(channels, flat);
+            m_MasterFlat = flat;
         }
     }
     catch (const cv::Exception &ex)
@@ -414,49 +433,9 @@ bool FITSStack::stack()
 {
     try
     {
-        for(int i = 0; i < m_StackImageData.size(); i++)
-        {
-            // Ignore any bad subs
-            if (m_StackImageData[i].status != OK)
-                continue;
+        // Calibrate and align the subs (most will already be underway) and collect them in sub order
+        collectPreparedSubs();
 
-            // Calibrate sub
-            if (!m_StackImageData[i].isCalibrated)
-            {
-                if (calibrateSub(m_StackImageData[i].image))
-                    m_StackImageData[i].isCalibrated = true;
-                else
-                {
-                    m_StackImageData[i].status = CALIBRATION_FAILED;
-                    continue;
-                }
-            }
-
-            if (m_InitialStackRef < 0)
-            {
-                // First image ise reference  thto which others are aligned
-                m_InitialStackRef = i;
-                m_StackImageData[i].isAligned = true;
-                setWCSStackImage(m_StackImageData[i].wcsprm);
-            }
-            if (m_StackData.alignMethod == LS_ALIGNMENT_NONE)
-                // No alignment needed so skip this stage
-                m_StackImageData[i].isAligned = true;
-            else if (!m_StackImageData[i].isAligned)
-            {
-                // Align this image to the reference image
-                cv::Mat warp, warpedImage;
-                if (!calcWarpMatrix(m_StackImageData[m_InitialStackRef].wcsprm, m_StackImageData[i].wcsprm, warp))
-                    m_StackImageData[i].status = ALIGNMENT_FAILED;
-                else
-                {
-                    cv::warpPerspective(m_StackImageData[i].image, warpedImage, warp,
-                                        m_StackImageData[i].image.size(), cv::INTER_LANCZOS4);
-                    m_StackImageData[i].image = warpedImage;
-                    m_StackImageData[i].isAligned = true;
-                }
-            }
-        }
         // Stack the aligned subs
         float totalWeight = 0.0;
         stackSubs(true, totalWeight, m_StackedImage32F);
@@ -492,39 +471,9 @@ bool FITSStack::stackn()
 {
     try
     {
-        for(int i = 0; i < m_StackImageData.size(); i++)
-        {
-            // Ignore any bad subs
-            if (m_StackImageData[i].status != OK)
-                continue;
+        // Calibrate and align the subs (most will already be underway) and collect them in sub order
+        collectPreparedSubs();
 
-            // Calibrate sub
-            if (!m_StackImageData[i].isCalibrated)
-            {
-                if (calibrateSub(m_StackImageData[i].image))
-                    m_StackImageData[i].isCalibrated = true;
-                else
-                {
-                    m_StackImageData[i].status = CALIBRATION_FAILED;
-                    continue;
-                }
-            }
-
-            // Alignment stage
-            cv::Mat warp, warpedImage;
-            if (m_StackData.alignMethod == LS_ALIGNMENT_NONE)
-                // No alignment needed so skip this stage
-                m_StackImageData[i].isAligned = true;
-            else if (!calcWarpMatrix(m_RunningStackImageData.ref_wcsprm, m_StackImageData[i].wcsprm, warp))
-                m_StackImageData[i].status = ALIGNMENT_FAILED;
-            else
-            {
-                cv::warpPerspective(m_StackImageData[i].image, warpedImage, warp, m_StackImageData[i].image.size(),
-                                    cv::INTER_LANCZOS4);
-                m_StackImageData[i].image = warpedImage;
-                m_StackImageData[i].isAligned = true;
-            }
-        }
         // Stack the aligned subs
         float totalWeight = m_RunningStackImageData.totalWeight;
         if (stackSubs(false, totalWeight, m_StackedImage32F))
@@ -618,8 +567,162 @@ bool FITSStack::calcWarpMatrix(struct wcsprm * wcs1, struct wcsprm * wcs2, cv::M
     }
 }
 
+// Replace the sub with its aligned version. In tiled mode the sub is a view of its scratch slot
+// so write the aligned image back into the slot rather than holding it on the heap
+void FITSStack::setAlignedSub(cv::Mat &sub, const cv::Mat &aligned)
+{
+    if (m_StackData.tileMemory > 0)
+    {
+        aligned.copyTo(sub);
+        m_Scratch.releaseRows(sub, 0, sub.rows);
+    }
+    else
+        sub = aligned;
+}
+
+void FITSStack::prepareSubAsync()
+{
+    if (m_StackImageData.size() <= 0)
+        return;
+
+    startPrepareSub(m_StackImageData.size() - 1);
+}
+
+void FITSStack::startPrepareSub(const int i)
+{
+    StackImageData &sub = m_StackImageData[i];
+    if (sub.status != OK || sub.isPreparing || (sub.isCalibrated && sub.isAligned))
+        return;
+
+    // Subs in the initial stack are aligned to the first good sub, later subs to the running stack reference
+    struct wcsprm * refWCS = nullptr;
+    if (getInitialStackDone())
+        refWCS = m_RunningStackImageData.ref_wcsprm;
+    else
+    {
+        if (m_InitialStackRef < 0)
+        {
+            m_InitialStackRef = i;
+            setWCSStackImage(sub.wcsprm);
+        }
+        if (m_InitialStackRef != i)
+            refWCS = m_StackImageData[m_InitialStackRef].wcsprm;
+    }
+
+    // The image is passed by value (a new header onto the same data) as m_StackImageData may be reallocated
+    // while the job runs as more subs arrive
+    const cv::Mat image = sub.image;
+    const bool isCalibrated = sub.isCalibrated;
+    struct wcsprm * subWCS = sub.wcsprm;
+
+    // addMaster() may replace the masters while the job runs, so it works with the ones current now.
+    // The copies are new headers sharing the data, which addMaster() never changes in place
+    const cv::Mat dark = m_MasterDark;
+    const cv::Mat flat = m_MasterFlat;
+
+    // wcslib updates the wcsprm it transforms with (lazy wcsset, work arrays) so each job gets its own
+    // copy of the reference rather than sharing it with the other jobs
+    QSharedPointer<struct wcsprm> jobRefWCS;
+    if (refWCS != nullptr && m_StackData.alignMethod != LS_ALIGNMENT_NONE)
+    {
+        jobRefWCS.reset(new struct wcsprm, [](struct wcsprm * wcs)
+        {
+            wcsfree(wcs);
+            delete wcs;
+        });
+        jobRefWCS->flag = -1; // Allocate space
+        int status = 0;
+        if ((status = wcssub(1, refWCS, 0x0, 0x0, jobRefWCS.data())) != 0 || (status = wcsset(jobRefWCS.data())) != 0)
+        {
+            qCDebug(KSTARS_FITS) << QString("%1 wcs copy error %2: %3").arg(__FUNCTION__).arg(status).arg(wcs_errmsg[status]);
+            sub.status = ALIGNMENT_FAILED;
+            return;
+        }
+    }
+
+    sub.isPreparing = true;
+    sub.prepared = QtConcurrent::run(&m_PreparePool, [this, image, isCalibrated, dark, flat, jobRefWCS, subWCS]()
+    {
+        return prepareSub(image, isCalibrated, dark, flat, jobRefWCS.data(), subWCS);
+    });
+}
+
+FITSStack::PreparedSub FITSStack::prepareSub(cv::Mat image, const bool isCalibrated, const cv::Mat &dark,
+        const cv::Mat &flat, struct wcsprm * refWCS, struct wcsprm * subWCS)
+{
+    PreparedSub result { OK, image };
+    try
+    {
+        if (!isCalibrated && !calibrateSub(result.image, dark, flat))
+        {
+            result.status = CALIBRATION_FAILED;
+            return result;
+        }
+
+        // No alignment needed if requested or if this is the reference sub
+        if (m_StackData.alignMethod == LS_ALIGNMENT_NONE || refWCS == nullptr)
+            return result;
+
+        cv::Mat warp, warpedImage;
+        if (!calcWarpMatrix(refWCS, subWCS, warp))
+        {
+            result.status = ALIGNMENT_FAILED;
+            return result;
+        }
+        cv::warpPerspective(result.image, warpedImage, warp, result.image.size(), cv::INTER_LANCZOS4);
+        setAlignedSub(result.image, warpedImage);
+    }
+    catch (const cv::Exception &ex)
+    {
+        QString s1 = ex.what();
+        qCDebug(KSTARS_FITS) << QString("openCV exception %1 called from %2").arg(s1).arg(__FUNCTION__);
+        result.status = ALIGNMENT_FAILED;
+    }
+    return result;
+}
+
+void FITSStack::collectPreparedSubs()
+{
+    // Start any subs that weren't prepared as they arrived, e.g. because the masters weren't loaded yet
+    for (int i = 0; i < m_StackImageData.size(); i++)
+        startPrepareSub(i);
+
+    // Pick up the results in sub order so the stack is independent of the order the jobs complete in
+    for (int i = 0; i < m_StackImageData.size(); i++)
+    {
+        StackImageData &sub = m_StackImageData[i];
+        if (!sub.isPreparing)
+            continue;
+
+        const PreparedSub result = sub.prepared.result();
+        sub.image = result.image;
+        sub.status = result.status;
+        sub.isCalibrated = (result.status != CALIBRATION_FAILED);
+        sub.isAligned = (result.status == OK);
+        sub.isPreparing = false;
+        sub.prepared = QFuture<PreparedSub>();
+    }
+}
+
+int FITSStack::getTileRows(const int numSubs, const int rows)
+{
+    if (m_StackData.tileMemory <= 0 || m_StackImageData.isEmpty())
+        return rows;
+
+    return FITSStackScratch::tileRows(m_StackData.tileMemory, numSubs, m_StackImageData[0].image.step[0], rows);
+}
+
+void FITSStack::releaseTile(const int startRow, const int numRows)
+{
+    if (m_StackData.tileMemory <= 0)
+        return;
+
+    for (const auto &sub : m_StackImageData)
+        m_Scratch.releaseRows(sub.image, startRow, numRows);
+}
+
 // Calibrate the passed in sub with an associated Dark (if available) and / or Flat (if available)
-bool FITSStack::calibrateSub(cv::Mat &sub)
+bool FITSStack::calibrateSub(cv::Mat &sub, const cv::Mat &dark, const cv::Mat &flat)
 {
     try
     {
@@ -627,15 +730,15 @@ bool FITSStack::calibrateSub(cv::Mat &sub)
             return false;
 
         // Dark subtraction (make sure no negative pixels)
-        if (!m_MasterDark.empty())
+        if (!dark.empty())
         {
-            sub -= m_MasterDark;
+            sub -= dark;
             cv::max(sub, 0.0f, sub);
         }
 
         // Flat calibration
-        if (!m_MasterFlat.empty())
-            sub /= m_MasterFlat;
+        if (!flat.empty())
+            sub /= flat;
         return true;
     }
     catch (const cv::Exception &ex)
@@ -685,11 +788,21 @@ bool FITSStack::stackSubs(const bool initial, float &totalWeight, cv::Mat &stack
                 stack = m_StackedImage32F * totalWeight;
             }
 
-            for (int sub = 0; sub < m_StackImageData.size(); sub++)
+            // Work through the subs a tile at a time. Each pixel sees the same operations in the same order
+            // as a single full frame pass so the result is the same whatever the tile size
+            const int rows = stack.rows;
+            const int tileRows = getTileRows(m_StackImageData.size(), rows);
+            for (int tileStart = 0; tileStart < rows; tileStart += tileRows)
             {
-                stack += m_StackImageData[sub].image * weights[sub];
-                totalWeight += weights[sub];
+                const int tileEnd = std::min(tileStart + tileRows, rows);
+                cv::Mat stackTile = stack.rowRange(tileStart, tileEnd);
+                for (int sub = 0; sub < m_StackImageData.size(); sub++)
+                    stackTile += m_StackImageData[sub].image.rowRange(tileStart, tileEnd) * weights[sub];
+                releaseTile(tileStart, tileEnd - tileStart);
             }
+
+            for (int sub = 0; sub < m_StackImageData.size(); sub++)
+                totalWeight += weights[sub];
             stack /= totalWeight;
         }
         return true;
@@ -767,48 +880,72 @@ cv::Mat FITSStack::stackSubsSigmaClipping(const QVector<float> &weights)
                                       [](const StackImageData &data) {return data.image.isContinuous(); });
         if (continuous)
         {
-            // We can flatten the 2D image to 1D for efficiency and also use parallel processing
-            cols *= rows;
-            rows = 1;
-
-            // Chunk up for available threads. Tried multipliers of 1, 2, 3, 4, 6, 8. Not a big difference by 2 was best
-            const int chunkSize = std::max(1, cols / (QThread::idealThreadCount() * 2));
-
-            QVector<QPair<int, int>> pixelChunks;
-            for (int start = 0; start < cols; start += chunkSize)
+            // We can flatten the 2D image to 1D for efficiency and also use parallel processing.
+            // In tiled mode the flattened image is processed a band of rows at a time so only the
+            // current band of each sub needs to be in memory. Tiles and chunks start on a multiple of the kernel's
+            // lanes so each pixel goes through the same path whatever the tile size and thread count
+            const int lanes = FITSSigmaClipKernel::lanes();
+            int tileRows = getTileRows(numImages, rows);
+            if (tileRows < rows)
+                tileRows = std::max(lanes, tileRows - tileRows % lanes);
+
+            // Batched kernel that clips several pixels at once in SIMD lanes
+            FITSSigmaClipKernel::Params params;
+            params.winsorize = (m_StackData.rejection == LS_STACKING_REJ_WINDSOR);
+            params.winsorCutoff = m_StackData.windsorCutoff;
+            params.lowSigma = m_StackData.lowSigma;
+            params.highSigma = m_StackData.highSigma;
+            const FITSSigmaClipKernel kernel(numImages, m_Channels, params,
+                                             std::vector<float>(weights.begin(), weights.end()));
+
+            qCDebug(KSTARS_FITS) << QString("Starting sigma clipping: %1 tile(s) of %2 rows on %3 threads")
+                                                .arg((rows + tileRows - 1) / tileRows).arg(tileRows)
+                                                .arg(QThread::idealThreadCount());
+
+            for (int tileStart = 0; tileStart < rows; tileStart += tileRows)
             {
-                int end = std::min(start + chunkSize, cols);
-                pixelChunks.append(qMakePair(start, end));
-            }
+                const int tileRowCount = std::min(tileRows, rows - tileStart);
+                const int tilePixels = tileRowCount * cols;
 
-            qCDebug(KSTARS_FITS) << QString("Starting sigma clipping: %1 chunks on %2 threads")
-                                                .arg(pixelChunks.size()).arg(QThread::idealThreadCount());
+                // Chunk up for available threads. Tried multipliers of 1, 2, 3, 4, 6, 8. Not a big difference by 2 was best
+                int chunkSize = std::max(1, tilePixels / (QThread::idealThreadCount() * 2));
+                chunkSize = ((chunkSize + lanes - 1) / lanes) * lanes;
 
-            // Get pointers once (since rows=1)
-            std::vector<const float *> imagesPtrs(numImages);
-            for (int i = 0; i < numImages; i++)
-                imagesPtrs[i] = m_StackImageData[i].image.ptr<float>(0);
+                QVector<QPair<int, int>> pixelChunks;
+                for (int start = 0; start < tilePixels; start += chunkSize)
+                {
+                    int end = std::min(start + chunkSize, tilePixels);
+                    pixelChunks.append(qMakePair(start, end));
+                }
 
-            float* finalImagePtr = finalImage.ptr<float>(0);
-            QVector<cv::Vec4f *> sigmaClipPtr(m_Channels);
-            for (int ch = 0; ch < m_Channels; ch++)
-                sigmaClipPtr[ch] = m_SigmaClip32FC4[ch].ptr<cv::Vec4f>(0);
+                // Get pointers to the start of the tile (the tile is treated as a single row)
+                std::vector<const float *> imagesPtrs(numImages);
+                for (int i = 0; i < numImages; i++)
+                    imagesPtrs[i] = m_StackImageData[i].image.ptr<float>(tileStart);
 
-            // Setup the function for parallel processing to handle a chunk of pixels
-            auto processPixelChunk = [&](const QPair<int, int>& chunk)
-            {
-                for (int x = chunk.first; x < chunk.second; x++)
+                float* tileImagePtr = finalImage.ptr<float>(tileStart);
+                QVector<cv::Vec4f *> tileSigmaClipPtr(m_Channels);
+                for (int ch = 0; ch < m_Channels; ch++)
+                    tileSigmaClipPtr[ch] = m_SigmaClip32FC4[ch].ptr<cv::Vec4f>(tileStart);
+
+                // Setup the function for parallel processing to handle a chunk of pixels
+                auto processPixelChunk = [&](const QPair<int, int>& chunk)
                 {
-                    // Cancellation check every once per 100 iterations
-                    if ((x - chunk.first) % 100 == 0 && QThread::currentThread()->isInterruptionRequested())
-                        return;
+                    // Process the chunk in batches with a cancellation check between batches
+                    const int batchSize = 128;
+                    for (int x = chunk.first; x < chunk.second; x += batchSize)
+                    {
+                        if (QThread::currentThread()->isInterruptionRequested())
+                            return;
 
-                    // Process the pixel
-                    stackSigmaClipPixel(x, imagesPtrs, finalImagePtr, sigmaClipPtr, weights);
-                }
-            };
+                        kernel.clip(x, std::min(x + batchSize, chunk.second), imagesPtrs.data(), tileImagePtr,
+                                    tileSigmaClipPtr.data());
+                    }
+                };
 
-            QtConcurrent::blockingMap(pixelChunks, processPixelChunk);
+                QtConcurrent::blockingMap(pixelChunks, processPixelChunk);
+                releaseTile(tileStart, tileRowCount);
+            }
         }
         else
         {
@@ -907,6 +1044,9 @@ cv::Mat FITSStack::stackSubsSigmaClipping(const QVector<float> &weights)
                 }
             }
         }
+
+        // Setup the running estimates for when new subs are added to this stack
+        seedOnlineClipping(weights);
         return finalImage;
     }
     catch (const cv::Exception &ex)
@@ -996,7 +1136,9 @@ void FITSStack::stackSigmaClipPixel(int x, const std::vector<const float *> &ima
     }
 }
 
-// Function to stack n subs to an existing stack using Sigma Clipping
+// Function to stack n subs to an existing stack using Sigma Clipping.
+// Each pixel / channel carries a running (Welford) estimate of the mean and variance of the accepted samples
+// so each new sub is clipped against limits that keep tightening as the stack grows, at O(pixels) per sub
 cv::Mat FITSStack::stacknSubsSigmaClipping(const QVector<float> &weights)
 {
     try
@@ -1005,8 +1147,9 @@ cv::Mat FITSStack::stacknSubsSigmaClipping(const QVector<float> &weights)
         int cols = m_StackImageData[0].image.cols;
         int numImages = m_StackImageData.size();
         cv::Mat finalImage = m_StackedImage32F;
-        float *finalImagePtr;
         QVector<cv::Vec4f *> sigmaClipPtr(m_Channels);
+        QVector<int *> onlineCountPtr(m_Channels);
+        QVector<cv::Vec2f *> onlineClipPtr(m_Channels);
 
         if (m_StackImageData.size() != weights.size())
         {
@@ -1014,61 +1157,58 @@ cv::Mat FITSStack::stacknSubsSigmaClipping(const QVector<float> &weights)
             return finalImage;
         }
 
-        // If all images are continuous so we can treat as 1D arrays to speed things up
+        if (m_OnlineCount32S.size() != m_Channels || m_OnlineClip32FC2.size() != m_Channels)
+        {
+            qCDebug(KSTARS_FITS) << QString("No running sigma clipping estimates in %1").arg(__FUNCTION__);
+            return finalImage;
+        }
+
+        // If all images are continuous so we can treat each tile as a 1D array to speed things up
         bool continuous = finalImage.isContinuous() &&
                           std::all_of(m_SigmaClip32FC4.begin(), m_SigmaClip32FC4.end(),
                                       [](const cv::Mat& mat) { return mat.isContinuous(); }) &&
+                          std::all_of(m_OnlineCount32S.begin(), m_OnlineCount32S.end(),
+                                      [](const cv::Mat& mat) { return mat.isContinuous(); }) &&
+                          std::all_of(m_OnlineClip32FC2.begin(), m_OnlineClip32FC2.end(),
+                                      [](const cv::Mat& mat) { return mat.isContinuous(); }) &&
                           std::all_of(m_StackImageData.begin(), m_StackImageData.end(),
                                       [](const StackImageData &data) {return data.image.isContinuous(); });
-        if (continuous)
-        {
-            cols *= rows;
-            rows = 1;
-        }
+        const int tileRows = continuous ? getTileRows(numImages, rows) : 1;
 
         // Process each pixel position
         std::vector<const float *> imagesPtrs(numImages);
-        for (int y = 0; y < rows; y++)
+        for (int y = 0; y < rows; y += tileRows)
         {
+            const int tileRowCount = std::min(tileRows, rows - y);
+            const int tilePixels = tileRowCount * cols;
+
             // Update pointers for current y
             for (int i = 0; i < numImages; i++)
                 imagesPtrs[i] = m_StackImageData[i].image.ptr<float>(y);
 
-            finalImagePtr = finalImage.ptr<float>(y);
+            float *finalImagePtr = finalImage.ptr<float>(y);
             for (int ch = 0; ch < m_Channels; ch++)
+            {
                 sigmaClipPtr[ch] = m_SigmaClip32FC4[ch].ptr<cv::Vec4f>(y);
+                onlineCountPtr[ch] = m_OnlineCount32S[ch].ptr<int>(y);
+                onlineClipPtr[ch] = m_OnlineClip32FC2[ch].ptr<cv::Vec2f>(y);
+            }
 
-            for (int x = 0; x < cols; x++)
-            {
-                for (int ch = 0; ch < m_Channels; ch++)
-                {
-                    // Get the sigma clip data from the current pixel/channel
-                    cv::Vec4f sigmaClip = sigmaClipPtr[ch][x];
-                    float lower = sigmaClip[0];
-                    float upper = sigmaClip[1];
-                    float sum = sigmaClip[2];
-                    float weightSum = sigmaClip[3];
-
-                    // Process each image
-                    for (int image = 0; image < numImages; image++)
-                    {
-                        float pixel = imagesPtrs[image][x * m_Channels + ch];
-                        if (lower < 0.0 || (pixel >= lower && pixel <= upper))
-                        {
-                            sum += pixel * weights[image];
-                            weightSum += weights[image];
-                        }
-                    }
+            // Each pixel is independent so split the tile up for the available threads
+            const int chunkSize = std::max(1, tilePixels / (QThread::idealThreadCount() * 2));
+            QVector<QPair<int, int>> pixelChunks;
+            for (int start = 0; start < tilePixels; start += chunkSize)
+                pixelChunks.append(qMakePair(start, std::min(start + chunkSize, tilePixels)));
 
-                    // Update image pixel with new value
-                    finalImagePtr[x * m_Channels + ch] = sum / weightSum;
+            auto processPixelChunk = [&](const QPair<int, int>& chunk)
+            {
+                for (int x = chunk.first; x < chunk.second; x++)
+                    stacknSigmaClipPixel(x, imagesPtrs, finalImagePtr, sigmaClipPtr, onlineCountPtr, onlineClipPtr,
+                                         weights);
+            };
 
-                    // Save the new intermediate results for next time
-                    sigmaClip[2] = sum;
-                    sigmaClip[3] = weightSum;
-                    sigmaClipPtr[ch][x] = sigmaClip;
-                }
-            }
+            QtConcurrent::blockingMap(pixelChunks, processPixelChunk);
+            releaseTile(y, tileRowCount);
         }
         return finalImage;
     }
@@ -1080,6 +1220,148 @@ cv::Mat FITSStack::stacknSubsSigmaClipping(const QVector<float> &weights)
     }
 }
 
+// Add the new subs' values for the pixel at position x to the running stack. Each value is winsorized (if required)
+// and clipped against the current running estimates. Accepted values update the estimates (Welford's algorithm)
+void FITSStack::stacknSigmaClipPixel(int x, const std::vector<const float *> &imagesPtrs, float *finalImagePtr,
+                                     const QVector<cv::Vec4f *> &sigmaClipPtr,
+                                     const QVector<int *> &onlineCountPtr, const QVector<cv::Vec2f *> &onlineClipPtr,
+                                     const QVector<float> &weights)
+{
+    const int numImages = imagesPtrs.size();
+    for (int ch = 0; ch < m_Channels; ch++)
+    {
+        cv::Vec4f sigmaClip = sigmaClipPtr[ch][x];
+        float lower = sigmaClip[0];
+        float upper = sigmaClip[1];
+        float sum = sigmaClip[2];
+        float weightSum = sigmaClip[3];
+
+        int count = onlineCountPtr[ch][x];
+        cv::Vec2f online = onlineClipPtr[ch][x];
+        float mean = online[0];
+        float m2 = online[1];
+
+        for (int image = 0; image < numImages; image++)
+        {
+            float pixel = imagesPtrs[image][x * m_Channels + ch];
+
+            // Until there are enough samples for a sensible estimate accept everything
+            if (count >= ONLINE_CLIP_MIN_SAMPLES)
+            {
+                const float stddev = std::sqrt(m2 / ((count - 1) * m_TruncatedVarianceFactor));
+                if (m_StackData.rejection == LS_STACKING_REJ_WINDSOR)
+                {
+                    const float winsorLower = std::max(0.0f, mean - stddev * static_cast<float>(m_StackData.windsorCutoff));
+                    const float winsorUpper = mean + stddev * static_cast<float>(m_StackData.windsorCutoff);
+                    pixel = std::min(std::max(pixel, winsorLower), winsorUpper);
+                }
+                lower = std::max(0.0f, mean - stddev * static_cast<float>(m_StackData.lowSigma));
+                upper = mean + stddev * static_cast<float>(m_StackData.highSigma);
+                if (pixel < lower || pixel > upper)
+                    continue;
+            }
+
+            count++;
+            const float delta = pixel - mean;
+            mean += delta / count;
+            m2 += delta * (pixel - mean);
+
+            sum += pixel * weights[image];
+            weightSum += weights[image];
+        }
+
+        // Update image pixel with new value (if all new values were rejected the pixel is unchanged)
+        if (weightSum > 0.0f)
+            finalImagePtr[x * m_Channels + ch] = sum / weightSum;
+
+        // Save the new intermediate results for next time
+        sigmaClipPtr[ch][x] = cv::Vec4f(lower, upper, sum, weightSum);
+        onlineCountPtr[ch][x] = count;
+        onlineClipPtr[ch][x] = cv::Vec2f(mean, m2);
+    }
+}
+
+// Seed the running estimates used by incremental stacking from the results of the initial sigma clipped stack.
+// The initial stack stores the clipping limits, which were set a fixed number of standard deviations either side
+// of the median, and the weighted sum of the accepted values. From these recover the mean and standard deviation.
+void FITSStack::seedOnlineClipping(const QVector<float> &weights)
+{
+    const int rows = m_SigmaClip32FC4[0].rows;
+    const int cols = m_SigmaClip32FC4[0].cols;
+    const float lowSigma = m_StackData.lowSigma;
+    const float highSigma = m_StackData.highSigma;
+    const float totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0f);
+    const float numSubs = weights.size();
+
+    m_TruncatedVarianceFactor = truncatedVarianceFactor(lowSigma, highSigma);
+    m_OnlineCount32S.clear();
+    m_OnlineCount32S.resize(m_Channels);
+    m_OnlineClip32FC2.clear();
+    m_OnlineClip32FC2.resize(m_Channels);
+    for (int ch = 0; ch < m_Channels; ch++)
+    {
+        m_OnlineCount32S[ch] = cv::Mat::zeros(rows, cols, CV_32SC1);
+        m_OnlineClip32FC2[ch] = cv::Mat::zeros(rows, cols, CV_32FC2);
+        for (int y = 0; y < rows; y++)
+        {
+            const cv::Vec4f *sigmaClipPtr = m_SigmaClip32FC4[ch].ptr<cv::Vec4f>(y);
+            int *countPtr = m_OnlineCount32S[ch].ptr<int>(y);
+            cv::Vec2f *onlinePtr = m_OnlineClip32FC2[ch].ptr<cv::Vec2f>(y);
+            for (int x = 0; x < cols; x++)
+            {
+                const float lower = sigmaClipPtr[x][0];
+                const float upper = sigmaClipPtr[x][1];
+                const float sum = sigmaClipPtr[x][2];
+                const float weightSum = sigmaClipPtr[x][3];
+
+                // Too few subs to sigma clip in the initial stack so start estimates from the new subs
+                if (lower < 0.0f || weightSum <= 0.0f || totalWeight <= 0.0f)
+                    continue;
+
+                const float mean = sum / weightSum;
+                float stddev = 0.0f;
+                if (lower > 0.0f && lowSigma + highSigma > 0.0f)
+                    stddev = (upper - lower) / (lowSigma + highSigma);
+                else if (highSigma > 0.0f)
+                    stddev = std::max(0.0f, upper - mean) / highSigma;
+
+                // Estimated number of subs accepted for this pixel, and the variance of the accepted samples
+                const int count = std::lround(numSubs * weightSum / totalWeight);
+                const float m2 = stddev * stddev * m_TruncatedVarianceFactor * std::max(0, count - 1);
+                countPtr[x] = count;
+                onlinePtr[x] = cv::Vec2f(mean, m2);
+            }
+        }
+    }
+}
+
+// The variance of accepted samples underestimates the true variance because the tails have been clipped.
+// Return the ratio of the variance of a normal distribution truncated at -lowSigma, +highSigma to its full variance.
+float FITSStack::truncatedVarianceFactor(const double lowSigma, const double highSigma)
+{
+    if (lowSigma <= 0.0 || highSigma <= 0.0)
+        return 1.0f;
+
+    auto pdf = [](double x)
+    {
+        return std::exp(-0.5 * x * x) / std::sqrt(2.0 * M_PI);
+    };
+    auto cdf = [](double x)
+    {
+        return 0.5 * (1.0 + std::erf(x / std::sqrt(2.0)));
+    };
+
+    const double alpha = -lowSigma;
+    const double beta = highSigma;
+    const double z = cdf(beta) - cdf(alpha);
+    if (z <= 0.0)
+        return 1.0f;
+
+    const double a = (alpha * pdf(alpha) - beta * pdf(beta)) / z;
+    const double b = (pdf(alpha) - pdf(beta)) / z;
+    return static_cast<float>(std::max(1e-3, 1.0 + a - b * b));
+}
+
 void FITSStack::setWCSStackImage(const struct wcsprm *wcs)
 {
     if (!wcs)
@@ -1700,6 +1982,10 @@ void FITSStack::tidyUpInitalStack(struct wcsprm * refWCS)
 {
     for (int i = 0; i < m_StackImageData.size(); i++)
     {
+        // Don't pull the data from under a sub still being calibrated / aligned
+        if (m_StackImageData[i].isPreparing)
+            m_StackImageData[i].prepared.waitForFinished();
+
         if (m_StackImageData[i].wcsprm != nullptr && m_StackImageData[i].wcsprm != refWCS)
         {
             // Don't free up the reference WCS as we'll need that for later processing
@@ -1710,6 +1996,9 @@ void FITSStack::tidyUpInitalStack(struct wcsprm * refWCS)
         m_StackImageData[i].image.release();
     }
     m_StackImageData.clear();
+
+    // Subs are views of the scratch file so only unmap once they have all been released
+    m_Scratch.clear();
 }
 
 // Release FITS and openCV memory used in the running stack
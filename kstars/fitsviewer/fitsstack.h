@@ -7,11 +7,14 @@
 #pragma once
 
 #include "fitscommon.h"
+#include "fitsstackscratch.h"
 #include "ekos/auxiliary/solverutils.h"
 #include <fits_debug.h>
 
+#include <QFuture>
 #include <QObject>
 #include <QPointer>
+#include <QThreadPool>
 
 #include "opencv2/opencv.hpp"
 #include "opencv2/imgcodecs.hpp"
@@ -44,6 +47,14 @@ class StellarSolverProfileEditor;
  *        4. The new sub(s) are added to the already existing stack.
  *        5. The new stack is post-processed and displayed.
  *
+ *        If a tile memory budget is set, subs are spilled to a memory-mapped scratch file (FITSStackScratch)
+ *        as they are loaded and the stacking routines work through them a band of rows at a time. This keeps
+ *        the memory used independent of the number of subs and gives the same result as stacking in memory.
+ *
+ *        Calibration and alignment of each sub run on a bounded thread pool as soon as the sub has been solved,
+ *        overlapping the loading and plate solving of the subs after it. The results are collected in sub order
+ *        before stacking so the stack doesn't depend on the order the threads finish in.
+ *
  * @author John Evans
  */
 class FITSStack : public QObject
@@ -98,6 +109,12 @@ class FITSStack : public QObject
          */
         void addSubStatus(const bool ok);
 
+        /**
+         * @brief Start calibrating and aligning the latest sub in the background. Call once the sub has been
+         *        solved and the calibration masters are loaded. stack() / stackn() pick up the result.
+         */
+        void prepareSubAsync();
+
         /**
          * @brief Perform an initial stack
          */
@@ -230,6 +247,13 @@ class FITSStack : public QObject
             OK
         } StackSubStatus;
 
+        // Result of calibrating and aligning a sub in the background
+        typedef struct
+        {
+            StackSubStatus status;
+            cv::Mat image;
+        } PreparedSub;
+
         /**
          * @brief Check that a new image is consistent with previous images in size, datatype, etc
          * @return success (or not)
@@ -297,9 +321,11 @@ class FITSStack : public QObject
         /**
          * @brief Calibrate the passed in sub
          * @param sub to be calibrated
+         * @param dark master to subtract (empty for none)
+         * @param flat master to divide by (empty for none)
          * @return success (or not)
          */
-        bool calibrateSub(cv::Mat &sub);
+        bool calibrateSub(cv::Mat &sub, const cv::Mat &dark, const cv::Mat &flat);
 
         /**
          * @brief Stack the passed in vector of subs
@@ -318,7 +344,9 @@ class FITSStack : public QObject
         cv::Mat stackSubsSigmaClipping(const QVector<float> &weights);
 
         /**
-         * @brief Called by stackSubsSigmaClipping to do the sigma clipping on pixel at position x
+         * @brief Called by stackSubsSigmaClipping to do the sigma clipping on pixel at position x. This is the
+         *        reference per pixel implementation, used when the subs can't be processed as 1D arrays.
+         *        Otherwise FITSSigmaClipKernel is used to process batches of pixels.
          * @param x position to process
          * @param imagesPtrs array of pointers to each image
          * @param finalImagePtr results image
@@ -335,6 +363,82 @@ class FITSStack : public QObject
          */
         cv::Mat stacknSubsSigmaClipping(const QVector<float> &weights);
 
+        /**
+         * @brief Replace the image of a sub with its aligned version. In tiled mode the aligned image is
+         *        written back into the sub's scratch slot.
+         * @param sub image to update
+         * @param aligned image
+         */
+        void setAlignedSub(cv::Mat &sub, const cv::Mat &aligned);
+
+        /**
+         * @brief Calibrate and align a sub. Called on m_PreparePool so must not touch m_StackImageData or the masters
+         * @param image of the sub. This is calibrated in place
+         * @param isCalibrated true if the sub has already been calibrated
+         * @param dark the master dark when the job was started, as addMaster() may replace it meanwhile
+         * @param flat the master flat when the job was started
+         * @param refWCS the job's own copy of the alignment reference (nullptr if this sub is the reference)
+         * @param subWCS of the sub
+         * @return status and the aligned image
+         */
+        PreparedSub prepareSub(cv::Mat image, const bool isCalibrated, const cv::Mat &dark, const cv::Mat &flat,
+                               struct wcsprm * refWCS, struct wcsprm * subWCS);
+
+        /**
+         * @brief Start preparing (calibrating and aligning) sub i on m_PreparePool if not already started
+         * @param i index of the sub
+         */
+        void startPrepareSub(const int i);
+
+        /**
+         * @brief Prepare any subs not already started and wait for all of them, storing the results in sub order
+         */
+        void collectPreparedSubs();
+
+        /**
+         * @brief Get the number of rows to process together so a tile across all subs fits the memory budget
+         * @param numSubs being stacked
+         * @param rows in each sub
+         * @return rows per tile (rows if not in tiled mode)
+         */
+        int getTileRows(const int numSubs, const int rows);
+
+        /**
+         * @brief In tiled mode release the memory backing a band of rows of each sub once it has been stacked
+         * @param startRow of the band
+         * @param numRows in the band
+         */
+        void releaseTile(const int startRow, const int numRows);
+
+        /**
+         * @brief Called by stacknSubsSigmaClipping to add the new subs' values at pixel position x to the stack
+         * @param x position to process
+         * @param imagesPtrs array of pointers to each image
+         * @param finalImagePtr results image
+         * @param sigmaClipPtr intermediate results pointer
+         * @param onlineCountPtr running number of accepted samples pointer
+         * @param onlineClipPtr running estimates (mean, M2) pointer
+         * @param weights to apply to sigma clipping
+         */
+        void stacknSigmaClipPixel(int x, const std::vector<const float *> &imagesPtrs, float *finalImagePtr,
+                                  const QVector<cv::Vec4f *> &sigmaClipPtr, const QVector<int *> &onlineCountPtr,
+                                  const QVector<cv::Vec2f *> &onlineClipPtr, const QVector<float> &weights);
+
+        /**
+         * @brief Setup the running per pixel estimates used for incremental sigma clipping from the initial stack
+         * @param weights of each sub in the initial stack
+         */
+        void seedOnlineClipping(const QVector<float> &weights);
+
+        /**
+         * @brief Get the variance of a normal distribution truncated at the sigma clipping limits as a
+         *        fraction of the full variance
+         * @param lowSigma clipping limit
+         * @param highSigma clipping limit
+         * @return variance factor (1.0 if no clipping)
+         */
+        static float truncatedVarianceFactor(const double lowSigma, const double highSigma);
+
         /**
          * @brief Store the WCS for the stack image based on the WCS for the master alignment sub
          * @param wcs is the master alignment sub WCS
@@ -419,6 +523,8 @@ class FITSStack : public QObject
             struct wcsprm * wcsprm;
             double hfr;
             int numStars;
+            bool isPreparing;
+            QFuture<PreparedSub> prepared;
         } StackImageData;
         QVector<StackImageData> m_StackImageData;
 
@@ -454,6 +560,14 @@ class FITSStack : public QObject
         // Stacking
         cv::Mat m_StackedImage32F;
         QVector<cv::Mat> m_SigmaClip32FC4;
+        // Running estimates of accepted samples for incremental sigma clipping: the count, then (mean, M2)
+        QVector<cv::Mat> m_OnlineCount32S;
+        QVector<cv::Mat> m_OnlineClip32FC2;
+        float m_TruncatedVarianceFactor { 1.0f };
+        static constexpr int ONLINE_CLIP_MIN_SAMPLES { 4 };
+        FITSStackScratch m_Scratch;
+        // Calibration and alignment of subs. Declared after the data it uses so it is destroyed (and waits) first
+        QThreadPool m_PreparePool;
         QSharedPointer<QByteArray> m_StackedBuffer { nullptr };
 
         // Stack Image
@@ -465,4 +579,6 @@ class FITSStack : public QObject
         int m_Channels { 0 };
         int m_BytesPerPixel { 0 };
         int m_CVType { 0 };
+
+        friend class TestFitsStack;
 };
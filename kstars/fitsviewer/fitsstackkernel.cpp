@@ -0,0 +1,289 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitsstackkernel.h"
+
+#include "opencv2/core/hal/intrin.hpp"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+#if CV_SIMD128
+constexpr int LANES = 4;
+#else
+constexpr int LANES = 1;
+#endif
+
+// Build the comparators of Batcher's odd-even merge sort for n values. Works for any n, not just powers of 2.
+std::vector<std::pair<int, int>> buildSortingNetwork(const int n)
+{
+    std::vector<std::pair<int, int>> network;
+    for (int p = 1; p < n; p *= 2)
+    {
+        for (int k = p; k >= 1; k /= 2)
+        {
+            for (int j = k % p; j + k < n; j += 2 * k)
+            {
+                for (int i = 0; i < std::min(k, n - j - k); i++)
+                {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+                        network.push_back(std::make_pair(i + j, i + j + k));
+                }
+            }
+        }
+    }
+    return network;
+}
+
+// Sample standard deviation (n - 1 denominator) using a 2 pass algorithm
+float scalarStdDev(const float *values, const int n)
+{
+    if (n < 2)
+        return 0.0f;
+
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++)
+        sum += values[i];
+    const float mean = sum / n;
+
+    float sumSq = 0.0f;
+    for (int i = 0; i < n; i++)
+    {
+        const float diff = values[i] - mean;
+        sumSq += diff * diff;
+    }
+    return std::sqrt(sumSq / (n - 1));
+}
+
+float scalarMedianFromSorted(const float *sorted, const int n)
+{
+    return (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * 0.5f;
+}
+
+#if CV_SIMD128
+cv::v_float32x4 laneStdDev(const cv::v_float32x4 *values, const int n)
+{
+    if (n < 2)
+        return cv::v_setzero_f32();
+
+    cv::v_float32x4 sum = cv::v_setzero_f32();
+    for (int i = 0; i < n; i++)
+        sum = sum + values[i];
+    const cv::v_float32x4 mean = sum / cv::v_setall_f32(static_cast<float>(n));
+
+    cv::v_float32x4 sumSq = cv::v_setzero_f32();
+    for (int i = 0; i < n; i++)
+    {
+        const cv::v_float32x4 diff = values[i] - mean;
+        sumSq = sumSq + diff * diff;
+    }
+    return cv::v_sqrt(sumSq / cv::v_setall_f32(static_cast<float>(n - 1)));
+}
+
+cv::v_float32x4 laneMedianFromSorted(const cv::v_float32x4 *sorted, const int n)
+{
+    return (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * cv::v_setall_f32(0.5f);
+}
+#endif
+}
+
+FITSSigmaClipKernel::FITSSigmaClipKernel(const int numImages, const int channels, const Params &params,
+        const std::vector<float> &weights) : m_NumImages(numImages), m_Channels(channels), m_Params(params),
+    m_Weights(weights)
+{
+    m_Network = buildSortingNetwork(numImages);
+}
+
+bool FITSSigmaClipKernel::hasSIMD()
+{
+    return LANES > 1;
+}
+
+int FITSSigmaClipKernel::lanes()
+{
+    return LANES;
+}
+
+void FITSSigmaClipKernel::clip(const int start, const int end, const float * const *imagesPtrs,
+                               float *finalImagePtr, cv::Vec4f * const *sigmaClipPtr, const bool useSIMD) const
+{
+    if (m_NumImages <= 0 || end <= start)
+        return;
+
+    // Working storage for the batch: the values in sub order (needed to apply each sub's weight) and sorted
+    std::vector<float> values(m_NumImages), sorted(m_NumImages);
+
+    int x = start;
+#if CV_SIMD128
+    if (useSIMD)
+    {
+        std::vector<cv::v_float32x4> laneValues(m_NumImages), laneSorted(m_NumImages);
+        for (; x + LANES <= end; x += LANES)
+        {
+            for (int ch = 0; ch < m_Channels; ch++)
+                clipLanes(x, ch, imagesPtrs, finalImagePtr, sigmaClipPtr, laneValues.data(), laneSorted.data());
+        }
+    }
+#else
+    Q_UNUSED(useSIMD);
+#endif
+
+    // Scalar fallback, also used for the tail of the batch
+    for (; x < end; x++)
+    {
+        for (int ch = 0; ch < m_Channels; ch++)
+            clipScalar(x, ch, imagesPtrs, finalImagePtr, sigmaClipPtr, values.data(), sorted.data());
+    }
+}
+
+void FITSSigmaClipKernel::clipScalar(const int x, const int ch, const float * const *imagesPtrs, float *finalImagePtr,
+                                     cv::Vec4f * const *sigmaClipPtr, float *values, float *sorted) const
+{
+    const int n = m_NumImages;
+    const int offset = x * m_Channels + ch;
+    for (int i = 0; i < n; i++)
+        values[i] = sorted[i] = imagesPtrs[i][offset];
+    std::sort(sorted, sorted + n);
+
+    float median = scalarMedianFromSorted(sorted, n);
+
+    if (m_Params.winsorize && n > 1)
+    {
+        // Winsorize the data. Clamping keeps the sorted values in order so no need to sort again
+        const float stddev = scalarStdDev(values, n);
+        const float lower = std::max(0.0f, median - stddev * m_Params.winsorCutoff);
+        const float upper = median + stddev * m_Params.winsorCutoff;
+        for (int i = 0; i < n; i++)
+        {
+            values[i] = std::min(std::max(values[i], lower), upper);
+            sorted[i] = std::min(std::max(sorted[i], lower), upper);
+        }
+        median = scalarMedianFromSorted(sorted, n);
+    }
+
+    float pixelValue = median;
+    float sum = 0.0f, weightSum = 0.0f, lower = -1.0f, upper = -1.0f;
+    if (n > 3)
+    {
+        const float stddev = scalarStdDev(values, n);
+        lower = std::max(0.0f, median - stddev * m_Params.lowSigma);
+        upper = median + stddev * m_Params.highSigma;
+
+        for (int i = 0; i < n; i++)
+        {
+            if (values[i] < lower || values[i] > upper)
+                continue;
+
+            sum += values[i] * m_Weights[i];
+            weightSum += m_Weights[i];
+        }
+
+        if (weightSum > 0.0f)
+            pixelValue = sum / weightSum;
+    }
+
+    sigmaClipPtr[ch][x] = cv::Vec4f(lower, upper, sum, weightSum);
+    finalImagePtr[offset] = pixelValue;
+}
+
+void FITSSigmaClipKernel::clipLanes(const int x, const int ch, const float * const *imagesPtrs, float *finalImagePtr,
+                                    cv::Vec4f * const *sigmaClipPtr, void *valuesBuffer, void *sortedBuffer) const
+{
+#if CV_SIMD128
+    using cv::v_float32x4;
+
+    const int n = m_NumImages;
+    v_float32x4 *values = static_cast<v_float32x4 *>(valuesBuffer);
+    v_float32x4 *sorted = static_cast<v_float32x4 *>(sortedBuffer);
+
+    // Gather LANES consecutive pixels of this channel from each sub. Mono subs can be loaded directly
+    alignas(16) float lane[LANES];
+    for (int i = 0; i < n; i++)
+    {
+        if (m_Channels == 1)
+            values[i] = cv::v_load(imagesPtrs[i] + x);
+        else
+        {
+            for (int l = 0; l < LANES; l++)
+                lane[l] = imagesPtrs[i][(x + l) * m_Channels + ch];
+            values[i] = cv::v_load_aligned(lane);
+        }
+        sorted[i] = values[i];
+    }
+
+    // Sort each lane with the sorting network - branch free min / max on whole vectors
+    for (const auto &comparator : m_Network)
+    {
+        const v_float32x4 a = sorted[comparator.first];
+        const v_float32x4 b = sorted[comparator.second];
+        sorted[comparator.first] = cv::v_min(a, b);
+        sorted[comparator.second] = cv::v_max(a, b);
+    }
+
+    const v_float32x4 zero = cv::v_setzero_f32();
+    v_float32x4 median = laneMedianFromSorted(sorted, n);
+
+    if (m_Params.winsorize && n > 1)
+    {
+        const v_float32x4 stddev = laneStdDev(values, n);
+        const v_float32x4 cutoff = cv::v_setall_f32(m_Params.winsorCutoff);
+        const v_float32x4 lower = cv::v_max(zero, median - stddev * cutoff);
+        const v_float32x4 upper = median + stddev * cutoff;
+        for (int i = 0; i < n; i++)
+        {
+            values[i] = cv::v_min(cv::v_max(values[i], lower), upper);
+            sorted[i] = cv::v_min(cv::v_max(sorted[i], lower), upper);
+        }
+        median = laneMedianFromSorted(sorted, n);
+    }
+
+    v_float32x4 pixelValue = median;
+    v_float32x4 sum = zero, weightSum = zero;
+    v_float32x4 lower = cv::v_setall_f32(-1.0f), upper = cv::v_setall_f32(-1.0f);
+    if (n > 3)
+    {
+        const v_float32x4 stddev = laneStdDev(values, n);
+        lower = cv::v_max(zero, median - stddev * cv::v_setall_f32(m_Params.lowSigma));
+        upper = median + stddev * cv::v_setall_f32(m_Params.highSigma);
+
+        for (int i = 0; i < n; i++)
+        {
+            const v_float32x4 weight = cv::v_setall_f32(m_Weights[i]);
+            const v_float32x4 keep = (values[i] >= lower) & (values[i] <= upper);
+            sum = sum + cv::v_select(keep, values[i] * weight, zero);
+            weightSum = weightSum + cv::v_select(keep, weight, zero);
+        }
+
+        const v_float32x4 valid = weightSum > zero;
+        pixelValue = cv::v_select(valid, sum / cv::v_select(valid, weightSum, cv::v_setall_f32(1.0f)), median);
+    }
+
+    // Scatter the results
+    alignas(16) float outValue[LANES], outLower[LANES], outUpper[LANES], outSum[LANES], outWeightSum[LANES];
+    cv::v_store_aligned(outValue, pixelValue);
+    cv::v_store_aligned(outLower, lower);
+    cv::v_store_aligned(outUpper, upper);
+    cv::v_store_aligned(outSum, sum);
+    cv::v_store_aligned(outWeightSum, weightSum);
+    for (int l = 0; l < LANES; l++)
+    {
+        sigmaClipPtr[ch][x + l] = cv::Vec4f(outLower[l], outUpper[l], outSum[l], outWeightSum[l]);
+        finalImagePtr[(x + l) * m_Channels + ch] = outValue[l];
+    }
+#else
+    Q_UNUSED(x);
+    Q_UNUSED(ch);
+    Q_UNUSED(imagesPtrs);
+    Q_UNUSED(finalImagePtr);
+    Q_UNUSED(sigmaClipPtr);
+    Q_UNUSED(valuesBuffer);
+    Q_UNUSED(sortedBuffer);
+#endif
+}
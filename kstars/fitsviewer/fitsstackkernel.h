@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "opencv2/core.hpp"
+
+/**
+ * @brief The FITSSigmaClipKernel class does the per pixel sigma clipping (and Winsorization) for FITSStack
+ *        on a batch of pixels at a time.
+ *
+ *        The values for each pixel are held in SIMD lanes (SSE / NEON via OpenCV universal intrinsics) so that
+ *        several pixel columns are clipped together. The median is found with a sorting network rather than a
+ *        sort, and all the working storage is allocated once per batch rather than per pixel. Builds without
+ *        SIMD support, and the pixels at the end of a batch that don't fill a vector, use a scalar version of
+ *        the same algorithm.
+ *
+ *        For each pixel the kernel writes the stacked value and the same intermediate data (lower, upper, sum,
+ *        weight sum) that FITSStack::stackSigmaClipPixel stores for use by incremental stacking.
+ *
+ * @author KStars Developers
+ */
+class FITSSigmaClipKernel
+{
+    public:
+        typedef struct
+        {
+            bool winsorize;
+            float winsorCutoff;
+            float lowSigma;
+            float highSigma;
+        } Params;
+
+        /**
+         * @brief Construct a kernel for a given set of subs
+         * @param numImages is the number of subs being stacked
+         * @param channels in each sub (1 or 3). Channels are interleaved
+         * @param params for the clipping process
+         * @param weights for each sub
+         */
+        FITSSigmaClipKernel(const int numImages, const int channels, const Params &params,
+                            const std::vector<float> &weights);
+
+        /**
+         * @brief Clip pixels [start, end)
+         * @param start is the first pixel to process
+         * @param end is one beyond the last pixel to process
+         * @param imagesPtrs array of numImages pointers to each sub
+         * @param finalImagePtr results image
+         * @param sigmaClipPtr array of channels pointers to the intermediate results
+         * @param useSIMD set to false to force the scalar path (for testing and benchmarking)
+         */
+        void clip(const int start, const int end, const float * const *imagesPtrs, float *finalImagePtr,
+                  cv::Vec4f * const *sigmaClipPtr, const bool useSIMD = true) const;
+
+        /**
+         * @brief Whether the build has SIMD support for the kernel
+         * @return SIMD available (or not)
+         */
+        static bool hasSIMD();
+
+        /**
+         * @brief Number of pixels clipped together in SIMD lanes. Batches that start on a multiple of this clip
+         *        each pixel the same way (lanes or scalar tail), whatever their size
+         * @return pixels per vector (1 without SIMD support)
+         */
+        static int lanes();
+
+    private:
+        void clipScalar(const int x, const int ch, const float * const *imagesPtrs, float *finalImagePtr,
+                        cv::Vec4f * const *sigmaClipPtr, float *values, float *sorted) const;
+        void clipLanes(const int x, const int ch, const float * const *imagesPtrs, float *finalImagePtr,
+                       cv::Vec4f * const *sigmaClipPtr, void *values, void *sorted) const;
+
+        int m_NumImages { 0 };
+        int m_Channels { 1 };
+        Params m_Params;
+        std::vector<float> m_Weights;
+        // Comparators of a Batcher odd-even merge sorting network for m_NumImages values
+        std::vector<std::pair<int, int>> m_Network;
+};
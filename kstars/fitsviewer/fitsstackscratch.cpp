@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitsstackscratch.h"
+#include "kspaths.h"
+#include <fits_debug.h>
+
+#include <QDir>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+FITSStackScratch::FITSStackScratch()
+{
+}
+
+FITSStackScratch::~FITSStackScratch()
+{
+    clear();
+}
+
+bool FITSStackScratch::open()
+{
+    if (m_File.isOpen())
+        return true;
+
+    QDir tempDir(KSPaths::writableLocation(QStandardPaths::TempLocation));
+    tempDir.mkpath(".");
+    m_File.setFileTemplate(tempDir.filePath("livestack_XXXXXX.scratch"));
+    if (!m_File.open())
+    {
+        qCDebug(KSTARS_FITS) << QString("Unable to open live stacking scratch file %1: %2")
+                             .arg(m_File.fileTemplate(), m_File.errorString());
+        return false;
+    }
+    return true;
+}
+
+cv::Mat FITSStackScratch::append(const cv::Mat &image)
+{
+    if (image.empty())
+        return cv::Mat();
+
+    if (m_Slots.isEmpty())
+    {
+        m_Rows = image.rows;
+        m_Cols = image.cols;
+        m_Type = image.type();
+        m_FrameBytes = static_cast<qint64>(image.total()) * image.elemSize();
+    }
+    else if (image.rows != m_Rows || image.cols != m_Cols || image.type() != m_Type)
+    {
+        qCDebug(KSTARS_FITS) << QString("%1 frame is inconsistent with the scratch file").arg(__FUNCTION__);
+        return cv::Mat();
+    }
+
+    if (!open())
+        return cv::Mat();
+
+    const qint64 offset = m_Slots.size() * m_FrameBytes;
+    if (!m_File.resize(offset + m_FrameBytes))
+    {
+        qCDebug(KSTARS_FITS) << QString("Unable to grow live stacking scratch file: %1").arg(m_File.errorString());
+        return cv::Mat();
+    }
+
+    uchar *slot = m_File.map(offset, m_FrameBytes);
+    if (slot == nullptr)
+    {
+        qCDebug(KSTARS_FITS) << QString("Unable to map live stacking scratch file: %1").arg(m_File.errorString());
+        m_File.resize(offset);
+        return cv::Mat();
+    }
+    m_Slots.push_back(slot);
+
+    // The slot is continuous so copyTo writes straight into the mapped memory without reallocating
+    cv::Mat frame(m_Rows, m_Cols, m_Type, slot);
+    image.copyTo(frame);
+    releaseRows(frame, 0, m_Rows);
+    return frame;
+}
+
+void FITSStackScratch::releaseRows(const cv::Mat &frame, int startRow, int numRows) const
+{
+#ifdef Q_OS_UNIX
+    if (frame.empty() || numRows <= 0)
+        return;
+
+    // madvise needs page aligned addresses so only release the whole pages inside the band
+    const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(frame.ptr(startRow));
+    uintptr_t end = start + static_cast<uintptr_t>(numRows) * frame.step[0];
+    start = (start + pageSize - 1) & ~(pageSize - 1);
+    end &= ~(pageSize - 1);
+    if (end > start)
+        madvise(reinterpret_cast<void *>(start), end - start, MADV_DONTNEED);
+#else
+    Q_UNUSED(frame);
+    Q_UNUSED(startRow);
+    Q_UNUSED(numRows);
+#endif
+}
+
+void FITSStackScratch::clear()
+{
+    for (auto slot : m_Slots)
+        m_File.unmap(slot);
+    m_Slots.clear();
+
+    if (m_File.isOpen())
+        m_File.resize(0);
+}
+
+int FITSStackScratch::tileRows(int budgetMB, int numFrames, size_t rowBytes, int rows)
+{
+    if (budgetMB <= 0 || numFrames <= 0 || rowBytes == 0)
+        return rows;
+
+    const size_t budget = static_cast<size_t>(budgetMB) * 1024 * 1024;
+    const size_t tile = budget / (static_cast<size_t>(numFrames) * rowBytes);
+    return std::max(1, std::min(rows, static_cast<int>(std::min(tile, static_cast<size_t>(rows)))));
+}
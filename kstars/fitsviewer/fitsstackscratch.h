@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QTemporaryFile>
+#include <QVector>
+
+#include "opencv2/core.hpp"
+
+/**
+ * @brief The FITSStackScratch class is a disk backed store for the subs used by FITSStack when stacking
+ *        in tiled (out-of-core) mode.
+ *
+ *        Each sub is written into its own slot of a memory-mapped scratch file and handed back to the
+ *        caller as a cv::Mat header over the mapped memory, so calibration and alignment can work on it
+ *        in place. The stacking routines then walk the subs a band of rows (a tile) at a time and release
+ *        the pages of each tile once it has been processed, so the resident memory used is governed by the
+ *        tile size rather than the number of subs.
+ *
+ *        All frames in the store must have the same size and type as the first frame appended.
+ *
+ * @author KStars Developers
+ */
+class FITSStackScratch
+{
+    public:
+        FITSStackScratch();
+        ~FITSStackScratch();
+
+        /**
+         * @brief Append a frame to the scratch file
+         * @param image to copy into the new slot
+         * @return cv::Mat header over the mapped slot (empty Mat on failure)
+         */
+        cv::Mat append(const cv::Mat &image);
+
+        /**
+         * @brief Drop the OS pages backing a band of rows of a frame. The data is kept in the scratch file
+         *        and is paged back in transparently if accessed again.
+         * @param frame previously returned by append
+         * @param startRow first row of the band
+         * @param numRows number of rows in the band
+         */
+        void releaseRows(const cv::Mat &frame, int startRow, int numRows) const;
+
+        /**
+         * @brief Unmap all slots and truncate the scratch file. Any cv::Mat headers returned by append
+         *        must have been released before calling this.
+         */
+        void clear();
+
+        /**
+         * @brief Get the number of frames currently stored
+         * @return number of frames
+         */
+        int size() const
+        {
+            return m_Slots.size();
+        }
+
+        /**
+         * @brief Calculate the number of rows in a tile so that a tile across all frames fits the budget
+         * @param budgetMB is the memory budget in MB
+         * @param numFrames is the number of frames processed together
+         * @param rowBytes is the size in bytes of a single row of a frame
+         * @param rows is the number of rows in a frame
+         * @return rows per tile (at least 1, at most rows)
+         */
+        static int tileRows(int budgetMB, int numFrames, size_t rowBytes, int rows);
+
+    private:
+        bool open();
+
+        QTemporaryFile m_File;
+        QVector<uchar *> m_Slots;
+        qint64 m_FrameBytes { 0 };
+        int m_Rows { 0 };
+        int m_Cols { 0 };
+        int m_Type { 0 };
+};
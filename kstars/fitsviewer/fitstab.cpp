@@ -941,6 +941,7 @@ void FITSTab::initSettings()
     m_LiveStackingUI.MasterFlat->setText(Options::fitsLSMasterFlat());
     m_LiveStackingUI.AlignMethod->setCurrentIndex(Options::fitsLSAlignMethod());
     m_LiveStackingUI.NumInMem->setValue(Options::fitsLSNumInMem());
+    m_LiveStackingUI.TileMemory->setValue(Options::fitsLSTileMemory());
     m_LiveStackingUI.LSDownscale->setCurrentIndex(Options::fitsLSDownscale());
     m_LiveStackingUI.Weighting->setCurrentIndex(Options::fitsLSWeighting());
     m_LiveStackingUI.Rejection->setCurrentIndex(Options::fitsLSRejection());
@@ -961,6 +962,7 @@ void FITSTab::saveSettings()
     Options::setFitsLSMasterFlat(m_LiveStackingUI.MasterFlat->text());
     Options::setFitsLSAlignMethod(m_LiveStackingUI.AlignMethod->currentIndex());
     Options::setFitsLSNumInMem(m_LiveStackingUI.NumInMem->value());
+    Options::setFitsLSTileMemory(m_LiveStackingUI.TileMemory->value());
     Options::setFitsLSDownscale(m_LiveStackingUI.LSDownscale->currentIndex());
     Options::setFitsLSWeighting(m_LiveStackingUI.Weighting->currentIndex());
     Options::setFitsLSRejection(m_LiveStackingUI.Rejection->currentIndex());
@@ -986,6 +988,7 @@ LiveStackData FITSTab::getAllSettings()
     data.alignMaster = m_LiveStackingUI.AlignMaster->text();
     data.alignMethod = static_cast<LiveStackAlignMethod>(m_LiveStackingUI.AlignMethod->currentIndex());
     data.numInMem = m_LiveStackingUI.NumInMem->value();
+    data.tileMemory = m_LiveStackingUI.TileMemory->value();
     data.downscale = static_cast<LiveStackDownscale>(m_LiveStackingUI.LSDownscale->currentIndex());
     data.weighting = static_cast<LiveStackFrameWeighting>(m_LiveStackingUI.Weighting->currentIndex());
     data.rejection = static_cast<LiveStackRejection>(m_LiveStackingUI.Rejection->currentIndex());
@@ -1038,7 +1041,7 @@ void FITSTab::selectLiveStackAlignSub()
 {
     QString selectedFilter;
     QString file = QFileDialog::getOpenFileName(this, i18nc("@title:window", "Select Alignment Sub"),
-                   m_liveStackDir, "FITS (*.fits *.fits.gz *.fit);;XISF (*.xisf)", &selectedFilter);
+                   m_liveStackDir, "FITS (*.fits *.fits.fz *.fits.gz *.fit);;XISF (*.xisf)", &selectedFilter);
     if (!file.isNull())
     {
         QUrl sequenceURL = QUrl::fromLocalFile(file);
@@ -1052,7 +1055,7 @@ void FITSTab::selectLiveStackMasterDark()
 {
     QString selectedFilter;
     QString file = QFileDialog::getOpenFileName(this, i18nc("@title:window", "Select Master Dark"),
-                                m_CurrentStackDir, "FITS (*.fits *.fits.gz *.fit);;XISF (*.xisf)", &selectedFilter);
+                                m_CurrentStackDir, "FITS (*.fits *.fits.fz *.fits.gz *.fit);;XISF (*.xisf)", &selectedFilter);
     if (!file.isNull())
     {
         QUrl sequenceURL = QUrl::fromLocalFile(file);
@@ -1066,7 +1069,7 @@ void FITSTab::selectLiveStackMasterFlat()
 {
     QString selectedFilter;
     QString file = QFileDialog::getOpenFileName(this, i18nc("@title:window", "Select Master Flat"),
-                   m_CurrentStackDir, "FITS (*.fits *.fits.gz *.fit);;XISF (*.xisf)", &selectedFilter);
+                   m_CurrentStackDir, "FITS (*.fits *.fits.fz *.fits.gz *.fit);;XISF (*.xisf)", &selectedFilter);
     if (!file.isNull())
     {
         QUrl sequenceURL = QUrl::fromLocalFile(file);
@@ -1168,11 +1171,11 @@ bool FITSTab::saveFile()
 #ifdef Q_OS_MACOS //For some reason, the other code caused KStars to crash on MacOS
         currentURL =
             QFileDialog::getSaveFileUrl(KStars::Instance(), i18nc("@title:window", "Save FITS"), currentDir,
-                                        "Images (*.fits *.fits.gz *.fit *.xisf *.jpg *.jpeg *.png)");
+                                        "Images (*.fits *.fits.fz *.fits.gz *.fit *.xisf *.jpg *.jpeg *.png)");
 #else
         currentURL =
             QFileDialog::getSaveFileUrl(KStars::Instance(), i18nc("@title:window", "Save FITS"), currentDir,
-                                        "FITS (*.fits *.fits.gz *.fit);;XISF (*.xisf);;JPEG (*.jpg *.jpeg);;PNG (*.png)", &selectedFilter);
+                                        "FITS (*.fits *.fits.fz *.fits.gz *.fit);;XISF (*.xisf);;JPEG (*.jpg *.jpeg);;PNG (*.png)", &selectedFilter);
 #endif
         // if user presses cancel
         if (currentURL.isEmpty())
@@ -0,0 +1,296 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitstilepyramid.h"
+
+#include "fitsdata.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+const QVector<QRgb> &grayColorTable()
+{
+    static const QVector<QRgb> table = []()
+    {
+        QVector<QRgb> colors(256);
+        for (int i = 0; i < 256; i++)
+            colors[i] = qRgb(i, i, i);
+        return colors;
+    }();
+    return table;
+}
+
+// Average of 4 pixels, rounded
+inline uint8_t averagePixels(int a, int b, int c, int d)
+{
+    return (a + b + c + d + 2) / 4;
+}
+}
+
+FITSTilePyramid::FITSTilePyramid(qint64 maxTileBytes) : m_MaxTileBytes(maxTileBytes)
+{
+}
+
+FITSTilePyramid::~FITSTilePyramid() = default;
+
+void FITSTilePyramid::reset(const QSharedPointer<FITSData> &data, const StretchParams &params, int sampling)
+{
+    clear();
+    m_Data = data;
+    m_Params = params;
+    m_Sampling = std::max(1, sampling);
+    m_Levels = 0;
+    m_Stretch.reset();
+
+    if (m_Data.isNull() || m_Data->getImageBuffer() == nullptr || m_Data->width() == 0 || m_Data->height() == 0)
+        return;
+
+    m_Stretch.reset(new Stretch(m_Data->width(), m_Data->height(), m_Data->channels(), m_Data->dataType()));
+    m_Stretch->setParams(params);
+    m_Stretch->recalculateInputRange(m_Data->getImageBuffer());
+
+    // Up to the level that fits in a single tile
+    m_Levels = 1;
+    for (QSize size = levelSize(0); size.width() > TILE_SIZE || size.height() > TILE_SIZE; m_Levels++)
+        size = QSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+}
+
+void FITSTilePyramid::clear()
+{
+    m_Tiles.clear();
+    m_TileBytes = 0;
+}
+
+QSize FITSTilePyramid::levelSize(int level) const
+{
+    int width = (m_Data->width() + m_Sampling - 1) / m_Sampling;
+    int height = (m_Data->height() + m_Sampling - 1) / m_Sampling;
+    for (int i = 0; i < level; i++)
+    {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+    return QSize(width, height);
+}
+
+QSize FITSTilePyramid::tileCount(int level) const
+{
+    const QSize size = levelSize(level);
+    return QSize((size.width() + TILE_SIZE - 1) / TILE_SIZE, (size.height() + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+QSize FITSTilePyramid::tileSize(int level, const QPoint &tile) const
+{
+    const QSize size = levelSize(level);
+    return QSize(std::min(TILE_SIZE, size.width() - tile.x() * TILE_SIZE),
+                 std::min(TILE_SIZE, size.height() - tile.y() * TILE_SIZE));
+}
+
+QImage FITSTilePyramid::newTile(const QSize &size) const
+{
+    if (m_Data->channels() == 1)
+    {
+        QImage tile(size, QImage::Format_Indexed8);
+        tile.setColorTable(grayColorTable());
+        return tile;
+    }
+    return QImage(size, QImage::Format_RGB32);
+}
+
+QImage FITSTilePyramid::stretchTile(const QPoint &tile) const
+{
+    QImage image = newTile(tileSize(0, tile));
+    const int x = tile.x() * TILE_SIZE * m_Sampling;
+    const int y = tile.y() * TILE_SIZE * m_Sampling;
+    const QRect region(x, y, std::min(TILE_SIZE * m_Sampling, m_Data->width() - x),
+                       std::min(TILE_SIZE * m_Sampling, m_Data->height() - y));
+    m_Stretch->run(m_Data->getImageBuffer(), &image, region, m_Sampling);
+    return image;
+}
+
+QImage FITSTilePyramid::reduceTile(int level, const QPoint &tile) const
+{
+    QImage image = newTile(tileSize(level, tile));
+    const bool color = image.format() == QImage::Format_RGB32;
+
+    // Each child covers a quarter of the tile, the last row and column of odd sized children are repeated.
+    for (int cy = 0; cy < 2; cy++)
+    {
+        for (int cx = 0; cx < 2; cx++)
+        {
+            const auto child = m_Tiles.constFind(key(level - 1, QPoint(2 * tile.x() + cx, 2 * tile.y() + cy)));
+            if (child == m_Tiles.constEnd())
+                continue;
+
+            const QImage &input = child.value().image;
+            const int width = (input.width() + 1) / 2, height = (input.height() + 1) / 2;
+            const int outX = cx * TILE_SIZE / 2, outY = cy * TILE_SIZE / 2;
+            for (int y = 0; y < height; y++)
+            {
+                const int y0 = 2 * y, y1 = std::min(2 * y + 1, input.height() - 1);
+                if (color)
+                {
+                    const QRgb *line0 = reinterpret_cast<const QRgb *>(input.constScanLine(y0));
+                    const QRgb *line1 = reinterpret_cast<const QRgb *>(input.constScanLine(y1));
+                    QRgb *output = reinterpret_cast<QRgb *>(image.scanLine(outY + y)) + outX;
+                    for (int x = 0; x < width; x++)
+                    {
+                        const int x0 = 2 * x, x1 = std::min(2 * x + 1, input.width() - 1);
+                        output[x] = qRgb(averagePixels(qRed(line0[x0]), qRed(line0[x1]), qRed(line1[x0]), qRed(line1[x1])),
+                                         averagePixels(qGreen(line0[x0]), qGreen(line0[x1]), qGreen(line1[x0]), qGreen(line1[x1])),
+                                         averagePixels(qBlue(line0[x0]), qBlue(line0[x1]), qBlue(line1[x0]), qBlue(line1[x1])));
+                    }
+                }
+                else
+                {
+                    const uint8_t *line0 = input.constScanLine(y0);
+                    const uint8_t *line1 = input.constScanLine(y1);
+                    uint8_t *output = image.scanLine(outY + y) + outX;
+                    for (int x = 0; x < width; x++)
+                    {
+                        const int x0 = 2 * x, x1 = std::min(2 * x + 1, input.width() - 1);
+                        output[x] = averagePixels(line0[x0], line0[x1], line1[x0], line1[x1]);
+                    }
+                }
+            }
+        }
+    }
+    return image;
+}
+
+void FITSTilePyramid::makeTiles(int level, const QVector<QPoint> &tiles)
+{
+    QVector<QPoint> missing;
+    for (const auto &tile : tiles)
+    {
+        if (!m_Tiles.contains(key(level, tile)))
+            missing.append(tile);
+    }
+    if (missing.isEmpty())
+        return;
+
+    QVector<QPoint> children;
+    if (level > 0)
+    {
+        const QSize count = tileCount(level - 1);
+        for (const auto &tile : missing)
+        {
+            for (int cy = 0; cy < 2; cy++)
+                for (int cx = 0; cx < 2; cx++)
+                {
+                    const QPoint child(2 * tile.x() + cx, 2 * tile.y() + cy);
+                    if (child.x() < count.width() && child.y() < count.height())
+                        children.append(child);
+                }
+        }
+        makeTiles(level - 1, children);
+    }
+
+    // Tiles only read the data or the level below, they are computed in parallel.
+    QVector<QImage> images(missing.size());
+    QVector<int> indexes(missing.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&](int i)
+    {
+        images[i] = level == 0 ? stretchTile(missing[i]) : reduceTile(level, missing[i]);
+    });
+
+    for (int i = 0; i < missing.size(); i++)
+    {
+        m_TileBytes += images[i].sizeInBytes();
+        m_Tiles.insert(key(level, missing[i]), { images[i], 0 });
+    }
+
+    // Over the budget, children that were never drawn themselves are not needed anymore.
+    // Otherwise reducing a large frame would keep all its level 0 tiles.
+    if (m_TileBytes > m_MaxTileBytes)
+    {
+        for (const auto &child : children)
+        {
+            const auto it = m_Tiles.find(key(level - 1, child));
+            if (it != m_Tiles.end() && it.value().drawn == 0)
+            {
+                m_TileBytes -= it.value().image.sizeInBytes();
+                m_Tiles.erase(it);
+            }
+        }
+    }
+}
+
+void FITSTilePyramid::evictTiles()
+{
+    if (m_TileBytes <= m_MaxTileBytes)
+        return;
+
+    QVector<QPair<quint64, quint64>> candidates;
+    for (auto it = m_Tiles.constBegin(); it != m_Tiles.constEnd(); ++it)
+    {
+        if (it.value().drawn != m_Draws)
+            candidates.append(qMakePair(it.value().drawn, it.key()));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto &candidate : candidates)
+    {
+        if (m_TileBytes <= m_MaxTileBytes)
+            break;
+        m_TileBytes -= m_Tiles.value(candidate.second).image.sizeInBytes();
+        m_Tiles.remove(candidate.second);
+    }
+}
+
+void FITSTilePyramid::draw(QPainter *painter, const QRectF &target, const QRectF &source)
+{
+    if (m_Levels == 0 || target.isEmpty() || source.isEmpty())
+        return;
+
+    m_Draws++;
+
+    // Pixels of level 0 per pixel of the target
+    const double reduction = source.width() / (m_Sampling * target.width());
+    const int level = reduction >= 2 ? std::min(static_cast<int>(std::log2(reduction)), m_Levels - 1) : 0;
+    const double levelScale = std::ldexp(static_cast<double>(m_Sampling), level);
+    const QRectF levelSource(source.x() / levelScale, source.y() / levelScale,
+                             source.width() / levelScale, source.height() / levelScale);
+
+    const QSize count = tileCount(level);
+    const int left = std::max(0, static_cast<int>(std::floor(levelSource.left() / TILE_SIZE)));
+    const int top = std::max(0, static_cast<int>(std::floor(levelSource.top() / TILE_SIZE)));
+    const int right = std::min(count.width() - 1, static_cast<int>(std::floor(levelSource.right() / TILE_SIZE)));
+    const int bottom = std::min(count.height() - 1, static_cast<int>(std::floor(levelSource.bottom() / TILE_SIZE)));
+
+    QVector<QPoint> tiles;
+    for (int y = top; y <= bottom; y++)
+        for (int x = left; x <= right; x++)
+            tiles.append(QPoint(x, y));
+    makeTiles(level, tiles);
+    for (const auto &tile : tiles)
+        m_Tiles[key(level, tile)].drawn = m_Draws;
+
+    const double scaleX = target.width() / levelSource.width();
+    const double scaleY = target.height() / levelSource.height();
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const auto &tile : tiles)
+    {
+        const QImage image = m_Tiles.value(key(level, tile)).image;
+        // Edges are rounded, so that neighbouring tiles meet without gaps.
+        const int x0 = qRound(target.x() + (tile.x() * TILE_SIZE - levelSource.x()) * scaleX);
+        const int y0 = qRound(target.y() + (tile.y() * TILE_SIZE - levelSource.y()) * scaleY);
+        const int x1 = qRound(target.x() + (tile.x() * TILE_SIZE + image.width() - levelSource.x()) * scaleX);
+        const int y1 = qRound(target.y() + (tile.y() * TILE_SIZE + image.height() - levelSource.y()) * scaleY);
+        painter->drawImage(QRect(x0, y0, x1 - x0, y1 - y0), image);
+    }
+    painter->restore();
+
+    evictTiles();
+}
@@ -0,0 +1,98 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "stretch.h"
+
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <memory>
+
+class FITSData;
+class QPainter;
+
+/**
+ * @class FITSTilePyramid
+ * @short Display image of large frames, stretched lazily into a pyramid of 256x256 tiles.
+ *
+ * Level 0 is the image at the preview sampling, each following level halves the resolution of the one
+ * below by averaging 2x2 pixels. Tiles are only computed when they are drawn: level 0 tiles are stretched
+ * from the image data, the others are reduced from their four children. Changing the stretch or the data
+ * drops all the tiles, so only the visible part of the image is stretched again. Past the memory budget, the
+ * tiles drawn longest ago are dropped, and tiles only computed to reduce a coarser level go first.
+ *
+ * Not thread safe, must be used from the GUI thread. Missing tiles are computed in parallel.
+ *
+ * @author KStars Developers
+ */
+class FITSTilePyramid
+{
+    public:
+        static constexpr int TILE_SIZE = 256;
+        static constexpr qint64 MAX_TILE_BYTES = 512LL * 1024 * 1024;
+
+        explicit FITSTilePyramid(qint64 maxTileBytes = MAX_TILE_BYTES);
+        ~FITSTilePyramid();
+
+        /**
+         * @brief reset Drop all tiles and set the source of the next ones.
+         * @param sampling Resolution of level 0, as FITSView's preview sampling.
+         */
+        void reset(const QSharedPointer<FITSData> &data, const StretchParams &params, int sampling);
+        void clear();
+
+        const StretchParams &params() const
+        {
+            return m_Params;
+        }
+
+        /**
+         * @brief draw Draw part of the image from the nearest level with at least the resolution of the target.
+         * @param target Rectangle in the painter's coordinates.
+         * @param source Rectangle of the image, in image pixels.
+         */
+        void draw(QPainter *painter, const QRectF &target, const QRectF &source);
+
+    private:
+        QSize levelSize(int level) const;
+        QSize tileCount(int level) const;
+        QSize tileSize(int level, const QPoint &tile) const;
+        QImage newTile(const QSize &size) const;
+        QImage stretchTile(const QPoint &tile) const;
+        QImage reduceTile(int level, const QPoint &tile) const;
+        // Compute the missing tiles of a level, and the tiles they depend on.
+        void makeTiles(int level, const QVector<QPoint> &tiles);
+        // Drop the tiles drawn longest ago until they fit in the budget, except those of the current draw.
+        void evictTiles();
+
+        static quint64 key(int level, const QPoint &tile)
+        {
+            return (static_cast<quint64>(level) << 48) | (static_cast<quint64>(tile.y()) << 24) | tile.x();
+        }
+
+        QSharedPointer<FITSData> m_Data;
+        std::unique_ptr<Stretch> m_Stretch;
+        StretchParams m_Params;
+        int m_Sampling { 1 };
+        int m_Levels { 0 };
+        struct Tile
+        {
+            QImage image;
+            // The last draw() that showed the tile, 0 if it was only computed to reduce a coarser level
+            quint64 drawn { 0 };
+        };
+        QHash<quint64, Tile> m_Tiles;
+        qint64 m_TileBytes { 0 };
+        qint64 m_MaxTileBytes { MAX_TILE_BYTES };
+        quint64 m_Draws { 0 };
+
+        friend class TestFitsTilePyramid;
+};
@@ -83,34 +83,44 @@ void ComputeGBStretchParams(const StretchParams &newParams, StretchParams* param
 
 }  // namespace
 
-// Runs the stretch checking the variables to see which parameters to use.
-// We call stretch even if we're not stretching, as the stretch code still
+// Returns the stretch parameters to display the image with, checking the variables to see which to use.
+// There are parameters even if we're not stretching, as the stretch code still
 // converts the image to the uint8 output image which will be displayed.
 // In that case, it will use an identity stretch.
-void FITSView::doStretch(QImage *outputImage)
+StretchParams FITSView::displayStretchParams()
 {
-    if (outputImage->isNull() || m_ImageData.isNull())
-        return;
-    Stretch stretch(static_cast<int>(m_ImageData->width()),
-                    static_cast<int>(m_ImageData->height()),
-                    m_ImageData->channels(), m_ImageData->dataType());
-
-    StretchParams tempParams;
     if (!stretchImage)
-        tempParams = StretchParams();  // Keeping it linear
+        return StretchParams();  // Keeping it linear
     else if (autoStretch)
     {
         // Compute new auto-stretch params.
-        stretchParams = stretch.computeParams(m_ImageData->getImageBuffer(), m_AutoStretchPreset);
+        Stretch stretch(static_cast<int>(m_ImageData->width()),
+                        static_cast<int>(m_ImageData->height()),
+                        m_ImageData->channels(), m_ImageData->dataType());
+        const FITSImage::Statistic &stats = m_ImageData->getStatistics();
+        stretchParams = stretch.computeParams(m_ImageData->getImageBuffer(), stats.median, stats.mad,
+                                              m_AutoStretchPreset);
         emit newStretch(stretchParams);
-        tempParams = stretchParams;
     }
-    else
-        // Use the existing stretch params.
-        tempParams = stretchParams;
+    // Use the existing stretch params.
+    return stretchParams;
+}
 
-    stretch.setParams(tempParams);
-    stretch.run(m_ImageData->getImageBuffer(), outputImage, m_PreviewSampling);
+// Stretches rawImage with the parameters of the last rescale(), if that wasn't done yet.
+// rawImage is allocated here, tiled images only need it to save or to draw overlays at full resolution.
+void FITSView::stretchDisplayImage()
+{
+    if (m_DisplayImageStretched || m_ImageData.isNull())
+        return;
+    const QImage::Format format = m_ImageData->channels() == 1 ? QImage::Format_Indexed8 : QImage::Format_RGB32;
+    if (rawImage.size() != displayImageSize() || rawImage.format() != format)
+        initDisplayImage();
+    Stretch stretch(static_cast<int>(m_ImageData->width()),
+                    static_cast<int>(m_ImageData->height()),
+                    m_ImageData->channels(), m_ImageData->dataType());
+    stretch.setParams(m_Pyramid.params());
+    stretch.run(m_ImageData->getImageBuffer(), &rawImage, m_PreviewSampling);
+    m_DisplayImageStretched = true;
 }
 
 // Store stretch parameters, and turn on stretching if it isn't already on.
@@ -740,6 +750,7 @@ bool FITSView::saveImage(const QString &newFilename)
     const QString ext = QFileInfo(newFilename).suffix();
     if (QImageReader::supportedImageFormats().contains(ext.toLatin1()))
     {
+        stretchDisplayImage();
         rawImage.save(newFilename, ext.toLatin1().constData());
         return true;
     }
@@ -850,9 +861,15 @@ bool FITSView::rescale(FITSZoom type)
             break;
     }
 
-    initDisplayImage();
     m_ImageFrame->setScaledContents(true);
-    doStretch(&rawImage);
+    // Large images are only stretched for the tiles on screen, the full image waits until it is needed.
+    m_Pyramid.reset(m_ImageData, displayStretchParams(), m_PreviewSampling);
+    m_DisplayImageStretched = false;
+    m_DisplayPixmapDirty = true;
+    if (isTiled())
+        rawImage = QImage();
+    else
+        stretchDisplayImage();
     setWidget(m_ImageFrame);
 
     // This is needed by fitstab, even if the zoom doesn't change, to change the stretch UI.
@@ -935,7 +952,7 @@ void FITSView::ZoomToFit()
     if (!m_ImageData)
         return;
 
-    if (rawImage.isNull() == false)
+    if (displayImageSize().isEmpty() == false)
     {
         rescale(ZOOM_FIT_WINDOW);
         updateFrame(true);
@@ -968,7 +985,15 @@ void FITSView::setImageMask(ImageMask *mask)
 bool FITSView::isLargeImage()
 {
     constexpr int largeImageNumPixels = 1000 * 1000;
-    return rawImage.width() * rawImage.height() >= largeImageNumPixels;
+    const QSize size = displayImageSize();
+    return size.width() * size.height() >= largeImageNumPixels;
+}
+
+// isTiled() returns whether a large image is drawn from the tile pyramid, straight to the screen.
+// Mosaic masks rearrange the image, those keep using the large-image pixmap.
+bool FITSView::isTiled()
+{
+    return isLargeImage() && dynamic_cast<ImageMosaicMask *>(m_ImageMask.get()) == nullptr;
 }
 
 // getScale() is related to the image and overlay rendering strategy used.
@@ -976,8 +1001,11 @@ bool FITSView::isLargeImage()
 // and we let the QLabel deal with scaling and zooming, then the scale is 1.0.
 // With smaller images, where memory use is not as severe, we create a pixmap that's the size of the scaled image
 // and get scale returns the ratio of that pixmap size to the image size.
+// Tiled images and their overlays are painted on the screen, at the zoomed size.
 double FITSView::getScale()
 {
+    if (isTiled() && !m_DrawingFullFrame)
+        return currentZoom / ZOOM_DEFAULT;
     return (isLargeImage() ? 1.0 : currentZoom / ZOOM_DEFAULT) / m_PreviewSampling;
 }
 
@@ -986,7 +1014,7 @@ double FITSView::getScale()
 // these sizes may be too small.
 double FITSView::scaleSize(double size)
 {
-    if (!isLargeImage())
+    if (!isLargeImage() || (isTiled() && !m_DrawingFullFrame))
         return size;
     return (currentZoom > 100.0 ? size : std::round(size * 100.0 / currentZoom)) / m_PreviewSampling;
 }
@@ -1012,7 +1040,9 @@ void FITSView::updateFrame(bool now)
         // and whether we need to therefore conserve memory. The small-image strategy explicitly scales up
         // the image, and writes overlays on the scaled pixmap. The large-image strategy uses a pixmap that's
         // the size of the image itself, never scaling that up.
-        if (isLargeImage())
+        if (isTiled())
+            updateFrameTiles();
+        else if (isLargeImage())
             updateFrameLargeImage();
         else
             updateFrameSmallImage();
@@ -1061,7 +1091,10 @@ bool FITSView::initDisplayPixmap(QImage &image, float scale)
 
 void FITSView::updateFrameLargeImage()
 {
-    if (m_ImageFrame.isNull() || !initDisplayPixmap(rawImage, 1.0 / m_PreviewSampling))
+    if (m_ImageFrame.isNull())
+        return;
+    stretchDisplayImage();
+    if (!initDisplayPixmap(rawImage, 1.0 / m_PreviewSampling))
         return;
     QPainter painter(&displayPixmap);
     // Possibly scale the fonts as we're drawing on the full image, not just the visible part of the scroll window.
@@ -1092,6 +1125,57 @@ void FITSView::updateFrameSmallImage()
     m_ImageFrame->resize(currentWidth, currentHeight);
 }
 
+// The frame has no pixmap, FITSLabel paints the visible tiles and overlays with drawFrame().
+void FITSView::updateFrameTiles()
+{
+    if (m_ImageFrame.isNull())
+        return;
+    m_ImageFrame->clear();
+    m_ImageFrame->resize(static_cast<int>(m_ImageData->width() * currentZoom / ZOOM_DEFAULT),
+                         static_cast<int>(m_ImageData->height() * currentZoom / ZOOM_DEFAULT));
+    m_ImageFrame->update();
+    m_DisplayPixmapDirty = true;
+}
+
+void FITSView::drawFrame(QPainter *painter, const QRect &exposed)
+{
+    if (m_ImageData.isNull())
+        return;
+    const double scale = currentZoom / ZOOM_DEFAULT;
+    m_Pyramid.draw(painter, exposed, QRectF(exposed.x() / scale, exposed.y() / scale,
+                                            exposed.width() / scale, exposed.height() / scale));
+    drawStarRingFilter(painter, scale, dynamic_cast<ImageRingMask *>(m_ImageMask.get()));
+    drawOverlay(painter, scale);
+}
+
+const QImage &FITSView::getDisplayImage()
+{
+    stretchDisplayImage();
+    return rawImage;
+}
+
+// Tiled images have no pixmap on screen, it is composed the same way as updateFrameLargeImage() does.
+const QPixmap &FITSView::getDisplayPixmap()
+{
+    if (isTiled() && m_DisplayPixmapDirty)
+    {
+        m_DrawingFullFrame = true;
+        stretchDisplayImage();
+        if (initDisplayPixmap(rawImage, 1.0 / m_PreviewSampling))
+        {
+            QPainter painter(&displayPixmap);
+            QFont font = painter.font();
+            font.setPixelSize(scaleSize(FONT_SIZE));
+            painter.setFont(font);
+            drawStarRingFilter(&painter, 1.0 / m_PreviewSampling, dynamic_cast<ImageRingMask *>(m_ImageMask.get()));
+            drawOverlay(&painter, getScale());
+        }
+        m_DrawingFullFrame = false;
+        m_DisplayPixmapDirty = false;
+    }
+    return displayPixmap;
+}
+
 void FITSView::drawStarRingFilter(QPainter *painter, double scale, ImageRingMask *ringMask)
 {
     if (ringMask == nullptr || !ringMask->active())
@@ -1356,7 +1440,14 @@ void FITSView::drawOverlay(QPainter * painter, double scale)
         drawStarCentroid(painter, scale);
 
     if (showClipping)
+    {
+        // Clipped pixels are drawn in image coordinates, tiled images are painted at the zoomed size.
+        painter->save();
+        if (isTiled() && !m_DrawingFullFrame)
+            painter->scale(scale, scale);
         drawClipping(painter);
+        painter->restore();
+    }
 
     if (showMagnifyingGlass)
         drawMagnifyingGlass(painter, scale);
@@ -1392,8 +1483,8 @@ void FITSView::drawMagnifyingGlass(QPainter *painter, double scale)
 
         // Normally we place the magnifying glass rectangle to the right and below the mouse curson.
         // However, if it would be rendered outside the image, put it on the other side.
-        int w = rawImage.width();
-        int h = rawImage.height();
+        int w = displayImageSize().width();
+        int h = displayImageSize().height();
         const int rightLimit = std::min(w, static_cast<int>((horizontalScrollBar()->value() + width()) * 100 / currentZoom));
         const int bottomLimit = std::min(h, static_cast<int>((verticalScrollBar()->value() + height()) * 100 / currentZoom));
         if (winLeft + winXOffset + inputDimension > rightLimit)
@@ -1413,9 +1504,13 @@ void FITSView::drawMagnifyingGlass(QPainter *painter, double scale)
         }
 
         // Finally, draw the magnified image.
-        painter->drawPixmap(QRect(winLeft * scale, winTop * scale, outputDimension, outputDimension),
-                            displayPixmap,
-                            QRect(imgLeft, imgTop, inputDimension / magAmount, inputDimension / magAmount));
+        if (isTiled() && !m_DrawingFullFrame)
+            m_Pyramid.draw(painter, QRect(winLeft * scale, winTop * scale, outputDimension, outputDimension),
+                           QRectF(imgLeft, imgTop, inputDimension / magAmount, inputDimension / magAmount));
+        else
+            painter->drawPixmap(QRect(winLeft * scale, winTop * scale, outputDimension, outputDimension),
+                                displayPixmap,
+                                QRect(imgLeft, imgTop, inputDimension / magAmount, inputDimension / magAmount));
         // Draw a white border.
         painter->setPen(QPen(Qt::white, scaleSize(1)));
         painter->drawRect(winLeft * scale, winTop * scale, outputDimension, outputDimension);
@@ -1507,7 +1602,7 @@ void FITSView::drawStarCentroid(QPainter * painter, double scale)
     if (showStarsHFR)
     {
         // If we need to print the HFR out, give an arbitrarily sized font to the painter
-        if (isLargeImage())
+        if (isLargeImage() && (m_DrawingFullFrame || !isTiled()))
             fontSize = scaleSize(painterFont.pointSizeF());
         painterFont.setPointSizeF(fontSize);
         painter->setFont(painterFont);
@@ -2070,7 +2165,9 @@ void FITSView::setFirstLoad(bool value)
 
 QPixmap &FITSView::getTrackingBoxPixmap(uint8_t margin)
 {
-    if (trackingBox.isNull() || m_ImageFrame.isNull() || m_ImageFrame->pixmap(Qt::ReturnByValueConstant()).isNull())
+    // Tiled images have no pixmap, grab() paints them.
+    if (trackingBox.isNull() || m_ImageFrame.isNull() ||
+            (!isTiled() && m_ImageFrame->pixmap(Qt::ReturnByValueConstant()).isNull()))
         return trackingBoxPixmap;
 
     // We need to know which rendering strategy updateFrame used to determine the scaling.
@@ -2151,7 +2248,7 @@ void FITSView::processRectangle(QPoint p1, QPoint p2, bool calculate)
     {
         if(m_ImageData)
         {
-            m_ImageData->makeRoiBuffer(selectionRectangleRaw);
+            m_ImageData->calculateRoiStats(selectionRectangleRaw);
             emit rectangleUpdated(selectionRectangleRaw);
         }
     }
@@ -2260,7 +2357,7 @@ void FITSView::toggleSelectionMode()
         emit rectangleUpdated(QRect());
     else if (m_ImageData)
     {
-        m_ImageData->makeRoiBuffer(selectionRectangleRaw);
+        m_ImageData->calculateRoiStats(selectionRectangleRaw);
         emit rectangleUpdated(selectionRectangleRaw);
     }
 
@@ -2619,12 +2716,21 @@ QPoint FITSView::getImagePoint(QPoint viewPortPoint)
     return imagePoint;
 }
 
-void FITSView::initDisplayImage()
+QSize FITSView::displayImageSize() const
 {
+    if (m_ImageData.isNull())
+        return QSize();
+
     // Account for leftover when sampling. Thus a 5-wide image sampled by 2
     // would result in a width of 3 (samples 0, 2 and 4).
-    int w = (m_ImageData->width() + m_PreviewSampling - 1) / m_PreviewSampling;
-    int h = (m_ImageData->height() + m_PreviewSampling - 1) / m_PreviewSampling;
+    return QSize((m_ImageData->width() + m_PreviewSampling - 1) / m_PreviewSampling,
+                 (m_ImageData->height() + m_PreviewSampling - 1) / m_PreviewSampling);
+}
+
+void FITSView::initDisplayImage()
+{
+    const int w = displayImageSize().width();
+    const int h = displayImageSize().height();
 
     if (m_ImageData->channels() == 1)
     {
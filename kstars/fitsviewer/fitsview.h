@@ -12,6 +12,7 @@
 
 #include <config-kstars.h>
 #include "stretch.h"
+#include "fitstilepyramid.h"
 
 #ifdef HAVE_DATAVISUALIZATION
 #include "starprofileviewer.h"
@@ -115,14 +116,15 @@ class FITSView : public QScrollArea
         {
             return currentZoom;
         }
-        const QImage &getDisplayImage() const
-        {
-            return rawImage;
-        }
-        const QPixmap &getDisplayPixmap() const
-        {
-            return displayPixmap;
-        }
+        // Large images are stretched on demand, the first call may take some time.
+        const QImage &getDisplayImage();
+        const QPixmap &getDisplayPixmap();
+
+        /**
+         * @brief drawFrame Draw the visible part of a large image and its overlays, at screen resolution.
+         * @param exposed Rectangle of the image frame to repaint.
+         */
+        void drawFrame(QPainter *painter, const QRect &exposed);
 
         // Tracking square
         void setTrackingBoxEnabled(bool enable);
@@ -406,12 +408,17 @@ class FITSView : public QScrollArea
 
     private:
         bool processData();
-        void doStretch(QImage *outputImage);
+        StretchParams displayStretchParams();
+        void stretchDisplayImage();
         double scaleSize(double size);
+        // Size of rawImage, the image at the preview sampling
+        QSize displayImageSize() const;
         bool isLargeImage();
+        bool isTiled();
         bool initDisplayPixmap(QImage &image, float space);
         void updateFrameLargeImage();
         void updateFrameSmallImage();
+        void updateFrameTiles();
         bool drawHFR(QPainter * painter, const QString &hfr, int x, int y);
 
         QPointer<QLabel> noImageLabel;
@@ -430,6 +437,12 @@ class FITSView : public QScrollArea
         QImage rawImage;
         // Actual pixmap after all the overlays
         QPixmap displayPixmap;
+        // Large images are displayed from tiles, rawImage and displayPixmap are then only made on demand.
+        FITSTilePyramid m_Pyramid;
+        bool m_DisplayImageStretched { false };
+        bool m_DisplayPixmapDirty { false };
+        // Overlays are drawn on the full resolution displayPixmap, not on the screen.
+        bool m_DrawingFullFrame { false };
 
         bool firstLoad { true };
         bool markStars { false };
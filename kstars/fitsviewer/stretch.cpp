@@ -55,10 +55,12 @@ T median(T const *values, int size, int sampleBy)
 // The extension parameters are not used.
 // Sampling is applied to the output (that is, with sampling=2, we compute every other output
 // sample both in width and height, so the output would have about 4X fewer pixels.
+// Only the region of the input is stretched, into the top-left of the output image.
+// When parallel is true, the lines are stretched in parallel.
 template <typename T>
 void stretchOneChannel(T *input_buffer, QImage *output_image,
                        const StretchParams &stretch_params,
-                       int input_range, int image_height, int image_width, int sampling)
+                       int input_range, int image_width, const QRect &region, int sampling, bool parallel)
 {
     QVector<QFuture<void>> futures;
 
@@ -83,14 +85,14 @@ void stretchOneChannel(T *input_buffer, QImage *output_image,
     const float k2 = ((2 * midtones) - 1) * hsRangeFactor / maxInput;
 
     // Increment the input index by the sampling, the output index increments by 1.
-    for (int j = 0, jout = 0; j < image_height; j += sampling, jout++)
+    for (int j = region.top(), jout = 0; j <= region.bottom(); j += sampling, jout++)
     {
-        futures.append(QtConcurrent::run([ = ]()
+        auto stretchLine = [ = ]()
         {
             T * inputLine  = input_buffer + j * image_width;
             auto * scanLine = output_image->scanLine(jout);
 
-            for (int i = 0, iout = 0; i < image_width; i += sampling, iout++)
+            for (int i = region.left(), iout = 0; i <= region.right(); i += sampling, iout++)
             {
                 const T input = inputLine[i];
                 if (input < nativeShadows) scanLine[iout] = 0;
@@ -101,7 +103,11 @@ void stretchOneChannel(T *input_buffer, QImage *output_image,
                     scanLine[iout] = (inputFloored * k1) / (inputFloored * k2 - midtones);
                 }
             }
-        }));
+        };
+        if (parallel)
+            futures.append(QtConcurrent::run(stretchLine));
+        else
+            stretchLine();
     }
     for(QFuture<void> future : futures)
         future.waitForFinished();
@@ -117,7 +123,7 @@ void stretchOneChannel(T *input_buffer, QImage *output_image,
 template <typename T>
 void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
                           const StretchParams &stretchParams,
-                          int inputRange, int imageHeight, int imageWidth, int sampling)
+                          int inputRange, int imageHeight, int imageWidth, const QRect &region, int sampling, bool parallel)
 {
     QVector<QFuture<void>> futures;
 
@@ -159,9 +165,9 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
 
     const int size = imageWidth * imageHeight;
 
-    for (int j = 0, jout = 0; j < imageHeight; j += sampling, jout++)
+    for (int j = region.top(), jout = 0; j <= region.bottom(); j += sampling, jout++)
     {
-        futures.append(QtConcurrent::run([ = ]()
+        auto stretchLine = [ = ]()
         {
             // R, G, B input images are stored one after another.
             T * inputLineR  = inputBuffer + j * imageWidth;
@@ -170,7 +176,7 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
 
             auto * scanLine = reinterpret_cast<QRgb*>(outputImage->scanLine(jout));
 
-            for (int i = 0, iout = 0; i < imageWidth; i += sampling, iout++)
+            for (int i = region.left(), iout = 0; i <= region.right(); i += sampling, iout++)
             {
                 const T inputR = inputLineR[i];
                 const T inputG = inputLineG[i];
@@ -203,7 +209,11 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
                 }
                 scanLine[iout] = qRgb(red, green, blue);
             }
-        }));
+        };
+        if (parallel)
+            futures.append(QtConcurrent::run(stretchLine));
+        else
+            stretchLine();
     }
     for(QFuture<void> future : futures)
         future.waitForFinished();
@@ -212,40 +222,23 @@ void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
 template <typename T>
 void stretchChannels(T *input_buffer, QImage *output_image,
                      const StretchParams &stretch_params,
-                     int input_range, int image_height, int image_width, int num_channels, int sampling)
+                     int input_range, int image_height, int image_width, int num_channels,
+                     const QRect &region, int sampling, bool parallel)
 {
     if (num_channels == 1)
         stretchOneChannel(input_buffer, output_image, stretch_params, input_range,
-                          image_height, image_width, sampling);
+                          image_width, region, sampling, parallel);
     else if (num_channels == 3)
         stretchThreeChannels(input_buffer, output_image, stretch_params, input_range,
-                             image_height, image_width, sampling);
+                             image_height, image_width, region, sampling, parallel);
 }
 
 // See section 8.5.7 in above link  https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
-template <typename T>
-void computeParamsOneChannel(T const *buffer, StretchParams1Channel *params,
-                             int inputRange, int height, int width, float B, float C)
+// From the median and the median absolute deviation of a channel, in input units.
+void computeParamsFromMAD(float median, float medDev, StretchParams1Channel *params, int inputRange, float B, float C)
 {
-    // Find the median sample.
-    constexpr int maxSamples = 500000;
-    const int sampleBy = width * height < maxSamples ? 1 : width * height / maxSamples;
-
-    T medianSample = median(buffer, width * height, sampleBy);
-    // Find the Median deviation: 1.4826 * median of abs(sample[i] - median).
-    const int numSamples = width * height / sampleBy;
-    std::vector<T> deviations(numSamples);
-    for (int index = 0, i = 0; i < numSamples; ++i, index += sampleBy)
-    {
-        if (medianSample > buffer[index])
-            deviations[i] = medianSample - buffer[index];
-        else
-            deviations[i] = buffer[index] - medianSample;
-    }
-
     // Shift everything to 0 -> 1.0.
-    const float medDev = median(deviations);
-    const float normalizedMedian = medianSample / static_cast<float>(inputRange);
+    const float normalizedMedian = median / static_cast<float>(inputRange);
     const float MADN = 1.4826 * medDev / static_cast<float>(inputRange);
 
     const bool upperHalf = normalizedMedian > 0.5;
@@ -281,6 +274,31 @@ void computeParamsOneChannel(T const *buffer, StretchParams1Channel *params,
     params->highlights_expansion = 1.0;
 }
 
+// As above, sampling the median and the median absolute deviation of the channel.
+template <typename T>
+void computeParamsOneChannel(T const *buffer, StretchParams1Channel *params,
+                             int inputRange, int height, int width, float B, float C)
+{
+    // Find the median sample.
+    constexpr int maxSamples = 500000;
+    const int sampleBy = width * height < maxSamples ? 1 : width * height / maxSamples;
+
+    T medianSample = median(buffer, width * height, sampleBy);
+    // Find the Median deviation: 1.4826 * median of abs(sample[i] - median).
+    const int numSamples = width * height / sampleBy;
+    std::vector<T> deviations(numSamples);
+    for (int index = 0, i = 0; i < numSamples; ++i, index += sampleBy)
+    {
+        if (medianSample > buffer[index])
+            deviations[i] = medianSample - buffer[index];
+        else
+            deviations[i] = buffer[index] - medianSample;
+    }
+
+    const float medDev = median(deviations);
+    computeParamsFromMAD(medianSample, medDev, params, inputRange, B, C);
+}
+
 // Need to know the possible range of input values.
 // Using the type of the sample and guessing.
 // Perhaps we should examine the contents for the file
@@ -324,36 +342,48 @@ void Stretch::run(uint8_t const *input, QImage *outputImage, int sampling)
     Q_ASSERT(outputImage->width() == (image_width + sampling - 1) / sampling);
     Q_ASSERT(outputImage->height() == (image_height + sampling - 1) / sampling);
     recalculateInputRange(input);
+    runRegion(input, outputImage, QRect(0, 0, image_width, image_height), sampling, true);
+}
 
+void Stretch::run(uint8_t const *input, QImage *outputImage, const QRect &region, int sampling) const
+{
+    Q_ASSERT(QRect(0, 0, image_width, image_height).contains(region));
+    Q_ASSERT(outputImage->width() >= (region.width() + sampling - 1) / sampling);
+    Q_ASSERT(outputImage->height() >= (region.height() + sampling - 1) / sampling);
+    runRegion(input, outputImage, region, sampling, false);
+}
+
+void Stretch::runRegion(uint8_t const *input, QImage *outputImage, const QRect &region, int sampling, bool parallel) const
+{
     switch (dataType)
     {
         case TBYTE:
             stretchChannels(reinterpret_cast<uint8_t const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         case TSHORT:
             stretchChannels(reinterpret_cast<short const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         case TUSHORT:
             stretchChannels(reinterpret_cast<unsigned short const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         case TLONG:
             stretchChannels(reinterpret_cast<long const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         case TFLOAT:
             stretchChannels(reinterpret_cast<float const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         case TLONGLONG:
             stretchChannels(reinterpret_cast<long long const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         case TDOUBLE:
             stretchChannels(reinterpret_cast<double const*>(input), outputImage, params,
-                            input_range, image_height, image_width, image_channels, sampling);
+                            input_range, image_height, image_width, image_channels, region, sampling, parallel);
             break;
         default:
             break;
@@ -420,63 +450,86 @@ StretchParams Stretch::computeParams(uint8_t const *input, int preset)
     StretchParams result;
     for (int channel = 0; channel < image_channels; ++channel)
     {
-        int offset = channel * image_width * image_height;
         StretchParams1Channel *params = channel == 0 ? &result.grey_red :
                                         (channel == 1 ? &result.green : &result.blue);
-        switch (dataType)
+        computeChannelParams(input, channel, params);
+    }
+    return result;
+}
+
+StretchParams Stretch::computeParams(uint8_t const *input, const double median[3], const double mad[3], int preset)
+{
+    setupStretchPreset(preset);
+    recalculateInputRange(input);
+    StretchParams result;
+    for (int channel = 0; channel < image_channels; ++channel)
+    {
+        StretchParams1Channel *params = channel == 0 ? &result.grey_red :
+                                        (channel == 1 ? &result.green : &result.blue);
+        // Statistics that were never calculated are sampled
+        if (median[channel] == 0 && mad[channel] == 0)
+            computeChannelParams(input, channel, params);
+        else
+            computeParamsFromMAD(median[channel], mad[channel], params, input_range, m_stretchB, m_stretchC);
+    }
+    return result;
+}
+
+void Stretch::computeChannelParams(uint8_t const *input, int channel, StretchParams1Channel *params) const
+{
+    int offset = channel * image_width * image_height;
+    switch (dataType)
+    {
+        case TBYTE:
         {
-            case TBYTE:
-            {
-                auto buffer = reinterpret_cast<uint8_t const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            case TSHORT:
-            {
-                auto buffer = reinterpret_cast<short const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            case TUSHORT:
-            {
-                auto buffer = reinterpret_cast<unsigned short const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            case TLONG:
-            {
-                auto buffer = reinterpret_cast<long const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            case TFLOAT:
-            {
-                auto buffer = reinterpret_cast<float const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            case TLONGLONG:
-            {
-                auto buffer = reinterpret_cast<long long const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            case TDOUBLE:
-            {
-                auto buffer = reinterpret_cast<double const*>(input);
-                computeParamsOneChannel(buffer + offset, params, input_range,
-                                        image_height, image_width, m_stretchB, m_stretchC);
-                break;
-            }
-            default:
-                break;
+            auto buffer = reinterpret_cast<uint8_t const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
+        }
+        case TSHORT:
+        {
+            auto buffer = reinterpret_cast<short const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
+        }
+        case TUSHORT:
+        {
+            auto buffer = reinterpret_cast<unsigned short const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
+        }
+        case TLONG:
+        {
+            auto buffer = reinterpret_cast<long const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
+        }
+        case TFLOAT:
+        {
+            auto buffer = reinterpret_cast<float const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
+        }
+        case TLONGLONG:
+        {
+            auto buffer = reinterpret_cast<long long const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
         }
+        case TDOUBLE:
+        {
+            auto buffer = reinterpret_cast<double const*>(input);
+            computeParamsOneChannel(buffer + offset, params, input_range,
+                                    image_height, image_width, m_stretchB, m_stretchC);
+            break;
+        }
+        default:
+            break;
     }
-    return result;
 }
@@ -69,6 +69,13 @@ class Stretch
          */
         StretchParams computeParams(const uint8_t *input, int preset = 1);
 
+        /**
+         * @brief computeParams As above, from the median and the median absolute deviation of each channel,
+         * e.g. those of FITSImage::Statistic, instead of sampling the image. Channels where both are 0 are sampled.
+         * @param input the raw data buffer, only read to check the input range of float images.
+         */
+        StretchParams computeParams(const uint8_t *input, const double median[3], const double mad[3], int preset = 1);
+
         /**
          * @brief run run the stretch algorithm according to the params given
          * placing the output in output_image.
@@ -81,6 +88,20 @@ class Stretch
          */
         void run(uint8_t const *input, QImage *output_image, int sampling=1);
 
+        /**
+         * @brief run Stretch a region of the image, on the calling thread, into the top-left of output_image.
+         * Used to stretch tiles as they are needed. Unlike the full image run(), the input range of float
+         * images isn't checked, call recalculateInputRange() once before.
+         * @param region the part of the input to stretch, in input pixels.
+         * @param sampling as above, output_image should be at least region's size divided by sampling.
+         */
+        void run(uint8_t const *input, QImage *output_image, const QRect &region, int sampling = 1) const;
+
+        /**
+         * @brief recalculateInputRange Adjusts the input range for float and double types.
+         */
+        void recalculateInputRange(const uint8_t *input);
+
         static int numPresets()
         {
             return m_NumPresets;
@@ -94,8 +115,10 @@ class Stretch
         }
 
  private:
-        // Adjusts input_range for float and double types.
-        void recalculateInputRange(const uint8_t *input);
+        void runRegion(uint8_t const *input, QImage *output_image, const QRect &region, int sampling, bool parallel) const;
+
+        // Samples a channel of the input to compute its parameters.
+        void computeChannelParams(uint8_t const *input, int channel, StretchParams1Channel *params) const;
 
         // Changes 2 stretch parameters depending on the preset.
         void setupStretchPreset(int preset);
@@ -35,6 +35,7 @@ typedef struct Statistic
     double mean[3] = {0};               // Average R, G, B value of the pixels in the image
     double stddev[3] = {0};             // Standard Deviation of the R, G, B pixel values in the image
     double median[3] = {0};             // Median R, G, B pixel value in the image
+    double mad[3] = {0};                // Median absolute deviation of the R, G, B pixel values from the median
     double SNR { 0 };                   // Signal to noise ratio
     uint32_t dataType { 0 };            // FITS image data type (TBYTE, TUSHORT, TULONG, TFLOAT, TLONGLONG, TDOUBLE)
     int bytesPerPixel { 1 };            // Number of bytes used for each pixel, size of datatype above
@@ -170,6 +170,10 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
 
     pixCacheItem_t *item = getCacheItem(key);
 
+    // Not in memory, try the decoded tiles on disk before downloading and decoding it again
+    if (item == nullptr && !m_downloadMap.contains(key))
+        item = loadFromDecodedCache(key);
+
     if (m_downloadMap.contains(key))
     {
         // downloading
@@ -222,13 +226,38 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
         return cacheImage;
     }
 
+    download(key, allsky);
+
+    return nullptr;
+}
+
+bool HIPSManager::prefetch(int level, int pix)
+{
+    if (m_currentURL.isEmpty())
+        return false;
+
+    pixCacheKey_t key;
+
+    key.level = level;
+    key.pix = pix;
+    key.uid = m_uid;
+
+    if (m_downloadMap.contains(key) || m_cache.contains(key) || loadFromDecodedCache(key) != nullptr)
+        return false;
+
+    download(key, false);
+    return true;
+}
+
+void HIPSManager::download(pixCacheKey_t &key, bool allsky)
+{
     QString path;
 
     if (!allsky)
     {
-        int dir = (pix / 10000) * 10000;
+        int dir = (key.pix / 10000) * 10000;
 
-        path = "/Norder" + QString::number(level) + "/Dir" + QString::number(dir) + "/Npix" + QString::number(pix) +
+        path = "/Norder" + QString::number(key.level) + "/Dir" + QString::number(dir) + "/Npix" + QString::number(key.pix) +
                '.' + m_currentFormat;
     }
     else
@@ -240,8 +269,6 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
     downloadURL.setPath(downloadURL.path() + path);
     g_download->begin(downloadURL, key);
     m_downloadMap.insert(key);
-
-    return nullptr;
 }
 
 
@@ -342,6 +369,7 @@ void HIPSManager::cancelAll()
 void HIPSManager::clearDiscCache()
 {
     g_discCache->clear();
+    m_decodedCache.clear();
 }
 
 void HIPSManager::slotDone(QNetworkReply::NetworkError error, QByteArray &data, pixCacheKey_t &key)
@@ -355,6 +383,10 @@ void HIPSManager::slotDone(QNetworkReply::NetworkError error, QByteArray &data,
         item->image = new QImage();
         if (item->image->loadFromData(data))
         {
+            // Keep the decoded tile on disk first, the memory cache may drop it straight away
+            if (openDecodedCache())
+                m_decodedCache.add(key, *item->image);
+
             addToMemoryCache(key, item);
 
             //SkyMap::Instance()->forceUpdate();
@@ -407,6 +439,37 @@ pixCacheItem_t *HIPSManager::getCacheItem(pixCacheKey_t &key)
     return m_cache.get(key);
 }
 
+pixCacheItem_t *HIPSManager::loadFromDecodedCache(pixCacheKey_t &key)
+{
+    if (!openDecodedCache())
+        return nullptr;
+
+    QImage *image = m_decodedCache.get(key);
+    if (image == nullptr)
+        return nullptr;
+
+    auto *item = new pixCacheItem_t;
+    item->image = image;
+    addToMemoryCache(key, item);
+
+    return getCacheItem(key);
+}
+
+bool HIPSManager::openDecodedCache()
+{
+    if (Options::hIPSDecodedCache() == 0 || m_currentTileWidth == 0)
+    {
+        m_decodedCache.close();
+        return false;
+    }
+
+    if (m_decodedCache.isOpen() && m_decodedCache.tileWidth() == m_currentTileWidth)
+        return true;
+
+    QString path = QDir(KSPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("hips_decoded/tiles.bin");
+    return m_decodedCache.open(path, m_currentTileWidth, static_cast<qint64>(Options::hIPSDecodedCache()) * 1024 * 1024);
+}
+
 bool HIPSManager::setCurrentSource(const QString &title)
 {
     if (title == "None")
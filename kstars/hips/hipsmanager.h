@@ -11,6 +11,7 @@
 #include "hips.h"
 #include "opships.h"
 #include "pixcache.h"
+#include "pixdisccache.h"
 #include "urlfiledownload.h"
 
 #include <QObject>
@@ -53,6 +54,16 @@ class HIPSManager : public QObject
 
         QImage *getPix(bool allsky, int level, int pix, bool &freeImage);
 
+        /**
+         * @brief Make sure a tile is in the memory cache or being downloaded, without waiting for it
+         * @return true if a download was started for the tile
+         */
+        bool prefetch(int level, int pix);
+        int pendingDownloads() const
+        {
+            return m_downloadMap.size();
+        }
+
         void readSources();
 
         void cancelAll();
@@ -116,10 +127,15 @@ class HIPSManager : public QObject
 
         // Cache
         PixCache m_cache;
+        // Decoded tiles that fell out of the memory cache
+        PixDiscCache m_decodedCache;
         QSet <pixCacheKey_t> m_downloadMap;
 
         void addToMemoryCache(pixCacheKey_t &key, pixCacheItem_t *item);
         pixCacheItem_t *getCacheItem(pixCacheKey_t &key);
+        pixCacheItem_t *loadFromDecodedCache(pixCacheKey_t &key);
+        bool openDecodedCache();
+        void download(pixCacheKey_t &key, bool allsky);
 
         // List of all sources in the database
         QList<QMap<QString, QString>> m_hipsSources;
@@ -0,0 +1,169 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "hipsprefetcher.h"
+
+#include "hipsmanager.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// How far ahead the view is extrapolated
+constexpr double LOOKAHEAD_SECS = 0.5;
+// Frames further apart than this are not treated as one continuous movement
+constexpr double MAX_FRAME_GAP_SECS = 1.0;
+// log(fov) change per second below which the view is not considered to be zooming
+constexpr double ZOOM_THRESHOLD = 0.05;
+// Furthest ring of neighbours queued around the predicted center
+constexpr int MAX_RINGS = 5;
+// Don't prefetch while this many downloads (of any kind) are in flight
+constexpr int MAX_PENDING_DOWNLOADS = 8;
+constexpr int PREFETCH_INTERVAL_MS = 50;
+// Approximate angular size of a level 0 HEALPix tile in degrees
+constexpr double LEVEL0_TILE_SIZE = 58.6;
+// Lowest level rendered from individual tiles, lower levels use the allsky image
+constexpr int MIN_TILE_LEVEL = 3;
+}
+
+HIPSPrefetcher::HIPSPrefetcher(QObject *parent) : QObject(parent)
+{
+    m_timer.setInterval(PREFETCH_INTERVAL_MS);
+    connect(&m_timer, &QTimer::timeout, this, &HIPSPrefetcher::issueRequests);
+    m_clock.start();
+}
+
+void HIPSPrefetcher::clear()
+{
+    m_timer.stop();
+    m_queue.clear();
+    m_next = 0;
+    m_hasLast = false;
+    std::fill(m_velocity, m_velocity + 3, 0.0);
+    m_zoomRate = 0;
+}
+
+void HIPSPrefetcher::update(double ra, double de, double fov, int level, int maxLevel)
+{
+    if (std::isnan(ra) || std::isnan(de) || fov <= 0)
+        return;
+
+    const double p[3] = { std::cos(de) * std::cos(ra), std::cos(de) * std::sin(ra), std::sin(de) };
+    const qint64 now = m_clock.elapsed();
+    const double dt = (now - m_lastTime) / 1000.0;
+
+    if (m_hasLast && dt > 0 && dt < MAX_FRAME_GAP_SECS)
+    {
+        // Frame times are noisy, so smooth the rates a little
+        for (int i = 0; i < 3; i++)
+            m_velocity[i] = 0.5 * m_velocity[i] + 0.5 * (p[i] - m_last[i]) / dt;
+        m_zoomRate = 0.5 * m_zoomRate + 0.5 * std::log(fov / m_lastFov) / dt;
+    }
+    else if (!m_hasLast || dt >= MAX_FRAME_GAP_SECS)
+    {
+        std::fill(m_velocity, m_velocity + 3, 0.0);
+        m_zoomRate = 0;
+    }
+
+    std::copy(p, p + 3, m_last);
+    m_lastFov = fov;
+    m_lastTime = now;
+    m_hasLast = true;
+
+    // Extrapolate the view
+    double q[3];
+    for (int i = 0; i < 3; i++)
+        q[i] = p[i] + m_velocity[i] * LOOKAHEAD_SECS;
+    const double norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2]);
+    if (norm <= 0)
+        return;
+
+    const double predictedRa = std::atan2(q[1], q[0]);
+    const double predictedDe = std::asin(q[2] / norm);
+    const double predictedFov = fov * std::exp(m_zoomRate * LOOKAHEAD_SECS);
+
+    m_queue.clear();
+    m_next = 0;
+
+    queueAround(level, predictedRa, predictedDe, fov, 0);
+
+    // When zooming, the tiles of the next level are needed soon but after the ones at the current level
+    if (m_zoomRate < -ZOOM_THRESHOLD && level < maxLevel)
+    {
+        const int nextLevel = HIPSManager::Instance()->getUsableLevel(level + 1);
+        if (nextLevel > level)
+            queueAround(nextLevel, predictedRa, predictedDe, predictedFov, 1);
+    }
+    else if (m_zoomRate > ZOOM_THRESHOLD && level > MIN_TILE_LEVEL)
+    {
+        const int nextLevel = HIPSManager::Instance()->getUsableLevel(level - 1);
+        if (nextLevel < level && nextLevel >= MIN_TILE_LEVEL)
+            queueAround(nextLevel, predictedRa, predictedDe, predictedFov, 1);
+    }
+
+    std::stable_sort(m_queue.begin(), m_queue.end(), [](const hipsPrefetchItem_t & a, const hipsPrefetchItem_t & b)
+    {
+        return a.priority < b.priority;
+    });
+
+    if (!m_queue.isEmpty() && !m_timer.isActive())
+        m_timer.start();
+}
+
+void HIPSPrefetcher::queueAround(int level, double ra, double de, double fov, int priority)
+{
+    // Enough rings of neighbours to cover the predicted field of view, plus one
+    const double tileSize = LEVEL0_TILE_SIZE / (1 << level);
+    const int rings = std::min(MAX_RINGS, static_cast<int>(std::ceil(0.5 * fov / tileSize)) + 1);
+    const int nside = 1 << level;
+
+    QSet<int> visited;
+    QVector<int> ring;
+    ring.append(m_HEALpix.getPix(level, ra, de));
+    visited.insert(ring.first());
+
+    for (int r = 0; r <= rings && !ring.isEmpty(); r++)
+    {
+        QVector<int> nextRing;
+        for (int pix : ring)
+        {
+            m_queue.append({ level, pix, priority + r });
+
+            int dirs[8];
+            m_HEALpix.neighbours(nside, pix, dirs);
+            for (int dir : dirs)
+            {
+                if (dir >= 0 && !visited.contains(dir))
+                {
+                    visited.insert(dir);
+                    nextRing.append(dir);
+                }
+            }
+        }
+        ring = nextRing;
+    }
+}
+
+void HIPSPrefetcher::issueRequests()
+{
+    HIPSManager *manager = HIPSManager::Instance();
+
+    while (m_next < m_queue.size() && manager->pendingDownloads() < MAX_PENDING_DOWNLOADS)
+    {
+        const hipsPrefetchItem_t &item = m_queue.at(m_next++);
+        manager->prefetch(item.level, item.pix);
+    }
+
+    if (m_next >= m_queue.size())
+    {
+        m_timer.stop();
+        m_queue.clear();
+        m_next = 0;
+    }
+}
@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "healpix.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+typedef struct
+{
+    int level;
+    int pix;
+    int priority;
+} hipsPrefetchItem_t;
+
+/**
+ * @brief The HIPSPrefetcher class requests the HiPS tiles that the sky map is likely to need next, before they
+ *        become visible.
+ *
+ *        Every frame the renderer reports the view it has just drawn. The prefetcher tracks how fast the center
+ *        is moving and the field of view is changing, extrapolates the view a short time ahead, and queues the
+ *        tiles around the predicted center. When zooming in the tiles of the next level are queued too, and when
+ *        zooming out the tiles of the previous level. Tiles closer to the predicted center have a higher priority.
+ *
+ *        The queue is drained from a timer, a few tiles at a time, so prefetching never delays the frame and
+ *        never holds up the tiles requested by the renderer itself.
+ *
+ * @author KStars Developers
+ */
+class HIPSPrefetcher : public QObject
+{
+        Q_OBJECT
+
+    public:
+        explicit HIPSPrefetcher(QObject *parent = nullptr);
+
+        /**
+         * @brief Report the view that was just rendered
+         * @param ra of the view center in radians
+         * @param de of the view center in radians
+         * @param fov of the view in degrees
+         * @param level HEALPix order of the rendered tiles
+         * @param maxLevel deepest order available in the current source
+         */
+        void update(double ra, double de, double fov, int level, int maxLevel);
+
+        /**
+         * @brief Forget the view history and drop all queued tiles
+         */
+        void clear();
+
+        /**
+         * @brief Get the tiles currently queued, in priority order
+         */
+        const QVector<hipsPrefetchItem_t> &queue() const
+        {
+            return m_queue;
+        }
+
+    private slots:
+        void issueRequests();
+
+    private:
+        void queueAround(int level, double ra, double de, double fov, int priority);
+
+        HEALPix m_HEALpix;
+        QVector<hipsPrefetchItem_t> m_queue;
+        int m_next { 0 };
+        QTimer m_timer;
+
+        // View history
+        QElapsedTimer m_clock;
+        bool m_hasLast { false };
+        qint64 m_lastTime { 0 };
+        double m_last[3] { 0, 0, 0 };
+        double m_lastFov { 0 };
+        // Smoothed rate of change of the view center (unit vector per second) and of log(fov) per second
+        double m_velocity[3] { 0, 0, 0 };
+        double m_zoomRate { 0 };
+};
@@ -15,10 +15,52 @@
 #include "skyqpainter.h"
 #include "projections/projector.h"
 
+#include <QtConcurrent>
+#include <QThread>
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+// Don't split the destination image into bands thinner than this
+constexpr int MIN_BAND_ROWS = 32;
+
+// UV Mapping to apply image unto the destination image
+// 4x4 = 16 points are mapped from the source image unto the destination image.
+// Starting from each grandchild pixel, each pix polygon is mapped accordingly.
+// For example, pixel 357 will have 4 child pixels, each of them will have 4 childs pixels and so
+// on. Each healpix pixel appears roughly as a diamond on the sky map.
+// The corners points for HealPIX moves from NORTH -> EAST -> SOUTH -> WEST
+// Hence first point is 0.25, 0.25 in UV coordinate system.
+// Depending on the selected algorithm, the mapping will either utilize nearest neighbour
+// or bilinear interpolation.
+const QPointF uv[16][4] = {{QPointF(.25, .25), QPointF(0.25, 0), QPointF(0, .0), QPointF(0, .25)},
+    {QPointF(.25, .5), QPointF(0.25, 0.25), QPointF(0, .25), QPointF(0, .5)},
+    {QPointF(.5, .25), QPointF(0.5, 0), QPointF(.25, .0), QPointF(.25, .25)},
+    {QPointF(.5, .5), QPointF(0.5, 0.25), QPointF(.25, .25), QPointF(.25, .5)},
+
+    {QPointF(.25, .75), QPointF(0.25, 0.5), QPointF(0, 0.5), QPointF(0, .75)},
+    {QPointF(.25, 1), QPointF(0.25, 0.75), QPointF(0, .75), QPointF(0, 1)},
+    {QPointF(.5, .75), QPointF(0.5, 0.5), QPointF(.25, .5), QPointF(.25, .75)},
+    {QPointF(.5, 1), QPointF(0.5, 0.75), QPointF(.25, .75), QPointF(.25, 1)},
+
+    {QPointF(.75, .25), QPointF(0.75, 0), QPointF(0.5, .0), QPointF(0.5, .25)},
+    {QPointF(.75, .5), QPointF(0.75, 0.25), QPointF(0.5, .25), QPointF(0.5, .5)},
+    {QPointF(1, .25), QPointF(1, 0), QPointF(.75, .0), QPointF(.75, .25)},
+    {QPointF(1, .5), QPointF(1, 0.25), QPointF(.75, .25), QPointF(.75, .5)},
+
+    {QPointF(.75, .75), QPointF(0.75, 0.5), QPointF(0.5, .5), QPointF(0.5, .75)},
+    {QPointF(.75, 1), QPointF(0.75, 0.75), QPointF(0.5, .75), QPointF(0.5, 1)},
+    {QPointF(1, .75), QPointF(1, 0.5), QPointF(.75, .5), QPointF(.75, .75)},
+    {QPointF(1, 1), QPointF(1, 0.75), QPointF(.75, .75), QPointF(.75, 1)},
+};
+}
+
 HIPSRenderer::HIPSRenderer()
 {
-    m_scanRender.reset(new ScanRender());
     m_HEALpix.reset(new HEALPix());
+    m_prefetcher.reset(new HIPSPrefetcher());
 }
 
 bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Projector *m_proj)
@@ -75,6 +117,12 @@ bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Proje
 
     int centerPix = m_HEALpix->getPix(level, ra, de);
 
+    // Queue the tiles the next frames are likely to need while this one renders
+    if (!allSky && Options::hIPSPrefetch())
+        m_prefetcher->update(ra, de, fov, level, HIPSManager::Instance()->getCurrentOrder());
+    else
+        m_prefetcher->clear();
+
     SkyPoint cornerSkyCoords[4];
     QPointF tileLine[2];
     m_HEALpix->getCornerPoints(level, centerPix, cornerSkyCoords);
@@ -92,17 +140,87 @@ bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Proje
     if (size < 0)
         size = HIPSManager::Instance()->getCurrentTileWidth();
 
-    bool old = m_scanRender->isBilinearInterpolationEnabled();
-    m_scanRender->setBilinearInterpolationEnabled(Options::hIPSBiLinearInterpolation()
-            && (size >= HIPSManager::Instance()->getCurrentTileWidth() || allSky));
+    bool bilinear = Options::hIPSBiLinearInterpolation()
+                    && (size >= HIPSManager::Instance()->getCurrentTileWidth() || allSky);
+
+    // Walk the visible tiles first, then rasterize them all in parallel
+    m_tiles.clear();
+    m_gridCells.clear();
 
     renderRec(allSky, level, centerPix, hipsImage);
 
-    m_scanRender->setBilinearInterpolationEnabled(old);
+    rasterizeTiles(hipsImage, bilinear);
+    drawGrid(hipsImage);
 
     return true;
 }
 
+void HIPSRenderer::rasterizeTiles(QImage *pDest, bool bilinear)
+{
+    if (m_tiles.isEmpty())
+        return;
+
+    // Each band of rows is owned by a single worker, so they never write to the same pixels.
+    // Within a band the tiles are drawn in the same order as before, so overlaps resolve the same way.
+    const int height = pDest->height();
+    const int bands = qMax(1, qMin(QThread::idealThreadCount(), height / MIN_BAND_ROWS));
+
+    while (static_cast<int>(m_bandRenders.size()) < bands)
+        m_bandRenders.emplace_back(new ScanRender());
+
+    QVector<int> bandIDs(bands);
+    std::iota(bandIDs.begin(), bandIDs.end(), 0);
+
+    // Take the destination pixels and the tile list here, on the calling thread, as both may detach.
+    // The workers only ever see the raw pixels.
+    quint32 *bits = reinterpret_cast<quint32 *>(pDest->bits());
+    const int width = pDest->width();
+    const int stride = pDest->bytesPerLine() / 4;
+    hipsTile_t *tiles = m_tiles.data();
+    const int tileCount = m_tiles.size();
+
+    QtConcurrent::blockingMap(bandIDs, [&](int band)
+    {
+        ScanRender *scanRender = m_bandRenders[band].get();
+        scanRender->setBilinearInterpolationEnabled(bilinear);
+        scanRender->setScanBand(band * height / bands, (band + 1) * height / bands);
+
+        for (int i = 0; i < tileCount; i++)
+        {
+            for (int j = 0; j < 16; j++)
+                scanRender->renderPolygon(3, tiles[i].fineScreenCoords[j], bits, width, height, stride,
+                                          &tiles[i].image, uv[j]);
+        }
+    });
+
+    m_tiles.clear();
+}
+
+void HIPSRenderer::drawGrid(QImage *pDest)
+{
+    if (m_gridCells.isEmpty())
+        return;
+
+    QPainter p(pDest);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(gridColor);
+
+    for (const auto &cell : m_gridCells)
+    {
+        const QPointF *cornerScreenCoords = cell.cornerScreenCoords;
+        p.drawLine(cornerScreenCoords[0].x(), cornerScreenCoords[0].y(), cornerScreenCoords[1].x(), cornerScreenCoords[1].y());
+        p.drawLine(cornerScreenCoords[1].x(), cornerScreenCoords[1].y(), cornerScreenCoords[2].x(), cornerScreenCoords[2].y());
+        p.drawLine(cornerScreenCoords[2].x(), cornerScreenCoords[2].y(), cornerScreenCoords[3].x(), cornerScreenCoords[3].y());
+        p.drawLine(cornerScreenCoords[3].x(), cornerScreenCoords[3].y(), cornerScreenCoords[0].x(), cornerScreenCoords[0].y());
+        p.drawText((cornerScreenCoords[0].x() + cornerScreenCoords[1].x() + cornerScreenCoords[2].x() + cornerScreenCoords[3].x()) /
+                   4,
+                   (cornerScreenCoords[0].y() + cornerScreenCoords[1].y() + cornerScreenCoords[2].y() + cornerScreenCoords[3].y()) / 4,
+                   QString::number(cell.pix) + " / " + QString::number(cell.level));
+    }
+
+    m_gridCells.clear();
+}
+
 void HIPSRenderer::renderRec(bool allsky, int level, int pix, QImage *pDest)
 {
     if (m_renderedMap.contains(pix))
@@ -127,6 +245,8 @@ void HIPSRenderer::renderRec(bool allsky, int level, int pix, QImage *pDest)
 
 bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
 {
+    Q_UNUSED(pDest);
+
     SkyPoint cornerSkyCoords[4];
     QPointF cornerScreenCoords[4];
     bool freeImage = false;
@@ -160,35 +280,10 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
 
             m_size += image->sizeInBytes();
 
-            // UV Mapping to apply image unto the destination image
-            // 4x4 = 16 points are mapped from the source image unto the destination image.
-            // Starting from each grandchild pixel, each pix polygon is mapped accordingly.
-            // For example, pixel 357 will have 4 child pixels, each of them will have 4 childs pixels and so
-            // on. Each healpix pixel appears roughly as a diamond on the sky map.
-            // The corners points for HealPIX moves from NORTH -> EAST -> SOUTH -> WEST
-            // Hence first point is 0.25, 0.25 in UV coordinate system.
-            // Depending on the selected algorithm, the mapping will either utilize nearest neighbour
-            // or bilinear interpolation.
-            QPointF uv[16][4] = {{QPointF(.25, .25), QPointF(0.25, 0), QPointF(0, .0), QPointF(0, .25)},
-                {QPointF(.25, .5), QPointF(0.25, 0.25), QPointF(0, .25), QPointF(0, .5)},
-                {QPointF(.5, .25), QPointF(0.5, 0), QPointF(.25, .0), QPointF(.25, .25)},
-                {QPointF(.5, .5), QPointF(0.5, 0.25), QPointF(.25, .25), QPointF(.25, .5)},
-
-                {QPointF(.25, .75), QPointF(0.25, 0.5), QPointF(0, 0.5), QPointF(0, .75)},
-                {QPointF(.25, 1), QPointF(0.25, 0.75), QPointF(0, .75), QPointF(0, 1)},
-                {QPointF(.5, .75), QPointF(0.5, 0.5), QPointF(.25, .5), QPointF(.25, .75)},
-                {QPointF(.5, 1), QPointF(0.5, 0.75), QPointF(.25, .75), QPointF(.25, 1)},
-
-                {QPointF(.75, .25), QPointF(0.75, 0), QPointF(0.5, .0), QPointF(0.5, .25)},
-                {QPointF(.75, .5), QPointF(0.75, 0.25), QPointF(0.5, .25), QPointF(0.5, .5)},
-                {QPointF(1, .25), QPointF(1, 0), QPointF(.75, .0), QPointF(.75, .25)},
-                {QPointF(1, .5), QPointF(1, 0.25), QPointF(.75, .25), QPointF(.75, .5)},
-
-                {QPointF(.75, .75), QPointF(0.75, 0.5), QPointF(0.5, .5), QPointF(0.5, .75)},
-                {QPointF(.75, 1), QPointF(0.75, 0.75), QPointF(0.5, .75), QPointF(0.5, 1)},
-                {QPointF(1, .75), QPointF(1, 0.5), QPointF(.75, .5), QPointF(.75, .75)},
-                {QPointF(1, 1), QPointF(1, 0.75), QPointF(.75, .75), QPointF(.75, 1)},
-            };
+            // The tile keeps its own reference to the image data, so it stays valid even if
+            // the cache drops the item before the tiles are rasterized.
+            hipsTile_t tile;
+            tile.image = *image;
 
             int childPixelID[4];
 
@@ -206,20 +301,19 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
                 // system.
                 m_HEALpix->getPixChilds(id, grandChildPixelID);
 
-                QPointF fineScreenCoords[4];
-
                 for (int id2 : grandChildPixelID)
                 {
                     SkyPoint fineSkyPoints[4];
                     m_HEALpix->getCornerPoints(level + 2, id2, fineSkyPoints);
 
                     for (int i = 0; i < 4; i++)
-                        fineScreenCoords[i] = m_projector->toScreen(&fineSkyPoints[i]);
-                    m_scanRender->renderPolygon(3, fineScreenCoords, pDest, image, uv[j]);
+                        tile.fineScreenCoords[j][i] = m_projector->toScreen(&fineSkyPoints[i]);
                     j++;
                 }
             }
 
+            m_tiles.append(tile);
+
             if (freeImage)
             {
                 delete image;
@@ -228,18 +322,11 @@ bool HIPSRenderer::renderPix(bool allsky, int level, int pix, QImage *pDest)
 
         if (Options::hIPSShowGrid())
         {
-            QPainter p(pDest);
-            p.setRenderHint(QPainter::Antialiasing);
-            p.setPen(gridColor);
-
-            p.drawLine(cornerScreenCoords[0].x(), cornerScreenCoords[0].y(), cornerScreenCoords[1].x(), cornerScreenCoords[1].y());
-            p.drawLine(cornerScreenCoords[1].x(), cornerScreenCoords[1].y(), cornerScreenCoords[2].x(), cornerScreenCoords[2].y());
-            p.drawLine(cornerScreenCoords[2].x(), cornerScreenCoords[2].y(), cornerScreenCoords[3].x(), cornerScreenCoords[3].y());
-            p.drawLine(cornerScreenCoords[3].x(), cornerScreenCoords[3].y(), cornerScreenCoords[0].x(), cornerScreenCoords[0].y());
-            p.drawText((cornerScreenCoords[0].x() + cornerScreenCoords[1].x() + cornerScreenCoords[2].x() + cornerScreenCoords[3].x()) /
-                       4,
-                       (cornerScreenCoords[0].y() + cornerScreenCoords[1].y() + cornerScreenCoords[2].y() + cornerScreenCoords[3].y()) / 4,
-                       QString::number(pix) + " / " + QString::number(level));
+            hipsGridCell_t cell;
+            std::copy(cornerScreenCoords, cornerScreenCoords + 4, cell.cornerScreenCoords);
+            cell.pix = pix;
+            cell.level = level;
+            m_gridCells.append(cell);
         }
 
         return true;
@@ -10,12 +10,31 @@
 
 #include "healpix.h"
 #include "hipsmanager.h"
+#include "hipsprefetcher.h"
 #include "scanrender.h"
 
+#include <QVector>
+
 #include <memory>
+#include <vector>
 
 class Projector;
 
+// A tile waiting to be rasterized: the source image and the screen coordinates
+// of the 4x4 grandchild pixels it is mapped onto.
+typedef struct
+{
+  QImage  image;
+  QPointF fineScreenCoords[16][4];
+} hipsTile_t;
+
+typedef struct
+{
+  QPointF cornerScreenCoords[4];
+  int     pix;
+  int     level;
+} hipsGridCell_t;
+
 class HIPSRenderer : public QObject
 {
   Q_OBJECT
@@ -25,6 +44,8 @@ public:
   bool render(uint16_t w, uint16_t h, QImage *hipsImage, const Projector *m_proj);
   void renderRec(bool allsky, int level, int pix, QImage *pDest);
   bool renderPix(bool allsky, int level, int pix, QImage *pDest);
+  void rasterizeTiles(QImage *pDest, bool bilinear);
+  void drawGrid(QImage *pDest);
 
 signals:
 
@@ -36,7 +57,11 @@ private:
   int m_size { 0 };
   QSet<int>  m_renderedMap;
   std::unique_ptr<HEALPix> m_HEALpix;
-  std::unique_ptr<ScanRender> m_scanRender;
+  std::unique_ptr<HIPSPrefetcher> m_prefetcher;
+  // One scan renderer per horizontal band of the destination image
+  std::vector<std::unique_ptr<ScanRender>> m_bandRenders;
+  QVector<hipsTile_t> m_tiles;
+  QVector<hipsGridCell_t> m_gridCells;
   const Projector *m_projector;
   QColor gridColor;
 };
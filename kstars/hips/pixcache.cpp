@@ -43,6 +43,11 @@ pixCacheItem_t *PixCache::get(pixCacheKey_t &key)
   return m_cache.object(key);
 }
 
+bool PixCache::contains(pixCacheKey_t &key) const
+{
+  return m_cache.contains(key);
+}
+
 void PixCache::setMaxCost(int maxCost)
 {
   m_cache.setMaxCost(maxCost);
@@ -17,6 +17,7 @@ public:
 
   void add(pixCacheKey_t &key, pixCacheItem_t *item, int cost);
   pixCacheItem_t *get(pixCacheKey_t &key);
+  bool contains(pixCacheKey_t &key) const;
   void setMaxCost(int maxCost);
   void printCache();
   int  used();
@@ -0,0 +1,317 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "pixdisccache.h"
+
+#include "kstars_debug.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <cstring>
+
+#define DISC_CACHE_MAGIC      0x4b534844  // file header
+#define DISC_SLOT_MAGIC       0x4b535458  // used slot
+#define DISC_CACHE_VERSION    1
+#define DISC_HEADER_SIZE      64
+
+typedef struct
+{
+  quint32 magic;
+  quint32 version;
+  quint32 tileWidth;
+  quint32 slotCount;
+  qint64  slotSize;
+} pixDiscHeader_t;
+
+typedef struct
+{
+  quint32 magic;
+  qint32  level;
+  qint32  pix;
+  qint32  width;
+  qint32  height;
+  qint32  bytesPerLine;
+  qint32  format;
+  qint64  uid;
+} pixDiscSlot_t;
+
+static QPair<qint64, qint64> discIndexKey(const pixCacheKey_t &key)
+{
+  return qMakePair(key.uid, (static_cast<qint64>(key.level) << 32) | static_cast<quint32>(key.pix));
+}
+
+// Bytes per pixel of the formats stored in the slots, 0 for any other format
+static int discBytesPerPixel(qint32 format)
+{
+  switch (format)
+  {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+      return 4;
+
+    case QImage::Format_Grayscale8:
+    case QImage::Format_Indexed8:
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+PixDiscCache::~PixDiscCache()
+{
+  close();
+}
+
+bool PixDiscCache::open(const QString &path, int tileWidth, qint64 maxSize)
+{
+  close();
+
+  if (tileWidth <= 0)
+    return false;
+
+  // Slots are page aligned and big enough for an RGBA tile
+  qint64 slotSize = DISC_HEADER_SIZE + static_cast<qint64>(tileWidth) * tileWidth * 4;
+  slotSize = (slotSize + 4095) & ~static_cast<qint64>(4095);
+  int slotCount = static_cast<int>(qMin<qint64>((maxSize - DISC_HEADER_SIZE) / slotSize, 1 << 20));
+  if (slotCount <= 0)
+    return false;
+
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::ReadWrite))
+  {
+    qCWarning(KSTARS) << "Unable to open HiPS decoded tile cache" << path << m_file.errorString();
+    return false;
+  }
+
+  // Drop the existing contents if they were made for a different layout
+  pixDiscHeader_t header;
+  bool valid = m_file.size() == DISC_HEADER_SIZE + slotSize * slotCount &&
+               m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header) &&
+               header.magic == DISC_CACHE_MAGIC && header.version == DISC_CACHE_VERSION &&
+               static_cast<int>(header.tileWidth) == tileWidth && header.slotSize == slotSize &&
+               static_cast<int>(header.slotCount) == slotCount;
+
+  if (!valid && (!m_file.resize(0) || !m_file.resize(DISC_HEADER_SIZE + slotSize * slotCount)))
+  {
+    qCWarning(KSTARS) << "Unable to size HiPS decoded tile cache" << path << m_file.errorString();
+    m_file.close();
+    return false;
+  }
+
+  m_data = m_file.map(0, m_file.size());
+  if (m_data == nullptr)
+  {
+    qCWarning(KSTARS) << "Unable to map HiPS decoded tile cache" << path << m_file.errorString();
+    m_file.close();
+    return false;
+  }
+
+  m_tileWidth = tileWidth;
+  m_slotSize = slotSize;
+  m_slotCount = slotCount;
+  m_lastUsed.fill(0, slotCount);
+
+  if (valid)
+  {
+    readIndex();
+  }
+  else
+  {
+    header.magic = DISC_CACHE_MAGIC;
+    header.version = DISC_CACHE_VERSION;
+    header.tileWidth = tileWidth;
+    header.slotCount = slotCount;
+    header.slotSize = slotSize;
+    memcpy(m_data, &header, sizeof(header));
+  }
+
+  return true;
+}
+
+void PixDiscCache::close()
+{
+  if (m_data)
+    m_file.unmap(m_data);
+  m_data = nullptr;
+
+  if (m_file.isOpen())
+    m_file.close();
+
+  m_index.clear();
+  m_lastUsed.clear();
+  m_tileWidth = 0;
+  m_slotSize = 0;
+  m_slotCount = 0;
+}
+
+bool PixDiscCache::isOpen() const
+{
+  return m_data != nullptr;
+}
+
+int PixDiscCache::tileWidth() const
+{
+  return m_tileWidth;
+}
+
+uchar *PixDiscCache::slot(int index) const
+{
+  return m_data + DISC_HEADER_SIZE + index * m_slotSize;
+}
+
+void PixDiscCache::readIndex()
+{
+  for (int i = 0; i < m_slotCount; i++)
+  {
+    pixDiscSlot_t header;
+    memcpy(&header, slot(i), sizeof(header));
+
+    if (header.magic != DISC_SLOT_MAGIC)
+      continue;
+
+    pixCacheKey_t key;
+    key.level = header.level;
+    key.pix = header.pix;
+    key.uid = header.uid;
+
+    // The file may have been damaged, e.g. by a crash while a slot was written. A slot whose image
+    // wouldn't fit in it, or a second copy of a tile, is dropped rather than read past its end later.
+    const int bytesPerPixel = discBytesPerPixel(header.format);
+    if (bytesPerPixel == 0 || header.level < 0 || header.pix < 0 || header.width <= 0 || header.height <= 0 ||
+        header.bytesPerLine < header.width * bytesPerPixel ||
+        static_cast<qint64>(header.bytesPerLine) * header.height > m_slotSize - DISC_HEADER_SIZE ||
+        m_index.contains(discIndexKey(key)))
+    {
+      quint32 magic = 0;
+      memcpy(slot(i), &magic, sizeof(magic));
+      continue;
+    }
+
+    m_index.insert(discIndexKey(key), i);
+    m_lastUsed[i] = ++m_clock;
+  }
+}
+
+int PixDiscCache::findFreeSlot()
+{
+  int oldest = 0;
+
+  for (int i = 0; i < m_slotCount; i++)
+  {
+    if (m_lastUsed[i] == 0)
+      return i;
+
+    if (m_lastUsed[i] < m_lastUsed[oldest])
+      oldest = i;
+  }
+
+  // Evict the least recently used tile
+  pixDiscSlot_t header;
+  memcpy(&header, slot(oldest), sizeof(header));
+
+  pixCacheKey_t key;
+  key.level = header.level;
+  key.pix = header.pix;
+  key.uid = header.uid;
+  m_index.remove(discIndexKey(key));
+
+  return oldest;
+}
+
+bool PixDiscCache::add(const pixCacheKey_t &key, const QImage &image)
+{
+  if (!isOpen() || image.isNull() || m_index.contains(discIndexKey(key)))
+    return false;
+
+  QImage tile = image;
+  if (discBytesPerPixel(tile.format()) == 0)
+    tile = tile.convertToFormat(QImage::Format_ARGB32);
+
+  qint64 bytes = static_cast<qint64>(tile.bytesPerLine()) * tile.height();
+  if (bytes > m_slotSize - DISC_HEADER_SIZE)
+    return false;
+
+  int index = findFreeSlot();
+  uchar *data = slot(index);
+
+  pixDiscSlot_t header;
+  header.magic = DISC_SLOT_MAGIC;
+  header.level = key.level;
+  header.pix = key.pix;
+  header.width = tile.width();
+  header.height = tile.height();
+  header.bytesPerLine = tile.bytesPerLine();
+  header.format = tile.format();
+  header.uid = key.uid;
+
+  memcpy(data + DISC_HEADER_SIZE, tile.constBits(), bytes);
+  memcpy(data, &header, sizeof(header));
+
+  m_index.insert(discIndexKey(key), index);
+  m_lastUsed[index] = ++m_clock;
+
+  return true;
+}
+
+QImage *PixDiscCache::get(const pixCacheKey_t &key)
+{
+  auto it = m_index.constFind(discIndexKey(key));
+  if (it == m_index.constEnd())
+    return nullptr;
+
+  int index = it.value();
+  const uchar *data = slot(index);
+
+  pixDiscSlot_t header;
+  memcpy(&header, data, sizeof(header));
+
+  // Copy out of the mapped file, the slot may be reused later
+  QImage mapped(data + DISC_HEADER_SIZE, header.width, header.height, header.bytesPerLine,
+                static_cast<QImage::Format>(header.format));
+  QImage *image = new QImage(mapped.copy());
+
+  if (image->format() == QImage::Format_Indexed8)
+  {
+    // ScanRender treats indexed tiles as grayscale
+    QVector<QRgb> colorTable(256);
+    for (int i = 0; i < 256; i++)
+      colorTable[i] = qRgb(i, i, i);
+    image->setColorTable(colorTable);
+  }
+
+  m_lastUsed[index] = ++m_clock;
+
+  return image;
+}
+
+bool PixDiscCache::contains(const pixCacheKey_t &key) const
+{
+  return m_index.contains(discIndexKey(key));
+}
+
+void PixDiscCache::clear()
+{
+  if (!isOpen())
+    return;
+
+  for (int i = 0; i < m_slotCount; i++)
+  {
+    quint32 magic = 0;
+    memcpy(slot(i), &magic, sizeof(magic));
+  }
+
+  m_index.clear();
+  m_lastUsed.fill(0);
+}
+
+qint64 PixDiscCache::used() const
+{
+  return m_index.size() * m_slotSize;
+}
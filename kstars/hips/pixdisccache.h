@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "hips.h"
+
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+/**
+ * @brief The PixDiscCache class is the second level of the HiPS tile cache, behind the RAM PixCache.
+ *
+ *        It keeps tiles that have already been decoded from JPEG/PNG in a memory mapped file, so a tile
+ *        that falls out of the RAM cache is brought back with a copy rather than being decoded again.
+ *        The file is split into fixed size slots, each large enough for one RGBA tile of the current
+ *        tile width. When all slots are in use the least recently used one is replaced.
+ *
+ *        Each slot carries its own header, so the contents of the file survive between sessions.
+ *
+ * @author KStars Developers
+ */
+class PixDiscCache
+{
+public:
+  PixDiscCache() = default;
+  ~PixDiscCache();
+
+  /**
+   * @brief Open (or create) the cache file
+   * @param path of the cache file
+   * @param tileWidth of the tiles to be stored. Existing contents made for another width are dropped.
+   * @param maxSize of the file in bytes
+   * @return true if the file is mapped and ready
+   */
+  bool open(const QString &path, int tileWidth, qint64 maxSize);
+  void close();
+  bool isOpen() const;
+  int  tileWidth() const;
+
+  /**
+   * @brief Store a decoded tile. Tiles larger than a slot (e.g. allsky images) are ignored.
+   * @return true if the tile was stored
+   */
+  bool add(const pixCacheKey_t &key, const QImage &image);
+
+  /**
+   * @brief Read a decoded tile back
+   * @return a new image owned by the caller, or nullptr if the tile isn't cached
+   */
+  QImage *get(const pixCacheKey_t &key);
+
+  bool contains(const pixCacheKey_t &key) const;
+  void clear();
+  qint64 used() const;
+
+private:
+  uchar *slot(int index) const;
+  int    findFreeSlot();
+  void   readIndex();
+
+  QFile  m_file;
+  uchar *m_data { nullptr };
+  int    m_tileWidth { 0 };
+  qint64 m_slotSize { 0 };
+  int    m_slotCount { 0 };
+  quint64 m_clock { 0 };
+  // Tile (uid, level and pix) -> slot index, and when each slot was last used (0 = free)
+  QHash<QPair<qint64, qint64>, int> m_index;
+  QVector<quint64> m_lastUsed;
+};
@@ -39,6 +39,14 @@ bool ScanRender::isBilinearInterpolationEnabled()
   return(bBilinear);
 }
 
+//////////////////////////////////////////////////
+void ScanRender::setScanBand(int top, int bottom)
+//////////////////////////////////////////////////
+{
+  m_bandTop = qMax(0, top);
+  m_bandBottom = qMin(bottom, MAX_BK_SCANLINES);
+}
+
 ///////////////////////////////////////////////
 void ScanRender::resetScanPoly(int sx, int sy)
 ///////////////////////////////////////////////
@@ -73,12 +81,15 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2)
     side = 1;
   }
 
-  if (y2 < 0)
+  int top = m_bandTop;
+  int bottom = qMin(m_sy, m_bandBottom);
+
+  if (y2 < top)
   {
     return; // offscreen
   }
 
-  if (y1 >= m_sy)
+  if (y1 >= bottom)
   {
     return; // offscreen
   }
@@ -94,17 +105,17 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2)
   float x = x1;
   int   y;
 
-  if (y2 >= m_sy)
+  if (y2 >= bottom)
   {
-    y2 = m_sy - 1;
+    y2 = bottom - 1;
   }
 
-  if (y1 < 0)
+  if (y1 < top)
   { // partially off screen
-    float m = (float) -y1;
+    float m = (float) (top - y1);
 
     x += dx * m;
-    y1 = 0;
+    y1 = top;
   }
 
   int minY = qMin(y1, y2);
@@ -168,9 +179,12 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
     side = 1;
   }
 
-  if (y2 < 0)
+  int top = m_bandTop;
+  int bottom = qMin(m_sy, m_bandBottom);
+
+  if (y2 < top)
     return; // offscreen
-  if (y1 >= m_sy)
+  if (y1 >= bottom)
     return; // offscreen
 
   float dy = (float)(y2 - y1);
@@ -182,8 +196,8 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
   float x = x1;
   int   y;
 
-  if (y2 >= m_sy)
-    y2 = m_sy - 1;
+  if (y2 >= bottom)
+    y2 = bottom - 1;
 
   float duv[2];
   float uv[2] = {u1, v1};
@@ -191,15 +205,15 @@ void ScanRender::scanLine(int x1, int y1, int x2, int y2, float u1, float v1, fl
   duv[0] = (u2 - u1) / dy;
   duv[1] = (v2 - v1) / dy;
 
-  if (y1 < 0)
+  if (y1 < top)
   { // partially off screen
-    float m = (float) -y1;
+    float m = (float) (top - y1);
 
     uv[0] += duv[0] * m;
     uv[1] += duv[1] * m;
 
     x += dx * m;
-    y1 = 0;
+    y1 = top;
   }
 
   int minY = qMin(y1, y2);
@@ -326,14 +340,26 @@ void ScanRender::setOpacity(float opacity)
 /////////////////////////////////////////////////////////
 void ScanRender::renderPolygon(QImage *dst, QImage *src)
 /////////////////////////////////////////////////////////
+{
+  renderPolygon((quint32 *)dst->bits(), dst->width(), dst->bytesPerLine() / 4, src);
+}
+
+void ScanRender::renderPolygon(quint32 *dst, int dw, int dstride, const QImage *src)
 {
   if (bBilinear)
-    renderPolygonBI(dst, src);
+    renderPolygonBI(dst, dw, dstride, src);
   else
-    renderPolygonNI(dst, src);
+    renderPolygonNI(dst, dw, dstride, src);
 }
 
 void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, QImage *pSrc, QPointF *uv)
+{
+  renderPolygon(interpolation, pts, (quint32 *)pDest->bits(), pDest->width(), pDest->height(),
+                pDest->bytesPerLine() / 4, pSrc, uv);
+}
+
+void ScanRender::renderPolygon(int interpolation, const QPointF *pts, quint32 *dst, int dw, int dh, int dstride,
+                               const QImage *pSrc, const QPointF *uv)
 {
   QPointF Auv = uv[0];
   QPointF Buv = uv[1];
@@ -342,12 +368,12 @@ void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, Q
 
   if (interpolation < 2)
   {
-    resetScanPoly(pDest->width(), pDest->height());
+    resetScanPoly(dw, dh);
     scanLine(pts[0].x(), pts[0].y(), pts[1].x(), pts[1].y(), 1, 1, 1, 0);
     scanLine(pts[1].x(), pts[1].y(), pts[2].x(), pts[2].y(), 1, 0, 0, 0);
     scanLine(pts[2].x(), pts[2].y(), pts[3].x(), pts[3].y(), 0, 0, 0, 1);
     scanLine(pts[3].x(), pts[3].y(), pts[0].x(), pts[0].y(), 0, 1, 1, 1);
-    renderPolygon(pDest, pSrc);
+    renderPolygon(dst, dw, dstride, pSrc);
     return;
   }
 
@@ -386,12 +412,12 @@ void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, Q
       QPointF D1 = Q1 + j * (Q2 - Q1) / interpolation;
       QPointF D1uv = Q1uv + j * (Q2uv - Q1uv) / interpolation;
 
-      resetScanPoly(pDest->width(), pDest->height());
+      resetScanPoly(dw, dh);
       scanLine(A1.x(), A1.y(), B1.x(), B1.y(), A1uv.x(), A1uv.y(), B1uv.x(), B1uv.y());
       scanLine(B1.x(), B1.y(), C1.x(), C1.y(), B1uv.x(), B1uv.y(), C1uv.x(), C1uv.y());
       scanLine(C1.x(), C1.y(), D1.x(), D1.y(), C1uv.x(), C1uv.y(), D1uv.x(), D1uv.y());
       scanLine(D1.x(), D1.y(), A1.x(), A1.y(), D1uv.x(), D1uv.y(), A1uv.x(), A1uv.y());
-      renderPolygon(pDest, pSrc);
+      renderPolygon(dst, dw, dstride, pSrc);
 
       //p->drawLine(A1, B1);
       //p->drawLine(B1, C1);
@@ -402,16 +428,14 @@ void ScanRender::renderPolygon(int interpolation, QPointF *pts, QImage *pDest, Q
 }
 
 ///////////////////////////////////////////////////////////
-void ScanRender::renderPolygonNI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonNI(quint32 *bitsDst, int w, int stride, const QImage *src)
 ///////////////////////////////////////////////////////////
 {
-  int w = dst->width();
   int sw = src->width();
   int sh = src->height();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
-  quint32 *bitsDst = (quint32 *)dst->bits();
   bkScan_t *scan = scLR;
   bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;      
 
@@ -459,7 +483,7 @@ void ScanRender::renderPolygonNI(QImage *dst, QImage *src)
     duv[0] *= tsx;
     duv[1] *= tsy;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    quint32 *pDst = bitsDst + (y * stride) + px1;
 
     int fuv[2];
     int fduv[2];
@@ -505,17 +529,15 @@ void ScanRender::renderPolygonNI(QImage *dst, QImage *src)
 
 
 ///////////////////////////////////////////////////////////
-void ScanRender::renderPolygonBI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonBI(quint32 *bitsDst, int w, int stride, const QImage *src)
 ///////////////////////////////////////////////////////////
 {
-  int w = dst->width();
   int sw = src->width();
   int sh = src->height();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
   const uchar *bitsSrc8 = (uchar *)src->constBits();
-  quint32 *bitsDst = (quint32 *)dst->bits();
   bkScan_t *scan = scLR;
   bool bw = src->format() == QImage::Format_Indexed8 || src->format() == QImage::Format_Grayscale8;
 
@@ -567,72 +589,74 @@ void ScanRender::renderPolygonBI(QImage *dst, QImage *src)
 
     int size = sw * sh;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    // Step through the source in 16.16 fixed point, the fractional part
+    // gives the bilinear weights with 8 bit precision
+    int fuv[2];
+    int fduv[2];
+
+    fuv[0] = uv[0] * 65536;
+    fuv[1] = uv[1] * 65536;
+
+    fduv[0] = duv[0] * 65536;
+    fduv[1] = duv[1] * 65536;
+
+    quint32 *pDst = bitsDst + (y * stride) + px1;
     if (bw)
     {
       for (int x = px1; x < px2; x++)
       {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
+        int index = (fuv[0] >> 16) + ((fuv[1] >> 16) * sw);
+        uint x_diff = (fuv[0] >> 8) & 0xff;
+        uint y_diff = (fuv[1] >> 8) & 0xff;
 
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
+        // The 4 weights always add up to 256
+        uint qxy = (x_diff * y_diff) >> 8;
+        uint qxy2 = x_diff - qxy;
+        uint qyx1 = y_diff - qxy;
+        uint qxy1 = 256 - x_diff - y_diff + qxy;
 
-        uchar a = bitsSrc8[index];
-        uchar b = bitsSrc8[(index + 1) % size];
-        uchar c = bitsSrc8[(index + sw) % size];
-        uchar d = bitsSrc8[(index + sw + 1) % size];
+        uint val = (bitsSrc8[index] * qxy1 + bitsSrc8[(index + 1) % size] * qxy2 +
+                    bitsSrc8[(index + sw) % size] * qyx1 + bitsSrc8[(index + sw + 1) % size] * qxy) >> 8;
 
-        int val = (a&0xff)*(x_1diff)*(y_1diff) + (b&0xff)*(x_diff)*(y_1diff) +
-                  (c&0xff)*(y_diff)*(x_1diff)   + (d&0xff)*(x_diff*y_diff);
-
-        *pDst = 0xff000000 |
-                ((((int)val)<<16)&0xff0000) |
-                ((((int)val)<<8)&0xff00) |
-                ((int)val) ;
+        *pDst = 0xff000000 | (val << 16) | (val << 8) | val;
         pDst++;
 
-        uv[0] += duv[0];
-        uv[1] += duv[1];
+        fuv[0] += fduv[0];
+        fuv[1] += fduv[1];
       }
     }
     else
     {
       for (int x = px1; x < px2; x++)
       {
-        float x_diff = uv[0] - static_cast<int>(uv[0]);
-        float y_diff = uv[1] - static_cast<int>(uv[1]);
-        float x_1diff = 1 - x_diff;
-        float y_1diff = 1 - y_diff;
+        int index = (fuv[0] >> 16) + ((fuv[1] >> 16) * sw);
+        uint x_diff = (fuv[0] >> 8) & 0xff;
+        uint y_diff = (fuv[1] >> 8) & 0xff;
 
-        int index = ((int)uv[0] + ((int)uv[1] * sw));
+        uint qxy = (x_diff * y_diff) >> 8;
+        uint qxy2 = x_diff - qxy;
+        uint qyx1 = y_diff - qxy;
+        uint qxy1 = 256 - x_diff - y_diff + qxy;
 
         quint32 a = bitsSrc[index];
         quint32 b = bitsSrc[(index + 1) % size];
         quint32 c = bitsSrc[(index + sw) % size];
         quint32 d = bitsSrc[(index + sw + 1) % size];
 
-        int qxy1 = (x_1diff * y_1diff) * 65536;
-        int qxy2 =(x_diff * y_1diff) * 65536;
-        int qxy = (x_diff * y_diff) * 65536;
-        int qyx1 = (y_diff * x_1diff) * 65536;
-
-        // blue element
-        int blue = ((a&0xff)*(qxy1) + (b&0xff)*(qxy2) + (c&0xff)*(qyx1)  + (d&0xff)*(qxy)) >> 16;
+        // Interpolate two channels per multiply: red and blue sit in separate 16 bit
+        // halves of the word (as do alpha and green), the weights add up to 256 so
+        // neither half can overflow into the other.
+        quint32 rb = ((a & 0x00ff00ff) * qxy1 + (b & 0x00ff00ff) * qxy2 +
+                      (c & 0x00ff00ff) * qyx1 + (d & 0x00ff00ff) * qxy) >> 8;
+        quint32 ag = ((a >> 8) & 0x00ff00ff) * qxy1 + ((b >> 8) & 0x00ff00ff) * qxy2 +
+                     ((c >> 8) & 0x00ff00ff) * qyx1 + ((d >> 8) & 0x00ff00ff) * qxy;
 
-        // green element
-        int green = (((a>>8)&0xff)*(qxy1) + ((b>>8)&0xff)*(qxy2) + ((c>>8)&0xff)*(qyx1)  + ((d>>8)&0xff)*(qxy)) >> 16;
-
-        // red element
-        int red = (((a>>16)&0xff)*(qxy1) + ((b>>16)&0xff)*(qxy2) +((c>>16)&0xff)*(qyx1)  + ((d>>16)&0xff)*(qxy)) >> 16;
-
-        *pDst = 0xff000000 | (((red)<<16)&0xff0000) | (((green)<<8)&0xff00) | (blue);
+        *pDst = 0xff000000 | (rb & 0x00ff00ff) | (ag & 0x0000ff00);
 
         pDst++;
 
-        uv[0] += duv[0];
-        uv[1] += duv[1];
+        fuv[0] += fduv[0];
+        fuv[1] += fduv[1];
       }
     }
   }
@@ -640,28 +664,27 @@ void ScanRender::renderPolygonBI(QImage *dst, QImage *src)
 
 void ScanRender::renderPolygonAlpha(QImage *dst, QImage *src)
 {
+  quint32 *bits = (quint32 *)dst->bits();
   if (bBilinear)
-    renderPolygonAlphaBI(dst, src);
+    renderPolygonAlphaBI(bits, dst->width(), dst->bytesPerLine() / 4, src);
   else
-    renderPolygonAlphaNI(dst, src);
+    renderPolygonAlphaNI(bits, dst->width(), dst->bytesPerLine() / 4, src);
 }
 
 
-void ScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonAlphaBI(quint32 *bitsDst, int w, int stride, const QImage *src)
 {
-  int w = dst->width();
   int sw = src->width();
   int sh = src->height();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();  
-  quint32 *bitsDst = (quint32 *)dst->bits();
   bkScan_t *scan = scLR;
   bool bw = src->format() == QImage::Format_Indexed8;
   float opacity = (m_opacity / 65536.) * 0.00390625f;
 
 #ifdef PARALLEL_OMP
-  #pragma omp parallel for shared(bitsDst, bitsSrc, scan, tsx, tsy, w, sw)
+  #pragma omp parallel for shared(bitsDst, bitsSrc, scan, tsx, tsy, w, stride, sw)
 #endif
   for (int y = plMinY; y <= plMaxY; y++)
   {
@@ -708,7 +731,7 @@ void ScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
 
     int size = sw * sh;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    quint32 *pDst = bitsDst + (y * stride) + px1;
     if (bw)
     {
       /*
@@ -797,20 +820,18 @@ void ScanRender::renderPolygonAlphaBI(QImage *dst, QImage *src)
 
 
 ////////////////////////////////////////////////////////////////
-void ScanRender::renderPolygonAlphaNI(QImage *dst, QImage *src)
+void ScanRender::renderPolygonAlphaNI(quint32 *bitsDst, int w, int stride, const QImage *src)
 ////////////////////////////////////////////////////////////////
 {
-  int w = dst->width();
   int sw = src->width();
   float tsx = src->width() - 1;
   float tsy = src->height() - 1;
   const quint32 *bitsSrc = (quint32 *)src->constBits();
-  quint32 *bitsDst = (quint32 *)dst->bits();
   bkScan_t *scan = scLR;
   float opacity = 0.00390625f * m_opacity;    
 
 #ifdef PARALLEL_OMP
-  #pragma omp parallel for shared(bitsDst, bitsSrc, scan, tsx, tsy, w, sw)
+  #pragma omp parallel for shared(bitsDst, bitsSrc, scan, tsx, tsy, w, stride, sw)
 #endif
   for (int y = plMinY; y <= plMaxY; y++)
   {
@@ -849,7 +870,7 @@ void ScanRender::renderPolygonAlphaNI(QImage *dst, QImage *src)
     if (px2 >= w)
       px2 = w - 1;
 
-    quint32 *pDst = bitsDst + (y * w) + px1;
+    quint32 *pDst = bitsDst + (y * stride) + px1;
 
     uv[0] *= tsx;
     uv[1] *= tsy;
@@ -27,19 +27,28 @@ class ScanRender
     explicit ScanRender(void);
     void setBilinearInterpolationEnabled(bool enable);
     bool isBilinearInterpolationEnabled(void);
+    // Restrict the rows written to [top, bottom). Renderers working on
+    // disjoint bands can share the same destination image across threads.
+    void setScanBand(int top, int bottom);
     void resetScanPoly(int sx, int sy);
     void scanLine(int x1, int y1, int x2, int y2);
     void scanLine(int x1, int y1, int x2, int y2, float u1, float v1, float u2, float v2);
     void renderPolygon(QColor col, QImage *dst);
     void renderPolygon(QImage *dst, QImage *src);
     void renderPolygon(int interpolation, QPointF *pts, QImage *pDest, QImage *pSrc, QPointF *uv);
+    // Same as above on the raw 32 bit pixels of the destination, dstride pixels per row.
+    // Renderers drawing bands of one image in parallel take the pixels once, up front,
+    // as QImage::bits() may detach the image.
+    void renderPolygon(quint32 *dst, int dw, int dstride, const QImage *src);
+    void renderPolygon(int interpolation, const QPointF *pts, quint32 *dst, int dw, int dh, int dstride,
+                       const QImage *pSrc, const QPointF *uv);
 
-    void renderPolygonNI(QImage *dst, QImage *src);
-    void renderPolygonBI(QImage *dst, QImage *src);
+    void renderPolygonNI(quint32 *bitsDst, int w, int stride, const QImage *src);
+    void renderPolygonBI(quint32 *bitsDst, int w, int stride, const QImage *src);
 
     void renderPolygonAlpha(QImage *dst, QImage *src);
-    void renderPolygonAlphaBI(QImage *dst, QImage *src);
-    void renderPolygonAlphaNI(QImage *dst, QImage *src);
+    void renderPolygonAlphaBI(quint32 *bitsDst, int w, int stride, const QImage *src);
+    void renderPolygonAlphaNI(quint32 *bitsDst, int w, int stride, const QImage *src);
 
     void renderPolygonAlpha(QColor col, QImage *dst);
     void setOpacity(float opacity);
@@ -50,6 +59,8 @@ private:
     int      plMaxY { 0 };
     int      m_sx { 0 };
     int      m_sy { 0 };
+    int      m_bandTop { 0 };
+    int      m_bandBottom { MAX_BK_SCANLINES };
     bkScan_t scLR[MAX_BK_SCANLINES];
     bool     bBilinear { false };
 };
@@ -17,6 +17,7 @@
 #include "streamwg.h"
 //#include "ekos/manager.h"
 #ifdef HAVE_CFITSIO
+#include "fitsviewer/fitscompressedwriter.h"
 #include "fitsviewer/fitsdata.h"
 #endif
 
@@ -32,6 +33,9 @@
 
 const QStringList RAWFormats = { "cr2", "cr3", "crw", "nef", "raf", "dng", "arw", "orf" };
 
+// Guide frames reusing the whole frame statistics of the last frame whose statistics were calculated
+constexpr int GUIDE_STATISTICS_REUSE = 10;
+
 const QString getFITSModeStringString(FITSMode mode)
 {
     return FITSModes[mode].toString();
@@ -48,6 +52,7 @@ Camera::Camera(GenericDevice *parent) : ConcreteDevice(parent)
     connect(m_Media.get(), &WSMedia::newFile, this, &Camera::setWSBLOB);
 
     connect(m_Parent->getClientManager(), &ClientManager::newBLOBManager, this, &Camera::setBLOBManager, Qt::UniqueConnection);
+    connect(&m_DecodeWatcher, &QFutureWatcher<bool>::finished, this, &Camera::finishDecoding);
     m_LastNotificationTS = QDateTime::currentDateTime();
 }
 
@@ -57,8 +62,8 @@ Camera::~Camera()
         m_ImageViewerWindow->close();
     if (fileWriteThread.isRunning())
         fileWriteThread.waitForFinished();
-    if (fileWriteBuffer != nullptr)
-        delete [] fileWriteBuffer;
+    if (m_DecodeWatcher.isRunning())
+        m_DecodeWatcher.waitForFinished();
 }
 
 void Camera::setBLOBManager(const char *device, INDI::Property prop)
@@ -560,34 +565,19 @@ void Camera::processStream(INDI::Property prop)
     emit showVideoFrame(prop, streamW, streamH);
 }
 
-void ISD::Camera::updateFileBuffer(INDI::Property prop, bool is_fits)
+void ISD::Camera::updateFileBuffer(INDI::Property prop)
 {
-    if (is_fits)
-    {
-        // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
-        if (fileWriteThread.isRunning())
-        {
-            fileWriteThread.waitForFinished();
-        }
-    }
-
-    // Will write blob data in a separate thread, and can't depend on the blob
+    // Will write and decode blob data in separate threads, and can't depend on the blob
     // memory, so copy it first.
 
     auto bp = prop.getBLOB()->at(0);
-    // Check buffer size.
-    if (fileWriteBufferSize != bp->getBlobLen())
-    {
-        if (fileWriteBuffer != nullptr)
-            delete [] fileWriteBuffer;
-        fileWriteBufferSize = bp->getBlobLen();
-        fileWriteBuffer = new char[fileWriteBufferSize];
-    }
+    // Reuse the buffer, unless a pending write still holds it.
+    if (!fileWriteBuffer.isDetached() || fileWriteBuffer.size() != bp->getBlobLen())
+        fileWriteBuffer = QByteArray(bp->getBlobLen(), Qt::Uninitialized);
 
     // Copy memory, and write file on a separate thread.
     // Probably too late to return an error if the file couldn't write.
-    memcpy(fileWriteBuffer, bp->getBlob(), bp->getBlobLen());
+    memcpy(fileWriteBuffer.data(), bp->getBlob(), bp->getBlobLen());
 }
 
 bool Camera::saveCurrentImage(QString &filename)
@@ -596,23 +586,22 @@ bool Camera::saveCurrentImage(QString &filename)
     // Would need to deal with the raw conversion, etc.
     if (BType == BLOB_FITS)
     {
-        // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
+        // Wait until the previous file is written before starting the next one.
         if (fileWriteThread.isRunning())
         {
             fileWriteThread.waitForFinished();
         }
 
-        // Wait until the file is written before overwritting the filename.
+        // The file is compressed on the same thread, while the next exposure runs.
+        auto write = Options::fitsCompression() > 0 ? &ISD::Camera::WriteCompressedImageFileInternal :
+                     &ISD::Camera::WriteImageFileInternal;
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        fileWriteThread = QtConcurrent::run(&ISD::Camera::WriteImageFileInternal, this, filename, fileWriteBuffer,
-                                            fileWriteBufferSize);
+        fileWriteThread = QtConcurrent::run(write, this, filename, fileWriteBuffer);
 #else
-        fileWriteThread = QtConcurrent::run(this, &ISD::Camera::WriteImageFileInternal, filename, fileWriteBuffer,
-                                            fileWriteBufferSize);
+        fileWriteThread = QtConcurrent::run(this, write, filename, fileWriteBuffer);
 #endif
     }
-    else if (!WriteImageFileInternal(filename, static_cast<char*>(fileWriteBuffer), fileWriteBufferSize))
+    else if (!WriteImageFileInternal(filename, fileWriteBuffer))
         return false;
 
     return true;
@@ -625,6 +614,10 @@ bool Camera::processBLOB(INDI::Property prop)
     if (bvp->getPermission() == IP_WO || bvp->at(0)->getSize() == 0)
         return false;
 
+    // Announce the previous image first, so images are announced in the order they were received, and the
+    // file buffer and BLOB type still match the previous image if it is saved when announced.
+    finishDecoding();
+
     BType = BLOB_OTHER;
 
     auto bp = bvp->at(0);
@@ -672,7 +665,7 @@ bool Camera::processBLOB(INDI::Property prop)
     // 1. file is preview or batch mode is not enabled
     // 2. file type is not FITS_NORMAL (focus, guide..etc)
     // create the file buffer only, saving the image file must be triggered from outside.
-    updateFileBuffer(prop, BType == BLOB_FITS);
+    updateFileBuffer(prop);
 
     // Don't spam, just one notification per 3 seconds
     if (QDateTime::currentDateTime().secsTo(m_LastNotificationTS) <= -3)
@@ -681,34 +674,103 @@ bool Camera::processBLOB(INDI::Property prop)
         m_LastNotificationTS = QDateTime::currentDateTime();
     }
 
-    QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<char *>(bp->getBlob()), bp->getSize());
+    ReceivedImage received;
+    received.property = prop;
+    received.element = bp->getName();
+    received.format = format;
+    received.chip = targetChip;
+    received.mode = targetChip->getCaptureMode();
+    received.guideSettings = m_GuideSettings;
+
     QSharedPointer<FITSData> imageData;
-    imageData.reset(new FITSData(targetChip->getCaptureMode()), &QObject::deleteLater);
+    imageData.reset(new FITSData(received.mode), &QObject::deleteLater);
     imageData->setExtension(shortFormat);
 
     // JM 2024.12.25: Only load from buffer if we need the imageData.
     // When neither FITS Viewer nor Summary view is used, and when the type is FITS_NORMAL in batch mode, then we save to disk directly
     // so that we do not incur delays in loading from buffer that may delay the sequence unnecessairly.
-    if ((Options::useFITSViewer() || Options::useSummaryPreview() || targetChip->getCaptureMode() != FITS_NORMAL
-            || !targetChip->isBatchMode()) &&
-            !imageData->loadFromBuffer(buffer))
+    if (Options::useFITSViewer() || Options::useSummaryPreview() || targetChip->getCaptureMode() != FITS_NORMAL
+            || !targetChip->isBatchMode())
+    {
+        // Decode the image and compute its statistics on a worker thread, large frames would otherwise stall
+        // the event loop. The image reads the file buffer in place, it is announced once loaded.
+        // Guiding only looks at the tracking box, statistics of consecutive frames are nearly the same.
+        if (received.mode == FITS_GUIDE && m_GuideStatisticsAge >= 0
+                && m_GuideStatisticsAge < GUIDE_STATISTICS_REUSE)
+            imageData->reuseStatistics(m_GuideStatistics, m_GuideSettings.exposure, m_GuideSettings.gain);
+
+        m_DecodingData = imageData;
+        m_DecodingImage = received;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        m_DecodeWatcher.setFuture(QtConcurrent::run(&FITSData::loadFromBuffer, imageData.data(), fileWriteBuffer));
+#else
+        m_DecodeWatcher.setFuture(QtConcurrent::run(imageData.data(), &FITSData::loadFromBuffer, fileWriteBuffer));
+#endif
+        return true;
+    }
+
+    publishImage(imageData, received);
+    return true;
+}
+
+void Camera::finishDecoding()
+{
+    // Already announced if it was waited for
+    if (m_DecodingData.isNull())
+        return;
+
+    m_DecodeWatcher.waitForFinished();
+    QSharedPointer<FITSData> imageData = m_DecodingData;
+    m_DecodingData.reset();
+
+    if (!m_DecodeWatcher.result())
     {
         emit error(ERROR_LOAD);
-        return true;
+        return;
     }
 
+    publishImage(imageData, m_DecodingImage);
+}
+
+void Camera::publishImage(const QSharedPointer<FITSData> &imageData, const ReceivedImage &received)
+{
     // Add metadata
     imageData->setProperty("device", getDeviceName());
-    imageData->setProperty("blobVector", prop.getName());
-    imageData->setProperty("blobElement", bp->getName());
-    imageData->setProperty("chip", targetChip->getType());
+    imageData->setProperty("blobVector", received.property.getName());
+    imageData->setProperty("blobElement", received.element);
+    imageData->setProperty("chip", received.chip->getType());
+
+    // Not if an exposure with other settings started while the frame was decoded, its statistics were dropped.
+    if (received.mode == FITS_GUIDE && received.guideSettings == m_GuideSettings)
+    {
+        if (imageData->statisticsReused())
+            m_GuideStatisticsAge++;
+        else
+        {
+            m_GuideStatistics = imageData->getStatistics();
+            m_GuideStatisticsAge = 0;
+        }
+    }
 
     // Retain a copy
-    targetChip->setImageData(imageData);
-    emit propertyUpdated(prop);
-    emit newImage(imageData, QString(bp->getFormat()).toLower());
+    received.chip->setImageData(imageData);
+    emit propertyUpdated(received.property);
+    emit newImage(imageData, received.format);
+}
 
-    return true;
+void Camera::guideExposureStarted(CameraChip *chip, double exposure)
+{
+    GuideSettings settings;
+    settings.exposure = exposure;
+    getGain(&settings.gain);
+    chip->getFrame(&settings.x, &settings.y, &settings.w, &settings.h);
+    chip->getBinning(&settings.binX, &settings.binY);
+
+    if (settings == m_GuideSettings)
+        return;
+
+    m_GuideSettings = settings;
+    m_GuideStatisticsAge = -1;
 }
 
 void Camera::StreamWindowHidden()
@@ -1595,7 +1657,7 @@ bool Camera::setScopeInfo(double focalLength, double aperture)
 }
 
 // Internal function to write an image blob to disk.
-bool Camera::WriteImageFileInternal(const QString &filename, char *buffer, const size_t size)
+bool Camera::WriteImageFileInternal(const QString &filename, const QByteArray &buffer)
 {
     QFile file(filename);
     if (!file.open(QIODevice::WriteOnly))
@@ -1607,9 +1669,10 @@ bool Camera::WriteImageFileInternal(const QString &filename, char *buffer, const
     int n = 0;
     QDataStream out(&file);
     bool ok = true;
+    const size_t size = buffer.size();
     for (size_t nr = 0; nr < size; nr += n)
     {
-        n = out.writeRawData(buffer + nr, size - nr);
+        n = out.writeRawData(buffer.constData() + nr, size - nr);
         if (n < 0)
         {
             ok = false;
@@ -1625,6 +1688,25 @@ bool Camera::WriteImageFileInternal(const QString &filename, char *buffer, const
     return ok;
 }
 
+// Internal function to write a FITS blob to disk as a tile compressed image.
+bool Camera::WriteCompressedImageFileInternal(const QString &filename, const QByteArray &buffer)
+{
+    QString error;
+    auto codec = static_cast<FITSCompressedWriter::Codec>(Options::fitsCompression());
+    if (!FITSCompressedWriter::writeFile(filename, buffer, codec, &error))
+    {
+        // Rather keep the frame uncompressed than lose it.
+        qCWarning(KSTARS_INDI) << "ISD:CCD Unable to compress" << filename << ":" << error;
+        return WriteImageFileInternal(filename, buffer);
+    }
+
+    QFile::setPermissions(filename, QFileDevice::ReadUser |
+                          QFileDevice::WriteUser |
+                          QFileDevice::ReadGroup |
+                          QFileDevice::ReadOther);
+    return true;
+}
+
 QString Camera::getCaptureFormat() const
 {
     if (m_CaptureFormatIndex < 0 || m_CaptureFormats.isEmpty() || m_CaptureFormatIndex >= m_CaptureFormats.size())
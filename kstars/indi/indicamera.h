@@ -236,6 +236,12 @@ class Camera : public ConcreteDevice
             return m_ExposurePresetsMinMax;
         }
 
+        /**
+         * @brief guideExposureStarted Called when a guide exposure of the chip starts. Statistics of earlier guide
+         * frames are only reused by frames of the same exposure, gain, frame and binning.
+         */
+        void guideExposureStarted(CameraChip *chip, double exposure);
+
         /**
          * @brief saveCurrentImage save the image that is currently in the image data buffer
          * @return true if saving succeeded
@@ -274,7 +280,38 @@ class Camera : public ConcreteDevice
 
     private:
         void processStream(INDI::Property prop);
-        bool WriteImageFileInternal(const QString &filename, char *buffer, const size_t size);
+        bool WriteImageFileInternal(const QString &filename, const QByteArray &buffer);
+        bool WriteCompressedImageFileInternal(const QString &filename, const QByteArray &buffer);
+        // Settings of a guide exposure, which change the statistics of its frame
+        struct GuideSettings
+        {
+            double exposure { -1 };
+            double gain { -1 };
+            int x { 0 }, y { 0 }, w { 0 }, h { 0 };
+            int binX { 1 }, binY { 1 };
+
+            bool operator==(const GuideSettings &other) const
+            {
+                return exposure == other.exposure && gain == other.gain && x == other.x && y == other.y &&
+                       w == other.w && h == other.h && binX == other.binX && binY == other.binY;
+            }
+        };
+        // What announcing an image needs from its BLOB. Copied when the BLOB is received, the next BLOB overwrites
+        // the property data while the image is being decoded.
+        struct ReceivedImage
+        {
+            INDI::Property property;
+            QString element;
+            QString format;
+            CameraChip *chip { nullptr };
+            FITSMode mode { FITS_NORMAL };
+            // Of the last guide exposure started when the image was received
+            GuideSettings guideSettings;
+        };
+        // Attach the metadata of the BLOB to the image and announce it
+        void publishImage(const QSharedPointer<FITSData> &imageData, const ReceivedImage &received);
+        // Wait for the image being decoded, if any, and announce it
+        void finishDecoding();
 
         bool HasGuideHead { false };
         bool HasCooler { false };
@@ -325,11 +362,22 @@ class Camera : public ConcreteDevice
         QMap<QString, double> m_ExposurePresets;
         QPair<double, double> m_ExposurePresetsMinMax;
 
-        // Used when writing the image fits file to disk in a separate thread.
-        void updateFileBuffer(INDI::Property prop, bool is_fits);
-        char *fileWriteBuffer { nullptr };
-        int fileWriteBufferSize { 0 };
+        // Used when writing the image fits file to disk and decoding it in separate threads.
+        // The buffer is implicitly shared with them instead of being copied. Decoded images don't keep it,
+        // so it is reused for the next BLOB once the file is written.
+        void updateFileBuffer(INDI::Property prop);
+        QByteArray fileWriteBuffer;
         QString fileWriteFilename;
-        QFuture<void> fileWriteThread;
+        QFuture<bool> fileWriteThread;
+
+        // Image being decoded off the GUI thread, announced when ready
+        QFutureWatcher<bool> m_DecodeWatcher;
+        QSharedPointer<FITSData> m_DecodingData;
+        ReceivedImage m_DecodingImage;
+        // Statistics of the last guide frame whose statistics were calculated, and the frames that reused them since.
+        // They are dropped when a guide exposure starts with other settings.
+        FITSImage::Statistic m_GuideStatistics;
+        GuideSettings m_GuideSettings;
+        int m_GuideStatisticsAge { -1 };
 };
 }
@@ -401,6 +401,9 @@ bool CameraChip::capture(double exposure)
     newExpProp->np = &n;
     newExpProp->nnp = 1;
 
+    if (captureMode == FITS_GUIDE)
+        m_Camera->guideExposureStarted(this, exposure);
+
     m_Camera->sendNewProperty(newExpProp.get());
 
     return true;
@@ -60,6 +60,36 @@ Eigen::Vector2f EquirectangularProjector::toScreenVec(const SkyPoint *o, bool oR
     return p;
 }
 
+void EquirectangularProjector::toScreenVec(const double *lon, const double *lat, int n, Eigen::Vector2f *screen,
+        bool *onVisibleHemisphere, bool oRefract) const
+{
+    oRefract &= m_vp.useRefraction;
+
+    double X0, Y0, sign;
+    if (m_vp.useAltAz)
+    {
+        X0   = m_vp.focus->az().reduce().radians();
+        Y0   = SkyPoint::refract(m_vp.focus->alt(), oRefract).radians();
+        sign = -1.0;
+    }
+    else
+    {
+        X0   = m_vp.focus->ra().reduce().radians();
+        Y0   = m_vp.focus->dec().radians();
+        sign = 1.0;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        const double Y = SkyPoint::refract(lat[i], oRefract && m_vp.useAltAz) * dms::DegToRad;
+        const double dX = KSUtils::reduceAngle(sign * (lon[i] * dms::DegToRad - X0), -dms::PI, dms::PI);
+
+        screen[i] = rst(dX, Y - Y0);
+        if (onVisibleHemisphere)
+            onVisibleHemisphere[i] = (screen[i][0] > 0 && screen[i][0] < m_vp.width);
+    }
+}
+
 SkyPoint EquirectangularProjector::fromScreen(const QPointF &p, KStarsData* data, bool onlyAltAz) const
 {
     SkyPoint result;
@@ -22,7 +22,10 @@ class EquirectangularProjector : public Projector
         Projection type() const override;
         double radius() const override;
         bool unusablePoint(const QPointF &p) const override;
+        using Projector::toScreenVec;
         Eigen::Vector2f toScreenVec(const SkyPoint *o, bool oRefract = true, bool *onVisibleHemisphere = nullptr) const override;
+        void toScreenVec(const double *lon, const double *lat, int n, Eigen::Vector2f *screen,
+                         bool *onVisibleHemisphere = nullptr, bool oRefract = true) const override;
         SkyPoint fromScreen(const QPointF &p, KStarsData* data, bool onlyAltAz = false) const override;
         QVector<Eigen::Vector2f> groundPoly(SkyPoint *labelpoint = nullptr, bool *drawLabel = nullptr) const override;
         void updateClipPoly() override;
@@ -26,6 +26,12 @@ double GnomonicProjector::projectionK(double x) const
     return 1.0 / x;
 }
 
+void GnomonicProjector::projectionKVec(const double *x, double *k, int n) const
+{
+    for (int i = 0; i < n; i++)
+        k[i] = 1.0 / x[i];
+}
+
 double GnomonicProjector::projectionL(double x) const
 {
     return atan(x);
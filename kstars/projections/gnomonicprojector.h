@@ -22,6 +22,7 @@ class GnomonicProjector : public Projector
     Projection type() const override;
     double radius() const override;
     double projectionK(double x) const override;
+    void projectionKVec(const double *x, double *k, int n) const override;
     double projectionL(double x) const override;
     double cosMaxFieldAngle() const override;
 };
@@ -26,6 +26,12 @@ double LambertProjector::projectionK(double x) const
     return sqrt(2.0 / (1.0 + x));
 }
 
+void LambertProjector::projectionKVec(const double *x, double *k, int n) const
+{
+    for (int i = 0; i < n; i++)
+        k[i] = sqrt(2.0 / (1.0 + x[i]));
+}
+
 double LambertProjector::projectionL(double x) const
 {
     return 2.0 * asin(0.5 * x);
@@ -6,6 +6,8 @@
 
 #include "orthographicprojector.h"
 
+#include <algorithm>
+
 OrthographicProjector::OrthographicProjector(const ViewParams &p) : Projector(p)
 {
     updateClipPoly();
@@ -27,6 +29,12 @@ double OrthographicProjector::projectionK(double x) const
     return 1.0;
 }
 
+void OrthographicProjector::projectionKVec(const double *x, double *k, int n) const
+{
+    Q_UNUSED(x);
+    std::fill(k, k + n, 1.0);
+}
+
 double OrthographicProjector::projectionL(double x) const
 {
     return asin(x);
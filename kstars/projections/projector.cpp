@@ -12,6 +12,9 @@
 #endif
 #include "skycomponents/skylabeler.h"
 
+#include <limits>
+#include <vector>
+
 namespace
 {
 void toXYZ(const SkyPoint *p, double *x, double *y, double *z)
@@ -599,3 +602,91 @@ Eigen::Vector2f Projector::toScreenVec(const SkyPoint *o, bool oRefract, bool *o
 #endif
     return p;
 }
+
+void Projector::toScreenVec(const SkyPoint * const *points, int n, Eigen::Vector2f *screen,
+                            bool *onVisibleHemisphere, bool oRefract) const
+{
+    std::vector<double> lon(n), lat(n);
+    for (int i = 0; i < n; i++)
+    {
+        if (m_vp.useAltAz)
+        {
+            lon[i] = points[i]->az().Degrees();
+            lat[i] = points[i]->alt().Degrees();
+        }
+        else
+        {
+            lon[i] = points[i]->ra().Degrees();
+            lat[i] = points[i]->dec().Degrees();
+        }
+    }
+    toScreenVec(lon.data(), lat.data(), n, screen, onVisibleHemisphere, oRefract);
+}
+
+void Projector::toScreenVec(const double *lon, const double *lat, int n, Eigen::Vector2f *screen,
+                            bool *onVisibleHemisphere, bool oRefract) const
+{
+    if (n <= 0)
+        return;
+
+    // Refraction only applies to altitudes
+    oRefract &= m_vp.useRefraction && m_vp.useAltAz;
+
+    // Azimuth goes in the opposite direction to RA
+    const double focusLon = m_vp.useAltAz ? m_vp.focus->az().radians() : m_vp.focus->ra().radians();
+    const double sign     = m_vp.useAltAz ? -1.0 : 1.0;
+
+    // c is the cosine of the angular distance from the center, (x, y) the projection before scaling by k
+    std::vector<double> c(n), k(n), x(n), y(n);
+    for (int i = 0; i < n; i++)
+    {
+        const double Y = (oRefract ? SkyPoint::refract(lat[i]) : lat[i]) * dms::DegToRad;
+        double dX      = sign * (lon[i] * dms::DegToRad - focusLon);
+
+        if (!(std::isfinite(Y) && std::isfinite(dX)))
+        {
+            c[i] = std::numeric_limits<double>::quiet_NaN();
+            x[i] = y[i] = 0;
+            continue;
+        }
+
+        dX = KSUtils::reduceAngle(dX, -dms::PI, dms::PI);
+
+        double sindX, cosdX, sinY, cosY;
+#ifdef HAVE_SINCOS
+        sincos(dX, &sindX, &cosdX);
+        sincos(Y, &sinY, &cosY);
+#else
+        sindX = sin(dX);
+        cosdX = cos(dX);
+        sinY  = sin(Y);
+        cosY  = cos(Y);
+#endif
+        c[i] = m_sinY0 * sinY + m_cosY0 * cosY * cosdX;
+        x[i] = cosY * sindX;
+        y[i] = m_cosY0 * sinY - m_sinY0 * cosY * cosdX;
+    }
+
+    projectionKVec(c.data(), k.data(), n);
+
+    // Same as rst(), with the rotation hoisted out of the loop
+    const double cosMax = cosMaxFieldAngle();
+    const double sgn    = m_vp.mirror ? -1. : 1.;
+    const double cosRot = m_vp.rotationAngle.cos(), sinRot = m_vp.rotationAngle.sin();
+    for (int i = 0; i < n; i++)
+    {
+        if (std::isnan(c[i]))
+        {
+            screen[i] = Eigen::Vector2f(0, 0);
+            if (onVisibleHemisphere)
+                onVisibleHemisphere[i] = false;
+            continue;
+        }
+
+        const double px = k[i] * x[i] * sgn, py = k[i] * y[i];
+        screen[i] = Eigen::Vector2f(m_vp.width / 2 - m_vp.zoomFactor * (px * cosRot - py * sinRot),
+                                    m_vp.height / 2 - m_vp.zoomFactor * (px * sinRot + py * cosRot));
+        if (onVisibleHemisphere)
+            onVisibleHemisphere[i] = (c[i] > cosMax);
+    }
+}
@@ -127,6 +127,39 @@ class Projector
         virtual Eigen::Vector2f toScreenVec(const SkyPoint *o, bool oRefract = true,
                                             bool *onVisibleHemisphere = nullptr) const;
 
+        /**
+         * Batched version of toScreenVec() for an array of SkyPoints.
+         *
+         * The coordinates are gathered from the points and projected in one pass by the
+         * toScreenVec() overload taking coordinate arrays.
+         *
+         * @param points array of n pointers to the SkyPoints to project
+         * @param n number of points
+         * @param screen array of n positions that receives the screen pixel x, y coordinates
+         * @param onVisibleHemisphere array of n flags that receives whether each point is on the
+         *   visible part of the Celestial Sphere. May be nullptr.
+         * @param oRefract true = use Options::useRefraction() value.
+         */
+        void toScreenVec(const SkyPoint * const *points, int n, Eigen::Vector2f *screen,
+                         bool *onVisibleHemisphere = nullptr, bool oRefract = true) const;
+
+        /**
+         * Batched version of toScreenVec() for arrays of coordinates.
+         *
+         * The values that only depend on the view are computed once per call, and the
+         * projection specific term is computed for the whole array by projectionKVec(),
+         * so there is one virtual call per batch rather than one per point.
+         *
+         * @param lon array of n RA values, or azimuths if the view uses horizontal coordinates (degrees)
+         * @param lat array of n Dec values, or altitudes if the view uses horizontal coordinates (degrees)
+         * @param n number of points
+         * @param screen array of n positions that receives the screen pixel x, y coordinates
+         * @param onVisibleHemisphere array of n flags, may be nullptr. @see toScreenVec()
+         * @param oRefract true = use Options::useRefraction() value.
+         */
+        virtual void toScreenVec(const double *lon, const double *lat, int n, Eigen::Vector2f *screen,
+                                 bool *onVisibleHemisphere = nullptr, bool oRefract = true) const;
+
         /**
          * This is exactly the same as toScreenVec but it returns a QPointF.
          * It just calls toScreenVec and converts the result.
@@ -290,6 +323,16 @@ class Projector
             return x;
         }
 
+        /**
+         * Batched version of projectionK() for n values.
+         * @see toScreenVec()
+         */
+        virtual void projectionKVec(const double *x, double *k, int n) const
+        {
+            for (int i = 0; i < n; i++)
+                k[i] = projectionK(x[i]);
+        }
+
         /**
          * This function returns the cosine of the maximum field angle, i.e., the maximum angular
          * distance from the focus for which a point should be projected. Default is 0, i.e.,
@@ -27,6 +27,12 @@ double StereographicProjector::projectionK(double x) const
     return 2.0 / (1.0 + x);
 }
 
+void StereographicProjector::projectionKVec(const double *x, double *k, int n) const
+{
+    for (int i = 0; i < n; i++)
+        k[i] = 2.0 / (1.0 + x[i]);
+}
+
 double StereographicProjector::projectionL(double x) const
 {
     return 2.0 * atan2(x, 2.0);
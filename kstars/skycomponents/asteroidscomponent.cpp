@@ -13,6 +13,7 @@
 #include "ksfilereader.h"
 #include "kstarsdata.h"
 #include "kstars_debug.h"
+#include "ksnumbers.h"
 #include "Options.h"
 #include "solarsystemcomposite.h"
 #include "skycomponent.h"
@@ -21,6 +22,7 @@
 #include "skymap.h"
 #else
 #include "kstarslite.h"
+#include "skymaplite.h"
 #endif
 #include "skypainter.h"
 #include "auxiliary/kspaths.h"
@@ -255,6 +257,87 @@ SkyObject *AsteroidsComponent::objectNearest(SkyPoint *p, double &maxrad)
     return oBest;
 }
 
+void AsteroidsComponent::buildOrbits()
+{
+    m_Orbits.clear();
+    m_OrbitIndex.clear();
+    m_OrbitObjects = m_ObjectList;
+
+    for (auto o : m_OrbitObjects)
+    {
+        KSAsteroid *ast = static_cast<KSAsteroid *>(o);
+        m_OrbitIndex.append(m_Orbits.add(ast->JD, ast->a, ast->e, ast->i.Degrees(), ast->w.Degrees(),
+                                         ast->N.Degrees(), ast->M.Degrees(), ast->P));
+    }
+}
+
+void AsteroidsComponent::updateSolarSystemBodies(KSNumbers *num)
+{
+    if (!selected())
+        return;
+
+    // Rebuild the elements whenever the asteroids have been (re)loaded
+    if (m_OrbitObjects != m_ObjectList)
+        buildOrbits();
+
+    m_Orbits.solve(num->julianDay());
+
+    //xe, ye, ze are the Earth's heliocentric cartesian coords
+    double cosBe, sinBe, cosLe, sinLe;
+    m_Earth->ecLong().SinCos(sinLe, cosLe);
+    m_Earth->ecLat().SinCos(sinBe, cosBe);
+
+    const double xe = m_Earth->rsun() * cosBe * cosLe;
+    const double ye = m_Earth->rsun() * cosBe * sinLe;
+    const double ze = m_Earth->rsun() * sinBe;
+
+    const double magLimit = Options::magLimitAsteroid();
+#ifdef KSTARS_LITE
+    const SkyObject *focus = SkyMapLite::Instance()->focusObject();
+#else
+    const SkyObject *focus = SkyMap::Instance()->focusObject();
+#endif
+
+    const double *x = m_Orbits.x(), *y = m_Orbits.y(), *z = m_Orbits.z(), *r = m_Orbits.r();
+
+    // Asteroids too faint to be drawn are still found by the find dialog, objectNearest() and the observing
+    // list, so their positions are kept fresh too, but only a slice of them is updated each time.
+    m_FaintSlice = (m_FaintSlice + 1) % FAINT_UPDATE_SLICES;
+
+    QList<SkyObject *> bodies;
+    for (int k = 0; k < m_OrbitObjects.size(); k++)
+    {
+        KSAsteroid *ast = static_cast<KSAsteroid *>(m_OrbitObjects.at(k));
+        const int index = m_OrbitIndex.at(k);
+
+        // Not an elliptical orbit, leave it to KSAsteroid
+        if (index < 0)
+        {
+            bodies.append(ast);
+            continue;
+        }
+
+        // The phase angle can only make the asteroid fainter, so this is the brightest it can be now
+        const double dx = x[index] - xe, dy = y[index] - ye, dz = z[index] - ze;
+        const double delta = std::sqrt(dx * dx + dy * dy + dz * dz);
+        const double brightest = ast->H + 5.0 * log10(r[index] * delta);
+
+        if (brightest < magLimit || std::isnan(brightest) || ast == focus || ast->hasTrail() ||
+                k % FAINT_UPDATE_SLICES == m_FaintSlice)
+        {
+            ast->setHeliocentricPosition(x[index], y[index], z[index]);
+            bodies.append(ast);
+        }
+        else
+        {
+            // Too faint to be shown, skip the rest of the calculation until its turn comes
+            ast->setMag(brightest);
+        }
+    }
+
+    updateBodies(bodies, num);
+}
+
 void AsteroidsComponent::updateDataFile(bool isAutoUpdate)
 {
     delete (downloadJob);
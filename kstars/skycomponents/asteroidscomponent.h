@@ -10,11 +10,13 @@
 #include "ksparser.h"
 #include "typedef.h"
 #include "skyobjects/ksasteroid.h"
+#include "skyobjects/ksorbitbatch.h"
 #include "solarsystemlistcomponent.h"
 #include "filedownloader.h"
 
 #include <QList>
 #include <QPointer>
+#include <QVector>
 
 /**
  * @class AsteroidsComponent
@@ -42,6 +44,16 @@ class AsteroidsComponent : public QObject, public SolarSystemListComponent,
         bool selected() override;
         SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
 
+        /**
+         * @short Update the coordinates of the asteroids.
+         *
+         * Kepler's equation is solved for all the asteroids at once. Only the asteroids that could be
+         * brighter than the magnitude limit go through the rest of the position calculation every time.
+         * The fainter ones, still used by searches and the observing list, take turns: each update
+         * calculates one of FAINT_UPDATE_SLICES slices of them.
+         */
+        void updateSolarSystemBodies(KSNumbers *num) override;
+
         void updateDataFile(bool isAutoUpdate = false);
 
     protected slots:
@@ -50,6 +62,17 @@ class AsteroidsComponent : public QObject, public SolarSystemListComponent,
 
     private:
         void loadDataFromText() override;
+        void buildOrbits();
 
         QPointer<FileDownloader> downloadJob;
+
+        // Orbital elements of the asteroids in m_OrbitObjects, m_OrbitIndex maps each object to its
+        // index in m_Orbits (or -1 if KSOrbitBatch can't handle its orbit)
+        KSOrbitBatch m_Orbits;
+        QList<SkyObject *> m_OrbitObjects;
+        QVector<int> m_OrbitIndex;
+
+        // Asteroids too faint to be drawn are updated once every FAINT_UPDATE_SLICES updates
+        static constexpr int FAINT_UPDATE_SLICES = 8;
+        int m_FaintSlice { 0 };
 };
@@ -47,6 +47,20 @@ CatalogsComponent::CatalogsComponent(SkyComposite *parent, const QString &db_fil
 
     m_catalog_colors = m_db_manager.get_catalog_colors();
     tryImportSkyComponents();
+
+    // Databases created before the full-text index of the names get it in the background,
+    // searches fall back to LIKE meanwhile.
+    QtConcurrent::run([db_filename]()
+    {
+        try
+        {
+            CatalogsDB::DBManager{ db_filename }.compile_missing_name_search();
+        }
+        catch (const CatalogsDB::DatabaseError &e)
+        {
+            qCWarning(KSTARS) << "Could not index the catalog names:" << e.what();
+        }
+    });
     qCInfo(KSTARS) << "Loaded DSO catalogs.";
 }
 
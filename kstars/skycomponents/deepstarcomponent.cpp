@@ -25,6 +25,8 @@
 
 #include <kstars_debug.h>
 
+#include <cstring>
+
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -93,6 +95,9 @@ bool DeepStarComponent::loadStaticStars()
     // TODO: Read the multiplying factor from the dataFile
     m_FaintMagnitude = faintmag / 100.0;
 
+    // The records follow on from the header. Read them straight from the mapped file if we can
+    const char *mappedRecords = starReader.getRecords(starReader.getDataOffset() + 5, starReader.getRecordCount());
+
     if (htm_level != m_skyMesh->level())
         qCWarning(KSTARS) << "HTM Level in shallow star data file and HTM Level in m_skyMesh do not match. EXPECT TROUBLE!";
 
@@ -115,7 +120,14 @@ bool DeepStarComponent::loadStaticStars()
 
             for (quint64 j = 0; j < records; ++j)
             {
-                bool fread_success = fread(&stardata, sizeof(StarData), 1, dataFile);
+                bool fread_success = true;
+                if (mappedRecords)
+                {
+                    memcpy(&stardata, mappedRecords, sizeof(StarData));
+                    mappedRecords += sizeof(StarData);
+                }
+                else
+                    fread_success = fread(&stardata, sizeof(StarData), 1, dataFile);
 
                 if (!fread_success)
                 {
@@ -128,19 +140,24 @@ bool DeepStarComponent::loadStaticStars()
                     byteSwap(&stardata);
 
                 /* Initialize star with data just read. */
-                StarObject *star;
 #ifdef KSTARS_LITE
-                star = &(SB->addStar(stardata)->star);
+                StarObject *star = &(SB->addStar(stardata)->star);
+                bool added = star != nullptr;
 #else
-                star = SB->addStar(stardata);
+                // The StarObject is only created for stars which can be looked up by HD number
+                bool added = SB->addStar(stardata);
 #endif
-                if (star)
+                if (added)
                 {
                     //KStarsData* data = KStarsData::Instance();
                     //star->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
                     //if( star->getHDIndex() != 0 )
                     if (stardata.HD)
+#ifdef KSTARS_LITE
                         m_CatalogNumber.insert(stardata.HD, star);
+#else
+                        m_CatalogNumber.insert(stardata.HD, SB->star(SB->getStarCount() - 1, false));
+#endif
                 }
                 else
                 {
@@ -166,8 +183,14 @@ bool DeepStarComponent::loadStaticStars()
 
             for (quint64 j = 0; j < records; ++j)
             {
-                bool fread_success = false;
-                fread_success      = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
+                bool fread_success = true;
+                if (mappedRecords)
+                {
+                    memcpy(&deepstardata, mappedRecords, sizeof(DeepStarData));
+                    mappedRecords += sizeof(DeepStarData);
+                }
+                else
+                    fread_success = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
 
                 if (!fread_success)
                 {
@@ -180,19 +203,24 @@ bool DeepStarComponent::loadStaticStars()
                     byteSwap(&deepstardata);
 
                 /* Initialize star with data just read. */
-                StarObject *star;
 #ifdef KSTARS_LITE
-                star = &(SB->addStar(stardata)->star);
+                StarObject *star = &(SB->addStar(stardata)->star);
+                bool added = star != nullptr;
 #else
-                star = SB->addStar(deepstardata);
+                // The StarObject is only created for stars which can be looked up by HD number
+                bool added = SB->addStar(deepstardata);
 #endif
-                if (star)
+                if (added)
                 {
                     //KStarsData* data = KStarsData::Instance();
                     //star->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
                     //if( star->getHDIndex() != 0 )
                     if (stardata.HD)
+#ifdef KSTARS_LITE
                         m_CatalogNumber.insert(stardata.HD, star);
+#else
+                        m_CatalogNumber.insert(stardata.HD, SB->star(SB->getStarCount() - 1, false));
+#endif
                 }
                 else
                 {
@@ -248,6 +276,13 @@ void DeepStarComponent::draw(SkyPainter *skyp)
     SkyMap *map       = SkyMap::Instance();
     KStarsData *data  = KStarsData::Instance();
     UpdateID updateID = data->updateID();
+    UpdateID updateNumID = data->updateNumID();
+    const KSNumbers *num = data->updateNum();
+    const CachingDms *lst = data->lst();
+    const CachingDms *lat = data->geo()->lat();
+    QVector<SkyPoint> points;
+    QVector<float> mags;
+    QVector<char> sps;
 
     //FIXME_FOV -- maybe not clamp like that...
     float radius = map->projector()->fov();
@@ -305,9 +340,15 @@ void DeepStarComponent::draw(SkyPainter *skyp)
     // Mark used blocks in the LRU Cache. Not required for static stars
     if (!staticStars)
     {
+        QSet<Trixel> prefetchTrixels;
+        prefetchTrixels.reserve(m_prefetchTrixels.size());
         while (region.hasNext())
         {
             Trixel currentRegion = region.next();
+
+            // The aperture extends beyond the screen so this also starts paging in the trixels around the view
+            m_starBlockList.at(currentRegion)->prefetch(!m_prefetchTrixels.contains(currentRegion));
+            prefetchTrixels.insert(currentRegion);
             for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
             {
                 std::shared_ptr<StarBlock> prevBlock = ((i >= 1) ? m_starBlockList.at(currentRegion)->block(
@@ -323,6 +364,7 @@ void DeepStarComponent::draw(SkyPainter *skyp)
                     break;
             }
         }
+        m_prefetchTrixels.swap(prefetchTrixels);
         t_updateCache = t.elapsed();
         region.reset();
     }
@@ -341,6 +383,10 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         if (currentRegion >= m_starBlockList.size())
             continue;
 
+        // Trixels off the corners of the screen need neither loading nor drawing
+        if (!m_skyMesh->onScreen(currentRegion))
+            continue;
+
         if (!staticStars)
         {
             m_starBlockList.at(currentRegion)->fillToMag(maglim);
@@ -358,15 +404,9 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         //                 <<  m_starBlockList[ currentRegion ]->getBlockCount() << " blocks";
 
         // REMARK: The following should never carry state, except for const parameters like updateID and maglim
-        std::function<void(std::shared_ptr<StarBlock>)> mapFunction = [&updateID, &maglim](std::shared_ptr<StarBlock> myBlock)
+        std::function<void(std::shared_ptr<StarBlock>)> mapFunction = [&](std::shared_ptr<StarBlock> myBlock)
         {
-            for (StarObject &star : myBlock->contents())
-            {
-                if (star.updateID != updateID)
-                    star.JITupdate();
-                if (star.mag() > maglim)
-                    break;
-            }
+            myBlock->updateCoords(num, lst, lat, updateID, updateNumID, maglim);
         };
 
         QtConcurrent::blockingMap(m_starBlockList.at(currentRegion)->contents(), mapFunction);
@@ -376,21 +416,23 @@ void DeepStarComponent::draw(SkyPainter *skyp)
             std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
             //            qDebug() << Q_FUNC_INFO << "---> Drawing stars from block " << i << " of trixel " <<
             //                currentRegion << ". SB has " << block->getStarCount() << " stars";
-            for (int j = 0; j < block->getStarCount(); j++)
+            // Draw from the block's arrays, no need to create the StarObjects
+            points.resize(block->getStarCount());
+            mags.resize(block->getStarCount());
+            sps.resize(block->getStarCount());
+            int count = 0;
+            for (; count < block->getStarCount(); count++)
             {
-                StarObject *curStar = block->star(j);
-
-                //                qDebug() << Q_FUNC_INFO << "We claim that he's from trixel " << currentRegion
-                //<< ", and indexStar says he's from " << m_skyMesh->indexStar( curStar );
-
-                float mag = curStar->mag();
+                float mag = block->mag(count);
 
                 if (mag > maglim)
                     break;
 
-                if (skyp->drawPointSource(curStar, mag, curStar->spchar()))
-                    visibleStarCount++;
+                block->getSkyPoint(count, points[count]);
+                mags[count] = mag;
+                sps[count]  = block->spchar(count);
             }
+            visibleStarCount += skyp->drawPointSources(points.constData(), mags.constData(), sps.constData(), count);
         }
 
         // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
@@ -461,6 +503,8 @@ bool DeepStarComponent::openDataFile()
         ret = fread(&MSpT, 2, 1, starReader.getFileHandle());
         if (starReader.getByteSwap())
             MSpT = bswap_16(MSpT);
+        if (!starReader.mapFile())
+            qCInfo(KSTARS) << "Unable to map" << dataFileName << "into memory. Reading it with stdio.";
         fileOpened = true;
         qCInfo(KSTARS) << "  Sky Mesh Size: " << m_skyMesh->size();
         for (long int i = 0; i < m_skyMesh->size(); i++)
@@ -497,6 +541,11 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
 
 #ifdef KSTARS_LITE
     m_zoomMagLimit = StarComponent::zoomMagnitudeLimit();
+#else
+    KStarsData *data = KStarsData::Instance();
+    std::shared_ptr<StarBlock> bestBlock;
+    int bestIndex = 0;
+    SkyPoint point;
 #endif
     if (!fileOpened)
         return nullptr;
@@ -516,13 +565,14 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
         for (int i = 0; i < m_starBlockList.at(currentRegion)->getBlockCount(); ++i)
         {
             std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
+#ifndef KSTARS_LITE
+            block->updateCoords(data->updateNum(), data->lst(), data->geo()->lat(), data->updateID(),
+                                data->updateNumID(), m_zoomMagLimit);
+#endif
             for (int j = 0; j < block->getStarCount(); ++j)
             {
 #ifdef KSTARS_LITE
                 StarObject *star = &(block->star(j)->star);
-#else
-                StarObject *star = block->star(j);
-#endif
                 if (!star)
                     continue;
                 if (star->mag() > m_zoomMagLimit)
@@ -534,10 +584,29 @@ SkyObject *DeepStarComponent::objectNearest(SkyPoint *p, double &maxrad)
                     oBest  = star;
                     maxrad = r;
                 }
+#else
+                if (block->mag(j) > m_zoomMagLimit)
+                    continue;
+
+                // Only create the StarObject of the nearest star
+                block->getSkyPoint(j, point);
+                double r = point.angularDistanceTo(p).Degrees();
+                if (r < maxrad)
+                {
+                    bestBlock = block;
+                    bestIndex = j;
+                    maxrad    = r;
+                }
+#endif
             }
         }
     }
 
+#ifndef KSTARS_LITE
+    if (bestBlock)
+        oBest = bestBlock->star(bestIndex);
+#endif
+
     // TODO: What if we are looking around a point that's not on
     // screen? objectNearest() will need to keep on filling up all
     // trixels around the SkyPoint to find the best match in case it
@@ -570,6 +639,11 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
     if (maglim < -28)
         maglim = m_FaintMagnitude;
 
+#ifndef KSTARS_LITE
+    KStarsData *data = KStarsData::Instance();
+    SkyPoint point;
+#endif
+
     while (region.hasNext())
     {
         Trixel currentRegion = region.next();
@@ -580,18 +654,27 @@ bool DeepStarComponent::starsInAperture(QList<StarObject *> &list, const SkyPoin
         for (int i = 0; i < sbl->getBlockCount(); ++i)
         {
             std::shared_ptr<StarBlock> block = sbl->block(i);
+#ifdef KSTARS_LITE
             for (int j = 0; j < block->getStarCount(); ++j)
             {
-#ifdef KSTARS_LITE
                 StarObject *star = &(block->star(j)->star);
-#else
-                StarObject *star = block->star(j);
-#endif
                 if (star->mag() > maglim)
                     break; // Stars are organized by magnitude, so this should work
                 if (star->angularDistanceTo(&center).Degrees() <= radius)
                     list.append(star);
             }
+#else
+            block->updateCoords(data->updateNum(), data->lst(), data->geo()->lat(), data->updateID(),
+                                data->updateNumID(), maglim);
+            for (int j = 0; j < block->getStarCount(); ++j)
+            {
+                if (block->mag(j) > maglim)
+                    break; // Stars are organized by magnitude, so this should work
+                block->getSkyPoint(j, point);
+                if (point.angularDistanceTo(&center).Degrees() <= radius)
+                    list.append(block->star(j));
+            }
+#endif
         }
     }
 
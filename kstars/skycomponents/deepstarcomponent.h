@@ -22,6 +22,8 @@
 #include "skyobjects/deepstardata.h"
 #include "skyobjects/stardata.h"
 
+#include <QSet>
+
 class SkyLabeler;
 class SkyMesh;
 class StarBlockFactory;
@@ -123,6 +125,8 @@ class DeepStarComponent : public ListComponent
 
     QVector<std::shared_ptr<StarBlockList>> m_starBlockList;
     QHash<int, StarObject *> m_CatalogNumber;
+    /// Trixels in the draw aperture last frame, used to prefetch only trixels that just became visible
+    QSet<Trixel> m_prefetchTrixels;
 
     bool staticStars { false };
 
@@ -20,6 +20,8 @@
 #include <QProgressDialog>
 #include <QtConcurrent>
 
+#include <numeric>
+
 SatellitesComponent::SatellitesComponent(SkyComposite *parent) : SkyComponent(parent)
 {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -85,9 +87,54 @@ void SatellitesComponent::update(KSNumbers *)
     if (!selected())
         return;
 
+    KStarsData *data = KStarsData::Instance();
+    const SatelliteFrame frame = Satellite::frame(data->clock()->utc().djd(), data->geo());
+
+    QVector<Satellite *> satellites;
     foreach (SatelliteGroup *group, m_groups)
     {
-        group->updateSatellitesPos();
+        foreach (Satellite *sat, *group)
+        {
+            if (sat->selected())
+                satellites.append(sat);
+        }
+    }
+
+    if (satellites != m_BatchSatellites)
+    {
+        m_Batch.clear();
+        m_BatchIndex.clear();
+        foreach (Satellite *sat, satellites)
+            m_BatchIndex.append(m_Batch.add(sat));
+        m_BatchSatellites = satellites;
+    }
+
+    m_Batch.solve(frame.jd);
+
+    QVector<int> indexes(satellites.size()), rc(satellites.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    QtConcurrent::blockingMap(indexes, [&](int i)
+    {
+        if (m_BatchIndex.at(i) < 0)
+        {
+            rc[i] = satellites.at(i)->updatePos(frame);
+            return;
+        }
+
+        double position[3], velocity[3];
+        rc[i] = m_Batch.state(m_BatchIndex.at(i), position, velocity);
+        if (rc[i] == 0)
+            rc[i] = satellites.at(i)->updatePos(frame, position, velocity);
+    });
+
+    // If position cannot be calculated, remove the satellite from its group
+    for (int i = 0; i < satellites.size(); i++)
+    {
+        if (rc.at(i) == 0)
+            continue;
+
+        foreach (SatelliteGroup *group, m_groups)
+            group->removeOne(satellites.at(i));
     }
 }
 
@@ -175,6 +222,7 @@ void SatellitesComponent::updateTLEs()
                 file.write(response->readAll());
                 file.close();
                 group->readTLE();
+                m_BatchSatellites.clear();
                 group->updateSatellitesPos();
                 progressDlg.setValue(++i);
             }
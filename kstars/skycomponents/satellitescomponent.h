@@ -6,10 +6,12 @@
 
 #pragma once
 
+#include "satellitebatch.h"
 #include "satellitegroup.h"
 #include "skycomponent.h"
 
 #include <QList>
+#include <QVector>
 
 class QPointF;
 class Satellite;
@@ -99,4 +101,10 @@ class SatellitesComponent : public SkyComponent
     private:
         QList<SatelliteGroup *> m_groups; // List of all groups
         QHash<QString, Satellite *> nameHash;
+
+        // Near Earth selected satellites are propagated together. The batch is rebuilt when the selection changes.
+        SatelliteBatch m_Batch;
+        QVector<Satellite *> m_BatchSatellites;
+        // Index of each satellite in the batch, or -1 for deep space satellites propagated one by one
+        QVector<int> m_BatchIndex;
 };
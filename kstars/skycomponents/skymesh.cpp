@@ -19,6 +19,9 @@
 #include <QPolygonF>
 #include <QPointF>
 
+#include <algorithm>
+#include <cmath>
+
 QMap<int, SkyMesh *> SkyMesh::pinstances;
 int SkyMesh::defaultLevel = -1;
 
@@ -268,6 +271,112 @@ const IndexHash &SkyMesh::indexPoly(const QPolygonF *points)
     return indexHash;
 }
 
+void SkyMesh::updateViewID()
+{
+#ifndef KSTARS_LITE
+    m_ViewDrawID = m_drawID;
+
+    const Projector *proj = SkyMap::Instance() ? SkyMap::Instance()->projector() : nullptr;
+    if (!proj)
+    {
+        m_CullTrixels = false;
+        return;
+    }
+
+    const ViewParams vp = proj->viewParams();
+    // At wide fields the trixels are too distorted for the corners to bound them, and most are on screen anyway
+    m_CullTrixels = vp.focus && proj->fov() <= 90.0;
+    if (!m_CullTrixels)
+        return;
+
+    QVector<double> key;
+    key << proj->type() << vp.width << vp.height << vp.zoomFactor << vp.rotationAngle.Degrees() << vp.useRefraction
+        << vp.useAltAz << vp.mirror << vp.focus->ra().Degrees() << vp.focus->dec().Degrees() << vp.focus->az().Degrees()
+        << vp.focus->alt().Degrees();
+    if (key != m_ViewKey)
+    {
+        m_ViewKey = key;
+        ++m_ViewID;
+    }
+#endif
+}
+
+bool SkyMesh::onScreen(Trixel trixel)
+{
+#ifndef KSTARS_LITE
+    if (m_ViewDrawID != m_drawID)
+        updateViewID();
+    if (!m_CullTrixels)
+        return true;
+
+    KStarsData *data         = KStarsData::Instance();
+    TrixelScreenCache &entry = m_ScreenCache[trixel];
+
+    // Apparent and horizontal coordinates of the corners only change with the time and location
+    if (entry.updateID != data->updateID())
+    {
+        double ra[4], dec[4];
+        vertices(trixel, &ra[0], &dec[0], &ra[1], &dec[1], &ra[2], &dec[2]);
+
+        // Centre of the trixel from the mean of the corner vectors
+        double x = 0, y = 0, z = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            x += cos(dec[i] * dms::DegToRad) * cos(ra[i] * dms::DegToRad);
+            y += cos(dec[i] * dms::DegToRad) * sin(ra[i] * dms::DegToRad);
+            z += sin(dec[i] * dms::DegToRad);
+        }
+        ra[3]  = atan2(y, x) / dms::DegToRad;
+        dec[3] = atan2(z, sqrt(x * x + y * y)) / dms::DegToRad;
+
+        for (int i = 0; i < 4; i++)
+        {
+            SkyPoint &point = entry.points[i];
+            point.set(dms(ra[i]).reduce(), dms(dec[i]));
+            point.updateCoordsNow(data->updateNum());
+            point.EquatorialToHorizontal(data->lst(), data->geo()->lat());
+        }
+        entry.updateID = data->updateID();
+        entry.viewID   = 0;
+    }
+
+    // On a change of view only the projection has to be redone
+    if (entry.viewID != m_ViewID)
+    {
+        const Projector *proj = SkyMap::Instance()->projector();
+        const ViewParams vp   = proj->viewParams();
+        const SkyPoint *points[4] = { &entry.points[0], &entry.points[1], &entry.points[2], &entry.points[3] };
+        Eigen::Vector2f screen[4];
+        bool visible[4];
+        proj->toScreenVec(points, 4, screen, visible);
+
+        entry.viewID   = m_ViewID;
+        entry.onScreen = true;
+        if (std::all_of(visible, visible + 4, [](bool v) { return v; }))
+        {
+            float minX = screen[0].x(), maxX = minX, minY = screen[0].y(), maxY = minY;
+            for (int i = 1; i < 4; i++)
+            {
+                minX = std::min(minX, screen[i].x());
+                maxX = std::max(maxX, screen[i].x());
+                minY = std::min(minY, screen[i].y());
+                maxY = std::max(maxY, screen[i].y());
+            }
+
+            // The edges of a projected trixel can bow out beyond its corners, and the stars near
+            // the edge have a size, so leave a generous margin
+            const float margin = 0.25 * std::max(maxX - minX, maxY - minY) + 16;
+            entry.onScreen = !(maxX + margin < 0 || minX - margin > vp.width || maxY + margin < 0 ||
+                               minY - margin > vp.height);
+        }
+    }
+    return entry.onScreen;
+#else
+    Q_UNUSED(trixel);
+    return true;
+#endif
+}
+
 // NOTE: SkyMesh::draw() is primarily used for debugging purposes, to
 // show the trixels to enable visualizing them. Thus, it is not
 // necessary that this be compatible with GL unless we abandon the
@@ -9,8 +9,11 @@
 #include "ksnumbers.h"
 #include "typedef.h"
 #include "htmesh/HTMesh.h"
+#include "skyobjects/skypoint.h"
 
+#include <QHash>
 #include <QMap>
+#include <QVector>
 
 class QPainter;
 class QPointF;
@@ -282,7 +285,44 @@ class SkyMesh : public HTMesh
     bool inDraw() const { return m_inDraw; }
     void inDraw(bool inDraw) { m_inDraw = inDraw; }
 
+    /**
+     * @short Check whether anything in a trixel can appear on the sky map.
+     *
+     * The trixels returned by aperture() cover a circle around the focus, so many of them
+     * are off the corners of the screen. This projects the corners and centre of the trixel
+     * and returns false if they are all well clear of the screen, so the whole trixel can be
+     * skipped. The answer is conservative: it is true whenever the trixel might be visible.
+     *
+     * The apparent and horizontal coordinates of the corners are cached per trixel and only
+     * recomputed when the time or location changes (KStarsData::updateID()). The result is
+     * cached until the view changes (pan, zoom, rotation or projection), and then only the
+     * projection of the cached coordinates is redone.
+     *
+     * @param trixel the trixel to check
+     * @return false if nothing in the trixel can be on screen
+     */
+    bool onScreen(Trixel trixel);
+
   private:
+    /** Screen visibility of a trixel for a given view. @see onScreen() */
+    struct TrixelScreenCache
+    {
+        // The three corners and the centre of the trixel
+        SkyPoint points[4];
+        UpdateID updateID { 0 };
+        quint64 viewID { 0 };
+        bool onScreen { true };
+    };
+
+    /** Bump m_ViewID if the view parameters have changed since the last draw */
+    void updateViewID();
+
+    QHash<Trixel, TrixelScreenCache> m_ScreenCache;
+    QVector<double> m_ViewKey;
+    quint64 m_ViewID { 1 };
+    DrawID m_ViewDrawID { 0 };
+    bool m_CullTrixels { false };
+
     DrawID m_drawID;
     int errLimit { 0 };
     int m_debug { 0 };
@@ -18,6 +18,7 @@
 #include <KLocalizedString>
 
 #include <QPen>
+#include <QtConcurrent>
 
 SolarSystemListComponent::SolarSystemListComponent(SolarSystemComposite *p) : ListComponent(p), m_Earth(p->earth())
 {
@@ -47,18 +48,24 @@ void SolarSystemListComponent::update(KSNumbers *)
 void SolarSystemListComponent::updateSolarSystemBodies(KSNumbers *num)
 {
     if (selected())
+        updateBodies(m_ObjectList, num);
+}
+
+void SolarSystemListComponent::updateBodies(QList<SkyObject *> bodies, KSNumbers *num)
+{
+    KStarsData *data = KStarsData::Instance();
+    const CachingDms *lat = data->geo()->lat();
+    const CachingDms *lst = data->lst();
+
+    QtConcurrent::blockingMap(bodies, [&](SkyObject * o)
     {
-        KStarsData *data = KStarsData::Instance();
-        foreach (SkyObject *o, m_ObjectList)
-        {
-            KSPlanetBase *p = (KSPlanetBase *)o;
-            p->findPosition(num, data->geo()->lat(), data->lst(), m_Earth);
-            p->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+        KSPlanetBase *p = (KSPlanetBase *)o;
+        p->findPosition(num, lat, lst, m_Earth);
+        p->EquatorialToHorizontal(lst, lat);
 
-            if (p->hasTrail())
-                p->updateTrail(data->lst(), data->geo()->lat());
-        }
-    }
+        if (p->hasTrail())
+            p->updateTrail(lst, lat);
+    });
 }
 
 void SolarSystemListComponent::drawTrails(SkyPainter *skyp)
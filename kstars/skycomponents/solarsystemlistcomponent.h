@@ -38,6 +38,15 @@ class SolarSystemListComponent : public ListComponent
   protected:
     void drawTrails(SkyPainter *skyp) override;
 
-  private:
+    /**
+     * @short Update the positions of the given bodies, spread over the global thread pool.
+     *
+     * Each body only changes its own state while the Earth and @p num are only read, so the
+     * bodies can be updated concurrently.
+     * @p bodies the bodies to update, all must be KSPlanetBase objects
+     * @p num Pointer to the KSNumbers object
+     */
+    void updateBodies(QList<SkyObject *> bodies, KSNumbers *num);
+
     KSPlanet *m_Earth { nullptr };
 };
@@ -12,6 +12,27 @@
 #include "skyobjects/stardata.h"
 #include "skyobjects/deepstardata.h"
 
+#ifndef KSTARS_LITE
+#include "ksnumbers.h"
+#include "Options.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+inline void sinCos(double radians, double &s, double &c)
+{
+#ifdef HAVE_SINCOS
+    sincos(radians, &s, &c);
+#else
+    s = ::sin(radians);
+    c = ::cos(radians);
+#endif
+}
+}
+#endif
+
 #ifdef KSTARS_LITE
 #include "skymaplite.h"
 #include "kstarslite/skyitems/skynodes/pointsourcenode.h"
@@ -35,11 +56,14 @@ StarBlock::StarBlock(int nstars)
 #ifdef KSTARS_LITE
       stars(nstars, StarNode())
 #else
-      stars(nstars, StarObject())
+      stars(nstars), capacity(nstars), m_Materialized(nstars, false), m_RA0(nstars), m_Dec0(nstars), m_PMRA(nstars),
+      m_PMDec(nstars), m_Mag(nstars), m_SpType(nstars), m_RA(nstars), m_Dec(nstars), m_Alt(nstars), m_Az(nstars)
 #endif
 {
 }
 
+StarBlock::~StarBlock() = default;
+
 void StarBlock::reset()
 {
     if (parent)
@@ -49,6 +73,17 @@ void StarBlock::reset()
     faintMag  = -5.0;
     brightMag = 35.0;
     nStars    = 0;
+
+#ifndef KSTARS_LITE
+    // The StarObjects themselves are kept so that pointers already handed out stay valid
+    m_Materialized.fill(false);
+    m_StarData.clear();
+    m_DeepStarData.clear();
+    m_Precessed   = 0;
+    m_Horizontal  = 0;
+    m_UpdateID    = 0;
+    m_UpdateNumID = 0;
+#endif
 }
 
 #ifdef KSTARS_LITE
@@ -82,31 +117,271 @@ StarNode *StarBlock::addStar(const DeepStarData &data)
     return &node;
 }
 #else
-StarObject *StarBlock::addStar(const StarData &data)
+bool StarBlock::addStar(const StarData &data)
 {
     if (isFull())
-        return nullptr;
-    StarObject &star = stars[nStars++];
+        return false;
 
-    star.init(&data);
-    if (star.mag() > faintMag)
-        faintMag = star.mag();
-    if (star.mag() < brightMag)
-        brightMag = star.mag();
-    return &star;
+    if (m_StarData.isEmpty())
+    {
+        m_IsDeep = false;
+        m_StarData.resize(capacity);
+    }
+    m_StarData[nStars++] = data;
+
+    // Same decoding as StarObject::init(const StarData *)
+    setHotData(data.RA / 1000000.0 * 15.0, data.Dec / 100000.0, data.dRA / 10.0, data.dDec / 10.0,
+               data.mag / 100.0, data.spec_type[0]);
+    return true;
 }
 
-StarObject *StarBlock::addStar(const DeepStarData &data)
+bool StarBlock::addStar(const DeepStarData &data)
 {
     if (isFull())
-        return nullptr;
-    StarObject &star = stars[nStars++];
+        return false;
 
-    star.init(&data);
-    if (star.mag() > faintMag)
-        faintMag = star.mag();
-    if (star.mag() < brightMag)
-        brightMag = star.mag();
+    if (m_DeepStarData.isEmpty())
+    {
+        m_IsDeep = true;
+        m_DeepStarData.resize(capacity);
+    }
+    m_DeepStarData[nStars++] = data;
+
+    // Same decoding as StarObject::init(const DeepStarData *)
+    float mag;
+    if (data.V == 30000 && data.B != 30000)
+        mag = (data.B - 1600) / 1000.0;
+    else
+        mag = data.V / 1000.0;
+
+    char sp = 'B';
+    if (data.B == 30000 || data.V == 30000)
+        sp = '?';
+    else
+    {
+        double BV_Index = (data.B - data.V) / 1000.0;
+        if (BV_Index > 0.0) sp = 'A';
+        if (BV_Index > 0.325) sp = 'F';
+        if (BV_Index > 0.575) sp = 'G';
+        if (BV_Index > 0.975) sp = 'K';
+        if (BV_Index > 1.6) sp = 'M';
+    }
+
+    setHotData(data.RA / 1000000.0 * 15.0, data.Dec / 100000.0, data.dRA / 100.0, data.dDec / 100.0, mag, sp);
+    return true;
+}
+
+void StarBlock::setHotData(double ra0, double dec0, float pmRA, float pmDec, float mag, char sp)
+{
+    const int i = nStars - 1;
+    m_RA0[i]    = m_RA[i] = ra0;
+    m_Dec0[i]   = m_Dec[i] = dec0;
+    m_PMRA[i]   = pmRA;
+    m_PMDec[i]  = pmDec;
+    m_Mag[i]    = mag;
+    m_SpType[i] = sp;
+    m_Materialized[i] = false;
+
+    // Stars are added in order of magnitude, but the counts of up to date stars must not run past this one
+    m_Precessed  = std::min(m_Precessed, i);
+    m_Horizontal = std::min(m_Horizontal, i);
+
+    if (mag > faintMag)
+        faintMag = mag;
+    if (mag < brightMag)
+        brightMag = mag;
+}
+
+StarObject *StarBlock::star(int i, bool update)
+{
+    if (!stars[i])
+        stars[i] = std::make_unique<StarObject>();
+
+    StarObject &star = *stars[i];
+    if (!m_Materialized[i])
+    {
+        if (m_IsDeep)
+            star.init(&m_DeepStarData[i]);
+        else
+            star.init(&m_StarData[i]);
+        m_Materialized[i] = true;
+    }
+    if (update)
+        star.JITupdate();
     return &star;
 }
+
+void StarBlock::updateCoords(const KSNumbers *num, const CachingDms *lst, const CachingDms *lat, UpdateID updateID,
+                             UpdateID updateNumID, float maglim)
+{
+    // Stars are sorted by magnitude so the stars to update are the first count in the block
+    int count = 0;
+    while (count < nStars && m_Mag[count] <= maglim)
+        ++count;
+
+    // Same short-circuiting as StarObject::JITupdate(): only recompute once per solar minute
+    if (updateNumID != m_UpdateNumID)
+    {
+        if (Options::alwaysRecomputeCoordinates() || Options::useRelativistic() ||
+                std::abs(m_LastPrecessJD - num->getJD()) >= 0.00069444)
+        {
+            m_Precessed  = 0;
+            m_Horizontal = 0;
+        }
+        m_UpdateNumID = updateNumID;
+    }
+    if (updateID != m_UpdateID)
+    {
+        m_Horizontal = 0;
+        m_UpdateID   = updateID;
+    }
+
+    if (m_Precessed == 0)
+        m_LastPrecessJD = num->getJD();
+    if (count > m_Precessed)
+    {
+        computeApparent(m_Precessed, count, num);
+        m_Precessed = count;
+    }
+    if (count > m_Horizontal)
+    {
+        computeHorizontal(m_Horizontal, count, lst, lat);
+        m_Horizontal = count;
+    }
+}
+
+void StarBlock::computeApparent(int start, int end, const KSNumbers *num)
+{
+    const double julianMillenia = num->julianMillenia();
+    const double pmScale        = julianMillenia * (M_PI / (180.0 * 3600.0));
+
+#ifndef SKYPOINT_USE_LIBNOVA
+    const bool exact = Options::useRelativistic();
+
+    // Everything that depends only on the time is computed once for the whole block
+    const Eigen::Matrix3d &precessionMatrix = num->p2();
+    double sinOb, cosOb, sinL, cosL, sinP, cosP;
+    num->obliquity()->SinCos(sinOb, cosOb);
+    num->sunTrueLongitude().SinCos(sinL, cosL);
+    num->earthPerihelionLongitude().SinCos(sinP, cosP);
+    const double dEcLong = num->dEcLong();
+    const double dObliq  = num->dObliq();
+    const double K       = num->constAberr().Degrees();
+    const double e       = num->earthEccentricity();
+    const double aberrCos = e * cosP - cosL;
+    const double aberrSin = e * sinP - sinL;
+#else
+    const bool exact = true;
+#endif
+
+    for (int i = start; i < end; ++i)
+    {
+        // Proper motion, as StarObject::getIndexCoords()
+        double ra0 = m_RA0[i] * dms::DegToRad, dec0 = m_Dec0[i] * dms::DegToRad;
+        double sinRA, cosRA, sinDec, cosDec;
+        sinCos(ra0, sinRA, cosRA);
+        sinCos(dec0, sinDec, cosDec);
+
+        const double pmms = double(m_PMRA[i]) * m_PMRA[i] + double(m_PMDec[i]) * m_PMDec[i];
+        if (!std::isnan(pmms) && pmms * julianMillenia * julianMillenia >= .01)
+        {
+            const double net_pmRA = m_PMRA[i] * pmScale, net_pmDec = m_PMDec[i] * pmScale;
+            const double x = cosDec * cosRA - net_pmRA * sinRA - net_pmDec * sinDec * cosRA;
+            const double y = cosDec * sinRA + net_pmRA * cosRA - net_pmDec * sinDec * sinRA;
+            const double z = sinDec + net_pmDec * cosDec;
+            ra0  = atan2(y, x);
+            dec0 = atan2(z, sqrt(x * x + y * y));
+            sinCos(ra0, sinRA, cosRA);
+            sinCos(dec0, sinDec, cosDec);
+        }
+
+#ifndef SKYPOINT_USE_LIBNOVA
+        // Precession, as SkyPoint::precess()
+        Eigen::Vector3d v, s(cosRA * cosDec, sinRA * cosDec, sinDec);
+        v.noalias() = precessionMatrix * s;
+        double ra  = atan2(v[1], v[0]);
+        if (ra < 0)
+            ra += 2.0 * dms::PI;
+        const double dec = asin(std::max(-1.0, std::min(1.0, v[2])));
+
+        // The approximations of nutation and aberration are not valid near the poles
+        if (!exact && fabs(dec) < 80.0 * dms::DegToRad)
+        {
+            sinCos(ra, sinRA, cosRA);
+            sinCos(dec, sinDec, cosDec);
+            const double tanDec = sinDec / cosDec;
+
+            // Nutation, as SkyPoint::nutate()
+            double raDeg  = ra / dms::DegToRad + dEcLong * (cosOb + sinOb * sinRA * tanDec) - dObliq * cosRA * tanDec;
+            double decDeg = dec / dms::DegToRad + dEcLong * (sinOb * cosRA) + dObliq * sinRA;
+
+            // Aberration, as SkyPoint::aberrate()
+            sinCos(raDeg * dms::DegToRad, sinRA, cosRA);
+            sinCos(decDeg * dms::DegToRad, sinDec, cosDec);
+            if (fabs(decDeg) < 80.0)
+            {
+                raDeg += (K / cosDec) * (cosRA * cosOb * aberrCos + sinRA * aberrSin);
+                decDeg += K * ((sinOb * cosDec - cosOb * sinDec * sinRA) * aberrCos + cosRA * sinDec * aberrSin);
+                m_RA[i]  = raDeg;
+                m_Dec[i] = decDeg;
+                continue;
+            }
+        }
+#endif
+
+        // Fall back to the full SkyPoint computation
+        SkyPoint sp;
+        sp.setRA0(ra0 / dms::DegToRad / 15.0);
+        sp.setDec0(dec0 / dms::DegToRad);
+        sp.updateCoords(num, false, nullptr, nullptr, true);
+        m_RA[i]  = sp.ra().Degrees();
+        m_Dec[i] = sp.dec().Degrees();
+    }
+}
+
+void StarBlock::computeHorizontal(int start, int end, const CachingDms *lst, const CachingDms *lat)
+{
+    // Same as SkyPoint::EquatorialToHorizontal()
+    double sinlat, coslat;
+    lat->SinCos(sinlat, coslat);
+    const double lstRad = lst->radians();
+
+    for (int i = start; i < end; ++i)
+    {
+        double sindec, cosdec, sinHA, cosHA;
+        sinCos(m_Dec[i] * dms::DegToRad, sindec, cosdec);
+        sinCos(lstRad - m_RA[i] * dms::DegToRad, sinHA, cosHA);
+
+        const double sinAlt = sindec * sinlat + cosdec * coslat * cosHA;
+        const double AltRad = asin(sinAlt);
+        double cosAlt       = sqrt(1 - sinAlt * sinAlt);
+        if (cosAlt == 0.)
+            cosAlt = cos(AltRad);
+
+        double AzRad;
+        const double arg = (sindec - sinlat * sinAlt) / (coslat * cosAlt);
+        if (arg <= -1.0)
+            AzRad = dms::PI;
+        else if (arg >= 1.0)
+            AzRad = 0.0;
+        else
+            AzRad = acos(arg);
+
+        if (sinHA > 0.0 && AzRad != 0.0)
+            AzRad = 2.0 * dms::PI - AzRad;
+
+        m_Alt[i] = AltRad / dms::DegToRad;
+        m_Az[i]  = AzRad / dms::DegToRad;
+    }
+}
+
+void StarBlock::getSkyPoint(int i, SkyPoint &p) const
+{
+    p.setRA0(m_RA0[i] / 15.0);
+    p.setDec0(m_Dec0[i]);
+    p.setRA(m_RA[i] / 15.0);
+    p.setDec(m_Dec[i]);
+    p.setAlt(m_Alt[i]);
+    p.setAz(m_Az[i]);
+}
 #endif
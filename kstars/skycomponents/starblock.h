@@ -11,12 +11,24 @@
 
 #include <QVector>
 
+#include <memory>
+#include <vector>
+
 class StarObject;
 class StarBlockList;
 class PointSourceNode;
 struct StarData;
 struct DeepStarData;
 
+#ifndef KSTARS_LITE
+#include "skyobjects/stardata.h"
+#include "skyobjects/deepstardata.h"
+
+class CachingDms;
+class KSNumbers;
+class SkyPoint;
+#endif
+
 #ifdef KSTARS_LITE
 #include "starobject.h"
 
@@ -35,6 +47,11 @@ struct StarNode
  *
  * Holds a block of stars and various peripheral variables to mark its place in data structures
  *
+ * Outside KStars Lite the fields needed to draw the stars (position, proper motion, magnitude and
+ * spectral type) are held in structure-of-arrays form. updateCoords() brings a whole block up to date
+ * in one pass and the StarObjects are only created, from the catalog record, when star() is called,
+ * e.g. when a star is selected or labelled.
+ *
  * @author  Akarsh Simha
  * @version 1.0
  */
@@ -58,7 +75,7 @@ class StarBlock
      */
     explicit StarBlock(int nstars = 100);
 
-    ~StarBlock() = default;
+    ~StarBlock();
 
     /**
      * @short Initialize another star with data.
@@ -69,9 +86,15 @@ class StarBlock
      *
      * @param  data    data to initialize star with.
      * @return pointer to star initialized with data. nullptr if block is full.
+     * Outside KStars Lite returns false if the block is full; the StarObject is only created by star().
      */
+#ifdef KSTARS_LITE
     StarBlockEntry *addStar(const StarData &data);
     StarBlockEntry *addStar(const DeepStarData &data);
+#else
+    bool addStar(const StarData &data);
+    bool addStar(const DeepStarData &data);
+#endif
 
     /**
      * @short Returns true if the StarBlock is full
@@ -89,6 +112,7 @@ class StarBlock
      *
      * @return The number of stars that this StarBlock can hold
      */
+#ifdef KSTARS_LITE
     inline int size() const { return stars.size(); }
 
     /**
@@ -106,6 +130,51 @@ class StarBlock
      */
 
     inline QVector<StarBlockEntry> &contents() { return stars; }
+#else
+    inline int size() const { return capacity; }
+
+    /**
+     * @short  Return the i-th star in this StarBlock, creating the StarObject if needed
+     *
+     * @param  i Index of StarBlock to return
+     * @param  update Bring the coordinates of the star up to date (StarObject::JITupdate())
+     * @return A pointer to the i-th StarObject
+     */
+    StarBlockEntry *star(int i, bool update = true);
+
+    /**
+     * @short Update the apparent and horizontal coordinates of the stars up to a magnitude limit
+     *
+     * Works on the arrays, so no StarObjects are needed. The terms of precession, nutation and
+     * aberration that only depend on time are worked out once per call rather than once per star.
+     * Stars near the poles, or all stars if relativistic corrections are on, fall back to the
+     * SkyPoint calculation. Like StarObject::JITupdate(), only stars whose coordinates are out
+     * of date are recomputed.
+     *
+     * @param num         Time dependent numbers to update to
+     * @param lst         Local sidereal time
+     * @param lat         Latitude of the observer
+     * @param updateID    KStarsData::updateID() of this update
+     * @param updateNumID KStarsData::updateNumID() of this update
+     * @param maglim      Only stars up to this magnitude are updated
+     */
+    void updateCoords(const KSNumbers *num, const CachingDms *lst, const CachingDms *lat, UpdateID updateID,
+                      UpdateID updateNumID, float maglim);
+
+    /**
+     * @short  Set a SkyPoint to the coordinates of the i-th star as last computed by updateCoords()
+     *
+     * @param  i Index of the star
+     * @param  p SkyPoint to set
+     */
+    void getSkyPoint(int i, SkyPoint &p) const;
+
+    /** @return The magnitude of the i-th star */
+    inline float mag(int i) const { return m_Mag[i]; }
+
+    /** @return The first character of the spectral type of the i-th star */
+    inline char spchar(int i) const { return m_SpType[i]; }
+#endif
 
     // These methods are there because we might want to make faintMag and brightMag private at some point
     /**
@@ -146,6 +215,43 @@ class StarBlock
 
     /** Number of initialized stars in StarBlock. */
     int nStars { 0 };
+#ifdef KSTARS_LITE
     /** Array of stars. */
     QVector<StarBlockEntry> stars;
+#else
+    /** StarObjects created by star(), one slot per index so only the stars actually used are built */
+    std::vector<std::unique_ptr<StarBlockEntry>> stars;
+
+    /** Store the drawing fields of the star just added at index nStars - 1 */
+    void setHotData(double ra0, double dec0, float pmRA, float pmDec, float mag, char sp);
+
+    /** Proper motion, precession, nutation and aberration of stars [start, end) */
+    void computeApparent(int start, int end, const KSNumbers *num);
+
+    /** Horizontal coordinates of stars [start, end) */
+    void computeHorizontal(int start, int end, const CachingDms *lst, const CachingDms *lat);
+
+    /** Number of stars the block can hold */
+    int capacity { 0 };
+    /** Catalog records, so StarObjects can be created on demand. Only one of these is used */
+    QVector<StarData> m_StarData;
+    QVector<DeepStarData> m_DeepStarData;
+    bool m_IsDeep { false };
+    /** Which entries of stars have been created from the catalog record */
+    QVector<bool> m_Materialized;
+
+    /** J2000 position (degrees), proper motion (mas / year), magnitude and spectral type */
+    QVector<double> m_RA0, m_Dec0;
+    QVector<float> m_PMRA, m_PMDec, m_Mag;
+    QVector<char> m_SpType;
+    /** Apparent and horizontal coordinates (degrees) */
+    QVector<double> m_RA, m_Dec, m_Alt, m_Az;
+
+    /** Number of leading stars with up to date apparent / horizontal coordinates */
+    int m_Precessed { 0 };
+    int m_Horizontal { 0 };
+    long double m_LastPrecessJD { 0 };
+    UpdateID m_UpdateID { 0 };
+    UpdateID m_UpdateNumID { 0 };
+#endif
 };
@@ -18,6 +18,9 @@
 
 #include <QDebug>
 
+#include <algorithm>
+#include <cstring>
+
 StarBlockList::StarBlockList(const Trixel &tr, DeepStarComponent *parent)
 {
     trixel       = tr;
@@ -92,7 +95,12 @@ bool StarBlockList::fillToMag(float maglim)
 
     Q_ASSERT(nBlocks == (unsigned int)blocks.size());
 
-    BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
+    // Read straight from the mapped file if we can, otherwise fall back to stdio
+    const char *records = nullptr;
+    if (dSReader->isMapped())
+        records = dSReader->getRecords(readOffset, dSReader->getRecordCount(trixelId) - nStars);
+    if (!records)
+        BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
 
     /*
     qDebug() << Q_FUNC_INFO << "Reading trixel" << trixel << ", id on disk =" << trixelId << ", currently nStars =" << nStars
@@ -126,7 +134,13 @@ bool StarBlockList::fillToMag(float maglim)
         // TODO: Make this more general
         if (dSReader->guessRecordSize() == 32)
         {
-            ret = fread(&stardata, sizeof(StarData), 1, dataFile);
+            if (records)
+            {
+                memcpy(&stardata, records, sizeof(StarData));
+                records += sizeof(StarData);
+            }
+            else
+                ret = fread(&stardata, sizeof(StarData), 1, dataFile);
             if (dSReader->getByteSwap())
                 DeepStarComponent::byteSwap(&stardata);
             readOffset += sizeof(StarData);
@@ -134,7 +148,13 @@ bool StarBlockList::fillToMag(float maglim)
         }
         else
         {
-            ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
+            if (records)
+            {
+                memcpy(&deepstardata, records, sizeof(DeepStarData));
+                records += sizeof(DeepStarData);
+            }
+            else
+                ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
             if (dSReader->getByteSwap())
                 DeepStarComponent::byteSwap(&deepstardata);
             readOffset += sizeof(DeepStarData);
@@ -154,6 +174,24 @@ bool StarBlockList::fillToMag(float maglim)
     return ((maglim < faintMag) ? true : false);
 }
 
+void StarBlockList::prefetch(bool becameVisible)
+{
+    if (staticStars)
+        return;
+
+    BinFileHelper *dSReader = parent->getStarReader();
+    unsigned int records    = dSReader->getRecordCount(trixel);
+    if (nStars >= records)
+        return;
+
+    long offset = (readOffset > 0) ? readOffset : dSReader->getOffset(trixel);
+    if (!becameVisible && offset == prefetchOffset)
+        return;
+
+    prefetchOffset = offset;
+    dSReader->prefetchRecords(offset, std::min<unsigned long>(records - nStars, PREFETCH_RECORDS));
+}
+
 void StarBlockList::setStaticBlock(std::shared_ptr<StarBlock> &block)
 {
     if (!block)
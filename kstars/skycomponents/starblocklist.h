@@ -37,6 +37,17 @@ class StarBlockList
      */
     bool fillToMag(float maglim);
 
+    /**
+     * @short Hint that the stars of this trixel not loaded yet will be needed soon
+     *
+     * If the catalog is memory mapped the OS starts paging in the next PREFETCH_RECORDS
+     * records of the trixel in the background, so a later fillToMag() doesn't block on disk I/O.
+     * Nothing is requested if the records were already asked for and no more stars were loaded since.
+     *
+     * @param becameVisible true if the trixel has just come into view, which always requests the records
+     */
+    void prefetch(bool becameVisible);
+
     /**
      * @short Sets the first StarBlock in the list to point to the given StarBlock
      *
@@ -93,9 +104,14 @@ class StarBlockList
     inline Trixel getTrixel() const { return trixel; }
 
   private:
+    /// Number of records beyond those already loaded that prefetch() asks for
+    static constexpr unsigned long PREFETCH_RECORDS { 1024 };
+
     Trixel trixel;
     unsigned long nStars { 0 };
     long readOffset { 0 };
+    /// File offset prefetch() last requested the records from, -1 if none
+    long prefetchOffset { -1 };
     float faintMag { -5 };
     QList<std::shared_ptr<StarBlock>> blocks;
     unsigned int nBlocks { 0 };
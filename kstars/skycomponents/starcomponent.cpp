@@ -14,6 +14,7 @@
 #endif
 #include "kstarsdata.h"
 #include "kstarssplash.h"
+#include "ksutils.h"
 #include "Options.h"
 #include "skylabeler.h"
 #include "skymap.h"
@@ -312,10 +313,17 @@ void StarComponent::draw(SkyPainter *skyp)
 
     int nTrixels = 0;
 
+    // The stars that get a label are projected together once they are all drawn
+    QVector<const SkyPoint *> labelPoints;
+    QVector<StarObject *> labelStars;
+
     while (region.hasNext())
     {
         ++nTrixels;
         Trixel currentRegion = region.next();
+        if (!m_skyMesh->onScreen(currentRegion))
+            continue;
+
         StarList *starList   = m_starIndex->at(currentRegion);
 
         for (auto &star : *starList)
@@ -336,10 +344,21 @@ void StarComponent::draw(SkyPainter *skyp)
 
             //FIXME_SKYPAINTER: find a better way to do this.
             if (drawn && !(m_hideLabels || mag > labelMagLim))
-                addLabel(proj->toScreen(star), star);
+            {
+                labelPoints.append(star);
+                labelStars.append(star);
+            }
         }
     }
 
+    if (!labelStars.isEmpty())
+    {
+        QVector<Eigen::Vector2f> labelScreen(labelStars.size());
+        proj->toScreenVec(labelPoints.constData(), labelPoints.size(), labelScreen.data());
+        for (int i = 0; i < labelStars.size(); i++)
+            addLabel(KSUtils::vecToPoint(labelScreen[i]), labelStars[i]);
+    }
+
     // Draw focusStar if not null
     if (focusStar)
     {
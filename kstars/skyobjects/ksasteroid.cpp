@@ -36,13 +36,16 @@ KSAsteroid *KSAsteroid::clone() const
     return new KSAsteroid(*this);
 }
 
-bool KSAsteroid::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase *Earth)
+void KSAsteroid::setHeliocentricPosition(double xh, double yh, double zh)
 {
-    // TODO: (Valentin) TOP LEVEL CONTROL OF CALCULATION FOR ALL OBJECTS
-    if(!toCalculate()){
-        return false;
-    }
+    HelioPos[0] = xh;
+    HelioPos[1] = yh;
+    HelioPos[2] = zh;
+    HasHelioPos = true;
+}
 
+void KSAsteroid::findHeliocentricPosition(double &xh, double &yh, double &zh) const
+{
     //determine the mean anomaly for the desired date.  This is the mean anomaly for the
     //ephemeis epoch, plus the number of days between the desired date and ephemeris epoch,
     //times the asteroid's mean daily motion (360/P):
@@ -93,9 +96,34 @@ bool KSAsteroid::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase
     i.SinCos(sini, cosi);
 
     //xh, yh, zh are the heliocentric cartesian coords with the ecliptic plane congruent with zh=0.
-    double xh = r * (cosN * cosvw - sinN * sinvw * cosi);
-    double yh = r * (sinN * cosvw + cosN * sinvw * cosi);
-    double zh = r * (sinvw * sini);
+    xh = r * (cosN * cosvw - sinN * sinvw * cosi);
+    yh = r * (sinN * cosvw + cosN * sinvw * cosi);
+    zh = r * (sinvw * sini);
+}
+
+bool KSAsteroid::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase *Earth)
+{
+    double xh, yh, zh;
+
+    if (HasHelioPos)
+    {
+        // Already solved by the caller, which has chosen to update this asteroid
+        xh = HelioPos[0];
+        yh = HelioPos[1];
+        zh = HelioPos[2];
+        HasHelioPos = false;
+    }
+    else
+    {
+        // TODO: (Valentin) TOP LEVEL CONTROL OF CALCULATION FOR ALL OBJECTS
+        if(!toCalculate()){
+            return false;
+        }
+
+        findHeliocentricPosition(xh, yh, zh);
+    }
+
+    double r = sqrt(xh * xh + yh * yh + zh * zh);
 
     //the spherical ecliptic coordinates:
     double ELongRad = atan2(yh, xh);
@@ -140,9 +168,20 @@ bool KSAsteroid::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase
     // So we have to precess as well
     setRA0(ra());
     setDec0(dec());
-    apparentCoord(J2000, lastPrecessJD);
-    //nutate(num);
-    //aberrate(num);
+    if (num->julianDay() == lastPrecessJD)
+    {
+        // Same as apparentCoord(J2000, lastPrecessJD), but reusing num rather than
+        // computing the precession and nutation terms again for every asteroid
+        precess(num);
+        nutate(num);
+        if (Options::useRelativistic() && checkBendLight())
+            bendlight();
+        aberrate(num);
+    }
+    else
+    {
+        apparentCoord(J2000, lastPrecessJD);
+    }
 
     return true;
 }
@@ -193,6 +193,18 @@ class KSAsteroid : public KSPlanetBase
      */
     bool toCalculate();
 
+    /**
+     * @short Set the heliocentric position found by a batched orbit solver (see KSOrbitBatch).
+     *
+     * The next findGeocentricPosition() starts from this position instead of solving Kepler's
+     * equation, and doesn't apply the toCalculate() magnitude filter: the caller has chosen to
+     * update this asteroid, e.g. a faint one whose turn has come.
+     * @param xh heliocentric ecliptic J2000 x coordinate (AU)
+     * @param yh heliocentric ecliptic J2000 y coordinate (AU)
+     * @param zh heliocentric ecliptic J2000 z coordinate (AU)
+     */
+    void setHeliocentricPosition(double xh, double yh, double zh);
+
   protected:
     /** Calculate the geocentric RA, Dec coordinates of the Asteroid.
         	*@note reimplemented from KSPlanetBase
@@ -222,6 +234,12 @@ class KSAsteroid : public KSPlanetBase
 
     void findMagnitude(const KSNumbers *) override;
 
+    /** Solve Kepler's equation for the heliocentric ecliptic cartesian coordinates at lastPrecessJD */
+    void findHeliocentricPosition(double &xh, double &yh, double &zh) const;
+
+    friend class AsteroidsComponent;
+    friend class TestKSOrbitBatch;
+
     int catN { 0 };
     long double JD { 0 };
     double q { 0 };
@@ -238,4 +256,7 @@ class KSAsteroid : public KSPlanetBase
     double G { 0 };
     QString OrbitID, OrbitClass, Dimensions;
     bool NEO { false };
+    // Position set by setHeliocentricPosition()
+    double HelioPos[3] { 0, 0, 0 };
+    bool HasHelioPos { false };
 };
@@ -0,0 +1,166 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "ksephemeriscache.h"
+
+#include <cmath>
+
+namespace
+{
+// The segments are dropped all at once when there are more than this, e.g. after a long time lapse
+constexpr int MAX_SEGMENTS = 16384;
+
+// Clenshaw's recurrence for sum(c[k] * T_k(x))
+double chebyshev(const double *c, int degree, double x)
+{
+    double b1 = 0, b2 = 0;
+    for (int k = degree; k >= 1; k--)
+    {
+        const double b0 = 2 * x * b1 - b2 + c[k];
+        b2 = b1;
+        b1 = b0;
+    }
+    return x * b1 - b2 + c[0];
+}
+
+// Bring the longitude within PI of the reference
+double unwrap(double longitude, double reference)
+{
+    return longitude - 2 * M_PI * std::round((longitude - reference) / (2 * M_PI));
+}
+}
+
+KSEphemerisCache::KSEphemerisCache(Function function, double segmentLength, int degree, double tolerance)
+    : m_Function(std::move(function)), m_SegmentLength(segmentLength), m_Degree(degree), m_Tolerance(tolerance)
+{
+}
+
+KSEphemerisCache::ephemerisSegment_t KSEphemerisCache::fit(qint64 index) const
+{
+    const int n = m_Degree + 1;
+    const double start = index * m_SegmentLength;
+    const double half = 0.5 * m_SegmentLength;
+
+    // Exact values at the Chebyshev nodes
+    QVector<double> nodes(n), values(3 * n);
+    for (int k = 0; k < n; k++)
+    {
+        nodes[k] = std::cos(M_PI * (k + 0.5) / n);
+        m_Function(start + half * (nodes[k] + 1), values.data() + 3 * k);
+        if (k > 0)
+            values[3 * k] = unwrap(values[3 * k], values[3 * (k - 1)]);
+    }
+
+    ephemerisSegment_t segment;
+    segment.coefficients.fill(0, 3 * n);
+    for (int c = 0; c < 3; c++)
+    {
+        double *coefficients = segment.coefficients.data() + c * n;
+        for (int j = 0; j < n; j++)
+        {
+            double sum = 0;
+            for (int k = 0; k < n; k++)
+                sum += values[3 * k + c] * std::cos(M_PI * j * (k + 0.5) / n);
+            coefficients[j] = (j == 0 ? 1.0 : 2.0) * sum / n;
+        }
+    }
+
+    // Check the fit half way between the nodes, where the error peaks, and at the ends of the segment
+    for (int k = 0; k <= n; k++)
+    {
+        const double x = (k == 0) ? 1.0 : (k == n) ? -1.0 : 0.5 * (nodes[k - 1] + nodes[k]);
+        double exact[3], fitted[3];
+        m_Function(start + half * (x + 1), exact);
+        for (int c = 0; c < 3; c++)
+            fitted[c] = chebyshev(segment.coefficients.constData() + c * n, m_Degree, x);
+        exact[0] = unwrap(exact[0], fitted[0]);
+
+        for (int c = 0; c < 3; c++)
+        {
+            if (!(std::fabs(fitted[c] - exact[c]) <= m_Tolerance))
+            {
+                segment.coefficients.clear();
+                return segment;
+            }
+        }
+    }
+
+    return segment;
+}
+
+void KSEphemerisCache::evaluate(double t, double *position)
+{
+    const double s = t / m_SegmentLength;
+    const qint64 index = static_cast<qint64>(std::floor(s));
+
+    // Always evaluate the exact function for times the fit can't represent
+    if (!std::isfinite(s))
+    {
+        m_Function(t, position);
+        return;
+    }
+
+    ephemerisSegment_t segment;
+    bool found;
+    {
+        QReadLocker locker(&m_Lock);
+        auto it = m_Segments.constFind(index);
+        found = (it != m_Segments.constEnd());
+        if (found)
+            segment = it.value();
+    }
+
+    if (!found)
+    {
+        // Fit outside the lock, at worst two threads fit the same segment
+        segment = fit(index);
+
+        QWriteLocker locker(&m_Lock);
+        if (m_Segments.size() >= MAX_SEGMENTS)
+            m_Segments.clear();
+        if (segment.coefficients.isEmpty() && !m_Segments.contains(index))
+            m_Rejected++;
+        m_Segments.insert(index, segment);
+    }
+
+    if (segment.coefficients.isEmpty())
+    {
+        m_Function(t, position);
+        return;
+    }
+
+    const int n = m_Degree + 1;
+    const double x = 2 * (s - index) - 1;
+    for (int c = 0; c < 3; c++)
+        position[c] = chebyshev(segment.coefficients.constData() + c * n, m_Degree, x);
+}
+
+void KSEphemerisCache::precompute(double t0, double t1)
+{
+    double position[3];
+    for (qint64 index = static_cast<qint64>(std::floor(t0 / m_SegmentLength));
+            index <= static_cast<qint64>(std::floor(t1 / m_SegmentLength)); index++)
+        evaluate((index + 0.5) * m_SegmentLength, position);
+}
+
+void KSEphemerisCache::clear()
+{
+    QWriteLocker locker(&m_Lock);
+    m_Segments.clear();
+    m_Rejected = 0;
+}
+
+int KSEphemerisCache::size() const
+{
+    QReadLocker locker(&m_Lock);
+    return m_Segments.size();
+}
+
+int KSEphemerisCache::rejected() const
+{
+    QReadLocker locker(&m_Lock);
+    return m_Rejected;
+}
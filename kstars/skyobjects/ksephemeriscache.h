@@ -0,0 +1,77 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVector>
+
+#include <functional>
+
+/**
+ * @class KSEphemerisCache
+ * @short Piecewise Chebyshev approximation of a slowly varying ecliptic position.
+ *
+ * The time axis is cut into segments of a fixed length. The first time a position is requested in a
+ * segment, the exact function (e.g. the VSOP87 series of a planet) is evaluated at the Chebyshev nodes
+ * of the segment and a polynomial is fitted through them. The fit is checked against the exact function
+ * between the nodes, and segments that don't reach the requested accuracy fall back to the exact
+ * function. Afterwards any position within the segment costs a polynomial evaluation.
+ *
+ * The positions are given as (longitude, latitude, distance) with the angles in radians. The longitude
+ * is unwrapped before fitting, so the longitude returned may be outside [0, 2 PI).
+ *
+ * The cache can be used from several threads at once.
+ *
+ * @author KStars Developers
+ */
+class KSEphemerisCache
+{
+    public:
+        /** Computes the exact position at time t into position[3] */
+        typedef std::function<void(double t, double *position)> Function;
+
+        /**
+         * @param function the exact function
+         * @param segmentLength length of the segments, in the unit of time of the function
+         * @param degree of the fitted polynomials
+         * @param tolerance largest error allowed, in radians for the angles and in the unit of the distance
+         */
+        KSEphemerisCache(Function function, double segmentLength, int degree, double tolerance);
+
+        /** @short Compute the position at time t into position[3] */
+        void evaluate(double t, double *position);
+
+        /** @short Fit all the segments covering [t0, t1] now rather than on demand */
+        void precompute(double t0, double t1);
+
+        void clear();
+
+        /** @return the number of segments fitted so far */
+        int size() const;
+
+        /** @return the number of segments which didn't reach the requested accuracy */
+        int rejected() const;
+
+    private:
+        typedef struct ephemerisSegment_t
+        {
+            // (degree + 1) coefficients for each of the three coordinates, empty if the fit was rejected
+            QVector<double> coefficients;
+        } ephemerisSegment_t;
+
+        ephemerisSegment_t fit(qint64 index) const;
+
+        Function m_Function;
+        double m_SegmentLength { 1 };
+        int m_Degree { 0 };
+        double m_Tolerance { 0 };
+
+        mutable QReadWriteLock m_Lock;
+        QHash<qint64, ephemerisSegment_t> m_Segments;
+        int m_Rejected { 0 };
+};
@@ -6,10 +6,12 @@
 
 #include "ksmoon.h"
 
+#include "ksephemeriscache.h"
 #include "ksnumbers.h"
 #include "ksutils.h"
 #include "kssun.h"
 #include "kstarsdata.h"
+#include "Options.h"
 #ifndef KSTARS_LITE
 #include "kspopupmenu.h"
 #endif
@@ -151,17 +153,45 @@ bool KSMoon::loadData()
 }
 
 bool KSMoon::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase *)
+{
+    if (!loadData())
+        return false;
+
+    double position[3];
+    if (Options::useEphemerisCache())
+        ephemerisCache()->evaluate(num->julianCenturies(), position);
+    else
+        calcEcliptic(num->julianCenturies(), position);
+
+    //Geocentric coordinates
+    setEcLong(dms(position[0] / dms::DegToRad));
+    setEcLat(dms(position[1] / dms::DegToRad));
+    Rearth = position[2];
+
+    EclipticToEquatorial(num->obliquity());
+
+    //Determine position angle
+    findPA(num);
+
+    return true;
+}
+
+KSEphemerisCache *KSMoon::ephemerisCache()
+{
+    // 4 day segments keep the fits well within 1e-9 radians (0.2 mas) and 1e-9 AU
+    static KSEphemerisCache cache(&KSMoon::calcEcliptic, 4.0 / 36525.0, 12, 1e-9);
+    return &cache;
+}
+
+void KSMoon::calcEcliptic(double T, double *position)
 {
     //Algorithms in this subroutine are taken from Chapter 45 of "Astronomical Algorithms"
     //by Jean Meeus (1991, Willmann-Bell, Inc. ISBN 0-943396-35-2.  https://www.willbell.com/math/mc1.htm)
     //updated to Jean Messus (1998, Willmann-Bell, http://www.naughter.com/aa.html )
 
-    double T, L, D, M, M1, F, A1, A2, A3;
+    double L, D, M, M1, F, A1, A2, A3;
     double sumL, sumR, sumB;
 
-    //Julian centuries since J2000
-    T = num->julianCenturies();
-
     double Et = 1.0 - 0.002516 * T - 0.0000074 * T * T;
 
     //Moon's mean longitude
@@ -188,9 +218,6 @@ bool KSMoon::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase *)
     sumL = 0.0;
     sumR = 0.0;
 
-    if (!loadData())
-        return false;
-
     for (const auto &mlrd : LRData)
     {
         double E = 1.0;
@@ -225,16 +252,9 @@ bool KSMoon::findGeocentricPosition(const KSNumbers *num, const KSPlanetBase *)
              115.0 * sin(L + M1));
 
     //Geocentric coordinates
-    setEcLong(dms(sumL / 1000000.0 + L * 180.0 / dms::PI)); //convert radians to degrees
-    setEcLat(dms(sumB / 1000000.0));
-    Rearth = (385000.56 + sumR / 1000.0) / AU_KM; //distance from Earth, in AU
-
-    EclipticToEquatorial(num->obliquity());
-
-    //Determine position angle
-    findPA(num);
-
-    return true;
+    position[0] = sumL / 1000000.0 * dms::DegToRad + L;
+    position[1] = sumB / 1000000.0 * dms::DegToRad;
+    position[2] = (385000.56 + sumR / 1000.0) / AU_KM; //distance from Earth, in AU
 }
 
 void KSMoon::findMagnitude(const KSNumbers *)
@@ -9,6 +9,7 @@
 #include "ksplanetbase.h"
 #include "dms.h"
 
+class KSEphemerisCache;
 class KSSun;
 
 /**
@@ -66,6 +67,8 @@ class KSMoon : public KSPlanetBase
      * interaction is complex and nonlinear.  As a result, the positions as
      * calculated by findPosition() are only accurate to about 10 arcseconds
      * (10 times less precise than the planets' positions!)
+     * When the UseEphemerisCache option is set, the coordinates are interpolated
+     * from Chebyshev polynomials fitted to the series (see KSEphemerisCache).
      * @short moon-specific coordinate finder
      * @param num KSNumbers pointer for the target date/time
      * @note we don't use the Earth pointer here
@@ -84,6 +87,17 @@ class KSMoon : public KSPlanetBase
   private:
     void findMagnitude(const KSNumbers *) override;
 
+    /**
+     * Sum the series for the geocentric ecliptic coordinates of the Moon.
+     * @param T Julian centuries since J2000
+     * @param position the longitude and latitude (radians) and the distance (AU)
+     * @note the data must have been loaded
+     */
+    static void calcEcliptic(double T, double *position);
+
+    /** @return the Chebyshev cache of calcEcliptic(), shared by all instances */
+    static KSEphemerisCache *ephemerisCache();
+
     static bool data_loaded;
     static int instance_count;
 
@@ -0,0 +1,122 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "ksorbitbatch.h"
+
+#include <Eigen/Core>
+
+#include <QtConcurrent>
+
+#include <cmath>
+
+namespace
+{
+// Bodies solved together, small enough for the working arrays to live on the stack
+constexpr int BLOCK_SIZE = 256;
+// Bodies handed to a worker thread at a time
+constexpr int CHUNK_SIZE = 16 * BLOCK_SIZE;
+// Kepler's equation is solved to better than 1e-9 radians (~0.2 mas)
+constexpr double KEPLER_TOLERANCE = 1e-9;
+constexpr int KEPLER_MAX_ITERATIONS = 50;
+
+typedef Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, BLOCK_SIZE, 1> BlockArray;
+typedef Eigen::Map<const Eigen::ArrayXd> ConstMap;
+typedef Eigen::Map<Eigen::ArrayXd> Map;
+}
+
+int KSOrbitBatch::add(long double JD, double a, double e, double i, double w, double N, double M, double P)
+{
+    if (!(e >= 0 && e < 1) || !(a > 0) || !(P > 0))
+        return -1;
+
+    const double deg = M_PI / 180.0;
+    const double sini = std::sin(i * deg), cosi = std::cos(i * deg);
+    const double sinw = std::sin(w * deg), cosw = std::cos(w * deg);
+    const double sinN = std::sin(N * deg), cosN = std::cos(N * deg);
+
+    m_Epoch.push_back(static_cast<double>(JD));
+    m_M0.push_back(M * deg);
+    m_MeanMotion.push_back(2 * M_PI / P);
+    m_E.push_back(e);
+    m_A.push_back(a);
+    m_B.push_back(a * std::sqrt(1.0 - e * e));
+
+    m_Px.push_back(cosN * cosw - sinN * sinw * cosi);
+    m_Py.push_back(sinN * cosw + cosN * sinw * cosi);
+    m_Pz.push_back(sinw * sini);
+    m_Qx.push_back(-cosN * sinw - sinN * cosw * cosi);
+    m_Qy.push_back(-sinN * sinw + cosN * cosw * cosi);
+    m_Qz.push_back(cosw * sini);
+
+    m_X.push_back(0);
+    m_Y.push_back(0);
+    m_Z.push_back(0);
+    m_R.push_back(0);
+
+    return size() - 1;
+}
+
+void KSOrbitBatch::clear()
+{
+    for (auto *v : { &m_Epoch, &m_M0, &m_MeanMotion, &m_E, &m_A, &m_B, &m_Px, &m_Py, &m_Pz, &m_Qx, &m_Qy, &m_Qz,
+                &m_X, &m_Y, &m_Z, &m_R })
+        v->clear();
+}
+
+void KSOrbitBatch::solve(long double jd)
+{
+    QVector<int> chunks;
+    for (int start = 0; start < size(); start += CHUNK_SIZE)
+        chunks.append(start);
+
+    QtConcurrent::blockingMap(chunks, [this, jd](int start)
+    {
+        solve(jd, start, std::min(start + CHUNK_SIZE, size()));
+    });
+}
+
+void KSOrbitBatch::solve(long double jd, int start, int end)
+{
+    const double t = static_cast<double>(jd);
+
+    for (int first = start; first < end; first += BLOCK_SIZE)
+    {
+        const int n = std::min(BLOCK_SIZE, end - first);
+
+        ConstMap epoch(m_Epoch.data() + first, n), M0(m_M0.data() + first, n);
+        ConstMap meanMotion(m_MeanMotion.data() + first, n), e(m_E.data() + first, n);
+        ConstMap a(m_A.data() + first, n), b(m_B.data() + first, n);
+
+        // Mean anomaly, reduced to [-PI, PI)
+        BlockArray M = M0 + meanMotion * (t - epoch);
+        M -= 2 * M_PI * ((M + M_PI) / (2 * M_PI)).floor();
+
+        // Newton's method from Danby's starting value converges for all elliptical orbits. All bodies
+        // of the block are iterated together until the slowest has converged.
+        BlockArray E = M + 0.85 * e * M.sign();
+        BlockArray sinE(n), cosE(n);
+        for (int iteration = 0; iteration < KEPLER_MAX_ITERATIONS; iteration++)
+        {
+            sinE = E.sin();
+            cosE = E.cos();
+            BlockArray dE = (E - e * sinE - M) / (1.0 - e * cosE);
+            E -= dE;
+            if (dE.abs().maxCoeff() < KEPLER_TOLERANCE)
+                break;
+        }
+        sinE = E.sin();
+        cosE = E.cos();
+
+        // Position in the orbital plane, then rotated into the ecliptic frame
+        BlockArray xv = a * (cosE - e);
+        BlockArray yv = b * sinE;
+
+        Map(m_X.data() + first, n) = xv * ConstMap(m_Px.data() + first, n) + yv * ConstMap(m_Qx.data() + first, n);
+        Map(m_Y.data() + first, n) = xv * ConstMap(m_Py.data() + first, n) + yv * ConstMap(m_Qy.data() + first, n);
+        Map(m_Z.data() + first, n) = xv * ConstMap(m_Pz.data() + first, n) + yv * ConstMap(m_Qz.data() + first, n);
+        Map(m_R.data() + first, n) = a * (1.0 - e * cosE);
+    }
+}
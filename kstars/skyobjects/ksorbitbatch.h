@@ -0,0 +1,96 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <vector>
+
+/**
+ * @class KSOrbitBatch
+ * @short Solves Kepler's equation for a large number of elliptical orbits at once.
+ *
+ * The orbital elements of all bodies are kept in contiguous arrays rather than in the individual
+ * KSAsteroid objects. Positions are computed a block of bodies at a time using Eigen array expressions,
+ * which are compiled to SIMD code, and the blocks are spread over the global thread pool. Everything that
+ * only depends on the elements (the orientation of the orbital plane, the mean motion, ...) is computed
+ * once when a body is added.
+ *
+ * The elements follow the KSAsteroid conventions: heliocentric ecliptic J2000 frame, angles in degrees,
+ * distances in AU and the orbital period in days. Only elliptical orbits (e < 1) are supported.
+ *
+ * @author KStars Developers
+ */
+class KSOrbitBatch
+{
+    public:
+        KSOrbitBatch() = default;
+
+        /**
+         * @short Add a body
+         * @param JD epoch of the elements
+         * @param a semi-major axis
+         * @param e eccentricity
+         * @param i inclination
+         * @param w argument of perihelion
+         * @param N longitude of the ascending node
+         * @param M mean anomaly at the epoch
+         * @param P orbital period
+         * @return index of the body, or -1 if the orbit can't be handled (not elliptical)
+         */
+        int add(long double JD, double a, double e, double i, double w, double N, double M, double P);
+
+        void clear();
+
+        int size() const
+        {
+            return static_cast<int>(m_A.size());
+        }
+
+        /**
+         * @short Compute the heliocentric positions of all the bodies, in parallel
+         * @param jd Julian Day to compute the positions for
+         */
+        void solve(long double jd);
+
+        /**
+         * @short Compute the heliocentric positions of the bodies [start, end) on the calling thread
+         */
+        void solve(long double jd, int start, int end);
+
+        /** @return heliocentric ecliptic cartesian coordinates (AU) of the bodies from the last solve */
+        const double *x() const
+        {
+            return m_X.data();
+        }
+        const double *y() const
+        {
+            return m_Y.data();
+        }
+        const double *z() const
+        {
+            return m_Z.data();
+        }
+        /** @return distances from the Sun (AU) of the bodies from the last solve */
+        const double *r() const
+        {
+            return m_R.data();
+        }
+
+    private:
+        // Elements
+        std::vector<double> m_Epoch;
+        std::vector<double> m_M0;
+        std::vector<double> m_MeanMotion;
+        std::vector<double> m_E;
+        std::vector<double> m_A;
+        std::vector<double> m_B;
+        // Unit vectors towards the perihelion (P) and 90 degrees ahead of it in the orbital plane (Q)
+        std::vector<double> m_Px, m_Py, m_Pz;
+        std::vector<double> m_Qx, m_Qy, m_Qz;
+
+        // Results
+        std::vector<double> m_X, m_Y, m_Z, m_R;
+};
@@ -6,9 +6,11 @@
 
 #include "ksplanet.h"
 
+#include "ksephemeriscache.h"
 #include "ksnumbers.h"
 #include "ksutils.h"
 #include "ksfilereader.h"
+#include "Options.h"
 
 #include <cmath>
 #include <typeinfo>
@@ -111,6 +113,57 @@ bool KSPlanet::OrbitDataManager::loadData(KSPlanet::OrbitDataColl &odc, const QS
     return true;
 }
 
+KSEphemerisCache *KSPlanet::OrbitDataManager::ephemerisCache(const QString &n)
+{
+    // Segment length (days) and degree of the polynomials for each planet, chosen so that the fits
+    // stay within the tolerance. The inner planets and the Earth (which includes the lunar
+    // perturbation) need shorter segments.
+    static const struct
+    {
+        const char *name;
+        double days;
+        int degree;
+    } parameters[] =
+    {
+        { "mercury", 16, 12 }, { "venus", 32, 12 }, { "earth", 16, 12 }, { "mars", 64, 12 },
+        { "jupiter", 64, 12 }, { "saturn", 64, 12 }, { "uranus", 64, 12 }, { "neptune", 32, 12 }
+    };
+    // About 2 mas, and 1.5 km in distance
+    const double tolerance = 1e-8;
+
+    QString nl = n.toLower();
+    auto it = caches.constFind(nl);
+    if (it != caches.constEnd())
+        return it.value().get();
+
+    OrbitDataColl odc;
+    if (!loadData(odc, nl))
+        return nullptr;
+
+    double days = 16;
+    int degree = 12;
+    for (const auto &p : parameters)
+    {
+        if (nl == QLatin1String(p.name))
+        {
+            days   = p.days;
+            degree = p.degree;
+        }
+    }
+
+    auto cache = std::make_shared<KSEphemerisCache>([odc](double jm, double * position)
+    {
+        EclipticPosition ep;
+        calcEclipticSeries(odc, jm, ep);
+        position[0] = ep.longitude.radians();
+        position[1] = ep.latitude.radians();
+        position[2] = ep.radius;
+    }, days / 365250.0, degree, tolerance);
+
+    caches.insert(nl, cache);
+    return cache.get();
+}
+
 KSPlanet::KSPlanet(const QString &s, const QString &imfile, const QColor &c, double pSize)
     : KSPlanetBase(s, imfile, c, pSize)
 {
@@ -191,16 +244,26 @@ bool KSPlanet::loadData()
 
 void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const
 {
-    double sum[6];
-    OrbitDataColl odc;
-    double Tpow[6];
-
-    Tpow[0] = 1.0;
-    for (int i = 1; i < 6; ++i)
+    if (Options::useEphemerisCache())
     {
-        Tpow[i] = Tpow[i - 1] * Tau;
+        if (m_EphemerisCache == nullptr)
+            m_EphemerisCache = odm.ephemerisCache(untranslatedName());
+
+        if (m_EphemerisCache != nullptr)
+        {
+            double position[3];
+            m_EphemerisCache->evaluate(Tau, position);
+
+            epret.longitude.setRadians(position[0]);
+            epret.longitude.setD(epret.longitude.reduce().Degrees());
+            epret.latitude.setRadians(position[1]);
+            epret.radius = position[2];
+            return;
+        }
     }
 
+    OrbitDataColl odc;
+
     if (!odm.loadData(odc, untranslatedName()))
     {
         epret.longitude = dms(0.0);
@@ -210,6 +273,20 @@ void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const
         return;
     }
 
+    calcEclipticSeries(odc, Tau, epret);
+}
+
+void KSPlanet::calcEclipticSeries(const OrbitDataColl &odc, double Tau, EclipticPosition &epret)
+{
+    double sum[6];
+    double Tpow[6];
+
+    Tpow[0] = 1.0;
+    for (int i = 1; i < 6; ++i)
+    {
+        Tpow[i] = Tpow[i - 1] * Tau;
+    }
+
     //Ecliptic Longitude
     for (int i = 0; i < 6; ++i)
     {
@@ -12,6 +12,9 @@
 #include <QString>
 #include <QVector>
 
+#include <memory>
+
+class KSEphemerisCache;
 class KSNumbers;
 
 /**
@@ -68,6 +71,8 @@ class KSPlanet : public KSPlanetBase
      * Calculate the ecliptic longitude and latitude of the planet for
      * the given date (expressed in Julian Millenia since J2000).  A reference
      * to the ecliptic coordinates is returned as the second object.
+     * @note When the UseEphemerisCache option is set, the position is interpolated from
+     * Chebyshev polynomials fitted to the VSOP87 series (see KSEphemerisCache).
      * @param jm Julian Millenia (=jd/1000)
      * @param ret The ecliptic coordinates are returned by reference through this argument.
      */
@@ -153,6 +158,13 @@ class KSPlanet : public KSPlanetBase
          */
         bool loadData(OrbitDataColl &odc, const QString &n);
 
+        /**
+         * Get the Chebyshev cache of a planet's positions, created on first use.
+         * @param n the name of the planet
+         * @return the cache, or nullptr if the planet's orbital data can't be loaded
+         */
+        KSEphemerisCache *ephemerisCache(const QString &n);
+
       private:
         /**
          * Read a single orbital data file from disk into an OrbitData vector.
@@ -164,12 +176,26 @@ class KSPlanet : public KSPlanetBase
         bool readOrbitData(const QString &fname, QVector<KSPlanet::OrbitData> *vector);
 
         QHash<QString, OrbitDataColl> hash;
+        QHash<QString, std::shared_ptr<KSEphemerisCache>> caches;
     };
 
+    /**
+     * Sum the VSOP87 series of a planet. This is the reference calcEcliptic() is
+     * approximating when the ephemeris cache is used.
+     * @param odc the orbital data of the planet
+     * @param jm Julian Millenia (=jd/1000)
+     * @param ret The ecliptic coordinates are returned by reference through this argument.
+     */
+    static void calcEclipticSeries(const OrbitDataColl &odc, double jm, EclipticPosition &ret);
+
   private:
     void findMagnitude(const KSNumbers *) override;
 
   protected:
     bool data_loaded { false };
     static OrbitDataManager odm;
+
+  private:
+    // Owned by odm, looked up on first use
+    mutable KSEphemerisCache *m_EphemerisCache { nullptr };
 };
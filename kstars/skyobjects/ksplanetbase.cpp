@@ -200,16 +200,21 @@ void KSPlanetBase::setRearth(const KSPlanetBase *Earth)
     double cosL, cosB, cosL0, cosB0;
     double x, y, z;
 
-    //The Moon's Rearth is set in its findGeocentricPosition()...
-    if (name() == i18n("Moon"))
+    // Minor bodies are never the Earth or the Moon, so skip the name checks which are
+    // expensive when repeated for every asteroid
+    if (type() != SkyObject::ASTEROID && type() != SkyObject::COMET)
     {
-        return;
-    }
-
-    if (name() == i18n("Earth"))
-    {
-        Rearth = 0.0;
-        return;
+        //The Moon's Rearth is set in its findGeocentricPosition()...
+        if (name() == i18n("Moon"))
+        {
+            return;
+        }
+
+        if (name() == i18n("Earth"))
+        {
+            Rearth = 0.0;
+            return;
+        }
     }
 
     if (!Earth)
@@ -11,12 +11,11 @@
 #include "kspopupmenu.h"
 #endif
 #include "kstarsdata.h"
-#include "kssun.h"
 #include "Options.h"
-#include "skymapcomposite.h"
 #include "kstars_debug.h"
 
 #include <cmath>
+#include <limits>
 #include <typeinfo>
 
 // Define some constants
@@ -705,27 +704,302 @@ void Satellite::init()
 int Satellite::updatePos()
 {
     KStarsData *data = KStarsData::Instance();
-    return sgp4((data->clock()->utc().djd() - m_tle_jd) * MINPD);
+    return updatePos(frame(data->clock()->utc().djd(), data->geo()));
 }
 
-int Satellite::sgp4(double tsince)
+int Satellite::updatePos(const SatelliteFrame &frame)
+{
+    double position[3], velocity[3];
+
+    int rc = sgp4((frame.jd - m_tle_jd) * MINPD, position, velocity);
+    if (rc != 0)
+        return rc;
+
+    return updatePos(frame, position, velocity);
+}
+
+int Satellite::updatePos(const SatelliteFrame &frame, const double *position, const double *velocity)
 {
     KStarsData *data = KStarsData::Instance();
 
+    double sat_posw = sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+    m_velocity      = sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2]);
+    m_altitude      = sat_posw - frame.obsDistance + MEANALT;
+
+    // Az and Dec
+    double azimuth, elevation;
+    horizontal(frame, position, azimuth, elevation, m_range);
+
+    setAz(azimuth / DEG2RAD);
+    setAlt(elevation / DEG2RAD);
+    HorizontalToEquatorial(data->lst(), data->geo()->lat());
+
+    // is the satellite visible ?
+    // Calculates satellite's eclipse status and depth
+    double sd_sun, sd_earth, delta, depth;
+
+    // Determine partial eclipse
+    sd_earth       = arcSin(RADIUSEARTHKM / sat_posw);
+    double rho_x   = frame.sun[0] - position[0];
+    double rho_y   = frame.sun[1] - position[1];
+    double rho_z   = frame.sun[2] - position[2];
+    double rho_w   = sqrt(rho_x * rho_x + rho_y * rho_y + rho_z * rho_z);
+    sd_sun         = arcSin(SR / rho_w);
+    double earth_x = -1.0 * position[0];
+    double earth_y = -1.0 * position[1];
+    double earth_z = -1.0 * position[2];
+    double earth_w = sat_posw;
+    delta          = PIO2 - arcSin((frame.sun[0] * earth_x + frame.sun[1] * earth_y + frame.sun[2] * earth_z) /
+                                   (frame.sunDistance * earth_w));
+    depth          = sd_earth - sd_sun - delta;
+
+    m_is_eclipsed = sd_earth >= sd_sun && depth >= 0;
+    m_is_visible  = !m_is_eclipsed && frame.sunAlt <= -12.0 && elevation >= 0.0;
+
+    return (0);
+}
+
+SatelliteFrame Satellite::frame(double jd, GeoLocation *geo)
+{
+    SatelliteFrame frame;
+    double sinlat, coslat, thetageo, c, sq, achcp;
+
+    frame.jd = jd;
+
+    // Observer ECI position
+    sinlat         = sin(geo->lat()->radians());
+    coslat         = cos(geo->lat()->radians());
+    thetageo       = geo->LMST(jd);
+    frame.sinlat   = sinlat;
+    frame.coslat   = coslat;
+    frame.sintheta = sin(thetageo);
+    frame.costheta = cos(thetageo);
+    c              = 1.0 / sqrt(1.0 + F * (F - 2.0) * sinlat * sinlat);
+    sq             = (1.0 - F) * (1.0 - F) * c;
+    achcp          = (RADIUSEARTHKM * c + MEANALT) * coslat;
+    frame.obs[0]   = achcp * frame.costheta;
+    frame.obs[1]   = achcp * frame.sintheta;
+    frame.obs[2]   = (RADIUSEARTHKM * sq + MEANALT) * sinlat;
+    frame.obsDistance =
+        sqrt(frame.obs[0] * frame.obs[0] + frame.obs[1] * frame.obs[1] + frame.obs[2] * frame.obs[2]);
+
+    // Find ECI coordinates of the sun
+    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
+
+    mjd  = jd - 2415020.0;
+    year = 1900.0 + mjd / 365.25;
+    T    = (mjd + deltaET(year) / (MINPD * 60.0)) / 36525.0;
+    M    = DEG2RAD * (Modulus(358.47583 + Modulus(35999.04975 * T, 360.0) - (0.000150 + 0.0000033 * T) * T * T, 360.0));
+    L    = DEG2RAD * (Modulus(279.69668 + Modulus(36000.76892 * T, 360.0) + 0.0003025 * T * T, 360.0));
+    e    = 0.01675104 - (0.0000418 + 0.000000126 * T) * T;
+    C    = DEG2RAD * ((1.919460 - (0.004789 + 0.000014 * T) * T) * sin(M) + (0.020094 - 0.000100 * T) * sin(2 * M) +
+                      0.000293 * sin(3 * M));
+    O    = DEG2RAD * (Modulus(259.18 - 1934.142 * T, 360.0));
+    Lsa  = Modulus(L + C - DEG2RAD * (0.00569 - 0.00479 * sin(O)), TWOPI);
+    nu   = Modulus(M + C, TWOPI);
+    R    = 1.0000002 * (1.0 - e * e) / (1.0 + e * cos(nu));
+    eps  = DEG2RAD * (23.452294 - (0.0130125 + (0.00000164 - 0.000000503 * T) * T) * T + 0.00256 * cos(O));
+    R    = AU * R;
+
+    frame.sun[0]      = R * cos(Lsa);
+    frame.sun[1]      = R * sin(Lsa) * cos(eps);
+    frame.sun[2]      = R * sin(Lsa) * sin(eps);
+    frame.sunDistance = R;
+
+    double azimuth, elevation, range;
+    horizontal(frame, frame.sun, azimuth, elevation, range);
+    frame.sunAlt = elevation / DEG2RAD;
+
+    return frame;
+}
+
+void Satellite::horizontal(const SatelliteFrame &frame, const double *position, double &azimuth, double &elevation,
+                           double &range)
+{
+    double range_posx = position[0] - frame.obs[0];
+    double range_posy = position[1] - frame.obs[1];
+    double range_posz = position[2] - frame.obs[2];
+    range             = sqrt(range_posx * range_posx + range_posy * range_posy + range_posz * range_posz);
+
+    double top_s = frame.sinlat * frame.costheta * range_posx + frame.sinlat * frame.sintheta * range_posy -
+                   frame.coslat * range_posz;
+    double top_e = -frame.sintheta * range_posx + frame.costheta * range_posy;
+    double top_z = frame.coslat * frame.costheta * range_posx + frame.coslat * frame.sintheta * range_posy +
+                   frame.sinlat * range_posz;
+
+    azimuth = atan(-top_e / top_s);
+    if (top_s > 0.)
+        azimuth += M_PI;
+    if (azimuth < 0.)
+        azimuth += TWOPI;
+    elevation = arcSin(top_z / range);
+}
+
+double Satellite::elevation(const SatelliteFrame &frame)
+{
+    double position[3], velocity[3], azimuth, alt, range;
+
+    if (sgp4((frame.jd - m_tle_jd) * MINPD, position, velocity) != 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    horizontal(frame, position, azimuth, alt, range);
+    return alt / DEG2RAD;
+}
+
+QList<SatellitePass> Satellite::findPasses(double startJD, double endJD, GeoLocation *geo, double minAltitude)
+{
+    // Times are found to about 0.1 second
+    const double tolerance = 1e-6;
+    const double goldenRatio = 0.5 * (sqrt(5.0) - 1.0);
+
+    QList<SatellitePass> passes;
+
+    if (!(endJD > startJD) || !(m_mean_motion > 0))
+        return passes;
+
+    // Altitude above minAltitude, which is positive while the satellite is up
+    auto height = [&](double jd)
+    {
+        return elevation(frame(jd, geo)) - minAltitude;
+    };
+    auto azimuth = [&](double jd)
+    {
+        SatelliteFrame f = frame(jd, geo);
+        double position[3], velocity[3], az = 0, alt, range;
+        if (sgp4((jd - m_tle_jd) * MINPD, position, velocity) == 0)
+            horizontal(f, position, az, alt, range);
+        return az / DEG2RAD;
+    };
+
+    // Sample often enough to see every orbit's highest point, at most every 10 minutes
+    const double period = TWOPI / m_mean_motion / MINPD;
+    const int count     = qMax(2, static_cast<int>(ceil((endJD - startJD) / qMin(period / 16.0, 10.0 / MINPD))) + 1);
+    const double step   = (endJD - startJD) / (count - 1);
+
+    QVector<double> times(count), heights(count);
+    for (int i = 0; i < count; i++)
+    {
+        times[i]   = i == count - 1 ? endJD : startJD + i * step;
+        heights[i] = height(times[i]);
+    }
+
+    // Bisection between a time the satellite is down (a) and one it is up (b)
+    auto crossing = [&](double a, double b)
+    {
+        while (fabs(b - a) > tolerance)
+        {
+            double m = 0.5 * (a + b);
+            if (height(m) > 0)
+                b = m;
+            else
+                a = m;
+        }
+        return 0.5 * (a + b);
+    };
+
+    for (int i = 0; i < count; i++)
+    {
+        // Sampled local maxima, including the window ends
+        const bool rising  = i == 0 || heights[i] > heights[i - 1];
+        const bool falling = i == count - 1 || heights[i] >= heights[i + 1];
+        if (!rising || !falling || std::isnan(heights[i]))
+            continue;
+
+        // Golden section search for the culmination between the neighbouring samples
+        double a = times[qMax(0, i - 1)], b = times[qMin(count - 1, i + 1)];
+        double c = b - goldenRatio * (b - a), d = a + goldenRatio * (b - a);
+        double hc = height(c), hd = height(d);
+        while (b - a > tolerance)
+        {
+            if (hc > hd)
+            {
+                b  = d;
+                d  = c;
+                hd = hc;
+                c  = b - goldenRatio * (b - a);
+                hc = height(c);
+            }
+            else
+            {
+                a  = c;
+                c  = d;
+                hc = hd;
+                d  = a + goldenRatio * (b - a);
+                hd = height(d);
+            }
+        }
+
+        double culmination = 0.5 * (a + b), maxHeight = height(culmination);
+        if (heights[i] > maxHeight)
+        {
+            culmination = times[i];
+            maxHeight   = heights[i];
+        }
+        if (!(maxHeight > 0))
+            continue;
+
+        SatellitePass pass;
+        pass.culminationJD  = culmination;
+        pass.culminationAlt = maxHeight + minAltitude;
+        pass.culminationAz  = azimuth(culmination);
+
+        // Walk back to the last sample the satellite was down, then bisect
+        int j = i;
+        while (j >= 0 && (times[j] >= culmination || heights[j] > 0))
+            j--;
+        if (j < 0)
+        {
+            pass.riseJD      = startJD;
+            pass.riseClipped = true;
+        }
+        else
+            pass.riseJD = crossing(times[j], j + 1 < count && times[j + 1] < culmination ? times[j + 1] : culmination);
+        pass.riseAz = azimuth(pass.riseJD);
+
+        // and forward to the first sample it is down again
+        j = i;
+        while (j < count && (times[j] <= culmination || heights[j] > 0))
+            j++;
+        if (j >= count)
+        {
+            pass.setJD      = endJD;
+            pass.setClipped = true;
+        }
+        else
+            pass.setJD = crossing(times[j], j > 0 && times[j - 1] > culmination ? times[j - 1] : culmination);
+        pass.setAz = azimuth(pass.setJD);
+
+        // Several sampled maxima may belong to the same pass
+        if (!passes.isEmpty() && pass.riseJD < passes.last().setJD)
+        {
+            if (pass.culminationAlt > passes.last().culminationAlt)
+            {
+                pass.riseJD      = passes.last().riseJD;
+                pass.riseAz      = passes.last().riseAz;
+                pass.riseClipped = passes.last().riseClipped;
+                passes.last()    = pass;
+            }
+            continue;
+        }
+
+        passes.append(pass);
+    }
+
+    return passes;
+}
+
+int Satellite::sgp4(double tsince, double *position, double *velocity)
+{
     int ktr;
     double am, axnl, aynl, betal, cosim, cnod, cos2u, coseo1 = 0, cosi, cosip, cosisq, cossu, cosu, delm, delomg, em,
                                                       ecose, el2, eo1, ep, esine, argpm, argpp, argpdf, pl,
                                                       mrt = 0.0, mvt, rdotl, rl, rvdot, rvdotl, sinim, dndt, sin2u, sineo1 = 0, sini, sinip, sinsu, sinu, snod, su, t2,
                                                       t3, t4, tem5, temp, temp1, temp2, tempa, tempe, templ, u, ux, uy, uz, vx, vy, vz, inclm, mm, nm, nodem, xinc,
-                                                      xincp, xl, xlm, mp, xmdf, xmx, xmy, nodedf, xnode, nodep, tc, sat_posx, sat_posy, sat_posz, sat_posw, sat_velx,
-                                                      sat_vely, sat_velz, sinlat, obs_posx, obs_posy, obs_posz, obs_posw, /*obs_velx, obs_vely, obs_velz,*/
-                                                      coslat, thetageo, sintheta, costheta, c, sq, achcp, vkmpersec;
+                                                      xincp, xl, xlm, mp, xmdf, xmx, xmy, nodedf, xnode, nodep, tc, vkmpersec;
     //    double emsq;
 
     const double temp4 = 1.5e-12;
 
-    double jul_utc = data->clock()->utc().djd();
-
     vkmpersec = RADIUSEARTHKM * XKE / 60.0;
 
     // Update for secular gravity and atmospheric drag
@@ -1111,22 +1385,12 @@ int Satellite::sgp4(double tsince)
     vz    = sini * cossu;
 
     // Position and velocity (in km and km/sec)
-    sat_posx   = (mrt * ux) * RADIUSEARTHKM;
-    sat_posy   = (mrt * uy) * RADIUSEARTHKM;
-    sat_posz   = (mrt * uz) * RADIUSEARTHKM;
-    sat_posw   = sqrt(sat_posx * sat_posx + sat_posy * sat_posy + sat_posz * sat_posz);
-    sat_velx   = (mvt * ux + rvdot * vx) * vkmpersec;
-    sat_vely   = (mvt * uy + rvdot * vy) * vkmpersec;
-    sat_velz   = (mvt * uz + rvdot * vz) * vkmpersec;
-    m_velocity = sqrt(sat_velx * sat_velx + sat_vely * sat_vely + sat_velz * sat_velz);
-
-    //     printf("tsince=%.15f\n", tsince);
-    //     printf("sat_posx=%.15f\n", sat_posx);
-    //     printf("sat_posy=%.15f\n", sat_posy);
-    //     printf("sat_posz=%.15f\n", sat_posz);
-    //     printf("sat_velx=%.15f\n", sat_velx);
-    //     printf("sat_vely=%.15f\n", sat_vely);
-    //     printf("sat_velz=%.15f\n", sat_velz);
+    position[0] = (mrt * ux) * RADIUSEARTHKM;
+    position[1] = (mrt * uy) * RADIUSEARTHKM;
+    position[2] = (mrt * uz) * RADIUSEARTHKM;
+    velocity[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+    velocity[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+    velocity[2] = (mvt * uz + rvdot * vz) * vkmpersec;
 
     if (mrt < 1.0)
     {
@@ -1134,97 +1398,6 @@ int Satellite::sgp4(double tsince)
         return (6);
     }
 
-    // Observer ECI position and velocity
-    sinlat   = sin(data->geo()->lat()->radians());
-    coslat   = cos(data->geo()->lat()->radians());
-    thetageo = data->geo()->LMST(jul_utc);
-    sintheta = sin(thetageo);
-    costheta = cos(thetageo);
-    c        = 1.0 / sqrt(1.0 + F * (F - 2.0) * sinlat * sinlat);
-    sq       = (1.0 - F) * (1.0 - F) * c;
-    achcp    = (RADIUSEARTHKM * c + MEANALT) * coslat;
-    obs_posx = achcp * costheta;
-    obs_posy = achcp * sintheta;
-    obs_posz = (RADIUSEARTHKM * sq + MEANALT) * sinlat;
-    obs_posw = sqrt(obs_posx * obs_posx + obs_posy * sat_posy + obs_posz * obs_posz);
-    /*obs_velx = -MFACTOR * obs_posy;
-    obs_vely = MFACTOR * obs_posx;
-    obs_velz = 0.;*/
-
-    m_altitude = sat_posw - obs_posw + MEANALT;
-
-    // Az and Dec
-    double range_posx = sat_posx - obs_posx;
-    double range_posy = sat_posy - obs_posy;
-    double range_posz = sat_posz - obs_posz;
-    m_range           = sqrt(range_posx * range_posx + range_posy * range_posy + range_posz * range_posz);
-    //     double range_velx = sat_velx - obs_velx;
-    //     double range_vely = sat_velx - obs_vely;
-    //     double range_velz = sat_velx - obs_velz;
-
-    double top_s = sinlat * costheta * range_posx + sinlat * sintheta * range_posy - coslat * range_posz;
-    double top_e = -sintheta * range_posx + costheta * range_posy;
-    double top_z = coslat * costheta * range_posx + coslat * sintheta * range_posy + sinlat * range_posz;
-
-    double azimuth = atan(-top_e / top_s);
-    if (top_s > 0.)
-        azimuth += M_PI;
-    if (azimuth < 0.)
-        azimuth += TWOPI;
-    double elevation = arcSin(top_z / m_range);
-
-    //     printf("azimuth=%.15f\n\r", azimuth / DEG2RAD);
-    //     printf("elevation=%.15f\n\r", elevation / DEG2RAD);
-
-    setAz(azimuth / DEG2RAD);
-    setAlt(elevation / DEG2RAD);
-    HorizontalToEquatorial(data->lst(), data->geo()->lat());
-
-    // is the satellite visible ?
-    // Find ECI coordinates of the sun
-    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
-
-    mjd  = jul_utc - 2415020.0;
-    year = 1900.0 + mjd / 365.25;
-    T    = (mjd + deltaET(year) / (MINPD * 60.0)) / 36525.0;
-    M    = DEG2RAD * (Modulus(358.47583 + Modulus(35999.04975 * T, 360.0) - (0.000150 + 0.0000033 * T) * T * T, 360.0));
-    L    = DEG2RAD * (Modulus(279.69668 + Modulus(36000.76892 * T, 360.0) + 0.0003025 * T * T, 360.0));
-    e    = 0.01675104 - (0.0000418 + 0.000000126 * T) * T;
-    C    = DEG2RAD * ((1.919460 - (0.004789 + 0.000014 * T) * T) * sin(M) + (0.020094 - 0.000100 * T) * sin(2 * M) +
-                      0.000293 * sin(3 * M));
-    O    = DEG2RAD * (Modulus(259.18 - 1934.142 * T, 360.0));
-    Lsa  = Modulus(L + C - DEG2RAD * (0.00569 - 0.00479 * sin(O)), TWOPI);
-    nu   = Modulus(M + C, TWOPI);
-    R    = 1.0000002 * (1.0 - e * e) / (1.0 + e * cos(nu));
-    eps  = DEG2RAD * (23.452294 - (0.0130125 + (0.00000164 - 0.000000503 * T) * T) * T + 0.00256 * cos(O));
-    R    = AU * R;
-
-    double sun_posx = R * cos(Lsa);
-    double sun_posy = R * sin(Lsa) * cos(eps);
-    double sun_posz = R * sin(Lsa) * sin(eps);
-    double sun_posw = R;
-
-    // Calculates satellite's eclipse status and depth
-    double sd_sun, sd_earth, delta, depth;
-
-    // Determine partial eclipse
-    sd_earth       = arcSin(RADIUSEARTHKM / sat_posw);
-    double rho_x   = sun_posx - sat_posx;
-    double rho_y   = sun_posy - sat_posy;
-    double rho_z   = sun_posz - sat_posz;
-    double rho_w   = sqrt(rho_x * rho_x + rho_y * rho_y + rho_z * rho_z);
-    sd_sun         = arcSin(SR / rho_w);
-    double earth_x = -1.0 * sat_posx;
-    double earth_y = -1.0 * sat_posy;
-    double earth_z = -1.0 * sat_posz;
-    double earth_w = sat_posw;
-    delta      = PIO2 - arcSin((sun_posx * earth_x + sun_posy * earth_y + sun_posz * earth_z) / (sun_posw * earth_w));
-    depth      = sd_earth - sd_sun - delta;
-    KSSun *sun = dynamic_cast<KSSun *>(data->skyComposite()->findByName(i18n("Sun")));
-
-    m_is_eclipsed = sd_earth >= sd_sun && depth >= 0;
-    m_is_visible  = !m_is_eclipsed && sun->alt().Degrees() <= -12.0 && elevation >= 0.0;
-
     return (0);
 }
 
@@ -8,10 +8,57 @@
 
 #include "skyobject.h"
 
+#include <QList>
 #include <QString>
 
+class GeoLocation;
 class KSPopupMenu;
 
+/**
+ * @class SatelliteFrame
+ * The observer and Sun positions at a given time. They are the same for all the satellites,
+ * so they are computed once per update rather than once per satellite.
+ *
+ * Positions are in the Earth centered inertial frame used by SGP4, in km.
+ */
+class SatelliteFrame
+{
+    public:
+        /// UTC julian date
+        double jd { 0 };
+        /// Sine and cosine of the observer latitude and local mean sidereal time
+        double sinlat { 0 }, coslat { 1 }, sintheta { 0 }, costheta { 1 };
+        /// Observer position and distance from the earth center
+        double obs[3] { 0, 0, 0 };
+        double obsDistance { 0 };
+        /// Sun position and distance from the earth center
+        double sun[3] { 0, 0, 0 };
+        double sunDistance { 0 };
+        /// Sun altitude above the observer horizon in degrees
+        double sunAlt { 0 };
+};
+
+/**
+ * @class SatellitePass
+ * A pass of a satellite above the observer horizon, as found by Satellite::findPasses().
+ * Times are UTC julian dates and angles are in degrees.
+ */
+class SatellitePass
+{
+    public:
+        double riseJD { 0 };
+        double riseAz { 0 };
+        double culminationJD { 0 };
+        double culminationAlt { 0 };
+        double culminationAz { 0 };
+        double setJD { 0 };
+        double setAz { 0 };
+        /// True if the satellite was already up at the start of the search window (riseJD is the window start)
+        bool riseClipped { false };
+        /// True if the satellite is still up at the end of the search window (setJD is the window end)
+        bool setClipped { false };
+};
+
 /**
  * @class Satellite
  * Represents an artificial satellites.
@@ -37,6 +84,42 @@ class Satellite : public SkyObject
         /** @short Update satellite position */
         int updatePos();
 
+        /**
+         * @short Update satellite position for the time and observer of a frame
+         * @return 0 on success or an sgp4 error code, see sgp4ErrorString()
+         */
+        int updatePos(const SatelliteFrame &frame);
+
+        /**
+         * @short Update satellite position from an already propagated state, e.g. from SatelliteBatch
+         * @param position ECI position in km
+         * @param velocity ECI velocity in km/s
+         */
+        int updatePos(const SatelliteFrame &frame, const double *position, const double *velocity);
+
+        /**
+         * @short Compute the observer and Sun positions
+         * @param jd UTC julian date
+         * @param geo observer location
+         */
+        static SatelliteFrame frame(double jd, GeoLocation *geo);
+
+        /**
+         * @short Find the passes of the satellite above the observer horizon
+         *
+         * The altitude is sampled a few times per orbit, then the culminations are located by golden section
+         * search and the rise and set times by bisection, to about 0.1 second.
+         *
+         * @param startJD start of the search window (UTC julian date)
+         * @param endJD end of the search window (UTC julian date)
+         * @param geo observer location
+         * @param minAltitude altitude in degrees above which the satellite is considered up
+         * @return passes ordered by time
+         * @note This doesn't change the current position of the satellite, but the deep space propagator
+         * keeps some state between calls, so use a clone() when searching from another thread.
+         */
+        QList<SatellitePass> findPasses(double startJD, double endJD, GeoLocation *geo, double minAltitude = 0);
+
         /**
          * @return True if the satellite is visible (above horizon, in the sunlight and sun at least 12° under horizon)
          */
@@ -72,15 +155,31 @@ class Satellite : public SkyObject
 
         void initPopupMenu(KSPopupMenu *pmenu) override;
 
+#ifdef UNIT_TEST
+        friend class TestSatellite; // Test class
+#endif
+
     private:
         /** @short Compute non time dependent parameters */
         void init();
 
-        /** @short Compute satellite position */
-        int sgp4(double tsince);
+        /**
+         * @short Compute satellite position
+         * @param tsince minutes since the TLE epoch
+         * @param position ECI position in km
+         * @param velocity ECI velocity in km/s
+         */
+        int sgp4(double tsince, double *position, double *velocity);
+
+        /** @short Compute the azimuth, elevation (radians) and range (km) of an ECI position */
+        static void horizontal(const SatelliteFrame &frame, const double *position, double &azimuth, double &elevation,
+                               double &range);
+
+        /** @return Satellite elevation in degrees at the given time, or NaN if it can't be propagated */
+        double elevation(const SatelliteFrame &frame);
 
         /** @return Arcsine of the argument */
-        double arcSin(double arg);
+        static double arcSin(double arg);
 
         /**
          * Provides the difference between UT (approximately the same as UTC)
@@ -88,10 +187,10 @@ class Satellite : public SkyObject
          * This function is based on a least squares fit of data from 1950
          * to 1991 and will need to be updated periodically.
          */
-        double deltaET(double year);
+        static double deltaET(double year);
 
         /** @return arg1 mod arg2 */
-        double Modulus(double arg1, double arg2);
+        static double Modulus(double arg1, double arg2);
 
         // TLE
         /// Satellite Number
@@ -166,4 +265,6 @@ class Satellite : public SkyObject
         double zmos { 0 }, atime { 0 }, xli { 0 }, xni { 0 };
 
         char method;
+
+        friend class SatelliteBatch;
 };
@@ -0,0 +1,264 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "satellitebatch.h"
+
+#include "satellite.h"
+
+#include <Eigen/Core>
+
+#include <QtConcurrent>
+
+#include <cmath>
+
+// Same WGS-72 constants as Satellite
+#define RADIUSEARTHKM 6378.135          // Earth radius (km)
+#define XKE           0.07436691613317  // 60.0 / sqrt(RADIUSEARTHKM^3/MU)
+#define J2            0.001082616       // The second gravitational zonal harmonic of the Earth
+#define TWOPI   6.2831853071795864769 // 2*PI
+#define X2O3    .66666666666666666667 // 2/3
+#define MINPD   1440                     // Minutes per day
+
+namespace
+{
+// Satellites propagated together, small enough for the working arrays to live on the stack
+constexpr int SATELLITE_BLOCK_SIZE = 256;
+// Satellites handed to a worker thread at a time
+constexpr int SATELLITE_CHUNK_SIZE = 4 * SATELLITE_BLOCK_SIZE;
+
+typedef Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, SATELLITE_BLOCK_SIZE, 1> SatelliteArray;
+typedef Eigen::Map<const Eigen::ArrayXd> SatelliteConstMap;
+typedef Eigen::Map<Eigen::ArrayXd> SatelliteMap;
+
+// Eigen has no fmod and atan2, use the C library ones to get the same results as Satellite::sgp4()
+SatelliteArray fmod2pi(const SatelliteArray &x)
+{
+    return x.unaryExpr([](double v)
+    {
+        return std::fmod(v, TWOPI);
+    });
+}
+}
+
+int SatelliteBatch::add(const Satellite *satellite)
+{
+    if (satellite->method != 'n' || !(satellite->m_mean_motion > 0))
+        return -1;
+
+    const Satellite &s = *satellite;
+
+    m_Epoch.push_back(s.m_tle_jd);
+    m_M0.push_back(s.m_mean_anomaly);
+    m_ArgPerigee0.push_back(s.m_arg_perigee);
+    m_Node0.push_back(s.m_ra);
+    m_MeanMotion.push_back(s.m_mean_motion);
+    m_Eccentricity.push_back(s.m_eccentricity);
+    m_A0.push_back(std::pow(XKE / s.m_mean_motion, X2O3));
+    m_Inclination.push_back(s.m_inclination);
+    m_SinI.push_back(std::sin(s.m_inclination));
+    m_CosI.push_back(std::cos(s.m_inclination));
+
+    m_MDot.push_back(s.mdot);
+    m_ArgPerigeeDot.push_back(s.argpdot);
+    m_NodeDot.push_back(s.nodedot);
+    m_NodeCf.push_back(s.nodecf);
+
+    m_Cc1.push_back(s.cc1);
+    m_BstarCc4.push_back(s.m_bstar * s.cc4);
+    m_T2Cof.push_back(s.t2cof);
+
+    // With these terms at zero the full drag model reduces to the simplified one
+    const bool full = !s.isimp;
+    m_BstarCc5.push_back(full ? s.m_bstar * s.cc5 : 0);
+    m_T3Cof.push_back(full ? s.t3cof : 0);
+    m_T4Cof.push_back(full ? s.t4cof : 0);
+    m_T5Cof.push_back(full ? s.t5cof : 0);
+    m_OmgCof.push_back(full ? s.omgcof : 0);
+    m_XmCof.push_back(full ? s.xmcof : 0);
+    m_Eta.push_back(s.eta);
+    m_DelMo.push_back(s.delmo);
+    m_SinMAo.push_back(s.sinmao);
+    m_D2.push_back(full ? s.d2 : 0);
+    m_D3.push_back(full ? s.d3 : 0);
+    m_D4.push_back(full ? s.d4 : 0);
+
+    m_AyCof.push_back(s.aycof);
+    m_XlCof.push_back(s.xlcof);
+    m_Con41.push_back(s.con41);
+    m_X1mth2.push_back(s.x1mth2);
+    m_X7thm1.push_back(s.x7thm1);
+
+    for (auto *v : { &m_X, &m_Y, &m_Z, &m_VX, &m_VY, &m_VZ })
+        v->push_back(0);
+    m_Error.push_back(0);
+
+    return size() - 1;
+}
+
+void SatelliteBatch::clear()
+{
+    for (auto *v : { &m_Epoch, &m_M0, &m_ArgPerigee0, &m_Node0, &m_MeanMotion, &m_Eccentricity, &m_A0, &m_Inclination,
+                &m_SinI, &m_CosI, &m_MDot, &m_ArgPerigeeDot, &m_NodeDot, &m_NodeCf, &m_Cc1, &m_BstarCc4, &m_BstarCc5,
+                &m_T2Cof, &m_T3Cof, &m_T4Cof, &m_T5Cof, &m_OmgCof, &m_XmCof, &m_Eta, &m_DelMo, &m_SinMAo, &m_D2,
+                &m_D3, &m_D4, &m_AyCof, &m_XlCof, &m_Con41, &m_X1mth2, &m_X7thm1, &m_X, &m_Y, &m_Z, &m_VX, &m_VY,
+                &m_VZ })
+        v->clear();
+    m_Error.clear();
+}
+
+void SatelliteBatch::solve(double jd)
+{
+    QVector<int> chunks;
+    for (int start = 0; start < size(); start += SATELLITE_CHUNK_SIZE)
+        chunks.append(start);
+
+    QtConcurrent::blockingMap(chunks, [this, jd](int start)
+    {
+        solve(jd, start, std::min(start + SATELLITE_CHUNK_SIZE, size()));
+    });
+}
+
+void SatelliteBatch::solve(double jd, int start, int end)
+{
+    for (int first = start; first < end; first += SATELLITE_BLOCK_SIZE)
+    {
+        const int n = std::min(SATELLITE_BLOCK_SIZE, end - first);
+
+        auto in = [first, n](const std::vector<double> &v)
+        {
+            return SatelliteConstMap(v.data() + first, n);
+        };
+
+        // Minutes since the TLE epochs
+        const SatelliteArray tsince = (jd - in(m_Epoch)) * MINPD;
+        const SatelliteArray t2 = tsince * tsince, t3 = t2 * tsince, t4 = t3 * tsince;
+
+        // Update for secular gravity and atmospheric drag
+        const SatelliteArray xmdf   = in(m_M0) + in(m_MDot) * tsince;
+        const SatelliteArray argpdf = in(m_ArgPerigee0) + in(m_ArgPerigeeDot) * tsince;
+        SatelliteArray nodem        = in(m_Node0) + in(m_NodeDot) * tsince + in(m_NodeCf) * t2;
+
+        const SatelliteArray delm = in(m_XmCof) * ((1.0 + in(m_Eta) * xmdf.cos()).cube() - in(m_DelMo));
+        const SatelliteArray temp = in(m_OmgCof) * tsince + delm;
+        SatelliteArray mm         = xmdf + temp;
+        SatelliteArray argpm      = argpdf - temp;
+
+        const SatelliteArray tempa =
+            1.0 - in(m_Cc1) * tsince - in(m_D2) * t2 - in(m_D3) * t3 - in(m_D4) * t4;
+        const SatelliteArray tempe = in(m_BstarCc4) * tsince + in(m_BstarCc5) * (mm.sin() - in(m_SinMAo));
+        const SatelliteArray templ =
+            in(m_T2Cof) * t2 + in(m_T3Cof) * t3 + t4 * (in(m_T4Cof) + tsince * in(m_T5Cof));
+
+        const SatelliteArray am = in(m_A0) * tempa * tempa;
+        const SatelliteArray nm = XKE / am.pow(1.5);
+        SatelliteArray em       = in(m_Eccentricity) - tempe;
+
+        Eigen::Map<Eigen::ArrayXi> error(m_Error.data() + first, n);
+        error = ((em >= 1.0) || (em < -0.001)).cast<int>();
+        em    = em.max(1.0e-6);
+
+        mm               = mm + in(m_MeanMotion) * templ;
+        SatelliteArray xlm = mm + argpm + nodem;
+        nodem            = fmod2pi(nodem);
+        argpm            = fmod2pi(argpm);
+        xlm              = fmod2pi(xlm);
+        mm               = fmod2pi(xlm - argpm - nodem);
+
+        // Long period periodics
+        const SatelliteArray axnl = em * argpm.cos();
+        SatelliteArray tmp        = 1.0 / (am * (1.0 - em * em));
+        const SatelliteArray aynl = em * argpm.sin() + tmp * in(m_AyCof);
+        const SatelliteArray xl   = mm + argpm + nodem + tmp * in(m_XlCof) * axnl;
+
+        // Solve kepler's equation. The number of iterations varies a lot between satellites, so this is done
+        // one satellite at a time rather than iterating the whole block until the slowest has converged.
+        const SatelliteArray u = fmod2pi(xl - nodem);
+        SatelliteArray sineo1(n), coseo1(n);
+        for (int k = 0; k < n; k++)
+        {
+            double eo1 = u[k], tem5 = 9999.9;
+            for (int ktr = 1; std::fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++)
+            {
+                sineo1[k] = std::sin(eo1);
+                coseo1[k] = std::cos(eo1);
+                tem5      = 1.0 - coseo1[k] * axnl[k] - sineo1[k] * aynl[k];
+                tem5      = (u[k] - aynl[k] * coseo1[k] + axnl[k] * sineo1[k] - eo1) / tem5;
+                if (std::fabs(tem5) >= 0.95)
+                    tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+                eo1 += tem5;
+            }
+        }
+
+        // Short period preliminary quantities
+        const SatelliteArray ecose = axnl * coseo1 + aynl * sineo1;
+        const SatelliteArray esine = axnl * sineo1 - aynl * coseo1;
+        const SatelliteArray el2   = axnl * axnl + aynl * aynl;
+        const SatelliteArray pl    = am * (1.0 - el2);
+        error                      = (error == 0 && (pl < 0.0)).select(4, error);
+
+        const SatelliteArray rl     = am * (1.0 - ecose);
+        const SatelliteArray rdotl  = am.sqrt() * esine / rl;
+        const SatelliteArray rvdotl = pl.sqrt() / rl;
+        const SatelliteArray betal  = (1.0 - el2).sqrt();
+        tmp                         = esine / (1.0 + betal);
+        const SatelliteArray sinu   = am / rl * (sineo1 - aynl - axnl * tmp);
+        const SatelliteArray cosu   = am / rl * (coseo1 - axnl + aynl * tmp);
+        SatelliteArray su           = sinu.binaryExpr(cosu, [](double y, double x)
+        {
+            return std::atan2(y, x);
+        });
+        const SatelliteArray sin2u = (cosu + cosu) * sinu;
+        const SatelliteArray cos2u = 1.0 - 2.0 * sinu * sinu;
+        tmp                        = 1.0 / pl;
+        const SatelliteArray temp1 = 0.5 * J2 * tmp;
+        const SatelliteArray temp2 = temp1 * tmp;
+
+        // Update for short period periodics
+        const SatelliteArray mrt =
+            rl * (1.0 - 1.5 * temp2 * betal * in(m_Con41)) + 0.5 * temp1 * in(m_X1mth2) * cos2u;
+        su                         = su - 0.25 * temp2 * in(m_X7thm1) * sin2u;
+        const SatelliteArray xnode = nodem + 1.5 * temp2 * in(m_CosI) * sin2u;
+        const SatelliteArray xinc  = in(m_Inclination) + 1.5 * temp2 * in(m_CosI) * in(m_SinI) * cos2u;
+        const SatelliteArray mvt = rdotl - nm * temp1 * in(m_X1mth2) * sin2u / XKE;
+        const SatelliteArray rvdot =
+            rvdotl + nm * temp1 * (in(m_X1mth2) * cos2u + 1.5 * in(m_Con41)) / XKE;
+        error = (error == 0 && (mrt < 1.0)).select(6, error);
+
+        // Orientation vectors
+        const SatelliteArray sinsu = su.sin(), cossu = su.cos();
+        const SatelliteArray snod = xnode.sin(), cnod = xnode.cos();
+        const SatelliteArray sini = xinc.sin(), cosi = xinc.cos();
+        const SatelliteArray xmx = -snod * cosi;
+        const SatelliteArray xmy = cnod * cosi;
+        const SatelliteArray ux  = xmx * sinsu + cnod * cossu;
+        const SatelliteArray uy  = xmy * sinsu + snod * cossu;
+        const SatelliteArray uz  = sini * sinsu;
+        const SatelliteArray vx  = xmx * cossu - cnod * sinsu;
+        const SatelliteArray vy  = xmy * cossu - snod * sinsu;
+        const SatelliteArray vz  = sini * cossu;
+
+        // Position and velocity (in km and km/sec)
+        const double vkmpersec = RADIUSEARTHKM * XKE / 60.0;
+        SatelliteMap(m_X.data() + first, n)  = mrt * ux * RADIUSEARTHKM;
+        SatelliteMap(m_Y.data() + first, n)  = mrt * uy * RADIUSEARTHKM;
+        SatelliteMap(m_Z.data() + first, n)  = mrt * uz * RADIUSEARTHKM;
+        SatelliteMap(m_VX.data() + first, n) = (mvt * ux + rvdot * vx) * vkmpersec;
+        SatelliteMap(m_VY.data() + first, n) = (mvt * uy + rvdot * vy) * vkmpersec;
+        SatelliteMap(m_VZ.data() + first, n) = (mvt * uz + rvdot * vz) * vkmpersec;
+    }
+}
+
+int SatelliteBatch::state(int index, double *position, double *velocity) const
+{
+    position[0] = m_X[index];
+    position[1] = m_Y[index];
+    position[2] = m_Z[index];
+    velocity[0] = m_VX[index];
+    velocity[1] = m_VY[index];
+    velocity[2] = m_VZ[index];
+
+    return m_Error[index];
+}
@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <vector>
+
+class Satellite;
+
+/**
+ * @class SatelliteBatch
+ * @short Propagates a large number of near Earth satellites at once with SGP4.
+ *
+ * The constants derived from each TLE by Satellite::init() are copied into contiguous arrays, and the
+ * time dependent part of SGP4 is evaluated a block of satellites at a time using Eigen array expressions,
+ * which are compiled to SIMD code. The blocks are spread over the global thread pool. The results are the
+ * same as Satellite::sgp4() up to rounding.
+ *
+ * Deep space satellites (period of 225 minutes or more) are not supported, their propagation keeps
+ * state between calls and depends on resonance terms that differ from one satellite to the next.
+ *
+ * @author KStars Developers
+ */
+class SatelliteBatch
+{
+    public:
+        SatelliteBatch() = default;
+
+        /**
+         * @short Add a satellite
+         * @return index of the satellite, or -1 if it can't be handled (deep space or invalid elements)
+         */
+        int add(const Satellite *satellite);
+
+        void clear();
+
+        int size() const
+        {
+            return static_cast<int>(m_Epoch.size());
+        }
+
+        /**
+         * @short Propagate all the satellites, in parallel
+         * @param jd UTC julian date
+         */
+        void solve(double jd);
+
+        /**
+         * @short Propagate the satellites [start, end) on the calling thread
+         */
+        void solve(double jd, int start, int end);
+
+        /**
+         * @short Get the state of a satellite from the last solve
+         * @param position ECI position in km
+         * @param velocity ECI velocity in km/s
+         * @return 0 on success or the same error code Satellite::sgp4() would return
+         */
+        int state(int index, double *position, double *velocity) const;
+
+    private:
+        // TLE epoch (julian date) and mean elements
+        std::vector<double> m_Epoch;
+        std::vector<double> m_M0, m_ArgPerigee0, m_Node0, m_MeanMotion, m_Eccentricity;
+        // Semi-major axis without drag, (XKE / n)^2/3
+        std::vector<double> m_A0;
+        // Inclination, and its sine and cosine
+        std::vector<double> m_Inclination, m_SinI, m_CosI;
+        // Secular rates
+        std::vector<double> m_MDot, m_ArgPerigeeDot, m_NodeDot, m_NodeCf;
+        // Drag. The terms of the simplified model (perigee below 220 km) are zero.
+        std::vector<double> m_Cc1, m_BstarCc4, m_BstarCc5, m_T2Cof, m_T3Cof, m_T4Cof, m_T5Cof;
+        std::vector<double> m_OmgCof, m_XmCof, m_Eta, m_DelMo, m_SinMAo, m_D2, m_D3, m_D4;
+        // Long and short period periodics
+        std::vector<double> m_AyCof, m_XlCof, m_Con41, m_X1mth2, m_X7thm1;
+
+        // Results
+        std::vector<double> m_X, m_Y, m_Z, m_VX, m_VY, m_VZ;
+        std::vector<int> m_Error;
+};
@@ -22,6 +22,17 @@ SkyPainter::SkyPainter()
 {
 }
 
+int SkyPainter::drawPointSources(const SkyPoint *locs, const float *mags, const char *sps, int n)
+{
+    int drawn = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (drawPointSource(&locs[i], mags[i], sps[i]))
+            drawn++;
+    }
+    return drawn;
+}
+
 void SkyPainter::setSizeMagLimit(float sizeMagLim)
 {
     m_sizeMagLim = sizeMagLim;
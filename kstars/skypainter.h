@@ -128,6 +128,18 @@ class SkyPainter
          */
         virtual bool drawPointSource(const SkyPoint *loc, float mag, char sp = 'A') = 0;
 
+        /**
+         * @short Draw an array of point sources (e.g., the stars of a star block).
+         * The default implementation calls drawPointSource() for each source; painters
+         * override it to project the whole array in one batch.
+         * @param locs array of n locations of the sources in the sky
+         * @param mags array of n magnitudes
+         * @param sps array of n spectral classes
+         * @param n number of sources
+         * @return the number of sources drawn
+         */
+        virtual int drawPointSources(const SkyPoint *locs, const float *mags, const char *sps, int n);
+
         /**
         * @short Draw a deep sky object (loaded from the new implementation)
         * @param obj the object to draw
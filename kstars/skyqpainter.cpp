@@ -11,6 +11,7 @@
 #include "kstarsdata.h"
 #include "kstars.h"
 #include "Options.h"
+#include "ksutils.h"
 #include "skymap.h"
 #include "projections/projector.h"
 #include "skycomponents/flagcomponent.h"
@@ -401,18 +402,22 @@ void SkyQPainter::drawSkyPolyline(LineList * list, SkipHashList * skipList,
 
     if (points->size() == 0)
         return;
-    QPointF oLast = m_proj->toScreen(points->first().get(), true, &isVisibleLast);
+
+    // Project the whole line in one batch
+    projectPoints(points);
+
+    QPointF oLast = KSUtils::vecToPoint(m_ScreenPoints[0]);
     // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(points->first().get());
+    isVisibleLast = m_ScreenVisible[0] && m_proj->checkVisibility(points->first().get());
     QPointF oThis, oThis2;
 
     for (int j = 1; j < points->size(); j++)
     {
         SkyPoint *pThis = points->at(j).get();
 
-        oThis2 = oThis = m_proj->toScreen(pThis, true, &isVisible);
+        oThis2 = oThis = KSUtils::vecToPoint(m_ScreenPoints[j]);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
+        isVisible = m_ScreenVisible[j] && m_proj->checkVisibility(pThis);
         bool doSkip = false;
         if (skipList)
         {
@@ -468,17 +473,23 @@ void SkyQPainter::drawSkyPolygon(LineList * list, bool forceClip)
         return;
     }
 
+    if (points->isEmpty())
+        return;
+
+    // Project the whole polygon in one batch
+    projectPoints(points);
+
     SkyPoint *pLast = points->last().get();
-    QPointF oLast   = m_proj->toScreen(pLast, true, &isVisibleLast);
+    QPointF oLast   = KSUtils::vecToPoint(m_ScreenPoints[points->size() - 1]);
     // & with the result of checkVisibility to clip away things below horizon
-    isVisibleLast &= m_proj->checkVisibility(pLast);
+    isVisibleLast = m_ScreenVisible[points->size() - 1] && m_proj->checkVisibility(pLast);
 
-    for (const auto &point : *points)
+    for (int j = 0; j < points->size(); j++)
     {
-        SkyPoint *pThis = point.get();
-        QPointF oThis   = m_proj->toScreen(pThis, true, &isVisible);
+        SkyPoint *pThis = points->at(j).get();
+        QPointF oThis   = KSUtils::vecToPoint(m_ScreenPoints[j]);
         // & with the result of checkVisibility to clip away things below horizon
-        isVisible &= m_proj->checkVisibility(pThis);
+        isVisible = m_ScreenVisible[j] && m_proj->checkVisibility(pThis);
 
         if (isVisible && isVisibleLast)
         {
@@ -733,6 +744,52 @@ bool SkyQPainter::drawPointSource(const SkyPoint * loc, float mag, char sp)
     }
 }
 
+int SkyQPainter::drawPointSources(const SkyPoint *locs, const float *mags, const char *sps, int n)
+{
+    // Check the visibility first so only the sources that might be on screen are projected
+    m_PointIndices.clear();
+    m_Points.clear();
+    for (int i = 0; i < n; i++)
+    {
+        if (m_proj->checkVisibility(&locs[i]))
+        {
+            m_PointIndices.push_back(i);
+            m_Points.push_back(&locs[i]);
+        }
+    }
+    if (m_Points.isEmpty())
+        return 0;
+
+    m_ScreenPoints.resize(m_Points.size());
+    m_ScreenVisible.resize(m_Points.size());
+    m_proj->toScreenVec(m_Points.constData(), m_Points.size(), m_ScreenPoints.data(), m_ScreenVisible.data());
+
+    int drawn = 0;
+    for (int i = 0; i < m_Points.size(); i++)
+    {
+        QPointF pos = KSUtils::vecToPoint(m_ScreenPoints[i]);
+        // FIXME: onScreen here should use canvas size rather than SkyMap size, especially while printing in portrait mode!
+        if (m_ScreenVisible[i] && m_proj->onScreen(pos))
+        {
+            const int index = m_PointIndices[i];
+            drawPointSource(pos, starWidth(mags[index]), sps[index]);
+            drawn++;
+        }
+    }
+    return drawn;
+}
+
+void SkyQPainter::projectPoints(const SkyList *points)
+{
+    m_Points.resize(points->size());
+    for (int i = 0; i < points->size(); i++)
+        m_Points[i] = points->at(i).get();
+
+    m_ScreenPoints.resize(points->size());
+    m_ScreenVisible.resize(points->size());
+    m_proj->toScreenVec(m_Points.constData(), m_Points.size(), m_ScreenPoints.data(), m_ScreenVisible.data());
+}
+
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
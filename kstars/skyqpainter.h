@@ -12,6 +12,9 @@
 
 #include <QColor>
 #include <QMap>
+#include <QVector>
+
+#include <Eigen/Core>
 
 class Projector;
 class QWidget;
@@ -88,6 +91,7 @@ class SkyQPainter : public SkyPainter, public QPainter
                              LineListLabel *label = nullptr) override;
         void drawSkyPolygon(LineList *list, bool forceClip = true) override;
         bool drawPointSource(const SkyPoint *loc, float mag, char sp = 'A') override;
+        int drawPointSources(const SkyPoint *locs, const float *mags, const char *sps, int n) override;
         bool drawCatalogObject(const CatalogObject &obj) override;
         void drawCatalogObjectImage(const QPointF &pos, const CatalogObject &obj,
                                     float positionAngle);
@@ -116,6 +120,14 @@ class SkyQPainter : public SkyPainter, public QPainter
 
     private:
         QColor skyColor() const;
+        /** Project all the points of a line list into m_ScreenPoints / m_ScreenVisible in one batch */
+        void projectPoints(const SkyList *points);
+
+        // Scratch buffers for the batched projections, kept to avoid allocating for every line and star block
+        QVector<const SkyPoint *> m_Points;
+        QVector<int> m_PointIndices;
+        QVector<Eigen::Vector2f> m_ScreenPoints;
+        QVector<bool> m_ScreenVisible;
         QPaintDevice *m_pd{ nullptr };
         const Projector *m_proj{ nullptr };
         bool m_vectorStars{ false };
@@ -44,15 +44,18 @@
 #include <QDesktopServices>
 #include <QDialog>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QImage>
 #include <QNetworkReply>
 #include <QPixmap>
 #include <QRegularExpression>
+#include <QSharedPointer>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
 #include <QStringList>
 #include <QWidget>
+#include <QtConcurrent>
 #include "zlib.h"
 
 #define DPRINTF if (false) fprintf
@@ -513,24 +516,39 @@ void getRunTimes(const QDate &date, const GeoLocation &geo, double minAltitude,
     }
 }
 
-// Computes the times when the given catalog object can be imaged on the date.
-double getRunHours(const CatalogObject &object, const QDate &date, const GeoLocation &geo, double minAltitude,
-                   double minMoonSeparation, double maxMoonAltitude, bool useArtificialHorizon)
+// Displays the visibility of a catalog object in its hours, altitude and moon items.
+void setVisibilityItems(const NightVisibility::Result &visibility, QStandardItem *hoursItem,
+                        QStandardItem *altitudeItem, QStandardItem *moonItem)
 {
-    QVector<QDateTime> jobStartTimes, jobEndTimes;
-    getRunTimes(date, geo, minAltitude, minMoonSeparation, maxMoonAltitude, object.ra0(), object.dec0(), useArtificialHorizon,
-                &jobStartTimes,
-                &jobEndTimes);
-    if (jobStartTimes.size() == 0 || jobEndTimes.size() == 0)
-        return 0;
-    else
+    const QString hoursText = QString("%1").arg(visibility.hours, 0, 'f', 1);
+    hoursItem->setText(hoursText);
+    hoursItem->setData(hoursText, Qt::UserRole);
+    hoursItem->setData(visibility.hours, HOURS_ROLE);
+
+    const QString altitudeText = QString("%1º").arg(visibility.maxAltitude, 0, 'f', 0);
+    altitudeItem->setText(altitudeText);
+    altitudeItem->setData(altitudeText, Qt::UserRole);
+    altitudeItem->setData(visibility.maxAltitude, ALTITUDE_ROLE);
+
+    const QString moonText = visibility.moonSeparation < 0 ? QString("") :
+                             QString("%1º").arg(visibility.moonSeparation, 0, 'f', 0);
+    moonItem->setText(moonText);
+    moonItem->setData(moonText, Qt::UserRole);
+    moonItem->setData(visibility.moonSeparation, MOON_ROLE);
+}
+
+// Computes the visibility of catalog objects on the worker threads.
+struct VisibilityFunctor
+{
+    typedef NightVisibility::Result result_type;
+
+    NightVisibility::Result operator()(const NightVisibility::Target &target) const
     {
-        double totalHours = 0.0;
-        for (int i = 0; i < jobStartTimes.size(); ++i)
-            totalHours += jobStartTimes[i].secsTo(jobEndTimes[i]) * 1.0 / 3600.0;
-        return totalHours;
+        return visibility->compute(target);
     }
-}
+
+    QSharedPointer<const NightVisibility> visibility;
+};
 
 // Pack is needed to generate the Astrobin search URLs.
 // This implementation was inspired by
@@ -752,43 +770,6 @@ double getAltitude(GeoLocation *geo, SkyPoint &p, const QDateTime &time)
     return p.alt().Degrees();
 }
 
-double getMaxAltitude(const KSAlmanac &ksal, const QDate &date, GeoLocation *geo, const SkyObject &object,
-                      double hoursAfterDusk = 0, double hoursBeforeDawn = 0)
-{
-    auto tz = QTimeZone(geo->TZ() * 3600);
-    KStarsDateTime midnight = KStarsDateTime(date.addDays(1), QTime(0, 1));
-    midnight.setTimeZone(tz);
-
-    QDateTime dawn = midnight.addSecs(24 * 3600 * ksal.getDawnAstronomicalTwilight());
-    dawn.setTimeZone(tz);
-    QDateTime dusk = midnight.addSecs(24 * 3600 * ksal.getDuskAstronomicalTwilight());
-    dusk.setTimeZone(tz);
-
-    QDateTime start = dusk.addSecs(hoursAfterDusk * 3600);
-    start.setTimeZone(tz);
-
-    auto end = dawn.addSecs(-hoursBeforeDawn * 3600);
-    end.setTimeZone(tz);
-
-    SkyPoint coords = object;
-    double maxAlt = -90;
-    auto t = start;
-    t.setTimeZone(tz);
-    QDateTime maxTime = t;
-
-    while (t.secsTo(end) > 0)
-    {
-        double alt = getAltitude(geo, coords, t);
-        if (alt > maxAlt)
-        {
-            maxAlt = alt;
-            maxTime = t;
-        }
-        t = t.addSecs(60 * 20);
-    }
-    return maxAlt;
-}
-
 }  // namespace
 
 CatalogFilter::CatalogFilter(QObject* parent) : QSortFilterProxyModel(parent)
@@ -1202,6 +1183,10 @@ void ImagingPlanner::initialize()
 
     connect(ui->CatalogView->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &ImagingPlanner::selectionChanged);
+    connect(&m_VisibilityWatcher, &QFutureWatcher<NightVisibility::Result>::resultsReadyAt,
+            this, &ImagingPlanner::visibilityResultsReady);
+    connect(&m_VisibilityWatcher, &QFutureWatcher<NightVisibility::Result>::finished,
+            this, &ImagingPlanner::visibilityFinished);
 
     // Initialize the date to KStars' date.
     if (getGeo())
@@ -1905,7 +1890,7 @@ CatalogObject *ImagingPlanner::addObject(const QString &name)
 
 // Adds the object to the catalog model, assuming a KStars catalog object can be found
 // for that name.
-bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name, int flags)
+bool ImagingPlanner::addCatalogItem(const NightVisibility &visibility, const QString &name, int flags)
 {
     CatalogObject *object = addObject(name);
     if (object == nullptr)
@@ -1919,6 +1904,11 @@ bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name,
         return ret;
     };
 
+    QStandardItem *hoursItem = getItemWithUserRole(QString());
+    QStandardItem *altitudeItem = getItemWithUserRole(QString());
+    QStandardItem *moonItem = getItemWithUserRole(QString());
+    setVisibilityItems(visibility.compute({object->ra0(), object->dec0()}), hoursItem, altitudeItem, moonItem);
+
     // Build the data. The columns must be the same as the #define columns at the top of this file.
     QList<QStandardItem *> itemList;
     for (int i = 0; i < LAST_COLUMN; ++i)
@@ -1929,10 +1919,6 @@ bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name,
         }
         else if (i == HOURS_COLUMN)
         {
-            double runHours = getRunHours(*object, getDate(), *getGeo(), ui->minAltitude->value(), ui->minMoon->value(),
-                                          ui->maxMoonAltitude->value(), ui->useArtificialHorizon->isChecked());
-            auto hoursItem = getItemWithUserRole(QString("%1").arg(runHours, 0, 'f', 1));
-            hoursItem->setData(runHours, HOURS_ROLE);
             itemList.append(hoursItem);
         }
         else if (i == TYPE_COLUMN)
@@ -1950,36 +1936,11 @@ bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name,
         }
         else if (i == ALTITUDE_COLUMN)
         {
-            const auto time = KStarsDateTime(QDateTime(getDate(), QTime(12, 0)));
-            const double altitude = getMaxAltitude(ksal, getDate(), getGeo(), *object, 0, 0);
-            auto altItem = getItemWithUserRole(QString("%1º").arg(altitude, 0, 'f', 0));
-            altItem->setData(altitude, ALTITUDE_ROLE);
-            itemList.append(altItem);
+            itemList.append(altitudeItem);
         }
         else if (i == MOON_COLUMN)
         {
-            KSMoon *moon = getMoon();
-            if (moon)
-            {
-                SkyPoint o;
-                o.setRA0(object->ra0());
-                o.setDec0(object->dec0());
-                auto tz = QTimeZone(getGeo()->TZ() * 3600);
-                KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-                midnight.setTimeZone(tz);
-                KSNumbers numbers(midnight.djd());
-                o.updateCoordsNow(&numbers);
-
-                double const separation = moon->angularDistanceTo(&o).Degrees();
-                auto moonItem = getItemWithUserRole(QString("%1º").arg(separation, 0, 'f', 0));
-                moonItem->setData(separation, MOON_ROLE);
-                itemList.append(moonItem);
-            }
-            else
-            {
-                auto moonItem = getItemWithUserRole(QString(""));
-                moonItem->setData(-1, MOON_ROLE);
-            }
+            itemList.append(moonItem);
         }
         else if (i == CONSTELLATION_COLUMN)
         {
@@ -2024,91 +1985,79 @@ void ImagingPlanner::addRowSlot(QList<QStandardItem *> itemList)
     updateCounts();
 }
 
+NightVisibility::Constraints ImagingPlanner::visibilityConstraints() const
+{
+    NightVisibility::Constraints constraints;
+    constraints.minAltitude = ui->minAltitude->value();
+    constraints.minMoonSeparation = ui->minMoon->value();
+    constraints.maxMoonAltitude = ui->maxMoonAltitude->value();
+    if (ui->useArtificialHorizon->isChecked() && KStarsData::Instance()->skyComposite()->artificialHorizon() != nullptr)
+        constraints.horizon = &KStarsData::Instance()->skyComposite()->artificialHorizon()->getHorizon();
+    return constraints;
+}
+
 void ImagingPlanner::recompute()
 {
     setStatus(i18n("Updating tables..."));
 
-    // Disconnect the filter from the model, or else we'll re-filter numRows squared times.
-    m_CatalogSortModel->setSourceModel(nullptr);
-
-    QElapsedTimer timer;
-    timer.start();
+    // Drop the results still coming for a previous date or previous constraints.
+    m_VisibilityWatcher.cancel();
+    m_VisibilityWatcher.waitForFinished();
 
-    auto tz = QTimeZone(getGeo()->TZ() * 3600);
-    KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-    KStarsDateTime ut  = getGeo()->LTtoUT(KStarsDateTime(midnight));
-    KSAlmanac ksal(ut, getGeo());
+    m_RecomputeTimer.start();
 
+    QVector<NightVisibility::Target> targets;
+    m_VisibilityRows.clear();
+    m_VisibilityNames.clear();
     for (int i = 0; i < m_CatalogModel->rowCount(); ++i)
     {
-        const QString &name = m_CatalogModel->item(i, 0)->text();
+        const QString &name = m_CatalogModel->item(i, NAME_COLUMN)->text();
         const CatalogObject *catalogEntry = getObject(name);
         if (catalogEntry == nullptr)
         {
             DPRINTF(stderr, "************* Couldn't find \"%s\"\n", name.toLatin1().data());
-            return;
-        }
-        double runHours = getRunHours(*catalogEntry, getDate(), *getGeo(), ui->minAltitude->value(),
-                                      ui->minMoon->value(), ui->maxMoonAltitude->value(), ui->useArtificialHorizon->isChecked());
-        QString hoursText = QString("%1").arg(runHours, 0, 'f', 1);
-        QStandardItem *hItem = new QStandardItem(hoursText);
-        hItem->setData(hoursText, Qt::UserRole);
-        hItem->setTextAlignment(Qt::AlignHCenter);
-        hItem->setData(runHours, HOURS_ROLE);
-        m_CatalogModel->setItem(i, HOURS_COLUMN, hItem);
-
-
-        const auto time = KStarsDateTime(QDateTime(getDate(), QTime(12, 0)));
-        const double altitude = getMaxAltitude(ksal, getDate(), getGeo(), *catalogEntry, 0, 0);
-        QString altText = QString("%1º").arg(altitude, 0, 'f', 0);
-        auto altItem = new QStandardItem(altText);
-        altItem->setData(altText, Qt::UserRole);
-        altItem->setData(altitude, ALTITUDE_ROLE);
-        m_CatalogModel->setItem(i, ALTITUDE_COLUMN, altItem);
-
-        KSMoon *moon = getMoon();
-        if (moon)
-        {
-            SkyPoint o;
-            o.setRA0(catalogEntry->ra0());
-            o.setDec0(catalogEntry->dec0());
-            auto tz = QTimeZone(getGeo()->TZ() * 3600);
-            KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-            midnight.setTimeZone(tz);
-            KSNumbers numbers(midnight.djd());
-            o.updateCoordsNow(&numbers);
-
-            double const separation = moon->angularDistanceTo(&o).Degrees();
-            QString moonText = QString("%1º").arg(separation, 0, 'f', 0);
-            auto moonItem = new QStandardItem(moonText);
-            moonItem->setData(moonText, Qt::UserRole);
-            moonItem->setData(separation, MOON_ROLE);
-            m_CatalogModel->setItem(i, MOON_COLUMN, moonItem);
-        }
-        else
-        {
-            auto moonItem = new QStandardItem("");
-            moonItem->setData("", Qt::UserRole);
-            moonItem->setData(-1, MOON_ROLE);
-            m_CatalogModel->setItem(i, MOON_COLUMN, moonItem);
+            continue;
         }
+        targets.append(NightVisibility::Target { catalogEntry->ra0(), catalogEntry->dec0() });
+        m_VisibilityRows.append(i);
+        m_VisibilityNames.append(name);
+    }
+
+    // Everything that doesn't depend on the object is computed once here, the objects are then
+    // computed on the worker threads and the table is updated as the results arrive.
+    // Don't re-sort and re-filter the table for each result, or else we'll do it numRows times.
+    m_CatalogSortModel->setDynamicSortFilter(false);
+    QSharedPointer<const NightVisibility> visibility(new NightVisibility(getDate(), getGeo(), getMoon(),
+            visibilityConstraints()));
+    m_VisibilityWatcher.setFuture(QtConcurrent::mapped(targets, VisibilityFunctor { visibility }));
+}
 
-        // Don't lose the imaged background highlighting.
-        const bool imaged = m_CatalogModel->item(i, FLAGS_COLUMN)->data(FLAGS_ROLE).toInt() & IMAGED_BIT;
-        if (imaged)
-            highlightImagedObject(m_CatalogModel->index(i, NAME_COLUMN), true);
-        const bool picked = m_CatalogModel->item(i, FLAGS_COLUMN)->data(FLAGS_ROLE).toInt() & PICKED_BIT;
-        if (picked)
-            highlightPickedObject(m_CatalogModel->index(i, NAME_COLUMN), true);
+void ImagingPlanner::visibilityResultsReady(int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+    {
+        // The table may have been reloaded since the computation started.
+        const int row = m_VisibilityRows[i];
+        if (row >= m_CatalogModel->rowCount() || m_CatalogModel->item(row, NAME_COLUMN)->text() != m_VisibilityNames[i])
+            continue;
+
+        // The items are updated in place, which keeps the imaged and picked highlighting.
+        setVisibilityItems(m_VisibilityWatcher.resultAt(i), m_CatalogModel->item(row, HOURS_COLUMN),
+                           m_CatalogModel->item(row, ALTITUDE_COLUMN), m_CatalogModel->item(row, MOON_COLUMN));
     }
-    // Reconnect the filter to the model.
-    m_CatalogSortModel->setSourceModel(m_CatalogModel.data());
-    // Need to do this again, I guess because we disconnected/reconnected above.
-    ui->CatalogView->setColumnHidden(FLAGS_COLUMN, true);
-    ui->CatalogView->setColumnHidden(NOTES_COLUMN, true);
+}
+
+void ImagingPlanner::visibilityFinished()
+{
+    m_CatalogSortModel->setDynamicSortFilter(true);
+    m_CatalogSortModel->invalidate();
+    if (m_VisibilityWatcher.isCanceled())
+        return;
+
     ui->CatalogView->resizeColumnsToContents();
+    scrollToName(currentObjectName());
 
-    DPRINTF(stderr, "Recompute took %.1fs\n", timer.elapsed() / 1000.0);
+    DPRINTF(stderr, "Recompute took %.1fs\n", m_RecomputeTimer.elapsed() / 1000.0);
     updateStatus();
 }
 
@@ -3818,13 +3767,13 @@ void ImagingPlanner::loadCatalogFromFile(QString path, bool reset)
     QStringList objectNames;
     if (inputFile.open(QIODevice::ReadOnly))
     {
-        const auto tz = QTimeZone(getGeo()->TZ() * 3600);
-        const KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-        const KStarsDateTime ut  = getGeo()->LTtoUT(KStarsDateTime(midnight));
-        const KSAlmanac ksal(ut, getGeo());
+        const NightVisibility visibility(getDate(), getGeo(), getMoon(), visibilityConstraints());
 
         if (reset)
         {
+            // Results still coming for the previous catalog would be dropped anyway.
+            m_VisibilityWatcher.cancel();
+            m_VisibilityWatcher.waitForFinished();
             Options::setImagingPlannerCatalogPath(path);
             Options::self()->save();
             if (m_CatalogModel->rowCount() > 0)
@@ -3934,7 +3883,7 @@ void ImagingPlanner::loadCatalogFromFile(QString path, bool reset)
         for (const auto &name : objectNames)
         {
             setStatus(i18n("%1/%2: Adding %3", ++iteration, objectNames.size(), name));
-            if (addCatalogItem(ksal, name, 0)) num++;
+            if (addCatalogItem(visibility, name, 0)) num++;
             else
             {
                 DPRINTF(stderr, "Couldn't add %s\n", name.toLatin1().data());
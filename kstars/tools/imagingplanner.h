@@ -8,9 +8,11 @@
 
 #include "ui_imagingplanner.h"
 #include "catalogsdb.h"
+#include "nightvisibility.h"
 
 #include <QDialog>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QMenu>
@@ -149,6 +151,8 @@ protected:
     void getHelp();
     void openOptionsMenu();
     void addRowSlot(QList<QStandardItem *> itemList);
+    void visibilityResultsReady(int begin, int end);
+    void visibilityFinished();
 
 
   private:
@@ -180,7 +184,8 @@ protected:
     bool getKStarsCatalogObject(const QString &name, CatalogObject *catObject);
     bool internetNameSearch(const QString &name, bool abellPlanetary, int abellNumber, CatalogObject * catObject);
 
-    bool addCatalogItem(const KSAlmanac &ksal, const QString &name, int flags = 0);
+    bool addCatalogItem(const NightVisibility &visibility, const QString &name, int flags = 0);
+    NightVisibility::Constraints visibilityConstraints() const;
     QUrl getAstrobinUrl(const QString &target, bool requireAwards, bool requireSomeFilters, double minRadius, double maxRadius);
     void popupAstrobin(const QString &target);
     void plotAltitudeGraph(const QDate &date, const dms &ra, const dms &dec);
@@ -251,6 +256,13 @@ protected:
     QFuture<void> m_LoadCatalogs;
     QFutureWatcher<void> *m_LoadCatalogsWatcher;
 
+    // Computes the hours, altitude and moon columns in the background, see recompute().
+    QFutureWatcher<NightVisibility::Result> m_VisibilityWatcher;
+    // Model row and object name of each result
+    QVector<int> m_VisibilityRows;
+    QStringList m_VisibilityNames;
+    QElapsedTimer m_RecomputeTimer;
+
     QHash<QString, CatalogObject> m_CatalogHash;
     QPixmap m_NoImagePixmap;
 
@@ -0,0 +1,351 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "nightvisibility.h"
+
+#include "artificialhorizoncomponent.h"
+#include "geolocation.h"
+#include "ksalmanac.h"
+#include "ksmoon.h"
+#include "Options.h"
+#include "skyobjects/skypoint.h"
+
+#include <QMap>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace
+{
+// Length of the night searched, in hours from noon
+constexpr double NIGHT_HOURS = 24.0;
+// Earth rotation, radians per hour of UT
+constexpr double SIDEREAL_RATE = 1.00273790935 * 15.0 * M_PI / 180.0;
+// Resolution of the Moon track, hours. The Moon moves about 0.1 degree against the stars in that time.
+constexpr double MOON_STEP = 10.0 / 60.0;
+// Sampling of the artificial horizon, hours, and bisections refining each crossing (to about a second)
+constexpr double HORIZON_STEP = 5.0 / 60.0;
+constexpr int HORIZON_BISECTIONS = 9;
+
+NightVisibility::Intervals intersectIntervals(const NightVisibility::Intervals &a, const NightVisibility::Intervals &b)
+{
+    NightVisibility::Intervals result;
+    int i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        const double start = std::max(a[i].first, b[j].first);
+        const double end = std::min(a[i].second, b[j].second);
+        if (start < end)
+            result.append(qMakePair(start, end));
+        if (a[i].second < b[j].second)
+            i++;
+        else
+            j++;
+    }
+    return result;
+}
+
+NightVisibility::Intervals complementIntervals(const NightVisibility::Intervals &intervals)
+{
+    NightVisibility::Intervals result;
+    double start = 0;
+    for (const auto &interval : intervals)
+    {
+        if (interval.first > start)
+            result.append(qMakePair(start, interval.first));
+        start = std::max(start, interval.second);
+    }
+    if (start < NIGHT_HOURS)
+        result.append(qMakePair(start, NIGHT_HOURS));
+    return result;
+}
+
+// Times when a value sampled every step hours from noon is below the limit, crossings are interpolated linearly
+NightVisibility::Intervals sampledWindows(const std::vector<double> &values, double limit, double step)
+{
+    NightVisibility::Intervals result;
+    if (values.empty())
+        return result;
+
+    bool below = values[0] <= limit;
+    double start = 0;
+    for (size_t i = 1; i < values.size(); i++)
+    {
+        if ((values[i] <= limit) == below)
+            continue;
+        const double t = step * (i - 1 + (limit - values[i - 1]) / (values[i] - values[i - 1]));
+        if (below)
+            result.append(qMakePair(start, t));
+        else
+            start = t;
+        below = !below;
+    }
+    if (below)
+        result.append(qMakePair(start, std::min(NIGHT_HOURS, step * (values.size() - 1))));
+    return result;
+}
+
+double clampUnit(double value)
+{
+    return std::min(1.0, std::max(-1.0, value));
+}
+
+// Astronomical dusk and dawn, in fractions of a day from midnight. KSAlmanac is slow to build and the scheduler
+// asks for the same nights over and over, so the last ones are kept.
+QPair<double, double> astronomicalTwilight(const KStarsDateTime &midnight, const GeoLocation *geo)
+{
+    static QMap<QString, QPair<double, double>> twilightCache;
+
+    // Lock this function because of the static cache
+    static std::mutex twilightMutex;
+    const std::lock_guard<std::mutex> lock(twilightMutex);
+
+    const QString key = QString("%1 %2 %3").arg(midnight.toString(Qt::ISODate)).arg(geo->lat()->Degrees())
+                        .arg(geo->lng()->Degrees());
+    auto cached = twilightCache.constFind(key);
+    if (cached != twilightCache.constEnd())
+        return cached.value();
+
+    if (twilightCache.size() > 10)
+        twilightCache.clear();
+    const KSAlmanac ksal(midnight, geo);
+    const QPair<double, double> twilight(ksal.getDuskAstronomicalTwilight(), ksal.getDawnAstronomicalTwilight());
+    twilightCache.insert(key, twilight);
+    return twilight;
+}
+}
+
+NightVisibility::NightVisibility(const QDate &date, const GeoLocation *geo, const KSMoon *moon,
+                                 const Constraints &constraints)
+    : m_Noon(geo->LTtoUT(KStarsDateTime(date, QTime(12, 0)))), m_Numbers(m_Noon.djd() + 0.5)
+{
+    m_LST = geo->GSTtoLST(m_Noon.gst()).radians();
+    m_SinLat = std::sin(geo->lat()->radians());
+    m_CosLat = std::cos(geo->lat()->radians());
+
+    // Dawn and dusk are given in fractions of a day from local midnight
+    const KStarsDateTime midnight = geo->LTtoUT(KStarsDateTime(date.addDays(1), QTime(0, 1)));
+    const QPair<double, double> twilight = astronomicalTwilight(midnight, geo);
+    const double midnightHours = m_Noon.secsTo(midnight) / 3600.0;
+    const double dusk = midnightHours + 24 * twilight.first;
+    const double dawn = midnightHours + 24 * twilight.second;
+    m_AstronomicalNight = qMakePair(std::max(0.0, dusk), std::min(NIGHT_HOURS, dawn));
+
+    if (constraints.enforceTwilight)
+        m_Night = qMakePair(std::max(0.0, dusk + Options::duskOffset()),
+                            std::min(NIGHT_HOURS, dawn + Options::dawnOffset() - std::abs(Options::preDawnTime()) / 60.0));
+
+    m_MinAltitude = constraints.minAltitude;
+    if (Options::enableAltitudeLimits())
+    {
+        m_MinAltitude = std::max(m_MinAltitude, Options::minimumAltLimit());
+        m_MaxAltitude = Options::maximumAltLimit();
+    }
+
+    if (constraints.horizon != nullptr && constraints.horizon->altitudeConstraintsExist())
+    {
+        m_Horizon = constraints.horizon;
+        // The horizon fills its cache on first use, do it now rather than from the worker threads
+        m_Horizon->altitudeConstraint(0);
+    }
+
+    m_MoonWindows.append(qMakePair(0.0, NIGHT_HOURS));
+    if (moon == nullptr)
+        return;
+
+    // Follow a copy of the Moon through the night
+    KSMoon track(*moon);
+    auto moveMoon = [&](const KStarsDateTime & ut)
+    {
+        KSNumbers numbers(ut.djd());
+        CachingDms LST = geo->GSTtoLST(ut.gst());
+        track.updateCoords(&numbers, true, geo->lat(), &LST, true);
+        track.EquatorialToHorizontal(&LST, geo->lat());
+    };
+
+    m_HasMoon = true;
+    m_MinMoonSeparation = constraints.minMoonSeparation;
+    std::vector<double> altitudes;
+    const int steps = static_cast<int>(std::ceil(NIGHT_HOURS / MOON_STEP));
+    for (int i = 0; i <= steps; i++)
+    {
+        moveMoon(KStarsDateTime(m_Noon.djd() + i * MOON_STEP / 24.0));
+        m_MoonX.push_back(track.dec().cos() * track.ra().cos());
+        m_MoonY.push_back(track.dec().cos() * track.ra().sin());
+        m_MoonZ.push_back(track.dec().sin());
+        altitudes.push_back(track.alt().Degrees());
+    }
+    if (constraints.maxMoonAltitude < 90)
+        m_MoonWindows = sampledWindows(altitudes, constraints.maxMoonAltitude, MOON_STEP);
+
+    moveMoon(midnight);
+    m_MoonMidnight[0] = track.dec().cos() * track.ra().cos();
+    m_MoonMidnight[1] = track.dec().cos() * track.ra().sin();
+    m_MoonMidnight[2] = track.dec().sin();
+}
+
+NightVisibility::Geometry NightVisibility::geometry(const Target &target) const
+{
+    SkyPoint p;
+    p.setRA0(target.ra0);
+    p.setDec0(target.dec0);
+    p.updateCoordsNow(&m_Numbers);
+
+    Geometry g;
+    g.sinDec = std::sin(p.dec().radians());
+    g.cosDec = std::cos(p.dec().radians());
+    g.a = m_SinLat * g.sinDec;
+    g.b = m_CosLat * g.cosDec;
+    g.hourAngle = std::remainder(m_LST - p.ra().radians(), 2 * M_PI);
+    g.x = g.cosDec * std::cos(p.ra().radians());
+    g.y = g.cosDec * std::sin(p.ra().radians());
+    g.z = g.sinDec;
+    return g;
+}
+
+NightVisibility::Result NightVisibility::compute(const Target &target) const
+{
+    const Geometry g = geometry(target);
+
+    Result result;
+    for (const auto &interval : windows(g))
+        result.hours += interval.second - interval.first;
+    result.maxAltitude = maxAltitude(g, m_AstronomicalNight);
+    if (m_HasMoon)
+        result.moonSeparation = std::acos(clampUnit(g.x * m_MoonMidnight[0] + g.y * m_MoonMidnight[1] +
+                                          g.z * m_MoonMidnight[2])) * 180.0 / M_PI;
+    return result;
+}
+
+NightVisibility::Intervals NightVisibility::windows(const Target &target) const
+{
+    return windows(geometry(target));
+}
+
+NightVisibility::Intervals NightVisibility::windows(const Geometry &g) const
+{
+    Intervals result;
+    if (m_Night.first < m_Night.second)
+        result.append(m_Night);
+
+    result = intersectIntervals(result, altitudeWindows(g, m_MinAltitude));
+    if (m_MaxAltitude < 90)
+        result = intersectIntervals(result, complementIntervals(altitudeWindows(g, m_MaxAltitude)));
+    result = intersectIntervals(result, m_MoonWindows);
+
+    if (m_HasMoon && m_MinMoonSeparation > 0 && !result.isEmpty())
+    {
+        // The separation is large enough where the cosine is small enough
+        std::vector<double> cosines(m_MoonX.size());
+        for (size_t i = 0; i < cosines.size(); i++)
+            cosines[i] = g.x * m_MoonX[i] + g.y * m_MoonY[i] + g.z * m_MoonZ[i];
+        result = intersectIntervals(result, sampledWindows(cosines, std::cos(m_MinMoonSeparation * M_PI / 180.0), MOON_STEP));
+    }
+
+    if (m_Horizon != nullptr && !result.isEmpty())
+        result = horizonWindows(g, result);
+    return result;
+}
+
+// The altitude is above the limit when cos(hour angle) >= (sin(limit) - a) / b, that is for hour angles
+// within +/- acos() of the transit.
+NightVisibility::Intervals NightVisibility::altitudeWindows(const Geometry &g, double altitude) const
+{
+    const double sinAltitude = std::sin(altitude * M_PI / 180.0);
+    double halfWidth;
+    if (g.b < 1e-9)
+        // At the pole, or a target at the pole: the altitude doesn't change
+        halfWidth = g.a >= sinAltitude ? M_PI : -1;
+    else
+    {
+        const double c = (sinAltitude - g.a) / g.b;
+        halfWidth = c <= -1 ? M_PI : (c > 1 ? -1 : std::acos(c));
+    }
+
+    Intervals result;
+    if (halfWidth >= M_PI)
+        result.append(qMakePair(0.0, NIGHT_HOURS));
+    else if (halfWidth >= 0)
+    {
+        // Transits are when the hour angle is a multiple of 2 pi
+        for (int k = -1; k <= 2; k++)
+        {
+            const double start = (2 * M_PI * k - halfWidth - g.hourAngle) / SIDEREAL_RATE;
+            const double end = (2 * M_PI * k + halfWidth - g.hourAngle) / SIDEREAL_RATE;
+            if (end > 0 && start < NIGHT_HOURS)
+                result.append(qMakePair(std::max(0.0, start), std::min(NIGHT_HOURS, end)));
+        }
+    }
+    return result;
+}
+
+bool NightVisibility::horizonOK(const Geometry &g, double t) const
+{
+    const double hourAngle = g.hourAngle + SIDEREAL_RATE * t;
+    const double sinH = std::sin(hourAngle), cosH = std::cos(hourAngle);
+    const double altitude = std::asin(clampUnit(g.a + g.b * cosH)) * 180.0 / M_PI;
+    double azimuth = std::atan2(-g.cosDec * sinH, g.sinDec * m_CosLat - g.cosDec * cosH * m_SinLat) * 180.0 / M_PI;
+    if (azimuth < 0)
+        azimuth += 360.0;
+    return m_Horizon->isAltitudeOK(azimuth, altitude, nullptr);
+}
+
+// The horizon is an arbitrary function of the azimuth, sample it and refine the crossings by bisection.
+NightVisibility::Intervals NightVisibility::horizonWindows(const Geometry &g, const Intervals &candidates) const
+{
+    Intervals result;
+    for (const auto &interval : candidates)
+    {
+        const int steps = std::max(1, static_cast<int>(std::ceil((interval.second - interval.first) / HORIZON_STEP)));
+        const double step = (interval.second - interval.first) / steps;
+
+        bool visible = horizonOK(g, interval.first);
+        double start = interval.first;
+        for (int i = 1; i <= steps; i++)
+        {
+            const double t = interval.first + i * step;
+            if (horizonOK(g, t) == visible)
+                continue;
+
+            double before = t - step, after = t;
+            for (int j = 0; j < HORIZON_BISECTIONS; j++)
+            {
+                const double middle = 0.5 * (before + after);
+                if (horizonOK(g, middle) == visible)
+                    before = middle;
+                else
+                    after = middle;
+            }
+
+            if (visible)
+                result.append(qMakePair(start, before));
+            else
+                start = after;
+            visible = !visible;
+        }
+        if (visible)
+            result.append(qMakePair(start, interval.second));
+    }
+    return result;
+}
+
+double NightVisibility::maxAltitude(const Geometry &g, const Interval &interval) const
+{
+    if (interval.first >= interval.second)
+        return -90;
+
+    // The altitude is highest at the ends of the interval or at a transit within it
+    double cosH = std::max(std::cos(g.hourAngle + SIDEREAL_RATE * interval.first),
+                           std::cos(g.hourAngle + SIDEREAL_RATE * interval.second));
+    for (int k = -1; k <= 2; k++)
+    {
+        const double transit = (2 * M_PI * k - g.hourAngle) / SIDEREAL_RATE;
+        if (transit >= interval.first && transit <= interval.second)
+            cosH = 1;
+    }
+    return std::asin(clampUnit(g.a + g.b * cosH)) * 180.0 / M_PI;
+}
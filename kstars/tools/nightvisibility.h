@@ -0,0 +1,137 @@
+/*
+    SPDX-FileCopyrightText: 2026 KStars Developers <kstars-devel@kde.org>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "dms.h"
+#include "ksnumbers.h"
+#include "kstarsdatetime.h"
+
+#include <QPair>
+#include <QVector>
+
+#include <vector>
+
+class ArtificialHorizon;
+class GeoLocation;
+class KSMoon;
+
+/**
+ * @class NightVisibility
+ * @short Computes when targets can be imaged during a night, for many targets at once.
+ *
+ * Everything that doesn't depend on the target is computed once by the constructor: the sidereal time,
+ * the twilight and the track of the Moon. For each target, the times when the altitude constraints are met
+ * are then solved analytically from the hour angle, the moon constraints are interpolated from the track,
+ * and only the artificial horizon, which has no closed form, is sampled. compute() doesn't change any shared
+ * state, so many targets can be evaluated in parallel.
+ *
+ * The constraints are the same as the scheduler's. Times are in hours from local noon on the date.
+ *
+ * @author KStars Developers
+ */
+class NightVisibility
+{
+    public:
+        // A time interval, in hours from local noon
+        typedef QPair<double, double> Interval;
+        typedef QVector<Interval> Intervals;
+
+        struct Constraints
+        {
+            double minAltitude { 0 };
+            double minMoonSeparation { 0 };
+            double maxMoonAltitude { 90 };
+            bool enforceTwilight { true };
+            // Enforced if not null and it has constraints
+            const ArtificialHorizon *horizon { nullptr };
+        };
+
+        struct Target
+        {
+            dms ra0;
+            dms dec0;
+        };
+
+        struct Result
+        {
+            // Time when all the constraints are met
+            double hours { 0 };
+            // Highest altitude between astronomical dusk and dawn, -90 if there is no astronomical night
+            double maxAltitude { -90 };
+            // Separation from the Moon at midnight, -1 without Moon
+            double moonSeparation { -1 };
+        };
+
+        /**
+         * @short Prepare the computations for the night that follows noon on the date.
+         * Must be called on the main thread, it reads the options and fills the cache of the artificial horizon.
+         * @param moon Moon object, copied. If null the moon constraints are ignored.
+         */
+        NightVisibility(const QDate &date, const GeoLocation *geo, const KSMoon *moon, const Constraints &constraints);
+
+        /**
+         * @short Compute the visibility of a target. Thread safe.
+         */
+        Result compute(const Target &target) const;
+
+        /**
+         * @short Times when all the constraints are met, in hours from local noon. Thread safe.
+         */
+        Intervals windows(const Target &target) const;
+
+        /**
+         * @return Local noon on the date, as UT. Windows are relative to this time.
+         */
+        const KStarsDateTime &noon() const
+        {
+            return m_Noon;
+        }
+
+    private:
+        // The position of a target during the night
+        struct Geometry
+        {
+            double sinDec { 0 }, cosDec { 1 };
+            // sin(altitude) = a + b * cos(hour angle)
+            double a { 0 }, b { 0 };
+            // Hour angle at noon
+            double hourAngle { 0 };
+            // Unit vector, equatorial coordinates of date
+            double x { 1 }, y { 0 }, z { 0 };
+        };
+
+        Geometry geometry(const Target &target) const;
+        Intervals windows(const Geometry &g) const;
+        Intervals altitudeWindows(const Geometry &g, double altitude) const;
+        Intervals horizonWindows(const Geometry &g, const Intervals &candidates) const;
+        bool horizonOK(const Geometry &g, double t) const;
+        double maxAltitude(const Geometry &g, const Interval &interval) const;
+
+        KStarsDateTime m_Noon;
+        // Precession and nutation at midnight, used for the whole night
+        KSNumbers m_Numbers;
+        // Local sidereal time at noon, radians
+        double m_LST { 0 };
+        double m_SinLat { 0 }, m_CosLat { 1 };
+
+        // Night, as limited by the twilight constraint, and the astronomical night
+        Interval m_Night { 0, 24 };
+        Interval m_AstronomicalNight { 0, 0 };
+
+        double m_MinAltitude { 0 };
+        double m_MaxAltitude { 90 };
+        double m_MinMoonSeparation { 0 };
+        const ArtificialHorizon *m_Horizon { nullptr };
+
+        // Moon track, unit vectors every MOON_STEP hours
+        bool m_HasMoon { false };
+        std::vector<double> m_MoonX, m_MoonY, m_MoonZ;
+        // Times when the moon altitude constraint is met
+        Intervals m_MoonWindows;
+        // Moon at midnight
+        double m_MoonMidnight[3] { 1, 0, 0 };
+};